@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup config
+ * Benchmark of the object name service with many named objects.
+ *
+ * This program names \c --nodes objects at the root of the name
+ * space, and \c --devices objects under each of them, as a script
+ * naming its vehicles and their devices would, then reports the cost
+ * of the lookups by name and by object, and of the name-based Config
+ * paths, e.g.
+ *
+ * \verbatim
+   ./waf --run="bench-names --nodes=10000 --devices=2"
+   \endverbatim
+ */
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * Report the cost of one benchmark.
+ * \param [in] name The benchmark name.
+ * \param [in] n The number of operations performed.
+ * \param [in] ms The elapsed time, in milliseconds.
+ */
+void
+Report (std::string name, uint64_t n, int64_t ms)
+{
+  std::cout << std::left << std::setw (36) << name
+            << std::right << std::setw (10) << std::fixed << std::setprecision (1)
+            << (ms * 1e6) / n << " ns/op"
+            << std::setw (10) << ms << " ms total"
+            << std::endl;
+}
+
+/**
+ * Build the name of an object.
+ * \param [in] prefix The name prefix.
+ * \param [in] i The index.
+ * \returns The name.
+ */
+std::string
+Name (std::string prefix, uint32_t i)
+{
+  std::ostringstream oss;
+  oss << prefix << i;
+  return oss.str ();
+}
+
+} // anonymous namespace
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 10000;
+  uint32_t devices = 2;
+  uint32_t rounds = 10;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of objects named at the root", nodes);
+  cmd.AddValue ("devices", "Number of objects named under each root object", devices);
+  cmd.AddValue ("rounds", "Number of times each lookup benchmark is repeated", rounds);
+  cmd.Parse (argc, argv);
+  NS_ABORT_MSG_IF (nodes == 0 || devices == 0, "--nodes and --devices must be positive");
+
+  std::vector<Ptr<Object> > roots;
+  std::vector<Ptr<Object> > leaves;
+  std::vector<std::string> rootNames;
+  std::vector<std::string> leafPaths;
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      roots.push_back (CreateObject<Object> ());
+      rootNames.push_back (Name ("Vehicle", i));
+      for (uint32_t j = 0; j < devices; j++)
+        {
+          leaves.push_back (CreateObject<Object> ());
+          leafPaths.push_back ("/Names/" + rootNames[i] + Name ("/Device", j));
+        }
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < nodes; i++)
+    {
+      Names::Add (rootNames[i], roots[i]);
+      for (uint32_t j = 0; j < devices; j++)
+        {
+          Names::Add (roots[i], Name ("Device", j), leaves[i * devices + j]);
+        }
+    }
+  Report ("Names::Add", nodes * (devices + 1), clock.End ());
+
+  Names::Clear ();
+  clock.Start ();
+  Names::Add ("Vehicle", roots.begin (), roots.end ());
+  for (uint32_t j = 0; j < devices; j++)
+    {
+      std::vector<Ptr<Object> > column;
+      for (uint32_t i = 0; i < nodes; i++)
+        {
+          column.push_back (leaves[i * devices + j]);
+        }
+      for (uint32_t i = 0; i < nodes; i++)
+        {
+          Names::Add (roots[i], Name ("Device", j), column[i]);
+        }
+    }
+  Report ("Names::Add in bulk", nodes * (devices + 1), clock.End ());
+
+  uint64_t n = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < leaves.size (); i++)
+        {
+          n += Names::Find<Object> (leafPaths[i]) != 0;
+        }
+    }
+  Report ("Names::Find", n, clock.End ());
+
+  n = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < leaves.size (); i++)
+        {
+          n += !Names::FindName (leaves[i]).empty ();
+        }
+    }
+  Report ("Names::FindName", n, clock.End ());
+
+  n = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < leaves.size (); i++)
+        {
+          n += !Names::FindPath (leaves[i]).empty ();
+        }
+    }
+  Report ("Names::FindPath", n, clock.End ());
+
+  n = 0;
+  clock.Start ();
+  for (uint32_t i = 0; i < leaves.size (); i++)
+    {
+      n += Config::LookupMatches (leafPaths[i]).GetN ();
+    }
+  Report ("Config::LookupMatches on /Names", n, clock.End ());
+
+  clock.Start ();
+  Names::Clear ();
+  Report ("Names::Clear", nodes * (devices + 1), clock.End ());
+  return 0;
+}
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <iomanip>
+
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup time
+ * Microbenchmark of the common ns3::Time conversions and operators.
+ *
+ * Each operation is run \c --n times on a small set of varying inputs
+ * and the average cost per operation is reported, e.g.
+ *
+ * \verbatim
+   ./waf --run="bench-time --n=10000000"
+   \endverbatim
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** Sink for the benchmark results, so the loops are not optimized away. */
+volatile double g_sink;
+
+/** Number of distinct inputs cycled through by each benchmark. */
+const uint32_t N_INPUTS = 16;
+
+/**
+ * Report the cost of one benchmark.
+ * \param [in] name The benchmark name.
+ * \param [in] n The number of operations performed.
+ * \param [in] ms The elapsed time, in milliseconds.
+ */
+void
+Report (std::string name, uint64_t n, int64_t ms)
+{
+  std::cout << std::left << std::setw (36) << name
+            << std::right << std::setw (10) << std::fixed << std::setprecision (2)
+            << (ms * 1e6) / n << " ns/op"
+            << std::endl;
+}
+
+} // anonymous namespace
+
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t n = 10000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("n", "Number of operations per benchmark", n);
+  cmd.Parse (argc, argv);
+
+  // Stop recording Time instances for resolution changes, as a real
+  // simulation does once it starts running.
+  Simulator::Run ();
+
+  double integral[N_INPUTS];
+  double fractional[N_INPUTS];
+  uint64_t integers[N_INPUTS];
+  Time times[N_INPUTS];
+  for (uint32_t i = 0; i < N_INPUTS; i++)
+    {
+      integral[i] = i + 1;
+      fractional[i] = (i + 1) * 0.137;
+      integers[i] = (i + 1) * 1000;
+      times[i] = Seconds (fractional[i]);
+    }
+
+  SystemWallClockMs clock;
+  double acc;
+
+  acc = 0;
+  clock.Start ();
+  for (uint64_t i = 0; i < n; i++)
+    {
+      acc += Seconds (integral[i % N_INPUTS]).GetTimeStep ();
+    }
+  Report ("Seconds (integral double)", n, clock.End ());
+  g_sink = acc;
+
+  acc = 0;
+  clock.Start ();
+  for (uint64_t i = 0; i < n; i++)
+    {
+      acc += Seconds (fractional[i % N_INPUTS]).GetTimeStep ();
+    }
+  Report ("Seconds (fractional double)", n, clock.End ());
+  g_sink = acc;
+
+  acc = 0;
+  clock.Start ();
+  for (uint64_t i = 0; i < n; i++)
+    {
+      acc += MilliSeconds (integers[i % N_INPUTS]).GetTimeStep ();
+    }
+  Report ("MilliSeconds (integer)", n, clock.End ());
+  g_sink = acc;
+
+  acc = 0;
+  clock.Start ();
+  for (uint64_t i = 0; i < n; i++)
+    {
+      acc += times[i % N_INPUTS].GetSeconds ();
+    }
+  Report ("GetSeconds", n, clock.End ());
+  g_sink = acc;
+
+  acc = 0;
+  clock.Start ();
+  for (uint64_t i = 0; i < n; i++)
+    {
+      acc += times[i % N_INPUTS].GetMilliSeconds ();
+    }
+  Report ("GetMilliSeconds", n, clock.End ());
+  g_sink = acc;
+
+  acc = 0;
+  clock.Start ();
+  for (uint64_t i = 0; i < n; i++)
+    {
+      acc += times[i % N_INPUTS].ToDouble (Time::PS);
+    }
+  Report ("ToDouble (Time::PS)", n, clock.End ());
+  g_sink = acc;
+
+  acc = 0;
+  clock.Start ();
+  for (uint64_t i = 0; i < n; i++)
+    {
+      Time t = times[i % N_INPUTS] + times[(i + 1) % N_INPUTS];
+      acc += (t > times[(i + 2) % N_INPUTS]) ? 1 : 0;
+    }
+  Report ("operator+ and operator>", n, clock.End ());
+  g_sink = acc;
+
+  acc = 0;
+  clock.Start ();
+  for (uint64_t i = 0; i < n; i++)
+    {
+      acc += (times[i % N_INPUTS] * 3).GetTimeStep ();
+    }
+  Report ("operator* (int64_t)", n, clock.End ());
+  g_sink = acc;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <iomanip>
+
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup tracing
+ * Microbenchmark of the per-packet cost of trace sources.
+ *
+ * A packet path firing 20 trace sources, each taking a reference
+ * counted pointer as a packet would, is run \c --n times with all the
+ * sources unconnected, with one of them connected, and with the
+ * sources fired through NS_TRACE, e.g.
+ *
+ * \verbatim
+   ./waf --run="bench-traced-callback --n=10000000"
+   \endverbatim
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** Stand-in for a Packet: reference counted, passed as Ptr<const>. */
+class Payload : public SimpleRefCount<Payload>
+{
+public:
+  uint32_t m_size;  //!< Payload size.
+};
+
+/** Number of trace sources fired per packet. */
+const uint32_t N_SOURCES = 20;
+
+/** Trace sink counting the bytes traced. */
+uint64_t g_bytes = 0;
+
+/**
+ * Trace sink.
+ * \param [in] p The traced payload.
+ */
+void
+Sink (Ptr<const Payload> p)
+{
+  g_bytes += p->m_size;
+}
+
+/** The trace sources of a device, queue and protocol path. */
+class Path
+{
+public:
+  /**
+   * Fire every trace source by calling it.
+   * \param [in] p The payload.
+   */
+  void Fire (Ptr<const Payload> p);
+  /**
+   * Fire every trace source through NS_TRACE.
+   * \param [in] p The payload.
+   */
+  void FireMacro (Ptr<const Payload> p);
+
+  /** The trace sources. */
+  TracedCallback<Ptr<const Payload> > m_sources[N_SOURCES];
+};
+
+void
+Path::Fire (Ptr<const Payload> p)
+{
+  for (uint32_t i = 0; i < N_SOURCES; i++)
+    {
+      m_sources[i] (p);
+    }
+}
+
+void
+Path::FireMacro (Ptr<const Payload> p)
+{
+  for (uint32_t i = 0; i < N_SOURCES; i++)
+    {
+      NS_TRACE (m_sources[i], (p));
+    }
+}
+
+/**
+ * Report the cost of one benchmark.
+ * \param [in] name The benchmark name.
+ * \param [in] n The number of packets.
+ * \param [in] ms The elapsed time, in milliseconds.
+ */
+void
+Report (std::string name, uint64_t n, int64_t ms)
+{
+  std::cout << std::left << std::setw (36) << name
+            << std::right << std::setw (10) << std::fixed << std::setprecision (2)
+            << (ms * 1e6) / n << " ns/packet"
+            << std::endl;
+}
+
+} // anonymous namespace
+
+
+int
+main (int argc, char *argv[])
+{
+  uint64_t n = 10000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("n", "Number of packets", n);
+  cmd.Parse (argc, argv);
+
+  Ptr<Payload> p = Create<Payload> ();
+  p->m_size = 1000;
+  Path path;
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  for (uint64_t i = 0; i < n; i++)
+    {
+      path.Fire (p);
+    }
+  Report ("20 unconnected sources", n, clock.End ());
+
+  clock.Start ();
+  for (uint64_t i = 0; i < n; i++)
+    {
+      path.FireMacro (p);
+    }
+  Report ("20 unconnected sources, NS_TRACE", n, clock.End ());
+
+  path.m_sources[N_SOURCES / 2].ConnectWithoutContext (MakeCallback (&Sink));
+  clock.Start ();
+  for (uint64_t i = 0; i < n; i++)
+    {
+      path.Fire (p);
+    }
+  Report ("20 sources, 1 connected", n, clock.End ());
+
+  std::cout << "Traced " << g_bytes << " bytes" << std::endl;
+  return 0;
+}
@@ -0,0 +1,298 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup object
+ * Benchmark of the TypeId registry, at the scale of a build with
+ * all the modules.
+ *
+ * A monolithic build registers more than a thousand TypeIds with
+ * several thousand attributes before \c main() starts, and scripts
+ * then look them up by name through ObjectFactory, Config and the
+ * helpers.  This program registers \c --types synthetic TypeIds (in
+ * inheritance chains of \c --depth types, each with \c --attributes
+ * attributes and \c --sources trace sources) on top of the TypeIds
+ * linked in, and reports the cost of the registration and of the
+ * lookups by name, e.g.
+ *
+ * \verbatim
+   ./waf --run="bench-type-id --types=1500 --attributes=4"
+   \endverbatim
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** The object created for all the synthetic TypeIds. */
+class BenchObject : public Object
+{
+public:
+  /**
+   * Register this type.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchObject")
+      .SetParent<Object> ()
+      .SetGroupName ("Core")
+      .AddConstructor<BenchObject> ()
+    ;
+    return tid;
+  }
+  /** The value of all the synthetic attributes. */
+  uint32_t m_value;
+  /** The synthetic trace sources. */
+  TracedCallback<uint32_t> m_trace;
+};
+
+/**
+ * Report the cost of one benchmark.
+ * \param [in] name The benchmark name.
+ * \param [in] n The number of operations performed.
+ * \param [in] ms The elapsed time, in milliseconds.
+ */
+void
+Report (std::string name, uint64_t n, int64_t ms)
+{
+  std::cout << std::left << std::setw (40) << name
+            << std::right << std::setw (10) << std::fixed << std::setprecision (1)
+            << (ms * 1e6) / n << " ns/op"
+            << std::setw (10) << ms << " ms total"
+            << std::endl;
+}
+
+/**
+ * Build the name of a synthetic type, attribute or trace source.
+ * \param [in] prefix The name prefix.
+ * \param [in] i The index.
+ * \returns The name.
+ */
+std::string
+Name (std::string prefix, uint32_t i)
+{
+  std::ostringstream oss;
+  oss << prefix << i;
+  return oss.str ();
+}
+
+} // anonymous namespace
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t types = 1500;
+  uint32_t depth = 4;
+  uint32_t attributes = 4;
+  uint32_t sources = 2;
+  uint32_t rounds = 50;
+
+  CommandLine cmd;
+  cmd.AddValue ("types", "Number of synthetic TypeIds", types);
+  cmd.AddValue ("depth", "Length of the inheritance chains", depth);
+  cmd.AddValue ("attributes", "Number of attributes per TypeId", attributes);
+  cmd.AddValue ("sources", "Number of trace sources per TypeId", sources);
+  cmd.AddValue ("rounds", "Number of times each lookup benchmark is repeated", rounds);
+  cmd.Parse (argc, argv);
+  NS_ABORT_MSG_IF (depth == 0 || attributes == 0,
+                   "--depth and --attributes must be positive");
+
+  SystemWallClockMs clock;
+  std::vector<std::string> names;
+  std::vector<std::vector<std::string> > attributeNames (types);
+  std::vector<std::vector<std::string> > sourceNames (types);
+  std::vector<TypeId> tids;
+  for (uint32_t i = 0; i < types; i++)
+    {
+      names.push_back (Name ("ns3::BenchType", i));
+      std::string suffix = Name ("Of", i);
+      for (uint32_t j = 0; j < attributes; j++)
+        {
+          attributeNames[i].push_back (Name ("Attribute", j) + suffix);
+        }
+      for (uint32_t j = 0; j < sources; j++)
+        {
+          sourceNames[i].push_back (Name ("Source", j) + suffix);
+        }
+    }
+
+  clock.Start ();
+  for (uint32_t i = 0; i < types; i++)
+    {
+      TypeId tid = TypeId (names[i].c_str ());
+      tid.SetParent (i % depth == 0 ? BenchObject::GetTypeId () : tids.back ())
+        .SetGroupName ("Core")
+        .AddConstructor<BenchObject> ();
+      for (uint32_t j = 0; j < attributes; j++)
+        {
+          tid.AddAttribute (attributeNames[i][j],
+                            "A synthetic attribute.",
+                            UintegerValue (j),
+                            MakeUintegerAccessor (&BenchObject::m_value),
+                            MakeUintegerChecker<uint32_t> ());
+        }
+      for (uint32_t j = 0; j < sources; j++)
+        {
+          tid.AddTraceSource (sourceNames[i][j],
+                              "A synthetic trace source.",
+                              MakeTraceSourceAccessor (&BenchObject::m_trace),
+                              "ns3::TracedValueCallback::Uint32");
+        }
+      tids.push_back (tid);
+    }
+  Report ("Register a TypeId", types, clock.End ());
+
+  uint64_t n = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < types; i++)
+        {
+          n += TypeId::LookupByName (names[i]).GetUid () != 0;
+        }
+    }
+  Report ("TypeId::LookupByName", n, clock.End ());
+
+  // Look up the attributes and trace sources of the whole
+  // inheritance chain from each type.
+  n = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < types; i++)
+        {
+          for (uint32_t k = i - i % depth; k <= i; k++)
+            {
+              for (uint32_t j = 0; j < attributes; j++)
+                {
+                  struct TypeId::AttributeInformation info;
+                  n += tids[i].LookupAttributeByName (attributeNames[k][j], &info);
+                }
+            }
+        }
+    }
+  Report ("TypeId::LookupAttributeByName", n, clock.End ());
+
+  n = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < types; i++)
+        {
+          for (uint32_t k = i - i % depth; k <= i; k++)
+            {
+              for (uint32_t j = 0; j < sources; j++)
+                {
+                  n += tids[i].LookupTraceSourceByName (sourceNames[k][j]) != 0;
+                }
+            }
+        }
+    }
+  Report ("TypeId::LookupTraceSourceByName", n, clock.End ());
+
+  n = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < types; i++)
+        {
+          Config::SetDefault (names[i] + "::" + attributeNames[i][0], UintegerValue (r));
+          n++;
+        }
+    }
+  Report ("Config::SetDefault", n, clock.End ());
+
+  n = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < types; i++)
+        {
+          ObjectFactory factory;
+          factory.SetTypeId (names[i]);
+          factory.Set (attributeNames[i][attributes - 1], UintegerValue (r));
+          n += factory.Create<Object> ()->GetObject<BenchObject> () != 0;
+        }
+    }
+  Report ("ObjectFactory::Create by name", n, clock.End ());
+
+  // Create many objects from the same factory, with a value parsed
+  // from a string, as the helpers do.
+  std::vector<ObjectFactory> factories (types);
+  for (uint32_t i = 0; i < types; i++)
+    {
+      factories[i].SetTypeId (tids[i]);
+      factories[i].Set (attributeNames[i][0], StringValue ("7"));
+    }
+  n = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < types; i++)
+        {
+          n += factories[i].Create<Object> () != 0;
+        }
+    }
+  Report ("ObjectFactory::Create", n, clock.End ());
+
+  std::vector<Ptr<Object> > objects;
+  for (uint32_t i = 0; i < types; i++)
+    {
+      objects.push_back (factories[i].Create<Object> ());
+    }
+  n = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < types; i++)
+        {
+          objects[i]->SetAttribute (attributeNames[i][0], StringValue ("9"));
+          n++;
+        }
+    }
+  Report ("ObjectBase::SetAttribute from a string", n, clock.End ());
+
+  std::vector<AttributeBundle> bundles (types);
+  for (uint32_t i = 0; i < types; i++)
+    {
+      bundles[i].SetTypeId (tids[i]);
+      bundles[i].Set (attributeNames[i][0], StringValue ("9"));
+    }
+  n = 0;
+  clock.Start ();
+  for (uint32_t r = 0; r < rounds; r++)
+    {
+      for (uint32_t i = 0; i < types; i++)
+        {
+          bundles[i].Apply (objects[i]);
+          n++;
+        }
+    }
+  Report ("AttributeBundle::Apply", n, clock.End ());
+
+  std::cout << "Registered " << TypeId::GetRegisteredN () << " TypeIds" << std::endl;
+  return 0;
+}
@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/stat.h>
+
+#include "ns3/core-module.h"
+#include "ns3/log-binary-sink.h"
+
+/**
+ * \file
+ * \ingroup logging
+ * Convert a log recorded with the \c binary-sink option of \c NS_LOG
+ * back to text, e.g.
+ *
+ * \verbatim
+   NS_LOG='binary-sink=run.log.bin:UdpEchoClientApplication' ./waf --run first
+   ./waf --run="log-binary-decode --in=run.log.bin --out=run.log"
+   \endverbatim
+ */
+
+using namespace ns3;
+
+/**
+ * Check if two names are the same file.
+ *
+ * \param [in] a The first file name.
+ * \param [in] b The second file name.
+ * \returns \c true if both names exist and are the same file.
+ */
+static bool
+IsSameFile (std::string a, std::string b)
+{
+  struct stat sa;
+  struct stat sb;
+  return stat (a.c_str (), &sa) == 0 && stat (b.c_str (), &sb) == 0
+    && sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+}
+
+int
+main (int argc, char *argv[])
+{
+  // The binary-sink option of NS_LOG, if still set, enabled the sink,
+  // maybe on the log to decode: stop it before anything else is
+  // logged, which would replace that log.
+  std::string sinkFile = LogBinarySink::GetFilename ();
+  bool recorded = LogBinarySink::Disable ();
+
+  std::string in = LogBinarySink::DEFAULT_FILENAME;
+  std::string out;
+
+  CommandLine cmd;
+  cmd.Usage ("Convert a binary log to text.");
+  cmd.AddValue ("in", "The binary log to read", in);
+  cmd.AddValue ("out", "The text file to write, instead of the standard output", out);
+  cmd.Parse (argc, argv);
+
+  if (recorded && IsSameFile (sinkFile, in))
+    {
+      std::cerr << "The binary-sink option of NS_LOG replaced " << in
+                << " with the lines logged while this program started:"
+                << " unset NS_LOG to decode a log" << std::endl;
+      return 1;
+    }
+
+  std::ifstream is (in.c_str (), std::ios::binary);
+  if (!is)
+    {
+      std::cerr << "Could not open " << in << std::endl;
+      return 1;
+    }
+
+  std::ofstream os;
+  if (!out.empty ())
+    {
+      os.open (out.c_str ());
+      if (!os)
+        {
+          std::cerr << "Could not open " << out << std::endl;
+          return 1;
+        }
+    }
+
+  if (!LogBinarySink::Decode (is, out.empty () ? std::cout : os))
+    {
+      std::cerr << in << " is not a binary log, or is truncated" << std::endl;
+      return 1;
+    }
+  return 0;
+}
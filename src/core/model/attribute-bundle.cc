@@ -0,0 +1,332 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "attribute-bundle.h"
+#include "attribute-construction-list.h"
+#include "log.h"
+#include "pointer.h"
+#include "string.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_STDLIB_H
+#include <cstdlib>
+#endif
+
+/**
+ * \file
+ * \ingroup object
+ * ns3::AttributeBundle implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AttributeBundle");
+
+AttributeBundle::AttributeBundle ()
+  : m_construction (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+AttributeBundle::AttributeBundle (TypeId tid)
+  : m_tid (tid),
+    m_construction (false)
+{
+  NS_LOG_FUNCTION (this << tid.GetName ());
+}
+
+void
+AttributeBundle::SetTypeId (TypeId tid)
+{
+  NS_LOG_FUNCTION (this << tid.GetName ());
+  m_tid = tid;
+  m_items.clear ();
+  m_construction = false;
+  m_environment.clear ();
+  m_defaults.clear ();
+}
+
+TypeId
+AttributeBundle::GetTypeId (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_tid;
+}
+
+void
+AttributeBundle::Set (std::string name, const AttributeValue &value)
+{
+  NS_LOG_FUNCTION (this << name << &value);
+  struct TypeId::AttributeInformation info;
+  if (!m_tid.LookupAttributeByName (name, &info))
+    {
+      NS_FATAL_ERROR ("Attribute name=" << name << " does not exist for tid=" << m_tid.GetName ());
+    }
+  if (!(info.flags & TypeId::ATTR_SET)
+      || !info.accessor->HasSetter ())
+    {
+      NS_FATAL_ERROR ("Attribute name=" << name << " is not settable for tid=" << m_tid.GetName ());
+    }
+  if (!Add (name, info, value, FROM_LIST, m_tid.GetName () + "::" + name))
+    {
+      NS_FATAL_ERROR ("Invalid value for attribute name=" << name << " of tid=" << m_tid.GetName ());
+    }
+}
+
+bool
+AttributeBundle::SetFailSafe (std::string name, const AttributeValue &value)
+{
+  NS_LOG_FUNCTION (this << name << &value);
+  struct TypeId::AttributeInformation info;
+  if (!m_tid.LookupAttributeByName (name, &info))
+    {
+      return false;
+    }
+  if (!(info.flags & TypeId::ATTR_SET)
+      || !info.accessor->HasSetter ())
+    {
+      return false;
+    }
+  return Add (name, info, value, FROM_LIST, m_tid.GetName () + "::" + name);
+}
+
+uint32_t
+AttributeBundle::GetN (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_items.size ();
+}
+
+void
+AttributeBundle::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_items.clear ();
+  m_construction = false;
+  m_environment.clear ();
+  m_defaults.clear ();
+}
+
+void
+AttributeBundle::Apply (ObjectBase *object) const
+{
+  NS_LOG_FUNCTION (this << object);
+  NS_ASSERT_MSG (object->GetInstanceTypeId () == m_tid
+                 || object->GetInstanceTypeId ().IsChildOf (m_tid),
+                 "Object of tid=" << object->GetInstanceTypeId ().GetName ()
+                 << " is not a " << m_tid.GetName ());
+  for (std::vector<struct Item>::const_iterator i = m_items.begin (); i != m_items.end (); ++i)
+    {
+      if (SetItem (object, *i))
+        {
+          continue;
+        }
+      if (!m_construction)
+        {
+          NS_FATAL_ERROR ("Attribute name=" << i->name << " could not be set for this object: tid="
+                          << object->GetInstanceTypeId ().GetName ());
+        }
+      SetFallback (object, *i);
+    }
+}
+
+bool
+AttributeBundle::SetItem (ObjectBase *object, const struct Item &item)
+{
+  NS_LOG_FUNCTION (object << item.name);
+  switch (item.mode)
+    {
+    case PARSE:
+      {
+        Ptr<AttributeValue> v = item.checker->CreateValidValue (*item.value);
+        return v != 0 && item.accessor->Set (object, *v);
+      }
+    default:
+      return item.accessor->Set (object, *item.value);
+    }
+}
+
+void
+AttributeBundle::SetFallback (ObjectBase *object, const struct Item &item) const
+{
+  NS_LOG_FUNCTION (this << object << item.name);
+  NS_LOG_DEBUG ("could not construct \"" << item.fullName << "\"");
+  if (item.source == FROM_LIST)
+    {
+      std::string value;
+      uint32_t next = 0;
+      while ((next = FindEnvironment (item.fullName, next, value)) != 0)
+        {
+          Ptr<AttributeValue> v = item.checker->CreateValidValue (StringValue (value));
+          if (v != 0 && item.accessor->Set (object, *v))
+            {
+              NS_LOG_DEBUG ("construct \"" << item.fullName << "\" from env var");
+              return;
+            }
+        }
+    }
+  if (item.source != FROM_INITIAL)
+    {
+      Ptr<AttributeValue> v = item.checker->CreateValidValue (*item.initialValue);
+      if (v != 0)
+        {
+          item.accessor->Set (object, *v);
+        }
+      NS_LOG_DEBUG ("construct \"" << item.fullName << "\" from initial value.");
+    }
+}
+
+void
+AttributeBundle::SetConstructionValues (const AttributeConstructionList &attributes)
+{
+  NS_LOG_FUNCTION (this << &attributes);
+  m_items.clear ();
+  m_construction = true;
+
+  // Parse the environment variable once, rather than for each
+  // attribute of each object as ObjectBase::ConstructSelf does.
+  // ObjectFactory sets the values again when the variable changes.
+  m_environment.clear ();
+  m_defaults.clear ();
+#ifdef HAVE_GETENV
+  char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+  if (envVar != 0)
+    {
+      m_environment = std::string (envVar);
+      std::string::size_type cur = 0;
+      std::string::size_type next = 0;
+      while (next != std::string::npos)
+        {
+          next = m_environment.find (";", cur);
+          std::string tmp = std::string (m_environment, cur, next-cur);
+          std::string::size_type equal = tmp.find ("=");
+          if (equal != std::string::npos)
+            {
+              m_defaults.push_back (std::make_pair (tmp.substr (0, equal),
+                                                    tmp.substr (equal + 1)));
+            }
+          cur = next + 1;
+        }
+    }
+#endif /* HAVE_GETENV */
+
+  TypeId tid = m_tid;
+  do {
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          Ptr<AttributeValue> value = attributes.Find (info.checker);
+          if (!(info.flags & TypeId::ATTR_CONSTRUCT))
+            {
+              if (value != 0)
+                {
+                  NS_FATAL_ERROR ("Attribute name=" << info.name << " tid=" << tid.GetName () << ": initial value cannot be set using attributes");
+                }
+              continue;
+            }
+          if (!info.accessor->HasSetter ())
+            {
+              // ObjectBase::ConstructSelf would fail silently
+              continue;
+            }
+          std::string fullName = tid.GetAttributeFullName (i);
+          if (value != 0 && Add (info.name, info, *value, FROM_LIST, fullName))
+            {
+              continue;
+            }
+          std::string env;
+          uint32_t next = 0;
+          bool found = false;
+          while (!found && (next = FindEnvironment (fullName, next, env)) != 0)
+            {
+              found = Add (info.name, info, StringValue (env), FROM_ENVIRONMENT, fullName);
+            }
+          if (!found)
+            {
+              Add (info.name, info, *info.initialValue, FROM_INITIAL, fullName);
+            }
+        }
+      tid = tid.GetParent ();
+    } while (tid != ObjectBase::GetTypeId ());
+}
+
+bool
+AttributeBundle::IsEnvironmentCurrent (void) const
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_GETENV
+  char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+  return envVar == 0 ? m_environment.empty () : m_environment == envVar;
+#else /* HAVE_GETENV */
+  return true;
+#endif /* HAVE_GETENV */
+}
+
+uint32_t
+AttributeBundle::FindEnvironment (std::string fullName, uint32_t start, std::string &value) const
+{
+  NS_LOG_FUNCTION (this << fullName << start);
+  for (uint32_t i = start; i < m_defaults.size (); i++)
+    {
+      if (m_defaults[i].first == fullName)
+        {
+          value = m_defaults[i].second;
+          return i + 1;
+        }
+    }
+  return 0;
+}
+
+bool
+AttributeBundle::Add (std::string name, const struct TypeId::AttributeInformation &info,
+                      const AttributeValue &value, enum Source source,
+                      std::string fullName)
+{
+  NS_LOG_FUNCTION (this << name << &value << source << fullName);
+  Ptr<AttributeValue> v = info.checker->CreateValidValue (value);
+  if (v == 0)
+    {
+      return false;
+    }
+  struct Item item;
+  item.name = name;
+  item.fullName = fullName;
+  item.accessor = info.accessor;
+  item.checker = info.checker;
+  item.initialValue = info.initialValue;
+  item.source = source;
+  item.value = v;
+  item.mode = SET;
+  // Parsing a string into a PointerValue creates an object, which
+  // each object must get its own copy of, as in ObjectBase::ConstructSelf().
+  // The object a PointerValue points to is shared, as it is there.
+  if (dynamic_cast<const PointerValue *> (PeekPointer (v)) != 0
+      && dynamic_cast<const StringValue *> (&value) != 0)
+    {
+      item.mode = PARSE;
+      item.value = value.Copy ();
+    }
+  for (std::vector<struct Item>::iterator i = m_items.begin (); i != m_items.end (); ++i)
+    {
+      if (i->name == name)
+        {
+          *i = item;
+          return true;
+        }
+    }
+  m_items.push_back (item);
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,294 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef ATTRIBUTE_BUNDLE_H
+#define ATTRIBUTE_BUNDLE_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "attribute.h"
+#include "object-base.h"
+#include "ptr.h"
+#include "type-id.h"
+
+/**
+ * \file
+ * \ingroup object
+ * ns3::AttributeBundle declaration.
+ */
+
+namespace ns3 {
+
+class AttributeConstructionList;
+
+/**
+ * \ingroup object
+ *
+ * \brief A set of attribute values, looked up, validated and parsed
+ * once, to be applied to many objects of the same TypeId.
+ *
+ * ObjectBase::SetAttribute() looks the attribute up by name and
+ * validates the value (parsing it again when it is a StringValue)
+ * each time it is called.  An AttributeBundle does this once, in
+ * Set(), and Apply() then only calls the attribute accessors:
+ *
+ * \code
+ *   AttributeBundle bundle (WifiNetDevice::GetTypeId ());
+ *   bundle.Set ("Mtu", StringValue ("1500"));
+ *   bundle.Apply (devices.Begin (), devices.End ());
+ * \endcode
+ *
+ * String values which create an object when they are parsed, like
+ * <tt>StringValue ("ns3::UniformRandomVariable[Max=10]")</tt> for a
+ * PointerValue attribute, are still parsed for each object, so that
+ * the objects do not share the object created.
+ *
+ * ObjectFactory keeps the values of all the attributes set at
+ * construction in an AttributeBundle, so that the objects it creates
+ * (and the objects created by the helpers, which use ObjectFactory)
+ * are constructed without attribute lookups or string parsing.
+ * The objects a PointerValue points to, set on the factory or as an
+ * initial value like
+ * <tt>Config::SetDefault ("ns3::Foo::Bar", PointerValue (bar))</tt>,
+ * are shared by all the objects constructed, as they are by the
+ * objects constructed through ObjectBase::ConstructSelf().
+ */
+class AttributeBundle
+{
+public:
+  /**
+   * Default constructor.
+   *
+   * This bundle can not hold values until it has a TypeId.
+   */
+  AttributeBundle ();
+  /**
+   * Construct a bundle for the attributes of a TypeId.
+   *
+   * \param [in] tid The TypeId of the objects the bundle is applied to.
+   */
+  AttributeBundle (TypeId tid);
+
+  /**
+   * Set the TypeId of the objects the bundle is applied to, and
+   * remove all the values.
+   *
+   * \param [in] tid The TypeId.
+   */
+  void SetTypeId (TypeId tid);
+  /**
+   * Get the TypeId of the objects the bundle is applied to.
+   * \returns The TypeId.
+   */
+  TypeId GetTypeId (void) const;
+
+  /**
+   * Add the value of an attribute, raising a fatal error if the
+   * attribute does not exist, can not be set, or if the value is
+   * not valid.
+   *
+   * The value replaces any previous value of the same attribute.
+   *
+   * \param [in] name The name of the attribute.
+   * \param [in] value The value of the attribute.
+   */
+  void Set (std::string name, const AttributeValue &value);
+  /**
+   * Add the value of an attribute, without raising errors.
+   *
+   * \param [in] name The name of the attribute.
+   * \param [in] value The value of the attribute.
+   * \returns \c true if the value was added.
+   */
+  bool SetFailSafe (std::string name, const AttributeValue &value);
+
+  /**
+   * Get the number of values.
+   * \returns The number of attribute values in the bundle.
+   */
+  uint32_t GetN (void) const;
+  /** Remove all the values. */
+  void Clear (void);
+
+  /**
+   * Set all the values of the bundle on an object, raising a fatal
+   * error if one of the accessors fails.
+   *
+   * The construction values of an ObjectFactory which can not be set
+   * fall back, as in ObjectBase::ConstructSelf(), to the \c NS_ATTRIBUTE_DEFAULT
+   * environment variable, then to the attribute initial value.
+   *
+   * \param [in] object The object, of the bundle TypeId or of a
+   *             TypeId derived from it.
+   */
+  void Apply (ObjectBase *object) const;
+  /**
+   * Set all the values of the bundle on an object.
+   *
+   * \tparam T \deduced The object type.
+   * \param [in] object The object.
+   */
+  template <typename T>
+  void Apply (Ptr<T> object) const;
+  /**
+   * Set all the values of the bundle on a range of objects.
+   *
+   * \tparam ITERATOR \deduced The type of iterator, which dereferences
+   *         to a Ptr<T>, e.g. NodeContainer::Iterator.
+   * \param [in] begin The first object.
+   * \param [in] end One past the last object.
+   */
+  template <typename ITERATOR>
+  void Apply (ITERATOR begin, ITERATOR end) const;
+
+private:
+  friend class ObjectFactory;
+
+  /**
+   * Add the values which all the attributes of the bundle TypeId and of
+   * its parents are constructed with.
+   *
+   * The values are taken, as in ObjectBase::ConstructSelf(), from
+   * \p attributes, else from the \c NS_ATTRIBUTE_DEFAULT environment
+   * variable, else from the attribute initial values.
+   *
+   * \param [in] attributes The values set on an ObjectFactory.
+   */
+  void SetConstructionValues (const AttributeConstructionList &attributes);
+  /**
+   * Check that the \c NS_ATTRIBUTE_DEFAULT environment variable has
+   * not changed since SetConstructionValues().
+   *
+   * \returns \c true if the construction values are still current.
+   */
+  bool IsEnvironmentCurrent (void) const;
+
+  /** Where a construction value comes from. */
+  enum Source
+  {
+    FROM_LIST,        //!< The values set on the ObjectFactory.
+    FROM_ENVIRONMENT, //!< The \c NS_ATTRIBUTE_DEFAULT environment variable.
+    FROM_INITIAL      //!< The attribute initial value.
+  };
+  /** How a value is set on each object. */
+  enum Mode
+  {
+    SET,              //!< The validated value is set.
+    PARSE             //!< The string is parsed for each object.
+  };
+
+  /**
+   * Add a value which does not need to be looked up.
+   *
+   * \param [in] name The attribute name.
+   * \param [in] info The attribute information.
+   * \param [in] value The value, not yet validated.
+   * \param [in] source Where the value comes from.
+   * \param [in] fullName The attribute full name.
+   * \returns \c true if the value is valid.
+   */
+  bool Add (std::string name, const struct TypeId::AttributeInformation &info,
+            const AttributeValue &value, enum Source source, std::string fullName);
+  /**
+   * Look a value up in the \c NS_ATTRIBUTE_DEFAULT environment variable.
+   *
+   * \param [in] fullName The full name of the attribute.
+   * \param [in] start The first entry of the variable to look at.
+   * \param [out] value The value found.
+   * \returns The index of the entry after the one found, or 0 if none was found.
+   */
+  uint32_t FindEnvironment (std::string fullName, uint32_t start, std::string &value) const;
+
+  /** An attribute value. */
+  struct Item
+  {
+    /** The attribute name. */
+    std::string name;
+    /** The attribute full name, as in the environment variable. */
+    std::string fullName;
+    /** The attribute accessor. */
+    Ptr<const AttributeAccessor> accessor;
+    /** The attribute checker. */
+    Ptr<const AttributeChecker> checker;
+    /** The value, validated unless \c mode is PARSE. */
+    Ptr<const AttributeValue> value;
+    /** The attribute initial value, for the construction values. */
+    Ptr<const AttributeValue> initialValue;
+    /** How the value is set on each object. */
+    enum Mode mode;
+    /** Where the value comes from. */
+    enum Source source;
+  };
+
+  /**
+   * Set a value on an object.
+   *
+   * \param [in] object The object.
+   * \param [in] item The value.
+   * \returns \c true if the accessor succeeded.
+   */
+  static bool SetItem (ObjectBase *object, const struct Item &item);
+  /**
+   * Set a construction value which could not be set on an object
+   * from the next source, as ObjectBase::ConstructSelf() does.
+   *
+   * \param [in] object The object.
+   * \param [in] item The value which could not be set.
+   */
+  void SetFallback (ObjectBase *object, const struct Item &item) const;
+
+  /** The TypeId of the objects the bundle is applied to. */
+  TypeId m_tid;
+  /** The attribute values. */
+  std::vector<struct Item> m_items;
+  /** Whether the values were set by SetConstructionValues(). */
+  bool m_construction;
+  /** The \c NS_ATTRIBUTE_DEFAULT variable the values were set with. */
+  std::string m_environment;
+  /** The name and value pairs of m_environment. */
+  std::vector<std::pair<std::string, std::string> > m_defaults;
+};
+
+} // namespace ns3
+
+
+/***************************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+void
+AttributeBundle::Apply (Ptr<T> object) const
+{
+  Apply (PeekPointer (object));
+}
+
+template <typename ITERATOR>
+void
+AttributeBundle::Apply (ITERATOR begin, ITERATOR end) const
+{
+  for (ITERATOR i = begin; i != end; ++i)
+    {
+      Apply (PeekPointer (*i));
+    }
+}
+
+} // namespace ns3
+
+#endif /* ATTRIBUTE_BUNDLE_H */
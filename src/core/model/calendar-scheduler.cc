@@ -125,6 +125,43 @@ CalendarScheduler::Insert (const Event &ev)
   m_qSize++;
   ResizeUp ();
 }
+void
+CalendarScheduler::InsertBatch (const std::vector<Scheduler::Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  // The events of a batch are usually later than the events already
+  // in their bucket: search their position from the end of the bucket.
+  for (std::vector<Scheduler::Event>::const_iterator ev = events.begin ();
+       ev != events.end (); ++ev)
+    {
+      Bucket &bucket = m_buckets[Hash (ev->key.m_ts)];
+      Bucket::iterator i = bucket.end ();
+      while (i != bucket.begin ())
+        {
+          Bucket::iterator prev = i;
+          --prev;
+          if (!(ev->key < prev->key))
+            {
+              break;
+            }
+          i = prev;
+        }
+      bucket.insert (i, *ev);
+    }
+  m_qSize += events.size ();
+
+  // Resize once to the final size.
+  uint32_t nBuckets = m_nBuckets;
+  while (m_qSize > nBuckets * 2 && nBuckets < 32768)
+    {
+      nBuckets *= 2;
+    }
+  if (nBuckets != m_nBuckets)
+    {
+      Resize (nBuckets);
+    }
+}
+
 bool
 CalendarScheduler::IsEmpty (void) const
 {
@@ -0,0 +1,573 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "checkpointer.h"
+#include "default-simulator-impl.h"
+#include "make-event.h"
+#include "random-variable-stream.h"
+#include "simulator.h"
+#include "string.h"
+#include "log.h"
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::Checkpointer, ns3::Checkpointable, ns3::CheckpointWriter and
+ * ns3::CheckpointReader implementations.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Checkpointer");
+
+NS_OBJECT_ENSURE_REGISTERED (Checkpointer);
+
+namespace {
+
+/** The first bytes of a checkpoint file. */
+const char MAGIC[8] = { 'n', 's', '3', 'c', 'k', 'p', 't', '\n' };
+/** The version of the checkpoint format. */
+const uint32_t VERSION = 1;
+
+/** The event restored in the place of a cancelled event. */
+void
+Cancelled (void)
+{
+}
+
+/**
+ * Get the simulator, once checked that it can be checkpointed.
+ * @returns The simulator.
+ */
+Ptr<DefaultSimulatorImpl>
+GetSimulator (void)
+{
+  return DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+}
+
+} // anonymous namespace
+
+
+CheckpointWriter::CheckpointWriter ()
+{
+}
+
+void
+CheckpointWriter::WriteU8 (uint8_t value)
+{
+  m_data.push_back (value);
+}
+
+void
+CheckpointWriter::WriteU32 (uint32_t value)
+{
+  for (int i = 0; i < 4; ++i)
+    {
+      m_data.push_back ((value >> (8 * i)) & 0xff);
+    }
+}
+
+void
+CheckpointWriter::WriteU64 (uint64_t value)
+{
+  for (int i = 0; i < 8; ++i)
+    {
+      m_data.push_back ((value >> (8 * i)) & 0xff);
+    }
+}
+
+void
+CheckpointWriter::WriteDouble (double value)
+{
+  uint64_t bits;
+  std::memcpy (&bits, &value, sizeof (bits));
+  WriteU64 (bits);
+}
+
+void
+CheckpointWriter::WriteString (std::string value)
+{
+  WriteU32 (value.size ());
+  m_data.append (value);
+}
+
+void
+CheckpointWriter::WriteTime (Time value)
+{
+  WriteU64 (value.GetTimeStep ());
+}
+
+void
+CheckpointWriter::WriteVector (const Vector &value)
+{
+  WriteDouble (value.x);
+  WriteDouble (value.y);
+  WriteDouble (value.z);
+}
+
+void
+CheckpointWriter::WriteEvent (const EventId &id)
+{
+  NS_ASSERT_MSG (id.GetUid () != 2, "The destroy events are not saved in the checkpoints");
+  if (Simulator::IsExpired (id))
+    {
+      WriteU8 (0);
+      return;
+    }
+  WriteU8 (1);
+  WriteU64 (id.GetTs ());
+  WriteU32 (id.GetContext ());
+  WriteU32 (id.GetUid ());
+  m_events.insert (id.GetUid ());
+}
+
+
+CheckpointReader::CheckpointReader (std::string data, std::string name)
+  : m_data (data),
+    m_offset (0),
+    m_name (name)
+{
+}
+
+void
+CheckpointReader::Read (uint8_t *buffer, uint32_t size)
+{
+  if (m_data.size () - m_offset < size)
+    {
+      NS_FATAL_ERROR ("Checkpointer: the state of " << m_name << " in the checkpoint is truncated");
+    }
+  std::memcpy (buffer, m_data.data () + m_offset, size);
+  m_offset += size;
+}
+
+bool
+CheckpointReader::IsEnd (void) const
+{
+  return m_offset == m_data.size ();
+}
+
+uint8_t
+CheckpointReader::ReadU8 (void)
+{
+  uint8_t value;
+  Read (&value, 1);
+  return value;
+}
+
+uint32_t
+CheckpointReader::ReadU32 (void)
+{
+  uint8_t bytes[4];
+  Read (bytes, 4);
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i)
+    {
+      value |= (uint32_t) bytes[i] << (8 * i);
+    }
+  return value;
+}
+
+uint64_t
+CheckpointReader::ReadU64 (void)
+{
+  uint8_t bytes[8];
+  Read (bytes, 8);
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i)
+    {
+      value |= (uint64_t) bytes[i] << (8 * i);
+    }
+  return value;
+}
+
+double
+CheckpointReader::ReadDouble (void)
+{
+  uint64_t bits = ReadU64 ();
+  double value;
+  std::memcpy (&value, &bits, sizeof (value));
+  return value;
+}
+
+std::string
+CheckpointReader::ReadString (void)
+{
+  uint32_t size = ReadU32 ();
+  if (m_data.size () - m_offset < size)
+    {
+      NS_FATAL_ERROR ("Checkpointer: the state of " << m_name << " in the checkpoint is truncated");
+    }
+  std::string value = m_data.substr (m_offset, size);
+  m_offset += size;
+  return value;
+}
+
+Time
+CheckpointReader::ReadTime (void)
+{
+  return TimeStep (ReadU64 ());
+}
+
+Vector
+CheckpointReader::ReadVector (void)
+{
+  Vector value;
+  value.x = ReadDouble ();
+  value.y = ReadDouble ();
+  value.z = ReadDouble ();
+  return value;
+}
+
+EventId
+CheckpointReader::ReadEvent (EventImpl *event)
+{
+  if (ReadU8 () == 0)
+    {
+      event->Unref ();
+      return EventId ();
+    }
+  Scheduler::EventKey key;
+  key.m_ts = ReadU64 ();
+  key.m_context = ReadU32 ();
+  key.m_uid = ReadU32 ();
+  return GetSimulator ()->ScheduleWithKey (key, event);
+}
+
+
+Checkpointable::~Checkpointable ()
+{
+}
+
+
+TypeId
+Checkpointer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Checkpointer")
+    .SetParent<Object> ()
+    .SetGroupName ("Core")
+    .AddConstructor<Checkpointer> ()
+    .AddAttribute ("Interval",
+                   "The simulation time between two periodic checkpoints.",
+                   TimeValue (Seconds (100)),
+                   MakeTimeAccessor (&Checkpointer::m_interval),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("Filename",
+                   "The file the periodic checkpoints are written to, "
+                   "each one replacing the previous one.",
+                   StringValue ("checkpoint.bin"),
+                   MakeStringAccessor (&Checkpointer::m_filename),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+Checkpointer::Checkpointer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Checkpointer::~Checkpointer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Checkpointer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Stop ();
+  m_models.clear ();
+  Object::DoDispose ();
+}
+
+void
+Checkpointer::AddModel (std::string name, Checkpointable *model)
+{
+  NS_LOG_FUNCTION (this << name << model);
+  NS_ASSERT_MSG (m_models.find (name) == m_models.end (),
+                 "A model named " << name << " is already added");
+  m_models[name] = model;
+}
+
+void
+Checkpointer::RemoveModel (std::string name)
+{
+  NS_LOG_FUNCTION (this << name);
+  m_models.erase (name);
+}
+
+void
+Checkpointer::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  Stop ();
+  m_event = Simulator::Schedule (m_interval, &Checkpointer::Periodic, this);
+}
+
+void
+Checkpointer::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_event);
+}
+
+void
+Checkpointer::SetStopTime (Time time)
+{
+  NS_LOG_FUNCTION (this << time);
+  NS_ASSERT_MSG (time >= Simulator::Now (), "Can not stop at " << time << ", in the past");
+  Simulator::Cancel (m_stopEvent);
+  m_stopEvent = Simulator::Schedule (time - Simulator::Now (), &Simulator::Stop);
+}
+
+void
+Checkpointer::Periodic (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Schedule the next checkpoint first, so that it is saved in this one.
+  m_event = Simulator::Schedule (m_interval, &Checkpointer::Periodic, this);
+  Save (m_filename);
+}
+
+void
+Checkpointer::Save (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  CheckSupported ();
+  Ptr<DefaultSimulatorImpl> simulator = GetSimulator ();
+
+  CheckpointWriter writer;
+  writer.m_data.append (MAGIC, sizeof (MAGIC));
+  writer.WriteU32 (VERSION);
+  DefaultSimulatorImpl::Clock clock = simulator->GetClock ();
+  writer.WriteU64 (clock.ts);
+  writer.WriteU32 (clock.currentUid);
+  writer.WriteU32 (clock.context);
+  writer.WriteU32 (clock.uid);
+  writer.WriteU64 (clock.eventCount);
+  writer.WriteEvent (m_event);
+  writer.WriteEvent (m_stopEvent);
+  RandomVariableStream::SaveAll (writer);
+
+  writer.WriteU32 (m_models.size ());
+  for (std::map<std::string, Checkpointable *>::const_iterator i = m_models.begin ();
+       i != m_models.end (); ++i)
+    {
+      // Each model is written in its own block, so that Load() can
+      // check that it reads exactly its state.
+      CheckpointWriter model;
+      i->second->SaveState (model);
+      writer.WriteString (i->first);
+      writer.WriteString (model.m_data);
+      writer.m_events.insert (model.m_events.begin (), model.m_events.end ());
+    }
+
+  std::vector<Scheduler::EventKey> pending;
+  std::vector<Scheduler::EventKey> cancelled;
+  simulator->GetPendingEvents (pending, cancelled);
+  uint32_t unsaved = 0;
+  std::vector<Scheduler::EventKey>::const_iterator first = pending.end ();
+  for (std::vector<Scheduler::EventKey>::const_iterator i = pending.begin ();
+       i != pending.end (); ++i)
+    {
+      if (writer.m_events.find (i->m_uid) == writer.m_events.end ())
+        {
+          if (unsaved++ == 0)
+            {
+              first = i;
+            }
+        }
+    }
+  if (unsaved != 0)
+    {
+      NS_FATAL_ERROR ("Checkpointer: " << unsaved << " pending events are not saved by any model,"
+                      << " the first at " << TimeStep (first->m_ts) << " in context "
+                      << first->m_context << ": the models which schedule them must be added"
+                      << " to the checkpointer");
+    }
+  // The cancelled events are restored too, as they are counted when
+  // their time comes.
+  writer.WriteU32 (cancelled.size ());
+  for (std::vector<Scheduler::EventKey>::const_iterator i = cancelled.begin ();
+       i != cancelled.end (); ++i)
+    {
+      writer.WriteU64 (i->m_ts);
+      writer.WriteU32 (i->m_context);
+      writer.WriteU32 (i->m_uid);
+    }
+
+  std::string temporary = filename + ".tmp";
+  std::ofstream os (temporary.c_str (), std::ios::binary | std::ios::trunc);
+  os.write (writer.m_data.data (), writer.m_data.size ());
+  os.close ();
+  if (!os)
+    {
+      NS_FATAL_ERROR ("Checkpointer: could not write the checkpoint " << temporary);
+    }
+  if (std::rename (temporary.c_str (), filename.c_str ()) != 0)
+    {
+      NS_FATAL_ERROR ("Checkpointer: could not rename the checkpoint " << temporary
+                      << " to " << filename << ": " << std::strerror (errno));
+    }
+  NS_LOG_LOGIC ("checkpoint of " << pending.size () << " events at " << Simulator::Now ()
+                << " written to " << filename);
+}
+
+void
+Checkpointer::Load (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  CheckSupported ();
+  Ptr<DefaultSimulatorImpl> simulator = GetSimulator ();
+
+  std::ifstream is (filename.c_str (), std::ios::binary);
+  if (!is.is_open ())
+    {
+      NS_FATAL_ERROR ("Checkpointer: could not open the checkpoint " << filename);
+    }
+  std::ostringstream data;
+  data << is.rdbuf ();
+  CheckpointReader reader (data.str (), "the simulator");
+  if (reader.m_data.compare (0, sizeof (MAGIC), MAGIC, sizeof (MAGIC)) != 0)
+    {
+      NS_FATAL_ERROR ("Checkpointer: " << filename << " is not a checkpoint");
+    }
+  reader.m_offset = sizeof (MAGIC);
+  uint32_t version = reader.ReadU32 ();
+  if (version != VERSION)
+    {
+      NS_FATAL_ERROR ("Checkpointer: " << filename << " is a checkpoint of version " << version
+                      << ", not " << VERSION);
+    }
+
+  DefaultSimulatorImpl::Clock clock;
+  clock.ts = reader.ReadU64 ();
+  clock.currentUid = reader.ReadU32 ();
+  clock.context = reader.ReadU32 ();
+  clock.uid = reader.ReadU32 ();
+  clock.eventCount = reader.ReadU64 ();
+  simulator->SetClock (clock);
+  m_event = reader.ReadEvent (MakeEvent (&Checkpointer::Periodic, this));
+  m_stopEvent = reader.ReadEvent (MakeEvent (&Simulator::Stop));
+  RandomVariableStream::RestoreAll (reader);
+
+  std::set<std::string> restored;
+  uint32_t n = reader.ReadU32 ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      std::string name = reader.ReadString ();
+      std::string state = reader.ReadString ();
+      std::map<std::string, Checkpointable *>::const_iterator model = m_models.find (name);
+      if (model == m_models.end ())
+        {
+          NS_FATAL_ERROR ("Checkpointer: the model " << name << " of the checkpoint "
+                          << filename << " is not added to the checkpointer");
+        }
+      CheckpointReader modelReader (state, "the model " + name);
+      model->second->RestoreState (modelReader);
+      if (!modelReader.IsEnd ())
+        {
+          NS_FATAL_ERROR ("Checkpointer: the model " << name
+                          << " did not read all its state from the checkpoint");
+        }
+      restored.insert (name);
+    }
+  for (std::map<std::string, Checkpointable *>::const_iterator i = m_models.begin ();
+       i != m_models.end (); ++i)
+    {
+      if (restored.find (i->first) == restored.end ())
+        {
+          NS_FATAL_ERROR ("Checkpointer: the model " << i->first << " is not in the checkpoint "
+                          << filename);
+        }
+    }
+  n = reader.ReadU32 ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      Scheduler::EventKey key;
+      key.m_ts = reader.ReadU64 ();
+      key.m_context = reader.ReadU32 ();
+      key.m_uid = reader.ReadU32 ();
+      EventId id = simulator->ScheduleWithKey (key, MakeEvent (&Cancelled));
+      id.Cancel ();
+    }
+  if (!reader.IsEnd ())
+    {
+      NS_FATAL_ERROR ("Checkpointer: " << filename << " has data after the checkpoint");
+    }
+  NS_LOG_LOGIC ("checkpoint " << filename << " restored at " << Simulator::Now ());
+}
+
+std::multiset<std::string> *
+Checkpointer::GetUnsupported (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  // Never deleted, as the destructors of static objects may remove
+  // their reasons.
+  static std::multiset<std::string> *unsupported = new std::multiset<std::string> ();
+  return unsupported;
+}
+
+void
+Checkpointer::AddUnsupported (std::string reason)
+{
+  NS_LOG_FUNCTION (reason);
+  GetUnsupported ()->insert (reason);
+}
+
+void
+Checkpointer::RemoveUnsupported (std::string reason)
+{
+  NS_LOG_FUNCTION (reason);
+  std::multiset<std::string> *unsupported = GetUnsupported ();
+  std::multiset<std::string>::iterator i = unsupported->find (reason);
+  if (i != unsupported->end ())
+    {
+      unsupported->erase (i);
+    }
+}
+
+void
+Checkpointer::CheckSupported (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::string impl = Simulator::GetImplementation ()->GetInstanceTypeId ().GetName ();
+  if (impl != "ns3::DefaultSimulatorImpl")
+    {
+      NS_FATAL_ERROR ("Checkpointer: a simulation run by " << impl
+                      << " can not be checkpointed, only ns3::DefaultSimulatorImpl can");
+    }
+  std::multiset<std::string> *unsupported = GetUnsupported ();
+  if (!unsupported->empty ())
+    {
+      std::ostringstream oss;
+      for (std::multiset<std::string>::const_iterator i = unsupported->begin ();
+           i != unsupported->end (); i = unsupported->upper_bound (*i))
+        {
+          oss << (i == unsupported->begin () ? "" : ", ") << *i;
+        }
+      NS_FATAL_ERROR ("Checkpointer: the simulation can not be checkpointed: " << oss.str ());
+    }
+}
+
+} // namespace ns3
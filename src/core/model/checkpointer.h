@@ -0,0 +1,365 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHECKPOINTER_H
+#define CHECKPOINTER_H
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "event-id.h"
+#include "event-impl.h"
+#include "nstime.h"
+#include "object.h"
+#include "vector.h"
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::Checkpointer, ns3::Checkpointable, ns3::CheckpointWriter and
+ * ns3::CheckpointReader declarations.
+ */
+
+namespace ns3 {
+
+/**
+ * @ingroup simulator
+ * @brief Write the state of a model to a checkpoint.
+ *
+ * The values are written in a fixed byte order, and the doubles bit
+ * for bit, so that a restored simulation continues exactly as the
+ * saved one.
+ */
+class CheckpointWriter
+{
+public:
+  /**
+   * Write an unsigned 8 bit integer.
+   * @param [in] value The value.
+   */
+  void WriteU8 (uint8_t value);
+  /**
+   * Write an unsigned 32 bit integer.
+   * @param [in] value The value.
+   */
+  void WriteU32 (uint32_t value);
+  /**
+   * Write an unsigned 64 bit integer.
+   * @param [in] value The value.
+   */
+  void WriteU64 (uint64_t value);
+  /**
+   * Write a double, bit for bit.
+   * @param [in] value The value.
+   */
+  void WriteDouble (double value);
+  /**
+   * Write a string.
+   * @param [in] value The value.
+   */
+  void WriteString (std::string value);
+  /**
+   * Write a time.
+   * @param [in] value The value.
+   */
+  void WriteTime (Time value);
+  /**
+   * Write a vector, bit for bit.
+   * @param [in] value The value.
+   */
+  void WriteVector (const Vector &value);
+  /**
+   * Write an event, which CheckpointReader::ReadEvent() schedules
+   * again if it is pending.
+   *
+   * Every pending event of the simulation must be written by the
+   * model which scheduled it.
+   *
+   * @param [in] id The event, expired or not.
+   */
+  void WriteEvent (const EventId &id);
+
+private:
+  friend class Checkpointer;
+
+  /** Constructor. */
+  CheckpointWriter ();
+
+  /** The data written. */
+  std::string m_data;
+  /** The unique ids of the pending events written. */
+  std::set<uint32_t> m_events;
+};
+
+/**
+ * @ingroup simulator
+ * @brief Read the state of a model from a checkpoint.
+ *
+ * The values must be read in the order they were written by
+ * CheckpointWriter.  Reading past the end of the state of the model
+ * is a fatal error.
+ */
+class CheckpointReader
+{
+public:
+  /**
+   * Read an unsigned 8 bit integer.
+   * @returns The value.
+   */
+  uint8_t ReadU8 (void);
+  /**
+   * Read an unsigned 32 bit integer.
+   * @returns The value.
+   */
+  uint32_t ReadU32 (void);
+  /**
+   * Read an unsigned 64 bit integer.
+   * @returns The value.
+   */
+  uint64_t ReadU64 (void);
+  /**
+   * Read a double.
+   * @returns The value.
+   */
+  double ReadDouble (void);
+  /**
+   * Read a string.
+   * @returns The value.
+   */
+  std::string ReadString (void);
+  /**
+   * Read a time.
+   * @returns The value.
+   */
+  Time ReadTime (void);
+  /**
+   * Read a vector.
+   * @returns The value.
+   */
+  Vector ReadVector (void);
+  /**
+   * Read an event, and schedule it with the time, context and unique
+   * id it had if it was pending:
+   *
+   * @code
+   *   m_event = reader.ReadEvent (MakeEvent (&MyModel::Timeout, this));
+   * @endcode
+   *
+   * @param [in] event The event to schedule, created by MakeEvent().
+   * @returns The id of the event, or an expired id if it was not
+   *          pending and was not scheduled.
+   */
+  EventId ReadEvent (EventImpl *event);
+
+private:
+  friend class Checkpointer;
+
+  /**
+   * Constructor.
+   * @param [in] data The data to read.
+   * @param [in] name The name of what is read, for the error messages.
+   */
+  CheckpointReader (std::string data, std::string name);
+  /**
+   * Read raw bytes.
+   * @param [out] buffer The bytes read.
+   * @param [in] size The number of bytes.
+   */
+  void Read (uint8_t *buffer, uint32_t size);
+  /**
+   * Check whether all the data was read.
+   * @returns @c true if all the data was read.
+   */
+  bool IsEnd (void) const;
+
+  /** The data to read. */
+  std::string m_data;
+  /** The offset of the next byte to read. */
+  std::string::size_type m_offset;
+  /** The name of what is read. */
+  std::string m_name;
+};
+
+/**
+ * @ingroup simulator
+ * @brief The interface of the models whose state is saved in the
+ * checkpoints, see Checkpointer::AddModel().
+ */
+class Checkpointable
+{
+public:
+  /** Destructor. */
+  virtual ~Checkpointable ();
+  /**
+   * Write the state of the model, and its pending events.
+   * @param [in,out] writer The checkpoint.
+   */
+  virtual void SaveState (CheckpointWriter &writer) const = 0;
+  /**
+   * Read the state written by SaveState(), and schedule the pending
+   * events again.
+   * @param [in,out] reader The checkpoint.
+   */
+  virtual void RestoreState (CheckpointReader &reader) = 0;
+};
+
+/**
+ * @ingroup simulator
+ * @brief Save the state of a running simulation to a checkpoint file,
+ * and restore it to continue the simulation bit-exactly, after a
+ * crash or to run a what-if branch.
+ *
+ * A checkpoint holds the clock and the event list of the simulator,
+ * the state of every random variable stream (see
+ * RandomVariableStream::SaveAll()) and the state of the models added
+ * with AddModel(), which implement Checkpointable.  The pending events
+ * are callbacks, which can not be written to a file: each model writes
+ * the events it scheduled, and schedules them again when it is
+ * restored, with the time, context and unique id they had, so that
+ * the restored events run in the same order.
+ *
+ * The simulation which restores a checkpoint must first create the
+ * same objects, with the same random variables, as the one which saved
+ * it; Load() then replaces their state, and the event list, with those
+ * of the checkpoint:
+ *
+ * @code
+ *   Ptr<Checkpointer> checkpointer = CreateObject<Checkpointer> ();
+ *   checkpointer->SetAttribute ("Filename", StringValue ("run.ckpt"));
+ *   checkpointer->AddModel ("traffic", &traffic);
+ *   if (resume)
+ *     {
+ *       checkpointer->Load ("run.ckpt");
+ *     }
+ *   else
+ *     {
+ *       checkpointer->SetStopTime (Seconds (36000));
+ *       checkpointer->Start ();
+ *     }
+ *   Simulator::Run ();
+ * @endcode
+ *
+ * What can not be saved is a fatal error which names it: a simulator
+ * other than ns3::DefaultSimulatorImpl, a pending event which no model
+ * wrote (with its time and context), a random variable or a model
+ * missing from the checkpoint or from the restored simulation, and
+ * any reason registered with AddUnsupported().  Only the models added
+ * to the checkpointer are saved: a model which has no pending event
+ * when a checkpoint is taken, and is not added, is restored in the
+ * state the simulation created it in.
+ *
+ * The file is written to a temporary file, and renamed, so that a
+ * crash while it is written keeps the previous checkpoint.
+ */
+class Checkpointer : public Object
+{
+public:
+  /**
+   * Get the registered TypeId for this class.
+   * @returns The TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  Checkpointer ();
+  /** Destructor. */
+  virtual ~Checkpointer ();
+
+  /**
+   * Add a model whose state is saved in the checkpoints.  The model
+   * must outlive the checkpointer, or be removed first.
+   * @param [in] name The unique name of the model in the checkpoints.
+   * @param [in] model The model.
+   */
+  void AddModel (std::string name, Checkpointable *model);
+  /**
+   * Remove a model added by AddModel().
+   * @param [in] name The name of the model.
+   */
+  void RemoveModel (std::string name);
+
+  /** Save a checkpoint to Filename every Interval of simulation time from now. */
+  void Start (void);
+  /** Stop saving periodic checkpoints. */
+  void Stop (void);
+  /**
+   * Stop the simulation at an absolute time, as Simulator::Stop() does
+   * with a delay, with an event saved in the checkpoints.
+   * @param [in] time The time to stop at.
+   */
+  void SetStopTime (Time time);
+
+  /**
+   * Save a checkpoint now.
+   * @param [in] filename The file to write it to.
+   */
+  void Save (std::string filename);
+  /**
+   * Restore a checkpoint, when the simulation is not running.
+   *
+   * All the pending events are removed: the events which must run in
+   * the restored simulation, other than those of the checkpoint, are
+   * scheduled after.
+   *
+   * @param [in] filename The file to read it from.
+   */
+  void Load (std::string filename);
+
+  /**
+   * Register a reason which prevents checkpoints, for example a
+   * model which can not save its state.  A reason can be added
+   * several times, and must be removed as many times.
+   * @param [in] reason The description of the reason.
+   */
+  static void AddUnsupported (std::string reason);
+  /**
+   * Remove a reason registered by AddUnsupported().
+   * @param [in] reason The description of the reason.
+   */
+  static void RemoveUnsupported (std::string reason);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /** Save a periodic checkpoint, and schedule the next one. */
+  void Periodic (void);
+  /**
+   * Report a fatal error if the simulation can not be checkpointed.
+   */
+  static void CheckSupported (void);
+  /**
+   * Get the registered reasons which prevent checkpoints.
+   * @returns The reasons.
+   */
+  static std::multiset<std::string> * GetUnsupported (void);
+
+  /** Simulation time between two periodic checkpoints. */
+  Time m_interval;
+  /** The file the periodic checkpoints are written to. */
+  std::string m_filename;
+  /** The models, by name. */
+  std::map<std::string, Checkpointable *> m_models;
+  /** The next periodic checkpoint. */
+  EventId m_event;
+  /** The end of the simulation, set by SetStopTime(). */
+  EventId m_stopEvent;
+};
+
+} // namespace ns3
+
+#endif /* CHECKPOINTER_H */
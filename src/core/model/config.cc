@@ -599,6 +599,20 @@ public:
   /** \copydoc Config::GetRootNamespaceObject() */
   Ptr<Object> GetRootNamespaceObject (uint32_t i) const;
 
+  /** \copydoc Config::InvalidateCompiledPaths() */
+  void InvalidateCompiledPaths (void);
+  /**
+   * Get the current namespace generation.
+   *
+   * The generation changes every time the namespace is invalidated,
+   * so a Config::CompiledPath resolved in an older generation is stale.
+   * \returns The namespace generation.
+   */
+  uint32_t GetGeneration (void) const;
+
+  /** Constructor. */
+  ConfigImpl ();
+
 private:
   /**
    * Break a Config path into the leading path and the last leaf token.
@@ -614,8 +628,16 @@ private:
 
   /** The list of Config path roots. */
   Roots m_roots;
+  /** The namespace generation. */
+  uint32_t m_generation;
 };
 
+ConfigImpl::ConfigImpl ()
+  : m_generation (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
 void 
 ConfigImpl::ParsePath (std::string path, std::string *root, std::string *leaf) const
 {
@@ -714,6 +736,7 @@ ConfigImpl::RegisterRootNamespaceObject (Ptr<Object> obj)
 {
   NS_LOG_FUNCTION (this << obj);
   m_roots.push_back (obj);
+  InvalidateCompiledPaths ();
 }
 
 void 
@@ -726,6 +749,7 @@ ConfigImpl::UnregisterRootNamespaceObject (Ptr<Object> obj)
       if (*i == obj)
         {
           m_roots.erase (i);
+          InvalidateCompiledPaths ();
           return;
         }
     }
@@ -744,6 +768,109 @@ ConfigImpl::GetRootNamespaceObject (uint32_t i) const
   return m_roots[i];
 }
 
+void
+ConfigImpl::InvalidateCompiledPaths (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_generation++;
+}
+
+uint32_t
+ConfigImpl::GetGeneration (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_generation;
+}
+
+namespace Config {
+
+CompiledPath::CompiledPath (std::string path)
+  : m_path (path),
+    m_resolved (false),
+    m_generation (0)
+{
+  NS_LOG_FUNCTION (this << path);
+  std::string::size_type slash = path.find_last_of ("/");
+  NS_ASSERT_MSG (slash != std::string::npos, "Invalid Config path " << path);
+  m_root = path.substr (0, slash);
+  m_leaf = path.substr (slash+1, path.size ()-(slash+1));
+}
+std::string
+CompiledPath::GetPath (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_path;
+}
+std::string
+CompiledPath::GetLeaf (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_leaf;
+}
+bool
+CompiledPath::IsResolved (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_resolved && m_generation == ConfigImpl::Get ()->GetGeneration ();
+}
+const MatchContainer &
+CompiledPath::GetMatches (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!IsResolved ())
+    {
+      NS_LOG_LOGIC ("resolving " << m_root);
+      m_generation = ConfigImpl::Get ()->GetGeneration ();
+      m_matches = ConfigImpl::Get ()->LookupMatches (m_root);
+      m_resolved = true;
+    }
+  return m_matches;
+}
+void
+CompiledPath::Invalidate (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_resolved = false;
+  m_matches = MatchContainer ();
+}
+void
+CompiledPath::Set (const AttributeValue &value)
+{
+  NS_LOG_FUNCTION (this << &value);
+  GetMatches ();
+  m_matches.Set (m_leaf, value);
+}
+void
+CompiledPath::Connect (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  GetMatches ();
+  m_matches.Connect (m_leaf, cb);
+}
+void
+CompiledPath::ConnectWithoutContext (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  GetMatches ();
+  m_matches.ConnectWithoutContext (m_leaf, cb);
+}
+void
+CompiledPath::Disconnect (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  GetMatches ();
+  m_matches.Disconnect (m_leaf, cb);
+}
+void
+CompiledPath::DisconnectWithoutContext (const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  GetMatches ();
+  m_matches.DisconnectWithoutContext (m_leaf, cb);
+}
+
+} // namespace Config
+
 namespace Config {
 
 void Reset (void)
@@ -873,6 +1000,12 @@ Ptr<Object> GetRootNamespaceObject (uint32_t i)
   return ConfigImpl::Get ()->GetRootNamespaceObject (i);
 }
 
+void InvalidateCompiledPaths (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ConfigImpl::Get ()->InvalidateCompiledPaths ();
+}
+
 } // namespace Config
 
 } // namespace ns3
@@ -258,6 +258,126 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \ingroup config
+ * \brief a Config path which is parsed once and whose matches are cached.
+ *
+ * Config::Set and Config::Connect parse their path and walk the whole
+ * object namespace on every call.  A CompiledPath splits its path into
+ * the object part and the final attribute or trace source name once,
+ * resolves the object part on first use and keeps the resulting
+ * MatchContainer, so that repeated bulk Sets and Connects (typically
+ * from scenario setup code) only pay for the resolution once:
+ *
+ * \code
+ *   Config::CompiledPath path ("/NodeList/[0-999]/$ns3::MobilityModel/CourseChange");
+ *   path.Connect (MakeCallback (&CourseChange));
+ *   for (uint32_t i = 0; i < path.GetMatches ().GetN (); ++i)
+ *     {
+ *       Ptr<Object> mobility = path.GetMatches ().Get (i);
+ *       ...
+ *     }
+ * \endcode
+ *
+ * The cached matches are an index over the object namespace: they are
+ * discarded and recomputed on next use whenever the namespace changes,
+ * that is, when a root namespace object is registered or unregistered,
+ * when an object is added to or renamed in the object name service, or
+ * when Config::InvalidateCompiledPaths is called (NodeList does so each
+ * time a Node is added).  Objects aggregated after the resolution are
+ * not detected automatically: call Invalidate() on the path, or
+ * Config::InvalidateCompiledPaths(), after such changes.
+ *
+ * Set() and Connect() act on the current matches only: objects which
+ * appear later are not connected retroactively.
+ */
+class CompiledPath
+{
+public:
+  /**
+   * Compile a Config path.
+   *
+   * \param [in] path A path to match attributes or trace sources.
+   *            The last path element names the attribute or the
+   *            trace source.
+   */
+  CompiledPath (std::string path);
+
+  /**
+   * \returns The path this object was compiled from.
+   */
+  std::string GetPath (void) const;
+  /**
+   * \returns The name of the attribute or trace source at the end
+   *          of the path.
+   */
+  std::string GetLeaf (void) const;
+  /**
+   * Get the objects which match the path, resolving it if the cached
+   * matches are missing or stale.
+   *
+   * \returns The objects which match the path, without its last element.
+   */
+  const MatchContainer &GetMatches (void);
+  /**
+   * \returns \c true if the cached matches are up to date.
+   */
+  bool IsResolved (void) const;
+  /**
+   * Discard the cached matches of this path.
+   */
+  void Invalidate (void);
+
+  /**
+   * \param [in] value The value to set in all matching attributes.
+   * \sa ns3::Config::Set
+   */
+  void Set (const AttributeValue &value);
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \sa ns3::Config::Connect
+   */
+  void Connect (const CallbackBase &cb);
+  /**
+   * \param [in] cb The callback to connect to the matching trace sources.
+   * \sa ns3::Config::ConnectWithoutContext
+   */
+  void ConnectWithoutContext (const CallbackBase &cb);
+  /**
+   * \param [in] cb The callback to disconnect from the matching trace sources.
+   * \sa ns3::Config::Disconnect
+   */
+  void Disconnect (const CallbackBase &cb);
+  /**
+   * \param [in] cb The callback to disconnect from the matching trace sources.
+   * \sa ns3::Config::DisconnectWithoutContext
+   */
+  void DisconnectWithoutContext (const CallbackBase &cb);
+
+private:
+  /** The full path. */
+  std::string m_path;
+  /** The path up to the final slash, which selects the objects. */
+  std::string m_root;
+  /** The last path element, the attribute or trace source name. */
+  std::string m_leaf;
+  /** The cached objects which match \c m_root. */
+  MatchContainer m_matches;
+  /** \c true if \c m_matches holds a resolution of \c m_root. */
+  bool m_resolved;
+  /** The namespace generation \c m_matches was resolved in. */
+  uint32_t m_generation;
+};
+
+/**
+ * \ingroup config
+ * Mark the matches cached by every CompiledPath as stale.
+ *
+ * This should be called whenever objects which could be reached through
+ * a Config path are created or aggregated after paths were compiled.
+ */
+void InvalidateCompiledPaths (void);
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
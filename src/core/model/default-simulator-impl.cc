@@ -25,10 +25,14 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "string.h"
+#include "enum.h"
 #include "assert.h"
 #include "log.h"
+#include "fatal-error.h"
 
 #include <cmath>
+#include <fstream>
 
 
 /**
@@ -53,6 +57,20 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("ProfileFile",
+                   "If not empty, account the wall clock time spent in each "
+                   "kind of event, and write the profile to this file when "
+                   "the simulator is destroyed.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
+    .AddAttribute ("ProfileFormat",
+                   "The format of the event profile: a report sorted by time, "
+                   "or folded stacks for flame graph tools.",
+                   EnumValue (EventProfiler::REPORT),
+                   MakeEnumAccessor (&DefaultSimulatorImpl::m_profileFormat),
+                   MakeEnumChecker (EventProfiler::REPORT, "Report",
+                                    EventProfiler::FOLDED, "Folded"))
   ;
   return tid;
 }
@@ -71,13 +89,17 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
+  m_eventCount = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_profileFormat = EventProfiler::REPORT;
+  m_profiler = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_profiler;
 }
 
 void
@@ -108,6 +130,17 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiler != 0)
+    {
+      std::ofstream os (m_profileFile.c_str ());
+      if (!os.is_open ())
+        {
+          NS_FATAL_ERROR ("Could not open the event profile file " << m_profileFile);
+        }
+      m_profiler->Write (os, m_profileFormat);
+      delete m_profiler;
+      m_profiler = 0;
+    }
 }
 
 void
@@ -141,12 +174,20 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
+  m_eventCount++;
 
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0)
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      m_profiler->Invoke (next.impl, m_currentContext);
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -173,6 +214,7 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
     m_eventsWithContext.swap(eventsWithContext);
     m_eventsWithContextEmpty = true;
   }
+  m_batch.clear ();
   while (!eventsWithContext.empty ())
     {
        EventWithContext event = eventsWithContext.front ();
@@ -184,8 +226,10 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
        ev.key.m_uid = m_uid;
        m_uid++;
        m_unscheduledEvents++;
-       m_events->Insert (ev);
+       m_batch.push_back (ev);
     }
+  m_events->InsertBatch (m_batch);
+  m_batch.clear ();
 }
 
 void
@@ -196,6 +240,10 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  if (!m_profileFile.empty () && m_profiler == 0)
+    {
+      m_profiler = new EventProfiler ();
+    }
 
   while (!m_events->IsEmpty () && !m_stop) 
     {
@@ -277,6 +325,51 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
     }
 }
 
+void
+DefaultSimulatorImpl::ScheduleBatch (EventBatch &batch)
+{
+  NS_LOG_FUNCTION (this << batch.GetN ());
+
+  if (SystemThread::Equals (m_main))
+    {
+      // The uids follow the order of the batch, so that the events
+      // run as if they were scheduled one at a time.
+      m_batch.clear ();
+      m_batch.reserve (batch.GetN ());
+      for (uint32_t i = 0; i < batch.GetN (); i++)
+        {
+          const EventBatch::Entry &entry = batch.Get (i);
+          NS_ASSERT (entry.delay >= 0);
+          Scheduler::Event ev;
+          ev.impl = entry.event;
+          ev.key.m_ts = m_currentTs + entry.delay;
+          ev.key.m_context = entry.context;
+          ev.key.m_uid = m_uid;
+          m_uid++;
+          m_batch.push_back (ev);
+        }
+      m_unscheduledEvents += batch.GetN ();
+      m_events->InsertBatch (m_batch);
+      m_batch.clear ();
+    }
+  else
+    {
+      CriticalSection cs (m_eventsWithContextMutex);
+      for (uint32_t i = 0; i < batch.GetN (); i++)
+        {
+          const EventBatch::Entry &entry = batch.Get (i);
+          EventWithContext ev;
+          ev.context = entry.context;
+          // Current time added in ProcessEventsWithContext()
+          ev.timestamp = entry.delay;
+          ev.event = entry.event;
+          m_eventsWithContext.push_back (ev);
+        }
+      m_eventsWithContextEmpty = false;
+    }
+  batch.Forget ();
+}
+
 EventId
 DefaultSimulatorImpl::ScheduleNow (EventImpl *event)
 {
@@ -414,4 +507,93 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
+uint64_t
+DefaultSimulatorImpl::GetPendingEventCount (void) const
+{
+  return m_unscheduledEvents;
+}
+
+DefaultSimulatorImpl::Clock
+DefaultSimulatorImpl::GetClock (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Clock clock;
+  clock.ts = m_currentTs;
+  clock.currentUid = m_currentUid;
+  clock.context = m_currentContext;
+  clock.uid = m_uid;
+  clock.eventCount = m_eventCount;
+  return clock;
+}
+
+void
+DefaultSimulatorImpl::GetPendingEvents (std::vector<Scheduler::EventKey> &pending,
+                                        std::vector<Scheduler::EventKey> &cancelled)
+{
+  NS_LOG_FUNCTION (this);
+  ProcessEventsWithContext ();
+  // The scheduler can only be read in order, by removing the events:
+  // they are inserted back with the same keys.
+  pending.clear ();
+  cancelled.clear ();
+  m_batch.clear ();
+  while (!m_events->IsEmpty ())
+    {
+      Scheduler::Event next = m_events->RemoveNext ();
+      if (next.impl->IsCancelled ())
+        {
+          cancelled.push_back (next.key);
+        }
+      else
+        {
+          pending.push_back (next.key);
+        }
+      m_batch.push_back (next);
+    }
+  m_events->InsertBatch (m_batch);
+  m_batch.clear ();
+}
+
+void
+DefaultSimulatorImpl::SetClock (const Clock &clock)
+{
+  NS_LOG_FUNCTION (this << clock.ts << clock.uid);
+  ProcessEventsWithContext ();
+  while (!m_events->IsEmpty ())
+    {
+      Scheduler::Event next = m_events->RemoveNext ();
+      next.impl->Cancel ();
+      next.impl->Unref ();
+    }
+  m_unscheduledEvents = 0;
+  m_currentTs = clock.ts;
+  m_currentUid = clock.currentUid;
+  m_currentContext = clock.context;
+  m_uid = clock.uid;
+  m_eventCount = clock.eventCount;
+}
+
+EventId
+DefaultSimulatorImpl::ScheduleWithKey (const Scheduler::EventKey &key, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << key.m_ts << key.m_uid << event);
+  NS_ASSERT_MSG (SystemThread::Equals (m_main), "Simulator::ScheduleWithKey Thread-unsafe invocation!");
+  NS_ASSERT (key.m_ts > m_currentTs
+             || (key.m_ts == m_currentTs && key.m_uid > m_currentUid));
+  NS_ASSERT (key.m_uid < m_uid);
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key = key;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
 } // namespace ns3
@@ -24,12 +24,15 @@
 #include "simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 #include "system-thread.h"
 #include "ns3/system-mutex.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <string>
+#include <vector>
 
 /**
  * \file
@@ -43,6 +46,10 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * When the \c ProfileFile attribute is set, the wall clock time
+ * spent in each kind of event is accounted by an EventProfiler,
+ * and the profile is written to that file by Simulator::Destroy().
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -65,6 +72,7 @@ public:
   virtual void Stop (Time const &delay);
   virtual EventId Schedule (Time const &delay, EventImpl *event);
   virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual void ScheduleBatch (EventBatch &batch);
   virtual EventId ScheduleNow (EventImpl *event);
   virtual EventId ScheduleDestroy (EventImpl *event);
   virtual void Remove (const EventId &id);
@@ -77,6 +85,50 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+  virtual uint64_t GetPendingEventCount (void) const;
+
+  /**
+   * \name Checkpoints
+   * Save and restore the event list, used by Checkpointer.
+   * @{
+   */
+  /** The clock of the simulator, saved in a checkpoint. */
+  struct Clock
+  {
+    uint64_t ts;          /**< Timestamp of the current event. */
+    uint32_t currentUid;  /**< Unique id of the current event. */
+    uint32_t context;     /**< Execution context of the current event. */
+    uint32_t uid;         /**< Next event unique id. */
+    uint64_t eventCount;  /**< Number of events executed. */
+  };
+  /**
+   * Get the clock of the simulator.
+   * \returns The clock.
+   */
+  Clock GetClock (void) const;
+  /**
+   * Get the keys of the pending events, in the order they will run.
+   * \param [out] pending The keys of the events which are not cancelled.
+   * \param [out] cancelled The keys of the cancelled events, which are
+   *              still counted by GetEventCount() when their time comes.
+   */
+  void GetPendingEvents (std::vector<Scheduler::EventKey> &pending,
+                         std::vector<Scheduler::EventKey> &cancelled);
+  /**
+   * Remove and cancel all the pending events, and set the clock.
+   * \param [in] clock The clock, returned by GetClock().
+   */
+  void SetClock (const Clock &clock);
+  /**
+   * Schedule an event with the key it had when a checkpoint was taken.
+   * \param [in] key The key of the event, which must not be in the past
+   *             of the clock.
+   * \param [in] event The event to schedule.
+   * \returns The id of the event.
+   */
+  EventId ScheduleWithKey (const Scheduler::EventKey &key, EventImpl *event);
+  /** @} */
 
 private:
   virtual void DoDispose (void);
@@ -115,6 +167,8 @@ private:
   bool m_stop;
   /** The event priority queue. */
   Ptr<Scheduler> m_events;
+  /** The events passed to Scheduler::InsertBatch(), kept to reuse its memory. */
+  std::vector<Scheduler::Event> m_batch;
 
   /** Next event unique id. */
   uint32_t m_uid;
@@ -129,9 +183,18 @@ private:
    *  not counting the Destroy events; this is used for validation
    */
   int m_unscheduledEvents;
+  /** Number of events executed. */
+  uint64_t m_eventCount;
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** The file to write the event profile to, or empty to not profile. */
+  std::string m_profileFile;
+  /** The format of the event profile. */
+  EventProfiler::Format m_profileFormat;
+  /** The event profiler, if profiling. */
+  EventProfiler *m_profiler;
 };
 
 } // namespace ns3
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-batch.h"
+#include "log.h"
+
+/**
+ * @file
+ * @ingroup events
+ * ns3::EventBatch implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventBatch");
+
+EventBatch::EventBatch ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+EventBatch::~EventBatch ()
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+}
+
+void
+EventBatch::Reserve (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_entries.reserve (n);
+}
+
+void
+EventBatch::Add (uint32_t context, Time const &delay, void (*f)(void))
+{
+  Add (context, delay, MakeEvent (f));
+}
+
+void
+EventBatch::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<struct Entry>::const_iterator i = m_entries.begin ();
+       i != m_entries.end (); ++i)
+    {
+      i->event->Unref ();
+    }
+  m_entries.clear ();
+}
+
+void
+EventBatch::Forget (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_entries.clear ();
+}
+
+} // namespace ns3
@@ -0,0 +1,353 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_BATCH_H
+#define EVENT_BATCH_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "event-impl.h"
+#include "make-event.h"
+#include "nstime.h"
+
+/**
+ * @file
+ * @ingroup events
+ * ns3::EventBatch declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * @ingroup events
+ * @brief A batch of events, each with its own context and delay, to
+ * be scheduled together by Simulator::ScheduleWithContext(EventBatch&).
+ *
+ * Scheduling a batch inserts all its events in the event list in one
+ * operation, which lets the scheduler use a cheaper bulk insertion
+ * than one insertion per event.  The events run exactly as if they
+ * were scheduled one at a time, in the order they were added to the
+ * batch; this is meant for the code which schedules many events at
+ * once, such as a channel delivering a frame to all its receivers:
+ *
+ * @code
+ *   EventBatch batch;
+ *   for (uint32_t i = 0; i < m_receivers.size (); i++)
+ *     {
+ *       batch.Add (m_receivers[i]->GetNode ()->GetId (), m_delay,
+ *                  &Receiver::Receive, m_receivers[i], packet->Copy ());
+ *     }
+ *   Simulator::ScheduleWithContext (batch);
+ * @endcode
+ *
+ * Scheduling empties the batch, which can then be reused without
+ * releasing its memory.  The events of a batch destroyed before it
+ * is scheduled are never run.  As with ScheduleWithContext(), the
+ * events can not be cancelled.
+ */
+class EventBatch
+{
+public:
+  /** An event of the batch. */
+  struct Entry
+  {
+    uint32_t context;   //!< The context of the event.
+    int64_t delay;      //!< The delay of the event, in time steps.
+    EventImpl *event;   //!< The event, holding a reference.
+  };
+
+  /** Constructor. */
+  EventBatch ();
+  /** Destructor, releasing the events not scheduled. */
+  ~EventBatch ();
+
+  /**
+   * Reserve room for some events.
+   * @param [in] n The number of events.
+   */
+  void Reserve (uint32_t n);
+
+  /**
+   * Add an event.
+   * @param [in] context The context of the event.
+   * @param [in] delay The relative expiration time of the event.
+   * @param [in] event The event, whose reference is taken over by the
+   *             batch, as returned by MakeEvent().
+   */
+  void Add (uint32_t context, Time const &delay, EventImpl *event);
+
+  /**
+   * @name Add an event which calls a method or a function.
+   * @see Simulator::ScheduleWithContext(uint32_t,const Time&,MEM,OBJ)
+   */
+  /** @{ */
+  /**
+   * @tparam MEM @inferred Class method function signature type.
+   * @tparam OBJ @inferred Class type of the object.
+   * @param [in] context The context of the event.
+   * @param [in] delay The relative expiration time of the event.
+   * @param [in] mem_ptr Member method pointer to invoke
+   * @param [in] obj The object on which to invoke the member method
+   */
+  template <typename MEM, typename OBJ>
+  void Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj);
+  /**
+   * @tparam MEM @inferred Class method function signature type.
+   * @tparam OBJ @inferred Class type of the object.
+   * @tparam T1 @inferred Type of first argument.
+   * @param [in] context The context of the event.
+   * @param [in] delay The relative expiration time of the event.
+   * @param [in] mem_ptr Member method pointer to invoke
+   * @param [in] obj The object on which to invoke the member method
+   * @param [in] a1 The first argument to pass to the invoked method
+   */
+  template <typename MEM, typename OBJ, typename T1>
+  void Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1);
+  /**
+   * @tparam MEM @inferred Class method function signature type.
+   * @tparam OBJ @inferred Class type of the object.
+   * @tparam T1 @inferred Type of first argument.
+   * @tparam T2 @inferred Type of second argument.
+   * @param [in] context The context of the event.
+   * @param [in] delay The relative expiration time of the event.
+   * @param [in] mem_ptr Member method pointer to invoke
+   * @param [in] obj The object on which to invoke the member method
+   * @param [in] a1 The first argument to pass to the invoked method
+   * @param [in] a2 The second argument to pass to the invoked method
+   */
+  template <typename MEM, typename OBJ, typename T1, typename T2>
+  void Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2);
+  /**
+   * @tparam MEM @inferred Class method function signature type.
+   * @tparam OBJ @inferred Class type of the object.
+   * @tparam T1 @inferred Type of first argument.
+   * @tparam T2 @inferred Type of second argument.
+   * @tparam T3 @inferred Type of third argument.
+   * @param [in] context The context of the event.
+   * @param [in] delay The relative expiration time of the event.
+   * @param [in] mem_ptr Member method pointer to invoke
+   * @param [in] obj The object on which to invoke the member method
+   * @param [in] a1 The first argument to pass to the invoked method
+   * @param [in] a2 The second argument to pass to the invoked method
+   * @param [in] a3 The third argument to pass to the invoked method
+   */
+  template <typename MEM, typename OBJ, typename T1, typename T2, typename T3>
+  void Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3);
+  /**
+   * @tparam MEM @inferred Class method function signature type.
+   * @tparam OBJ @inferred Class type of the object.
+   * @tparam T1 @inferred Type of first argument.
+   * @tparam T2 @inferred Type of second argument.
+   * @tparam T3 @inferred Type of third argument.
+   * @tparam T4 @inferred Type of fourth argument.
+   * @param [in] context The context of the event.
+   * @param [in] delay The relative expiration time of the event.
+   * @param [in] mem_ptr Member method pointer to invoke
+   * @param [in] obj The object on which to invoke the member method
+   * @param [in] a1 The first argument to pass to the invoked method
+   * @param [in] a2 The second argument to pass to the invoked method
+   * @param [in] a3 The third argument to pass to the invoked method
+   * @param [in] a4 The fourth argument to pass to the invoked method
+   */
+  template <typename MEM, typename OBJ, typename T1, typename T2, typename T3, typename T4>
+  void Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4);
+  /**
+   * @param [in] context The context of the event.
+   * @param [in] delay The relative expiration time of the event.
+   * @param [in] f The function to invoke.
+   */
+  void Add (uint32_t context, Time const &delay, void (*f)(void));
+  /**
+   * @tparam U1 @deduced Formal type of the first argument to the function.
+   * @tparam T1 @deduced Actual type of the first argument.
+   * @param [in] context The context of the event.
+   * @param [in] delay The relative expiration time of the event.
+   * @param [in] f The function to invoke.
+   * @param [in] a1 The first argument to pass to the function to invoke.
+   */
+  template <typename U1, typename T1>
+  void Add (uint32_t context, Time const &delay, void (*f)(U1), T1 a1);
+  /**
+   * @tparam U1 @deduced Formal type of the first argument to the function.
+   * @tparam U2 @deduced Formal type of the second argument to the function.
+   * @tparam T1 @deduced Actual type of the first argument.
+   * @tparam T2 @deduced Actual type of the second argument.
+   * @param [in] context The context of the event.
+   * @param [in] delay The relative expiration time of the event.
+   * @param [in] f The function to invoke.
+   * @param [in] a1 The first argument to pass to the function to invoke.
+   * @param [in] a2 The second argument to pass to the function to invoke.
+   */
+  template <typename U1, typename U2, typename T1, typename T2>
+  void Add (uint32_t context, Time const &delay, void (*f)(U1,U2), T1 a1, T2 a2);
+  /**
+   * @tparam U1 @deduced Formal type of the first argument to the function.
+   * @tparam U2 @deduced Formal type of the second argument to the function.
+   * @tparam U3 @deduced Formal type of the third argument to the function.
+   * @tparam T1 @deduced Actual type of the first argument.
+   * @tparam T2 @deduced Actual type of the second argument.
+   * @tparam T3 @deduced Actual type of the third argument.
+   * @param [in] context The context of the event.
+   * @param [in] delay The relative expiration time of the event.
+   * @param [in] f The function to invoke.
+   * @param [in] a1 The first argument to pass to the function to invoke.
+   * @param [in] a2 The second argument to pass to the function to invoke.
+   * @param [in] a3 The third argument to pass to the function to invoke.
+   */
+  template <typename U1, typename U2, typename U3, typename T1, typename T2, typename T3>
+  void Add (uint32_t context, Time const &delay, void (*f)(U1,U2,U3), T1 a1, T2 a2, T3 a3);
+  /** @} */
+
+  /**
+   * Get the number of events.
+   * @returns The number of events in the batch.
+   */
+  uint32_t GetN (void) const;
+  /**
+   * Check whether the batch is empty.
+   * @returns @c true if the batch has no events.
+   */
+  bool IsEmpty (void) const;
+  /**
+   * Get an event.
+   * @param [in] i The index of the event, in the order it was added.
+   * @returns The event.
+   */
+  const Entry & Get (uint32_t i) const;
+  /** Remove and release all the events, which are never run. */
+  void Clear (void);
+  /**
+   * Remove all the events without releasing them, once their
+   * references were taken over by the event list.
+   *
+   * This is meant for the SimulatorImpl subclasses.
+   */
+  void Forget (void);
+
+private:
+  /**
+   * Copy constructor, not implemented: a batch owns its events.
+   * @param [in] o The batch to copy.
+   */
+  EventBatch (const EventBatch &o);
+  /**
+   * Assignment, not implemented: a batch owns its events.
+   * @param [in] o The batch to copy.
+   * @returns This batch.
+   */
+  EventBatch & operator = (const EventBatch &o);
+
+  /** The events, in the order they were added. */
+  std::vector<struct Entry> m_entries;
+};
+
+} // namespace ns3
+
+
+/***************************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************************/
+
+namespace ns3 {
+
+inline void
+EventBatch::Add (uint32_t context, Time const &delay, EventImpl *event)
+{
+  struct Entry entry;
+  entry.context = context;
+  entry.delay = delay.GetTimeStep ();
+  entry.event = event;
+  m_entries.push_back (entry);
+}
+
+template <typename MEM, typename OBJ>
+void
+EventBatch::Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj)
+{
+  Add (context, delay, MakeEvent (mem_ptr, obj));
+}
+
+template <typename MEM, typename OBJ, typename T1>
+void
+EventBatch::Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1)
+{
+  Add (context, delay, MakeEvent (mem_ptr, obj, a1));
+}
+
+template <typename MEM, typename OBJ, typename T1, typename T2>
+void
+EventBatch::Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
+{
+  Add (context, delay, MakeEvent (mem_ptr, obj, a1, a2));
+}
+
+template <typename MEM, typename OBJ, typename T1, typename T2, typename T3>
+void
+EventBatch::Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3)
+{
+  Add (context, delay, MakeEvent (mem_ptr, obj, a1, a2, a3));
+}
+
+template <typename MEM, typename OBJ, typename T1, typename T2, typename T3, typename T4>
+void
+EventBatch::Add (uint32_t context, Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2, T3 a3, T4 a4)
+{
+  Add (context, delay, MakeEvent (mem_ptr, obj, a1, a2, a3, a4));
+}
+
+template <typename U1, typename T1>
+void
+EventBatch::Add (uint32_t context, Time const &delay, void (*f)(U1), T1 a1)
+{
+  Add (context, delay, MakeEvent (f, a1));
+}
+
+template <typename U1, typename U2, typename T1, typename T2>
+void
+EventBatch::Add (uint32_t context, Time const &delay, void (*f)(U1,U2), T1 a1, T2 a2)
+{
+  Add (context, delay, MakeEvent (f, a1, a2));
+}
+
+template <typename U1, typename U2, typename U3, typename T1, typename T2, typename T3>
+void
+EventBatch::Add (uint32_t context, Time const &delay, void (*f)(U1,U2,U3), T1 a1, T2 a2, T3 a3)
+{
+  Add (context, delay, MakeEvent (f, a1, a2, a3));
+}
+
+inline uint32_t
+EventBatch::GetN (void) const
+{
+  return m_entries.size ();
+}
+
+inline bool
+EventBatch::IsEmpty (void) const
+{
+  return m_entries.empty ();
+}
+
+inline const EventBatch::Entry &
+EventBatch::Get (uint32_t i) const
+{
+  return m_entries[i];
+}
+
+} // namespace ns3
+
+#endif /* EVENT_BATCH_H */
@@ -66,4 +66,13 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void
+EventImpl::GetSite (Site &site) const
+{
+  NS_LOG_FUNCTION (this << &site);
+  site.event = &typeid (*this);
+  site.object = 0;
+  site.function = 0;
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <typeinfo>
 #include "simple-ref-count.h"
 
 /**
@@ -44,6 +45,25 @@ namespace ns3 {
 class EventImpl : public SimpleRefCount<EventImpl>
 {
 public:
+  /**
+   * The code an event runs, as seen by the event profiler.
+   *
+   * Events which call the same function on objects of the same type
+   * have the same Site.
+   */
+  struct Site
+  {
+    /** The type of the event, which identifies its MakeEvent() signature. */
+    const std::type_info *event;
+    /**
+     * The dynamic type of the object a class method is called on,
+     * or 0 if the event does not call a class method.
+     */
+    const std::type_info *object;
+    /** The address of the function called, or 0 if it is not known. */
+    const void *function;
+  };
+
   /** Default constructor. */
   EventImpl ();
   /** Destructor. */
@@ -65,6 +85,16 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Identify the code this event runs.
+   *
+   * This is called by the simulator when profiling events, just
+   * before Invoke(). The default implementation only identifies
+   * the type of the event.
+   *
+   * \param [out] site The code this event runs.
+   */
+  virtual void GetSite (Site &site) const;
 
 protected:
   /**
@@ -0,0 +1,389 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+#include <cxxabi.h>
+#include <sys/time.h>
+#include <time.h>
+#ifdef HAVE_EXECINFO_H
+#include <execinfo.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/**
+ * Demangle a C++ symbol or type name.
+ * \param [in] mangled The mangled name.
+ * \returns The demangled name, or \p mangled if it can not be demangled.
+ */
+std::string
+Demangle (const std::string &mangled)
+{
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled.c_str (), 0, 0, &status);
+  if (status != 0)
+    {
+      return mangled;
+    }
+  std::string name = demangled;
+  std::free (demangled);
+  return name;
+}
+
+/**
+ * Get the function signature from the type of an event.
+ *
+ * The events are local classes of the MakeEvent() functions, and the
+ * first argument of these functions is the function pointer.
+ *
+ * \param [in] event The type of the event.
+ * \returns The function pointer type, or the name of \p event if it
+ *          is not a MakeEvent() event.
+ */
+std::string
+GetSignature (const std::type_info &event)
+{
+  std::string name = Demangle (event.name ());
+  std::string::size_type i = name.find ("MakeEvent");
+  if (i == std::string::npos)
+    {
+      return name;
+    }
+  // Skip the template arguments, then return the first function argument
+  i += 9;
+  std::string::size_type start = std::string::npos;
+  int depth = 0;
+  for (; i < name.size (); i++)
+    {
+      char c = name[i];
+      if (depth == 0 && c == '(')
+        {
+          start = i + 1;
+        }
+      if (c == '<' || c == '(')
+        {
+          depth++;
+        }
+      else if (c == '>' || c == ')')
+        {
+          depth--;
+          if (depth == 0 && start != std::string::npos)
+            {
+              break;
+            }
+        }
+      else if (depth == 1 && c == ',' && start != std::string::npos)
+        {
+          break;
+        }
+    }
+  if (start == std::string::npos || i == name.size ())
+    {
+      return name;
+    }
+  return name.substr (start, i - start);
+}
+
+/** The time and number of events of a row of the report. */
+struct Row
+{
+  uint64_t events;    //!< Number of events.
+  uint64_t time;      //!< Wall clock time, in nanoseconds.
+  uint32_t contexts;  //!< Number of contexts.
+};
+
+/**
+ * Order report rows by decreasing time.
+ * \param [in] a The first row.
+ * \param [in] b The second row.
+ * \returns \c true if \p a took more time than \p b.
+ */
+bool
+MoreTime (const std::pair<std::string, Row> &a, const std::pair<std::string, Row> &b)
+{
+  return a.second.time > b.second.time;
+}
+
+/**
+ * Print a context the way the default log node printer does.
+ * \param [in] context The context.
+ * \returns The context as a string.
+ */
+std::string
+ContextToString (uint32_t context)
+{
+  std::ostringstream oss;
+  if (context == 0xffffffff)
+    {
+      oss << "-1";
+    }
+  else
+    {
+      oss << context;
+    }
+  return oss.str ();
+}
+
+} // anonymous namespace
+
+
+bool
+EventProfiler::Key::operator < (const Key &other) const
+{
+  if (site.function != other.site.function)
+    {
+      return std::less<const void *> () (site.function, other.site.function);
+    }
+  if (site.object != other.site.object)
+    {
+      return std::less<const std::type_info *> () (site.object, other.site.object);
+    }
+  if (site.event != other.site.event)
+    {
+      return std::less<const std::type_info *> () (site.event, other.site.event);
+    }
+  return context < other.context;
+}
+
+EventProfiler::EventProfiler ()
+  : m_cancelled (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+EventProfiler::GetClock (void)
+{
+#if defined (HAVE_RT) && defined (CLOCK_MONOTONIC)
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000ULL;
+#endif
+}
+
+void
+EventProfiler::Invoke (EventImpl *event, uint32_t context)
+{
+  // Do not add function logging here, it would be accounted to the event.
+  if (event->IsCancelled ())
+    {
+      // The object of a cancelled event may be gone.
+      m_cancelled++;
+      return;
+    }
+  Key key;
+  event->GetSite (key.site);
+  key.context = context;
+
+  uint64_t start = GetClock ();
+  event->Invoke ();
+  uint64_t time = GetClock () - start;
+
+  CountersMap::iterator i = m_counters.find (key);
+  if (i == m_counters.end ())
+    {
+      Counters counters;
+      counters.events = 0;
+      counters.time = 0;
+      i = m_counters.insert (std::make_pair (key, counters)).first;
+    }
+  i->second.events++;
+  i->second.time += time;
+}
+
+void
+EventProfiler::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_counters.clear ();
+  m_cancelled = 0;
+}
+
+std::string
+EventProfiler::GetFunctionName (const EventImpl::Site &site)
+{
+  NS_LOG_FUNCTION (site.function);
+  if (site.function == 0)
+    {
+      return GetSignature (*site.event);
+    }
+#ifdef HAVE_EXECINFO_H
+  void *address = const_cast<void *> (site.function);
+  char **symbols = backtrace_symbols (&address, 1);
+  if (symbols != 0)
+    {
+      // "module(symbol+offset) [address]": only use the symbol
+      // if it starts at the address.
+      std::string line = symbols[0];
+      std::free (symbols);
+      std::string::size_type open = line.find ('(');
+      std::string::size_type plus = line.find ('+', open);
+      std::string::size_type close = line.find (')', open);
+      if (open != std::string::npos && plus != std::string::npos
+          && close != std::string::npos && plus > open + 1
+          && std::strtoul (line.substr (plus + 1, close - plus - 1).c_str (), 0, 0) == 0)
+        {
+          return Demangle (line.substr (open + 1, plus - open - 1));
+        }
+    }
+#endif /* HAVE_EXECINFO_H */
+  std::ostringstream oss;
+  oss << GetSignature (*site.event) << "@" << site.function;
+  return oss.str ();
+}
+
+std::string
+EventProfiler::GetObjectName (const EventImpl::Site &site)
+{
+  NS_LOG_FUNCTION (site.object);
+  if (site.object == 0)
+    {
+      return "";
+    }
+  return Demangle (site.object->name ());
+}
+
+void
+EventProfiler::Write (std::ostream &os, enum Format format) const
+{
+  NS_LOG_FUNCTION (this << &os << format);
+
+  // Name each site once, and merge the sites with the same name
+  typedef std::map<std::string, Row> Rows;
+  Rows sites;
+  std::map<uint32_t, Row> contexts;
+  std::map<std::string, uint64_t> stacks;
+  uint64_t events = 0;
+  uint64_t time = 0;
+  std::string function;
+  std::string object;
+  for (CountersMap::const_iterator i = m_counters.begin (); i != m_counters.end (); ++i)
+    {
+      const EventImpl::Site &site = i->first.site;
+      CountersMap::const_iterator previous = i;
+      if (i == m_counters.begin ()
+          || (--previous)->first.site.function != site.function
+          || previous->first.site.object != site.object
+          || previous->first.site.event != site.event)
+        {
+          function = GetFunctionName (site);
+          object = GetObjectName (site);
+        }
+      const Counters &counters = i->second;
+      events += counters.events;
+      time += counters.time;
+
+      std::string label = function;
+      if (!object.empty ())
+        {
+          label += " [" + object + "]";
+        }
+      Row &row = sites[label];
+      row.events += counters.events;
+      row.time += counters.time;
+      row.contexts++;
+
+      Row &context = contexts[i->first.context];
+      context.events += counters.events;
+      context.time += counters.time;
+
+      std::string stack = "context " + ContextToString (i->first.context) + ";";
+      if (!object.empty ())
+        {
+          stack += object + ";";
+        }
+      stacks[stack + function] += counters.time;
+    }
+
+  if (format == FOLDED)
+    {
+      for (std::map<std::string, uint64_t>::const_iterator i = stacks.begin ();
+           i != stacks.end (); ++i)
+        {
+          os << i->first << " " << i->second << std::endl;
+        }
+      return;
+    }
+
+  std::vector<std::pair<std::string, Row> > sorted (sites.begin (), sites.end ());
+  std::stable_sort (sorted.begin (), sorted.end (), MoreTime);
+  std::vector<std::pair<std::string, Row> > sortedContexts;
+  for (std::map<uint32_t, Row>::const_iterator i = contexts.begin (); i != contexts.end (); ++i)
+    {
+      sortedContexts.push_back (std::make_pair (ContextToString (i->first), i->second));
+    }
+  std::stable_sort (sortedContexts.begin (), sortedContexts.end (), MoreTime);
+
+  std::ios::fmtflags flags = os.flags ();
+  double total = time > 0 ? time : 1;
+  os << "# Event profile: " << events << " events, "
+     << m_cancelled << " cancelled, "
+     << std::fixed << std::setprecision (6) << time * 1e-9
+     << " s of wall clock time in events" << std::endl
+     << "#" << std::endl
+     << "#    time (s)     time       events   ns/event  contexts  site" << std::endl;
+  for (std::vector<std::pair<std::string, Row> >::const_iterator i = sorted.begin ();
+       i != sorted.end (); ++i)
+    {
+      const Row &row = i->second;
+      os << std::setw (13) << std::setprecision (6) << row.time * 1e-9
+         << std::setw (8) << std::setprecision (2) << row.time * 100 / total << " %"
+         << std::setw (13) << row.events
+         << std::setw (11) << std::setprecision (1) << double (row.time) / row.events
+         << std::setw (10) << row.contexts
+         << "  " << i->first << std::endl;
+    }
+  os << "#" << std::endl
+     << "#    time (s)     time       events   ns/event  context" << std::endl;
+  for (std::vector<std::pair<std::string, Row> >::const_iterator i = sortedContexts.begin ();
+       i != sortedContexts.end (); ++i)
+    {
+      const Row &row = i->second;
+      os << std::setw (13) << std::setprecision (6) << row.time * 1e-9
+         << std::setw (8) << std::setprecision (2) << row.time * 100 / total << " %"
+         << std::setw (13) << row.events
+         << std::setw (11) << std::setprecision (1) << double (row.time) / row.events
+         << "  " << i->first << std::endl;
+    }
+  os.flags (flags);
+}
+
+} // namespace ns3
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "event-impl.h"
+
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * Account the wall clock time spent in each kind of event.
+ *
+ * The simulator hands the events it runs to Invoke(), which measures
+ * the time spent in EventImpl::Invoke() and attributes it to the
+ * EventImpl::Site of the event (the function called, and the type of
+ * the object it is called on) and to the context of the event, which
+ * is usually the node it runs on.
+ *
+ * The profile is written with Write(), either as a report sorted by
+ * time, or as folded stacks which can be turned into a flame graph:
+ * \code
+ *   $ ./waf --run "my-program --ns3::DefaultSimulatorImpl::ProfileFile=run.folded --ns3::DefaultSimulatorImpl::ProfileFormat=Folded"
+ *   $ flamegraph.pl run.folded > run.svg
+ * \endcode
+ *
+ * Function names are looked up in the dynamic symbol table, so
+ * functions of a program which is not linked with \c -rdynamic, and
+ * functions local to a file, are named after their signature and
+ * address instead.
+ */
+class EventProfiler
+{
+public:
+  /** The output formats of Write(). */
+  enum Format
+  {
+    REPORT,  //!< Tables of sites and contexts, sorted by time.
+    FOLDED   //!< One "context;object;function nanoseconds" line per site and context.
+  };
+
+  /** Constructor. */
+  EventProfiler ();
+
+  /**
+   * Invoke an event, and account the time it took.
+   *
+   * \param [in] event The event to invoke.
+   * \param [in] context The context the event runs in.
+   */
+  void Invoke (EventImpl *event, uint32_t context);
+  /** Forget all the events accounted so far. */
+  void Clear (void);
+  /**
+   * Write the profile.
+   *
+   * \param [in,out] os The stream to write to.
+   * \param [in] format The output format.
+   */
+  void Write (std::ostream &os, enum Format format) const;
+
+private:
+  /** Where the time is accounted. */
+  struct Key
+  {
+    EventImpl::Site site;  //!< The code the event runs.
+    uint32_t context;      //!< The context of the event.
+    /**
+     * Order the keys by site, then by context.
+     * \param [in] other The key to compare with.
+     * \returns \c true if this key is before \p other.
+     */
+    bool operator < (const Key &other) const;
+  };
+  /** What is accounted. */
+  struct Counters
+  {
+    uint64_t events;  //!< Number of events invoked.
+    uint64_t time;    //!< Wall clock time spent in these events, in nanoseconds.
+  };
+  /** Container of the Counters of each Key. */
+  typedef std::map<Key, Counters> CountersMap;
+
+  /**
+   * Read the monotonic wall clock.
+   * \returns The wall clock time, in nanoseconds.
+   */
+  static uint64_t GetClock (void);
+  /**
+   * Get the name of the function run by an event.
+   * \param [in] site The code the event runs.
+   * \returns The function name, or the signature and address of the function.
+   */
+  static std::string GetFunctionName (const EventImpl::Site &site);
+  /**
+   * Get the name of the type of the object an event is bound to.
+   * \param [in] site The code the event runs.
+   * \returns The type name, or an empty string for a function.
+   */
+  static std::string GetObjectName (const EventImpl::Site &site);
+
+  /** The time and number of events of each site and context. */
+  CountersMap m_counters;
+  /** Number of cancelled events, which are not accounted in m_counters. */
+  uint64_t m_cancelled;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -19,6 +19,11 @@
  */
 #include "fatal-impl.h"
 #include "log.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "log-binary-sink.h"
+#endif
 
 #include <iostream>
 #include <list>
@@ -147,6 +152,10 @@ void
 FlushStreams (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+#ifdef HAVE_PTHREAD_H
+  /* Write out the log lines leading to the error */
+  LogBinarySink::Flush ();
+#endif
   std::list<std::ostream*> **pl = PeekStreamList ();
   if (*pl == 0)
     {
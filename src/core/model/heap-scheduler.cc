@@ -206,6 +206,30 @@ HeapScheduler::Insert (const Event &ev)
   BottomUp ();
 }
 
+void
+HeapScheduler::InsertBatch (const std::vector<Scheduler::Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  if (events.size () <= Last ())
+    {
+      // Few events: each one percolates up from the bottom.
+      for (std::vector<Scheduler::Event>::const_iterator i = events.begin ();
+           i != events.end (); ++i)
+        {
+          m_heap.push_back (*i);
+          BottomUp ();
+        }
+      return;
+    }
+  // Many events: append them all, and rebuild the heap from the
+  // bottom in linear time.
+  m_heap.insert (m_heap.end (), events.begin (), events.end ());
+  for (uint32_t i = Parent (Last ()); i >= Root (); i--)
+    {
+      TopDown (i);
+    }
+}
+
 Scheduler::Event
 HeapScheduler::PeekNext (void) const
 {
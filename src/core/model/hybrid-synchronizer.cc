@@ -0,0 +1,513 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>       // clock_gettime
+#include <sys/time.h>  // gettimeofday
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ns3/core-config.h"
+#ifdef HAVE_SYS_TIMERFD_H
+#include <poll.h>
+#include <sys/timerfd.h>
+#endif
+
+#include "hybrid-synchronizer.h"
+#include "log.h"
+#include "boolean.h"
+#include "uinteger.h"
+#include "unused.h"
+
+/**
+ * \file
+ * \ingroup realtime
+ * ns3::HybridSynchronizer implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HybridSynchronizer");
+
+NS_OBJECT_ENSURE_REGISTERED (HybridSynchronizer);
+
+TypeId
+HybridSynchronizer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HybridSynchronizer")
+    .SetParent<Synchronizer> ()
+    .SetGroupName ("Core")
+    .AddConstructor<HybridSynchronizer> ()
+    .AddAttribute ("SpinThreshold",
+                   "The time spent spinning before each deadline, until the "
+                   "wakeup latency is measured.",
+                   TimeValue (MicroSeconds (200)),
+                   MakeTimeAccessor (&HybridSynchronizer::m_initialSpinThreshold),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("MinSpinThreshold",
+                   "The smallest time spent spinning before each deadline.",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&HybridSynchronizer::m_minSpinThreshold),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("MaxSpinThreshold",
+                   "The largest time spent spinning before each deadline.",
+                   TimeValue (MilliSeconds (2)),
+                   MakeTimeAccessor (&HybridSynchronizer::m_maxSpinThreshold),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("Adaptive",
+                   "Adapt the spin threshold to the measured wakeup latency.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&HybridSynchronizer::m_adaptive),
+                   MakeBooleanChecker ())
+    .AddAttribute ("UseTimerFd",
+                   "Sleep with a timerfd set to an absolute deadline, where "
+                   "available, instead of a timed wait on a condition variable.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&HybridSynchronizer::m_useTimerFd),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Tick",
+                   "Events due within this time are run without waiting.",
+                   TimeValue (Time (0)),
+                   MakeTimeAccessor (&HybridSynchronizer::m_tick),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("HistogramBinWidth",
+                   "The width of the bins of the jitter histogram.",
+                   TimeValue (MicroSeconds (10)),
+                   MakeTimeAccessor (&HybridSynchronizer::m_binWidth),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("HistogramBins",
+                   "The number of bins of the jitter histogram; the last one "
+                   "counts all the larger jitters.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&HybridSynchronizer::m_bins),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("HistogramInterval",
+                   "The number of events between two JitterHistogram traces, "
+                   "or 0 to disable them.",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&HybridSynchronizer::m_histogramInterval),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("WakeupLatency",
+                     "How late each sleep ended.",
+                     MakeTraceSourceAccessor (&HybridSynchronizer::m_wakeupLatencyTrace),
+                     "ns3::Time::TracedCallback")
+    .AddTraceSource ("Jitter",
+                     "How late each event was run after the deadline it was "
+                     "synchronized to.",
+                     MakeTraceSourceAccessor (&HybridSynchronizer::m_jitterTrace),
+                     "ns3::Time::TracedCallback")
+    .AddTraceSource ("JitterHistogram",
+                     "The jitter histogram, every HistogramInterval events.",
+                     MakeTraceSourceAccessor (&HybridSynchronizer::m_histogramTrace),
+                     "ns3::HybridSynchronizer::HistogramTracedCallback")
+  ;
+  return tid;
+}
+
+HybridSynchronizer::HybridSynchronizer ()
+  : m_spinThreshold (0),
+    m_latencyMean (0),
+    m_latencyDeviation (0),
+    m_latencySamples (0),
+    m_sinceHistogram (0),
+    m_deadline (0),
+    m_synchronized (false),
+    m_nsEventStart (0),
+    m_timerFd (-1)
+{
+  NS_LOG_FUNCTION (this);
+  m_pipe[0] = -1;
+  m_pipe[1] = -1;
+}
+
+HybridSynchronizer::~HybridSynchronizer ()
+{
+  NS_LOG_FUNCTION (this);
+  CloseTimerFd ();
+}
+
+void
+HybridSynchronizer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  CloseTimerFd ();
+  Synchronizer::DoDispose ();
+}
+
+Time
+HybridSynchronizer::GetSpinThreshold (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_spinThreshold == 0)
+    {
+      return m_initialSpinThreshold;
+    }
+  return NanoSeconds (m_spinThreshold);
+}
+
+std::vector<uint64_t>
+HybridSynchronizer::GetJitterHistogram (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<uint64_t> histogram = m_histogram;
+  histogram.resize (m_bins, 0);
+  return histogram;
+}
+
+bool
+HybridSynchronizer::DoRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
+uint64_t
+HybridSynchronizer::GetRealtime (void)
+{
+#if defined (HAVE_RT) && defined (CLOCK_MONOTONIC)
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000ULL;
+#endif
+}
+
+uint64_t
+HybridSynchronizer::GetNormalizedRealtime (void)
+{
+  return GetRealtime () - m_realtimeOriginNano;
+}
+
+uint64_t
+HybridSynchronizer::DoGetCurrentRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetNormalizedRealtime ();
+}
+
+void
+HybridSynchronizer::DoSetOrigin (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  m_realtimeOriginNano = GetRealtime ();
+  if (m_spinThreshold == 0)
+    {
+      m_spinThreshold = m_initialSpinThreshold.GetNanoSeconds ();
+    }
+  if (m_useTimerFd && m_timerFd < 0 && !OpenTimerFd ())
+    {
+      NS_LOG_WARN ("timerfd not available, sleeping on a condition variable");
+      m_useTimerFd = false;
+    }
+  NS_LOG_INFO ("origin = " << m_realtimeOriginNano);
+}
+
+int64_t
+HybridSynchronizer::DoGetDrift (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  uint64_t nsNow = GetNormalizedRealtime ();
+  if (nsNow > ns)
+    {
+      return (int64_t)(nsNow - ns);
+    }
+  else
+    {
+      return -(int64_t)(ns - nsNow);
+    }
+}
+
+bool
+HybridSynchronizer::DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay)
+{
+  NS_LOG_FUNCTION (this << nsCurrent << nsDelay);
+  //
+  // The simulator asks us to wait nsDelay from nsCurrent, which is the
+  // normalized real time it read.  We wait for the absolute deadline
+  // instead, so the time spent since nsCurrent is not waited twice.
+  //
+  uint64_t deadline = nsCurrent + nsDelay;
+  uint64_t tick = m_tick.GetNanoSeconds ();
+  uint64_t now = GetNormalizedRealtime ();
+  if (now + tick >= deadline)
+    {
+      NS_LOG_LOGIC ("Deadline within one tick");
+      m_deadline = deadline;
+      m_synchronized = true;
+      return true;
+    }
+
+  if (m_spinThreshold == 0)
+    {
+      m_spinThreshold = m_initialSpinThreshold.GetNanoSeconds ();
+    }
+  if (deadline - now > m_spinThreshold)
+    {
+      uint64_t wakeup = deadline - m_spinThreshold;
+      NS_LOG_LOGIC ("SleepWait until " << wakeup << " ns");
+      if (!SleepWait (wakeup))
+        {
+          NS_LOG_LOGIC ("SleepWait interrupted");
+          return false;
+        }
+      int64_t latency = (int64_t)(GetNormalizedRealtime () - wakeup);
+      m_wakeupLatencyTrace (NanoSeconds (latency));
+      if (m_adaptive)
+        {
+          UpdateSpinThreshold (latency);
+        }
+    }
+  else if (m_adaptive && m_latencySamples != 0)
+    {
+      //
+      // Without sleeps there are no latencies to learn from, so let a
+      // threshold inflated by a few slow wakeups shrink back until we
+      // sleep again.
+      //
+      m_latencyDeviation -= m_latencyDeviation / 8;
+      ComputeSpinThreshold ();
+    }
+  NS_LOG_LOGIC ("SpinWait until " << deadline << " ns");
+  if (!SpinWait (deadline))
+    {
+      return false;
+    }
+  m_deadline = deadline;
+  m_synchronized = true;
+  return true;
+}
+
+void
+HybridSynchronizer::UpdateSpinThreshold (int64_t latency)
+{
+  NS_LOG_FUNCTION (this << latency);
+  //
+  // Track the mean and mean deviation of the latency like TCP tracks the
+  // round trip time, and spin for long enough to cover nearly all the
+  // wakeups.
+  //
+  double sample = std::min (latency, m_maxSpinThreshold.GetNanoSeconds ());
+  if (m_latencySamples == 0)
+    {
+      m_latencyMean = sample;
+      m_latencyDeviation = sample / 2;
+    }
+  else
+    {
+      m_latencyDeviation += (std::fabs (sample - m_latencyMean) - m_latencyDeviation) / 4;
+      m_latencyMean += (sample - m_latencyMean) / 8;
+    }
+  m_latencySamples++;
+  ComputeSpinThreshold ();
+}
+
+void
+HybridSynchronizer::ComputeSpinThreshold (void)
+{
+  double threshold = m_latencyMean + 4 * m_latencyDeviation;
+  double low = m_minSpinThreshold.GetNanoSeconds ();
+  double high = m_maxSpinThreshold.GetNanoSeconds ();
+  threshold = std::max (low, std::min (high, threshold));
+  m_spinThreshold = std::max ((uint64_t)1, (uint64_t)threshold);
+  NS_LOG_LOGIC ("spin threshold " << m_spinThreshold << " ns");
+}
+
+bool
+HybridSynchronizer::SpinWait (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  for (;;)
+    {
+      if (GetNormalizedRealtime () >= ns)
+        {
+          return true;
+        }
+      if (m_condition.GetCondition ())
+        {
+          return false;
+        }
+    }
+}
+
+bool
+HybridSynchronizer::SleepWait (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+#ifdef HAVE_SYS_TIMERFD_H
+  if (m_useTimerFd && m_timerFd >= 0)
+    {
+      struct itimerspec its;
+      uint64_t absolute = m_realtimeOriginNano + ns;
+      its.it_interval.tv_sec = 0;
+      its.it_interval.tv_nsec = 0;
+      its.it_value.tv_sec = absolute / 1000000000ULL;
+      its.it_value.tv_nsec = absolute % 1000000000ULL;
+      timerfd_settime (m_timerFd, TFD_TIMER_ABSTIME, &its, 0);
+
+      struct pollfd fds[2];
+      fds[0].fd = m_timerFd;
+      fds[0].events = POLLIN;
+      fds[1].fd = m_pipe[0];
+      fds[1].events = POLLIN;
+      for (;;)
+        {
+          if (m_condition.GetCondition ())
+            {
+              return false;
+            }
+          fds[0].revents = 0;
+          fds[1].revents = 0;
+          if (poll (fds, 2, -1) < 0)
+            {
+              // Interrupted by a signal
+              continue;
+            }
+          if (fds[0].revents & POLLIN)
+            {
+              uint64_t expirations;
+              ssize_t n = read (m_timerFd, &expirations, sizeof (expirations));
+              NS_UNUSED (n);
+              return !m_condition.GetCondition ();
+            }
+          if (fds[1].revents & POLLIN)
+            {
+              char buffer[64];
+              while (read (m_pipe[0], buffer, sizeof (buffer)) > 0)
+                {
+                }
+            }
+        }
+    }
+#endif /* HAVE_SYS_TIMERFD_H */
+  uint64_t now = GetNormalizedRealtime ();
+  if (now >= ns)
+    {
+      return !m_condition.GetCondition ();
+    }
+  return m_condition.TimedWait (ns - now);
+}
+
+void
+HybridSynchronizer::DoSignal (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_condition.SetCondition (true);
+  m_condition.Signal ();
+  if (m_pipe[1] >= 0)
+    {
+      char c = 0;
+      ssize_t n = write (m_pipe[1], &c, 1);
+      NS_UNUSED (n);
+    }
+}
+
+void
+HybridSynchronizer::DoSetCondition (bool cond)
+{
+  NS_LOG_FUNCTION (this << cond);
+  m_condition.SetCondition (cond);
+}
+
+void
+HybridSynchronizer::DoEventStart (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nsEventStart = GetNormalizedRealtime ();
+  //
+  // Only the events the simulator synchronized to are accounted, not the
+  // idle waits for external events.
+  //
+  if (m_synchronized)
+    {
+      m_synchronized = false;
+      RecordJitter ((int64_t)(m_nsEventStart - m_deadline));
+    }
+}
+
+uint64_t
+HybridSynchronizer::DoEventEnd (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetNormalizedRealtime () - m_nsEventStart;
+}
+
+void
+HybridSynchronizer::RecordJitter (int64_t jitter)
+{
+  NS_LOG_FUNCTION (this << jitter);
+  m_jitterTrace (NanoSeconds (jitter));
+  if (m_histogram.size () != m_bins)
+    {
+      m_histogram.resize (m_bins, 0);
+    }
+  uint64_t magnitude = jitter < 0 ? -jitter : jitter;
+  uint64_t bin = magnitude / m_binWidth.GetNanoSeconds ();
+  m_histogram[std::min (bin, (uint64_t)(m_bins - 1))]++;
+  if (m_histogramInterval != 0 && ++m_sinceHistogram >= m_histogramInterval)
+    {
+      m_sinceHistogram = 0;
+      m_histogramTrace (m_histogram);
+    }
+}
+
+bool
+HybridSynchronizer::OpenTimerFd (void)
+{
+  NS_LOG_FUNCTION (this);
+#if defined (HAVE_SYS_TIMERFD_H) && defined (HAVE_RT)
+  // The deadlines are read from the monotonic clock.
+  m_timerFd = timerfd_create (CLOCK_MONOTONIC, 0);
+  if (m_timerFd < 0)
+    {
+      return false;
+    }
+  if (pipe (m_pipe) < 0)
+    {
+      CloseTimerFd ();
+      return false;
+    }
+  fcntl (m_pipe[0], F_SETFL, O_NONBLOCK);
+  fcntl (m_pipe[1], F_SETFL, O_NONBLOCK);
+  return true;
+#else
+  return false;
+#endif /* HAVE_SYS_TIMERFD_H && HAVE_RT */
+}
+
+void
+HybridSynchronizer::CloseTimerFd (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_timerFd >= 0)
+    {
+      close (m_timerFd);
+      m_timerFd = -1;
+    }
+  for (int i = 0; i < 2; i++)
+    {
+      if (m_pipe[i] >= 0)
+        {
+          close (m_pipe[i]);
+          m_pipe[i] = -1;
+        }
+    }
+}
+
+} // namespace ns3
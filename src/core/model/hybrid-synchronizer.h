@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HYBRID_SYNCHRONIZER_H
+#define HYBRID_SYNCHRONIZER_H
+
+#include <vector>
+
+#include "system-condition.h"
+#include "synchronizer.h"
+#include "traced-callback.h"
+
+/**
+ * @file
+ * @ingroup realtime
+ * ns3::HybridSynchronizer declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * @ingroup realtime
+ * @brief Synchronizer which sleeps, then spins, for a time learnt from
+ * the measured wakeup latency.
+ *
+ * Like the WallClockSynchronizer, this synchronizer sleeps until
+ * shortly before the deadline of the next event, then spins until
+ * the deadline.  Instead of a fixed number of clock ticks, the spin
+ * time is the SpinThreshold, which is adapted after each sleep to the
+ * mean plus four mean deviations of the measured wakeup latency (how
+ * late the sleeps end), between MinSpinThreshold and
+ * MaxSpinThreshold.  Waits too short to sleep let the deviation
+ * decay, so that a few slow wakeups do not stop the sleeps for good.
+ * On an idle host the threshold shrinks to a few
+ * tens of microseconds and the synchronizer mostly sleeps; under load
+ * it grows so that the deadlines are still met.
+ *
+ * Time is read from the monotonic clock.  With UseTimerFd, the sleeps
+ * are timerfd waits for an absolute deadline, which are not delayed
+ * by the time spent setting them up; otherwise they are timed waits
+ * on a condition variable.
+ *
+ * Events due within one Tick of the current real time are run
+ * without waiting, so that bursts of events with nearly the same
+ * timestamps do not each pay for a synchronization.
+ *
+ * The lateness of each event with respect to the deadline it was
+ * synchronized to (not the backlog of a simulation which can not keep
+ * up with real time, see Synchronizer::GetDrift()) is reported by
+ * the Jitter trace source,
+ * and is accumulated in a histogram of HistogramBins bins of
+ * HistogramBinWidth, the last one counting all the larger values.
+ * The histogram is reported every HistogramInterval events by the
+ * JitterHistogram trace source, and can be read with
+ * GetJitterHistogram().
+ *
+ * To use it, set the SynchronizerType of the RealtimeSimulatorImpl:
+ * @code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::RealtimeSimulatorImpl"));
+ *   Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+ *                       TypeIdValue (HybridSynchronizer::GetTypeId ()));
+ * @endcode
+ */
+class HybridSynchronizer : public Synchronizer
+{
+public:
+  /**
+   * Get the registered TypeId for this class.
+   * @returns The TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  HybridSynchronizer ();
+  /** Destructor. */
+  virtual ~HybridSynchronizer ();
+
+  /**
+   * Get the current spin threshold.
+   * @returns The time spent spinning before each deadline.
+   */
+  Time GetSpinThreshold (void) const;
+  /**
+   * Get the jitter histogram.
+   * @returns The number of events in each bin of HistogramBinWidth;
+   *          the last bin counts all the larger jitters.
+   */
+  std::vector<uint64_t> GetJitterHistogram (void) const;
+
+  /**
+   * TracedCallback signature for the jitter histogram.
+   *
+   * @param [in] histogram The number of events in each bin.
+   */
+  typedef void (* HistogramTracedCallback)(const std::vector<uint64_t> &histogram);
+
+protected:
+  virtual void DoDispose (void);
+
+  // Inherited from Synchronizer
+  virtual void DoSetOrigin (uint64_t ns);
+  virtual bool DoRealtime (void);
+  virtual uint64_t DoGetCurrentRealtime (void);
+  virtual bool DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay);
+  virtual void DoSignal (void);
+  virtual void DoSetCondition (bool cond);
+  virtual int64_t DoGetDrift (uint64_t ns);
+  virtual void DoEventStart (void);
+  virtual uint64_t DoEventEnd (void);
+
+private:
+  /**
+   * Read the monotonic clock.
+   * @returns The current time, in ns.
+   */
+  static uint64_t GetRealtime (void);
+  /**
+   * Get the current normalized real time.
+   * @returns The current time since the origin, in ns.
+   */
+  uint64_t GetNormalizedRealtime (void);
+  /**
+   * Sleep until a normalized real time, or until the condition is set.
+   * @param [in] ns The normalized real time to wake up at.
+   * @returns @c true if we slept until @p ns,
+   *          @c false if we returned because the condition was set.
+   */
+  bool SleepWait (uint64_t ns);
+  /**
+   * Spin until a normalized real time, or until the condition is set.
+   * @param [in] ns The normalized real time to wait for.
+   * @returns @c true if we reached @p ns,
+   *          @c false if we returned because the condition was set.
+   */
+  bool SpinWait (uint64_t ns);
+  /**
+   * Adapt the spin threshold to the latency of a wakeup.
+   * @param [in] latency How late the last sleep ended, in ns.
+   */
+  void UpdateSpinThreshold (int64_t latency);
+  /** Set the spin threshold from the latency mean and deviation. */
+  void ComputeSpinThreshold (void);
+  /**
+   * Account the jitter of an event.
+   * @param [in] jitter How late the event is run, in ns.
+   */
+  void RecordJitter (int64_t jitter);
+  /**
+   * Open the timerfd and the pipe which interrupts it.
+   * @returns @c true if the timerfd can be used.
+   */
+  bool OpenTimerFd (void);
+  /** Close the timerfd and its pipe. */
+  void CloseTimerFd (void);
+
+  /** Initial spin threshold. */
+  Time m_initialSpinThreshold;
+  /** Smallest spin threshold. */
+  Time m_minSpinThreshold;
+  /** Largest spin threshold. */
+  Time m_maxSpinThreshold;
+  /** Whether the spin threshold is adapted to the wakeup latency. */
+  bool m_adaptive;
+  /** Whether to sleep with a timerfd. */
+  bool m_useTimerFd;
+  /** Events due within this time are run without waiting. */
+  Time m_tick;
+  /** Width of the bins of the jitter histogram. */
+  Time m_binWidth;
+  /** Number of bins of the jitter histogram. */
+  uint32_t m_bins;
+  /** Number of events between two JitterHistogram traces. */
+  uint32_t m_histogramInterval;
+
+  /** Current spin threshold, in ns; 0 until the first sleep. */
+  uint64_t m_spinThreshold;
+  /** Mean wakeup latency, in ns. */
+  double m_latencyMean;
+  /** Mean deviation of the wakeup latency, in ns. */
+  double m_latencyDeviation;
+  /** Number of wakeup latencies measured. */
+  uint64_t m_latencySamples;
+  /** Number of events in each bin of the jitter histogram. */
+  std::vector<uint64_t> m_histogram;
+  /** Number of events since the last JitterHistogram trace. */
+  uint32_t m_sinceHistogram;
+  /** The last deadline synchronized to, in ns. */
+  uint64_t m_deadline;
+  /** Whether the next event is the one synchronized to m_deadline. */
+  bool m_synchronized;
+  /** Time recorded by DoEventStart. */
+  uint64_t m_nsEventStart;
+
+  /** The timerfd, or -1. */
+  int m_timerFd;
+  /** The pipe written by DoSignal to interrupt the timerfd wait. */
+  int m_pipe[2];
+
+  /** Thread synchronizer. */
+  SystemCondition m_condition;
+
+  /** Trace of the wakeup latency of each sleep. */
+  TracedCallback<Time> m_wakeupLatencyTrace;
+  /** Trace of the jitter of each event. */
+  TracedCallback<Time> m_jitterTrace;
+  /** Trace of the jitter histogram. */
+  TracedCallback<const std::vector<uint64_t> &> m_histogramTrace;
+};
+
+} // namespace ns3
+
+#endif /* HYBRID_SYNCHRONIZER_H */
@@ -93,8 +93,32 @@ public:
   /**@{*/
   inline int64x64_t (const double value)
   {
-    const int64x64_t tmp ((long double)value);
-    _v = tmp._v;
+    const bool negative = value < 0;
+    const double v = negative ? -value : value;
+    // 2^63: below this the integer part fits in an int64_t
+    if (!(v < 9223372036854775808.0))
+      {
+        const int64x64_t tmp ((long double)value);
+        _v = tmp._v;
+        return;
+      }
+    // Same computation as the long double constructor below, but
+    // without the cost of std::modf: the truncating conversion gives
+    // the same integer part, and the fractional part of a double is
+    // exactly representable.
+    int128_t hi = static_cast<int64_t> (v);
+    long double flo = v - static_cast<double> (static_cast<int64_t> (v));
+    const long double round = 0.5;
+    flo = flo * HP_MAX_64 + round;
+    const uint64_t lo = flo;
+    if (flo >= HP_MAX_64)
+      {
+        // conversion to uint64 rolled over
+        ++hi;
+      }
+    _v = hi << 64;
+    _v |= lo;
+    _v = negative ? -_v : _v;
   }
   inline int64x64_t (const long double value)
   {
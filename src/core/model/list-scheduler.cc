@@ -21,6 +21,7 @@
 #include "list-scheduler.h"
 #include "event-impl.h"
 #include "log.h"
+#include <algorithm>
 #include <utility>
 #include <string>
 #include "assert.h"
@@ -70,6 +71,25 @@ ListScheduler::Insert (const Event &ev)
     }
   m_events.push_back (ev);
 }
+
+void
+ListScheduler::InsertBatch (const std::vector<Scheduler::Event> &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  // Merge the sorted batch in one pass over the list.
+  std::vector<Scheduler::Event> sorted (events);
+  std::sort (sorted.begin (), sorted.end ());
+  EventsI i = m_events.begin ();
+  for (std::vector<Scheduler::Event>::const_iterator ev = sorted.begin ();
+       ev != sorted.end (); ++ev)
+    {
+      while (i != m_events.end () && !(ev->key < i->key))
+        {
+          i++;
+        }
+      m_events.insert (i, *ev);
+    }
+}
 bool
 ListScheduler::IsEmpty (void) const
 {
@@ -0,0 +1,651 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "log-binary-sink.h"
+#include "fatal-error.h"
+#include "nstime.h"
+#include "simulator.h"
+#include "ns3/core-config.h"
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#ifdef HAVE_STDLIB_H
+#include <cstdlib>
+#endif
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::LogBinarySink implementation.
+ */
+
+namespace ns3 {
+
+// Note:  There is no logging in this file: while the sink is enabled
+// everything written to std::clog comes back here.  For the same
+// reason the sink uses pthreads directly rather than SystemMutex and
+// SystemThread, which log their own operations.
+
+namespace {
+
+/** Identifies a binary log file. */
+const char MAGIC[8] = { 'n', 's', '3', 'l', 'o', 'g', 'b', '1' };
+
+/** Record flag: the record holds a time prefix. */
+const uint32_t HAS_TIME = 1;
+/** Record flag: the record holds a node prefix. */
+const uint32_t HAS_NODE = 2;
+
+/**
+ * \ingroup logging
+ * Header of one record in the binary log, in native byte order.
+ */
+struct RecordHeader
+{
+  uint32_t size;        //!< Length of the text following the header.
+  uint32_t flags;       //!< HAS_TIME and HAS_NODE bits.
+  double time;          //!< Simulation time, in seconds.
+  uint32_t node;        //!< Simulation context.
+  uint32_t timeOffset;  //!< Position of the time prefix in the text.
+  uint32_t nodeOffset;  //!< Position of the node prefix in the text.
+};
+
+/**
+ * \ingroup logging
+ * The record being built by one thread, and the records it completed.
+ *
+ * Only the logging thread and the writer thread lock the mutex, so
+ * logging threads do not contend with each other.
+ */
+struct ThreadRecord
+{
+  RecordHeader header;        //!< The raw prefixes.
+  std::string text;           //!< The text written so far.
+  pthread_mutex_t mutex;      //!< Protects the pending records.
+  pthread_cond_t roomCond;    //!< Signals room in the pending records.
+  std::vector<char> pending;  //!< Records of this thread not yet written.
+};
+
+/** Pending bytes of a thread above which the writer thread is woken up. */
+const std::size_t WRITE_THRESHOLD = 64 * 1024;
+/** Pending bytes of a thread above which it waits for the writer. */
+const std::size_t MAX_PENDING = 16 * 1024 * 1024;
+/** Longest time records stay pending before being written, in ns. */
+const long WRITE_PERIOD = 100000000;
+
+/**
+ * \ingroup logging
+ * The stream buffer which replaces the one of \c std::clog.
+ *
+ * The buffer is unbuffered from the point of view of std::streambuf:
+ * characters go straight into the ThreadRecord of the calling thread,
+ * and are committed to the pending records of that thread on sync(),
+ * which \c std::endl calls at the end of each log line.  The writer
+ * thread swaps the pending records of each thread out in turn and
+ * writes them to the file, so the lines of one thread stay in order
+ * but the lines of different threads may be interleaved differently
+ * than they were logged.
+ */
+class LogBinarySinkImpl : public std::streambuf
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] file The log file, open for appending, which the
+   *            sink now owns and truncates when it writes the first
+   *            record.
+   * \param [in] filename The name of the log file.
+   */
+  LogBinarySinkImpl (FILE *file, std::string filename);
+  /** Destructor. */
+  virtual ~LogBinarySinkImpl ();
+
+  /**
+   * Write the pending records, stop the writer thread and close the file.
+   * \returns \c true if records were written to the file.
+   */
+  bool Stop (void);
+  /**
+   * Get the name of the log file.
+   * \returns The name of the log file.
+   */
+  std::string GetFilename (void) const;
+  /** Wait for the records committed so far to be written. */
+  void Flush (void);
+  /**
+   * Get the record of the calling thread.
+   * \returns The record being built by this thread.
+   */
+  ThreadRecord *GetRecord (void);
+
+protected:
+  virtual int_type overflow (int_type c);
+  virtual std::streamsize xsputn (const char *s, std::streamsize n);
+  virtual int sync (void);
+
+private:
+  /**
+   * Append a record to the pending records of its thread and reset it.
+   * \param [in,out] record The record to commit.
+   */
+  void Commit (ThreadRecord *record);
+  /**
+   * Writer thread entry point.
+   * \param [in] arg The LogBinarySinkImpl.
+   * \returns 0.
+   */
+  static void *Run (void *arg);
+  /** Writer thread loop. */
+  void DoRun (void);
+  /** Truncate the log file and write its header. */
+  void Start (void);
+
+  FILE *m_file;                            //!< The log file.
+  std::string m_filename;                  //!< The name of the log file.
+  bool m_started;                          //!< Whether the file was truncated.
+  pthread_key_t m_key;                     //!< Key of the per-thread records.
+  pthread_t m_thread;                      //!< The writer thread.
+  pthread_mutex_t m_mutex;                 //!< Protects the members below.
+  pthread_cond_t m_dataCond;               //!< Wakes up the writer thread.
+  pthread_cond_t m_doneCond;               //!< Signals completed flushes.
+  std::vector<ThreadRecord *> m_records;   //!< All per-thread records.
+  uint64_t m_flushRequested;               //!< Last flush request.
+  uint64_t m_flushed;                      //!< Last flush request completed.
+  bool m_stop;                             //!< Stop the writer thread.
+};
+
+/** The sink, if enabled. */
+LogBinarySinkImpl *g_sink = 0;
+/** The original stream buffer of std::clog. */
+std::streambuf *g_clogBuffer = 0;
+/** The default time printer, whose time is recorded raw. */
+LogTimePrinter g_recordedTimePrinter = 0;
+/** The default node printer, whose context is recorded raw. */
+LogNodePrinter g_recordedNodePrinter = 0;
+
+LogBinarySinkImpl::LogBinarySinkImpl (FILE *file, std::string filename)
+  : m_file (file),
+    m_filename (filename),
+    m_started (false),
+    m_flushRequested (0),
+    m_flushed (0),
+    m_stop (false)
+{
+  pthread_key_create (&m_key, 0);
+  pthread_mutex_init (&m_mutex, 0);
+  pthread_cond_init (&m_dataCond, 0);
+  pthread_cond_init (&m_doneCond, 0);
+  if (pthread_create (&m_thread, 0, &LogBinarySinkImpl::Run, this) != 0)
+    {
+      NS_FATAL_ERROR ("Could not start the binary log writer thread");
+    }
+}
+
+LogBinarySinkImpl::~LogBinarySinkImpl ()
+{
+  for (std::vector<ThreadRecord *>::iterator i = m_records.begin ();
+       i != m_records.end (); ++i)
+    {
+      pthread_cond_destroy (&(*i)->roomCond);
+      pthread_mutex_destroy (&(*i)->mutex);
+      delete *i;
+    }
+  pthread_key_delete (m_key);
+  pthread_cond_destroy (&m_doneCond);
+  pthread_cond_destroy (&m_dataCond);
+  pthread_mutex_destroy (&m_mutex);
+}
+
+ThreadRecord *
+LogBinarySinkImpl::GetRecord (void)
+{
+  ThreadRecord *record = static_cast<ThreadRecord *> (pthread_getspecific (m_key));
+  if (record == 0)
+    {
+      record = new ThreadRecord ();
+      std::memset (&record->header, 0, sizeof (record->header));
+      pthread_mutex_init (&record->mutex, 0);
+      pthread_cond_init (&record->roomCond, 0);
+      record->pending.reserve (WRITE_THRESHOLD * 2);
+      pthread_setspecific (m_key, record);
+      pthread_mutex_lock (&m_mutex);
+      m_records.push_back (record);
+      pthread_mutex_unlock (&m_mutex);
+    }
+  return record;
+}
+
+void
+LogBinarySinkImpl::Commit (ThreadRecord *record)
+{
+  record->header.size = record->text.size ();
+  pthread_mutex_lock (&record->mutex);
+  while (record->pending.size () >= MAX_PENDING && !m_stop)
+    {
+      pthread_cond_signal (&m_dataCond);
+      pthread_cond_wait (&record->roomCond, &record->mutex);
+    }
+  const char *header = reinterpret_cast<const char *> (&record->header);
+  record->pending.insert (record->pending.end (), header, header + sizeof (RecordHeader));
+  record->pending.insert (record->pending.end (), record->text.begin (), record->text.end ());
+  bool wake = record->pending.size () >= WRITE_THRESHOLD;
+  pthread_mutex_unlock (&record->mutex);
+  if (wake)
+    {
+      // The writer also wakes up periodically, so a signal missed
+      // while it is busy only delays the write.
+      pthread_cond_signal (&m_dataCond);
+    }
+  record->header.flags = 0;
+  record->text.clear ();
+}
+
+LogBinarySinkImpl::int_type
+LogBinarySinkImpl::overflow (int_type c)
+{
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      GetRecord ()->text.push_back (traits_type::to_char_type (c));
+    }
+  return traits_type::not_eof (c);
+}
+
+std::streamsize
+LogBinarySinkImpl::xsputn (const char *s, std::streamsize n)
+{
+  GetRecord ()->text.append (s, n);
+  return n;
+}
+
+int
+LogBinarySinkImpl::sync (void)
+{
+  ThreadRecord *record = GetRecord ();
+  if (!record->text.empty ())
+    {
+      Commit (record);
+    }
+  return 0;
+}
+
+void
+LogBinarySinkImpl::Flush (void)
+{
+  sync ();
+  // Called from the fatal error path: do not wait if this thread
+  // was interrupted while holding the lock.
+  if (pthread_mutex_trylock (&m_mutex) != 0)
+    {
+      return;
+    }
+  uint64_t request = ++m_flushRequested;
+  pthread_cond_signal (&m_dataCond);
+  while (m_flushed < request && !m_stop)
+    {
+      pthread_cond_wait (&m_doneCond, &m_mutex);
+    }
+  pthread_mutex_unlock (&m_mutex);
+}
+
+bool
+LogBinarySinkImpl::Stop (void)
+{
+  pthread_mutex_lock (&m_mutex);
+  m_stop = true;
+  pthread_cond_signal (&m_dataCond);
+  pthread_cond_broadcast (&m_doneCond);
+  for (std::vector<ThreadRecord *>::iterator i = m_records.begin ();
+       i != m_records.end (); ++i)
+    {
+      pthread_mutex_lock (&(*i)->mutex);
+      pthread_cond_broadcast (&(*i)->roomCond);
+      pthread_mutex_unlock (&(*i)->mutex);
+    }
+  pthread_mutex_unlock (&m_mutex);
+  pthread_join (m_thread, 0);
+  bool recorded = m_started;
+  // Nothing was logged: leave an existing file as it was, but
+  // complete a new one as an empty log.
+  if (!m_started && std::fseek (m_file, 0, SEEK_END) == 0 && std::ftell (m_file) == 0)
+    {
+      Start ();
+    }
+  std::fclose (m_file);
+  m_file = 0;
+  return recorded;
+}
+
+std::string
+LogBinarySinkImpl::GetFilename (void) const
+{
+  return m_filename;
+}
+
+void
+LogBinarySinkImpl::Start (void)
+{
+  std::fflush (m_file);
+  if (ftruncate (fileno (m_file), 0) != 0)
+    {
+      std::fprintf (stderr, "Could not truncate the binary log file\n");
+    }
+  // The file is open for appending: the writes now start at offset 0.
+  std::fwrite (MAGIC, 1, sizeof (MAGIC), m_file);
+  m_started = true;
+}
+
+void *
+LogBinarySinkImpl::Run (void *arg)
+{
+  static_cast<LogBinarySinkImpl *> (arg)->DoRun ();
+  return 0;
+}
+
+void
+LogBinarySinkImpl::DoRun (void)
+{
+  std::vector<char> writing;
+  writing.reserve (WRITE_THRESHOLD * 2);
+  std::vector<ThreadRecord *> records;
+  pthread_mutex_lock (&m_mutex);
+  while (true)
+    {
+      if (m_flushRequested == m_flushed && !m_stop)
+        {
+          struct timeval tv;
+          gettimeofday (&tv, 0);
+          struct timespec deadline;
+          deadline.tv_sec = tv.tv_sec;
+          deadline.tv_nsec = tv.tv_usec * 1000 + WRITE_PERIOD;
+          if (deadline.tv_nsec >= 1000000000)
+            {
+              deadline.tv_sec += 1;
+              deadline.tv_nsec -= 1000000000;
+            }
+          pthread_cond_timedwait (&m_dataCond, &m_mutex, &deadline);
+        }
+      uint64_t request = m_flushRequested;
+      bool stop = m_stop;
+      records = m_records;
+      pthread_mutex_unlock (&m_mutex);
+
+      for (std::vector<ThreadRecord *>::iterator i = records.begin ();
+           i != records.end (); ++i)
+        {
+          ThreadRecord *record = *i;
+          pthread_mutex_lock (&record->mutex);
+          writing.swap (record->pending);
+          pthread_cond_broadcast (&record->roomCond);
+          pthread_mutex_unlock (&record->mutex);
+          if (!writing.empty ())
+            {
+              if (!m_started)
+                {
+                  Start ();
+                }
+              std::fwrite (&writing[0], 1, writing.size (), m_file);
+              writing.clear ();
+            }
+        }
+      std::fflush (m_file);
+
+      pthread_mutex_lock (&m_mutex);
+      m_flushed = request;
+      pthread_cond_broadcast (&m_doneCond);
+      if (stop)
+        {
+          break;
+        }
+    }
+  pthread_mutex_unlock (&m_mutex);
+}
+
+/**
+ * \ingroup logging
+ * Time printer used while the binary sink is enabled.
+ * \param [in,out] os The output stream to print the time on.
+ */
+void
+RecordTime (std::ostream &os)
+{
+  if (g_sink == 0 || os.rdbuf () != g_sink)
+    {
+      g_recordedTimePrinter (os);
+      return;
+    }
+  ThreadRecord *record = g_sink->GetRecord ();
+  record->header.flags |= HAS_TIME;
+  record->header.time = Simulator::Now ().GetSeconds ();
+  record->header.timeOffset = record->text.size ();
+}
+
+/**
+ * \ingroup logging
+ * Node printer used while the binary sink is enabled.
+ * \param [in,out] os The output stream to print the node id on.
+ */
+void
+RecordNode (std::ostream &os)
+{
+  if (g_sink == 0 || os.rdbuf () != g_sink)
+    {
+      g_recordedNodePrinter (os);
+      return;
+    }
+  ThreadRecord *record = g_sink->GetRecord ();
+  record->header.flags |= HAS_NODE;
+  record->header.node = Simulator::GetContext ();
+  record->header.nodeOffset = record->text.size ();
+}
+
+/**
+ * \ingroup logging
+ * Handler for the \c binary-sink option of \c NS_LOG.
+ */
+class LogBinarySinkOption
+{
+public:
+  /** Constructor, enables the sink if requested by \c NS_LOG. */
+  LogBinarySinkOption ();
+  /** Destructor, completes the log file. */
+  ~LogBinarySinkOption ();
+};
+
+LogBinarySinkOption::LogBinarySinkOption ()
+{
+#ifdef HAVE_GETENV
+  char *envVar = getenv ("NS_LOG");
+  if (envVar == 0)
+    {
+      return;
+    }
+  std::string env = envVar;
+  std::string::size_type cur = 0;
+  std::string::size_type next = 0;
+  while (next != std::string::npos)
+    {
+      next = env.find_first_of (":", cur);
+      std::string tmp = std::string (env, cur, next - cur);
+      if (tmp == "binary-sink")
+        {
+          LogBinarySink::Enable (LogBinarySink::DEFAULT_FILENAME);
+        }
+      else if (tmp.compare (0, 12, "binary-sink=") == 0)
+        {
+          LogBinarySink::Enable (tmp.substr (12));
+        }
+      cur = next + 1;
+    }
+#endif
+}
+
+LogBinarySinkOption::~LogBinarySinkOption ()
+{
+  LogBinarySink::Disable ();
+}
+
+/** Invoke the handler for \c binary-sink in \c NS_LOG. */
+LogBinarySinkOption g_logBinarySinkOption;
+
+} // anonymous namespace
+
+
+const char *LogBinarySink::DEFAULT_FILENAME = "ns3-log.bin";
+
+void
+LogBinarySink::Enable (std::string filename)
+{
+  Disable ();
+  // The file is only truncated when the first record is written, so
+  // that a program which logs nothing, like log-binary-decode, does
+  // not destroy the log it is given.
+  FILE *file = std::fopen (filename.c_str (), "ab");
+  if (file == 0)
+    {
+      NS_FATAL_ERROR ("Could not open binary log file " << filename);
+    }
+  g_sink = new LogBinarySinkImpl (file, filename);
+  g_clogBuffer = std::clog.rdbuf (g_sink);
+}
+
+bool
+LogBinarySink::Disable (void)
+{
+  if (g_sink == 0)
+    {
+      return false;
+    }
+  std::clog.flush ();
+  std::clog.rdbuf (g_clogBuffer);
+  g_clogBuffer = 0;
+  LogBinarySinkImpl *sink = g_sink;
+  g_sink = 0;
+  bool recorded = sink->Stop ();
+  delete sink;
+  return recorded;
+}
+
+bool
+LogBinarySink::IsEnabled (void)
+{
+  return g_sink != 0;
+}
+
+std::string
+LogBinarySink::GetFilename (void)
+{
+  return g_sink != 0 ? g_sink->GetFilename () : std::string ();
+}
+
+void
+LogBinarySink::Flush (void)
+{
+  if (g_sink != 0)
+    {
+      g_sink->Flush ();
+    }
+}
+
+void
+LogBinarySink::SetRecordedPrinters (LogTimePrinter timePrinter,
+                                    LogNodePrinter nodePrinter)
+{
+  g_recordedTimePrinter = timePrinter;
+  g_recordedNodePrinter = nodePrinter;
+}
+
+LogTimePrinter
+LogBinarySink::GetTimePrinter (LogTimePrinter printer)
+{
+  if (printer != 0 && printer == g_recordedTimePrinter)
+    {
+      return &RecordTime;
+    }
+  return printer;
+}
+
+LogNodePrinter
+LogBinarySink::GetNodePrinter (LogNodePrinter printer)
+{
+  if (printer != 0 && printer == g_recordedNodePrinter)
+    {
+      return &RecordNode;
+    }
+  return printer;
+}
+
+bool
+LogBinarySink::Decode (std::istream &is, std::ostream &os)
+{
+  char magic[sizeof (MAGIC)];
+  if (!is.read (magic, sizeof (magic))
+      || std::memcmp (magic, MAGIC, sizeof (MAGIC)) != 0)
+    {
+      return false;
+    }
+  std::string text;
+  while (true)
+    {
+      RecordHeader header;
+      is.read (reinterpret_cast<char *> (&header), sizeof (header));
+      if (is.gcount () == 0 && is.eof ())
+        {
+          return true;
+        }
+      if (!is)
+        {
+          return false;
+        }
+      text.resize (header.size);
+      if (header.size > 0 && !is.read (&text[0], header.size))
+        {
+          return false;
+        }
+
+      // The time printer always runs before the node printer.
+      std::string::size_type start = 0;
+      if (header.flags & HAS_TIME)
+        {
+          os.write (text.data (), header.timeOffset - start);
+          std::ostringstream oss;
+          oss << header.time << "s";
+          os << oss.str ();
+          start = header.timeOffset;
+        }
+      if (header.flags & HAS_NODE)
+        {
+          os.write (text.data () + start, header.nodeOffset - start);
+          if (header.node == 0xffffffff)
+            {
+              os << "-1";
+            }
+          else
+            {
+              os << header.node;
+            }
+          start = header.nodeOffset;
+        }
+      os.write (text.data () + start, text.size () - start);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_LOG_BINARY_SINK_H
+#define NS3_LOG_BINARY_SINK_H
+
+#include <iostream>
+#include <string>
+
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::LogBinarySink declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup logging
+ *
+ * Asynchronous binary backend for the logging macros.
+ *
+ * By default the logging macros format every message, including the
+ * time and node prefixes, directly on \c std::clog and flush it at the
+ * end of each line.  When the binary sink is enabled, \c std::clog is
+ * redirected to a per-thread record buffer instead:
+ *
+ *  - the simulation time and node id prefixes are stored raw, and only
+ *    formatted when the log is decoded;
+ *  - each completed line becomes one binary record, appended to a
+ *    shared buffer without any system call;
+ *  - a background thread writes the records to the log file.
+ *
+ * The log file can be turned back into the text the synchronous
+ * backend would have printed with Decode(), or with the
+ * \c log-binary-decode program.
+ *
+ * The sink is selected with the \c binary-sink option of the \c NS_LOG
+ * environment variable, optionally followed by the file name (the
+ * default is \c ns3-log.bin):
+ * \code
+ *   $ NS_LOG='binary-sink=run.log.bin:UdpEchoClientApplication=level_all|prefix_all' ./waf --run ...
+ *   $ ./waf --run "log-binary-decode --in=run.log.bin"
+ * \endcode
+ *
+ * An existing log file is only replaced when the first line is
+ * logged, so a run which logs nothing leaves it as it was.
+ *
+ * The time and node prefixes printed by the default printers of the
+ * Simulator are recorded raw, and decoded as these printers show
+ * them.  The printers set with LogSetTimePrinter() and
+ * LogSetNodePrinter() are still called, and their text recorded.
+ */
+class LogBinarySink
+{
+public:
+  /**
+   * Start capturing \c std::clog into a binary log file.
+   *
+   * If the sink is already enabled it is first disabled, which
+   * completes the previous file.  The file is truncated when the
+   * first record is written to it.
+   *
+   * \param [in] filename The log file to write.
+   */
+  static void Enable (std::string filename);
+  /**
+   * Write all pending records, close the log file and restore
+   * the original \c std::clog buffer.
+   *
+   * \returns \c true if the sink was enabled and wrote records to
+   *          its file, which then replaced the previous content.
+   */
+  static bool Disable (void);
+  /**
+   * Check if the binary sink is capturing \c std::clog.
+   *
+   * \returns \c true if the sink is enabled.
+   */
+  static bool IsEnabled (void);
+  /**
+   * Get the file the sink writes to.
+   *
+   * \returns The name of the log file, or an empty string if the
+   *          sink is not enabled.
+   */
+  static std::string GetFilename (void);
+  /**
+   * Wait until all records logged so far are written to the file.
+   *
+   * This is called by FatalImpl::FlushStreams() so that the lines
+   * leading to a fatal error are not lost.
+   */
+  static void Flush (void);
+
+  /**
+   * Set the printers whose prefixes the sink records raw.
+   *
+   * These are the default printers installed by the Simulator: they
+   * must print the current simulation time in seconds followed by
+   * \c s, and the current context, or -1 for none.
+   *
+   * \param [in] timePrinter The default time printer.
+   * \param [in] nodePrinter The default node printer.
+   */
+  static void SetRecordedPrinters (LogTimePrinter timePrinter,
+                                   LogNodePrinter nodePrinter);
+  /**
+   * Get the time printer to use while the sink is enabled.
+   *
+   * \param [in] printer The time printer installed.
+   * \returns A printer recording the raw time if \p printer is the
+   *          default time printer, else \p printer itself, whose text
+   *          is recorded as is.
+   */
+  static LogTimePrinter GetTimePrinter (LogTimePrinter printer);
+  /**
+   * Get the node printer to use while the sink is enabled.
+   *
+   * \param [in] printer The node printer installed.
+   * \returns A printer recording the raw context if \p printer is the
+   *          default node printer, else \p printer itself, whose text
+   *          is recorded as is.
+   */
+  static LogNodePrinter GetNodePrinter (LogNodePrinter printer);
+
+  /**
+   * Convert a binary log back to text.
+   *
+   * \param [in] is The binary log.
+   * \param [in,out] os The stream to print the text log on.
+   * \returns \c false if \p is is not a binary log, or is truncated.
+   */
+  static bool Decode (std::istream &is, std::ostream &os);
+
+  /**
+   * The default log file name.
+   */
+  static const char *DEFAULT_FILENAME;
+};
+
+} // namespace ns3
+
+#endif /* NS3_LOG_BINARY_SINK_H */
@@ -30,6 +30,10 @@
 #include <cstring>
 #endif
 
+#ifdef HAVE_PTHREAD_H
+#include "log-binary-sink.h"
+#endif
+
 #ifdef HAVE_STDLIB_H
 #include <cstdlib>
 #endif
@@ -534,7 +538,11 @@ static void CheckEnvironmentVariables (void)
       std::string tmp = std::string (env, cur, next-cur);
       std::string::size_type equal = tmp.find ("=");
       std::string component;
-      if (equal == std::string::npos)
+      if (tmp == "binary-sink" || tmp.compare (0, 12, "binary-sink=") == 0)
+        {
+          // handled by LogBinarySink
+        }
+      else if (equal == std::string::npos)
         {
           // ie no '=' characters found 
           component = tmp;
@@ -619,6 +627,12 @@ void LogSetTimePrinter (LogTimePrinter printer)
 }
 LogTimePrinter LogGetTimePrinter (void)
 {
+#ifdef HAVE_PTHREAD_H
+  if (LogBinarySink::IsEnabled ())
+    {
+      return LogBinarySink::GetTimePrinter (g_logTimePrinter);
+    }
+#endif
   return g_logTimePrinter;
 }
 
@@ -628,6 +642,12 @@ void LogSetNodePrinter (LogNodePrinter printer)
 }
 LogNodePrinter LogGetNodePrinter (void)
 {
+#ifdef HAVE_PTHREAD_H
+  if (LogBinarySink::IsEnabled ())
+    {
+      return LogBinarySink::GetNodePrinter (g_logNodePrinter);
+    }
+#endif
   return g_logNodePrinter;
 }
 
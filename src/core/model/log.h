@@ -71,6 +71,14 @@
  * \c NS_LOG='*=level_all|prefix' would enable all log levels and prefix all
  * prints with the component and function names.
  *
+ * On large runs the cost of formatting and flushing each line
+ * synchronously dominates.  The \c binary-sink option records the
+ * log in binary form from a background thread instead, see
+ * ns3::LogBinarySink:
+ * \code
+ *   $ NS_LOG='binary-sink=run.log.bin:Component1=level_all|prefix_all'
+ * \endcode
+ *
  * A note on NS_LOG_FUNCTION() and NS_LOG_FUNCTION_NOARGS():
  * generally, use of (at least) NS_LOG_FUNCTION(this) is preferred,
  * with the any function parameters added:
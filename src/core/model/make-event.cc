@@ -20,6 +20,8 @@
 #include "make-event.h"
 #include "log.h"
 
+#include <cstring>
+
 /**
  * \file
  * \ingroup events
@@ -44,6 +46,12 @@ public:
       : m_function (function)
     {
     }
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = 0;
+      site.function = MakeEventFunctionAddress (0, &m_function, sizeof (m_function));
+    }
     virtual ~EventFunctionImpl0 ()
     {
     }
@@ -58,4 +66,46 @@ private:
   return ev;
 }
 
+const void *
+MakeEventFunctionAddress (const void *obj, const void *function, std::size_t size)
+{
+  NS_LOG_FUNCTION (obj << function << size);
+  if (size == sizeof (const void *))
+    {
+      // A function pointer
+      const void *address;
+      std::memcpy (&address, function, sizeof (address));
+      return address;
+    }
+#if defined (__GNUC__)
+  if (obj != 0 && size == 2 * sizeof (const void *))
+    {
+      // An Itanium C++ ABI class method pointer: the function address,
+      // or one plus the offset of the method in the virtual table,
+      // followed by the adjustment of the object pointer.
+      uintptr_t ptr;
+      intptr_t adj;
+      std::memcpy (&ptr, function, sizeof (ptr));
+      std::memcpy (&adj, static_cast<const char *> (function) + sizeof (ptr), sizeof (adj));
+#if defined (__arm__) || defined (__aarch64__)
+      // The ARM variant flags virtual methods in the adjustment instead.
+      bool isVirtual = (adj & 1) != 0;
+      adj >>= 1;
+      uintptr_t offset = ptr;
+#else
+      bool isVirtual = (ptr & 1) != 0;
+      uintptr_t offset = ptr - 1;
+#endif
+      if (!isVirtual)
+        {
+          return reinterpret_cast<const void *> (ptr);
+        }
+      const char *self = static_cast<const char *> (obj) + adj;
+      const char *vtable = *reinterpret_cast<const char * const *> (self);
+      return *reinterpret_cast<const void * const *> (vtable + offset);
+    }
+#endif /* __GNUC__ */
+  return 0;
+}
+
 } // namespace ns3
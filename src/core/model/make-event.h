@@ -264,6 +264,9 @@ EventImpl * MakeEvent (void (*f)(U1,U2,U3,U4,U5), T1 a1, T2 a2, T3 a3, T4 a4, T5
 #include "event-impl.h"
 #include "type-traits.h"
 
+#include <cstddef>
+#include <typeinfo>
+
 namespace ns3 {
 
 /**
@@ -302,6 +305,99 @@ struct EventMemberImplObjTraits<T *>
   }
 };
 
+/**
+ * \ingroup events
+ * \defgroup makeeventmemberobject MakeEventMemberObject
+ * Convert an object to the class of a class method pointer, which is
+ * the object the adjustment of an Itanium C++ ABI method pointer
+ * applies to, for MakeEventFunctionAddress().
+ *
+ * \tparam C The class of the method.
+ * \tparam R The return type of the method.
+ * \tparam O The type of the object.
+ * \param [in] obj The object the method is called on.
+ * \returns The address of the \p C part of \p obj.
+ */
+/** @{ */
+template <typename C, typename R, typename O>
+const void * MakeEventMemberObject (R (C::*)(), O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+template <typename C, typename R, typename O>
+const void * MakeEventMemberObject (R (C::*)() const, O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+template <typename C, typename R, typename T1, typename O>
+const void * MakeEventMemberObject (R (C::*)(T1), O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+template <typename C, typename R, typename T1, typename O>
+const void * MakeEventMemberObject (R (C::*)(T1) const, O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+template <typename C, typename R, typename T1, typename T2, typename O>
+const void * MakeEventMemberObject (R (C::*)(T1, T2), O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+template <typename C, typename R, typename T1, typename T2, typename O>
+const void * MakeEventMemberObject (R (C::*)(T1, T2) const, O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+template <typename C, typename R, typename T1, typename T2, typename T3, typename O>
+const void * MakeEventMemberObject (R (C::*)(T1, T2, T3), O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+template <typename C, typename R, typename T1, typename T2, typename T3, typename O>
+const void * MakeEventMemberObject (R (C::*)(T1, T2, T3) const, O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+template <typename C, typename R, typename T1, typename T2, typename T3, typename T4, typename O>
+const void * MakeEventMemberObject (R (C::*)(T1, T2, T3, T4), O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+template <typename C, typename R, typename T1, typename T2, typename T3, typename T4, typename O>
+const void * MakeEventMemberObject (R (C::*)(T1, T2, T3, T4) const, O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+template <typename C, typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename O>
+const void * MakeEventMemberObject (R (C::*)(T1, T2, T3, T4, T5), O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+template <typename C, typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename O>
+const void * MakeEventMemberObject (R (C::*)(T1, T2, T3, T4, T5) const, O &obj)
+{
+  return static_cast<const C *> (&obj);
+}
+/** @} */
+
+/**
+ * \ingroup events
+ * Get the address of the code called through a function pointer
+ * or a class method pointer, for EventImpl::GetSite().
+ *
+ * Virtual class methods are looked up in the virtual table of \p obj.
+ *
+ * \param [in] obj The object a class method is called on, converted
+ *            to the class of the method with MakeEventMemberObject(),
+ *            or 0 for a function pointer.
+ * \param [in] function The function or class method pointer.
+ * \param [in] size The size of the pointer at \p function.
+ * \returns The address of the function, or 0 if it is not known.
+ */
+const void * MakeEventFunctionAddress (const void *obj, const void *function,
+                                       std::size_t size);
+
 template <typename MEM, typename OBJ>
 EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
 {
@@ -314,6 +410,13 @@ public:
         m_function (function)
     {
     }
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = &typeid (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      site.function = MakeEventFunctionAddress (MakeEventMemberObject (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj)),
+                                                &m_function, sizeof (m_function));
+    }
     virtual ~EventMemberImpl0 ()
     {
     }
@@ -344,6 +447,13 @@ public:
     {
     }
 protected:
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = &typeid (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      site.function = MakeEventFunctionAddress (MakeEventMemberObject (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj)),
+                                                &m_function, sizeof (m_function));
+    }
     virtual ~EventMemberImpl1 ()
     {
     }
@@ -375,6 +485,13 @@ public:
     {
     }
 protected:
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = &typeid (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      site.function = MakeEventFunctionAddress (MakeEventMemberObject (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj)),
+                                                &m_function, sizeof (m_function));
+    }
     virtual ~EventMemberImpl2 ()
     {
     }
@@ -408,6 +525,13 @@ public:
     {
     }
 protected:
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = &typeid (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      site.function = MakeEventFunctionAddress (MakeEventMemberObject (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj)),
+                                                &m_function, sizeof (m_function));
+    }
     virtual ~EventMemberImpl3 ()
     {
     }
@@ -443,6 +567,13 @@ public:
     {
     }
 protected:
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = &typeid (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      site.function = MakeEventFunctionAddress (MakeEventMemberObject (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj)),
+                                                &m_function, sizeof (m_function));
+    }
     virtual ~EventMemberImpl4 ()
     {
     }
@@ -481,6 +612,13 @@ public:
     {
     }
 protected:
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = &typeid (EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+      site.function = MakeEventFunctionAddress (MakeEventMemberObject (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj)),
+                                                &m_function, sizeof (m_function));
+    }
     virtual ~EventMemberImpl5 ()
     {
     }
@@ -514,6 +652,12 @@ public:
         m_a1 (a1)
     {
     }
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = 0;
+      site.function = MakeEventFunctionAddress (0, &m_function, sizeof (m_function));
+    }
 protected:
     virtual ~EventFunctionImpl1 ()
     {
@@ -544,6 +688,12 @@ public:
         m_a2 (a2)
     {
     }
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = 0;
+      site.function = MakeEventFunctionAddress (0, &m_function, sizeof (m_function));
+    }
 protected:
     virtual ~EventFunctionImpl2 ()
     {
@@ -577,6 +727,12 @@ public:
         m_a3 (a3)
     {
     }
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = 0;
+      site.function = MakeEventFunctionAddress (0, &m_function, sizeof (m_function));
+    }
 protected:
     virtual ~EventFunctionImpl3 ()
     {
@@ -612,6 +768,12 @@ public:
         m_a4 (a4)
     {
     }
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = 0;
+      site.function = MakeEventFunctionAddress (0, &m_function, sizeof (m_function));
+    }
 protected:
     virtual ~EventFunctionImpl4 ()
     {
@@ -649,6 +811,12 @@ public:
         m_a5 (a5)
     {
     }
+    virtual void GetSite (Site &site) const
+    {
+      site.event = &typeid (*this);
+      site.object = 0;
+      site.function = MakeEventFunctionAddress (0, &m_function, sizeof (m_function));
+    }
 protected:
     virtual ~EventFunctionImpl5 ()
     {
@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+#include "memory-accounting.h"
+#include "assert.h"
+#include "log.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_STDLIB_H
+#include <cstdlib>
+#endif
+
+/**
+ * \file
+ * \ingroup object
+ * ns3::MemoryAccounting implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MemoryAccounting");
+
+namespace {
+
+/** The counters and their indexes. */
+struct Registry
+{
+  /** The counters, indexed by Id. */
+  std::vector<MemoryAccounting::Counter> counters;
+  /** The Id of each name. */
+  std::map<std::string, MemoryAccounting::Id> names;
+  /** The Id plus one of each TypeId uid, or 0 if not registered yet. */
+  std::vector<MemoryAccounting::Id> uids;
+};
+
+/**
+ * Get the registry.
+ *
+ * The registry is never deleted, so that the memory freed by the
+ * destructors of other static objects can still be accounted.
+ *
+ * \returns The registry.
+ */
+Registry *
+GetRegistry (void)
+{
+  static Registry *registry = new Registry ();
+  return registry;
+}
+
+/**
+ * Compare two counters by decreasing peak size.
+ * \param [in] a The first counter.
+ * \param [in] b The second counter.
+ * \returns \c true if \p a goes before \p b.
+ */
+bool
+ComparePeak (const MemoryAccounting::Counter &a, const MemoryAccounting::Counter &b)
+{
+  if (a.peakBytes != b.peakBytes)
+    {
+      return a.peakBytes > b.peakBytes;
+    }
+  return a.name < b.name;
+}
+
+} // anonymous namespace
+
+#ifdef HAVE_GETENV
+bool MemoryAccounting::m_enabled = getenv ("NS_MEMORY_ACCOUNTING") != 0;
+#else
+bool MemoryAccounting::m_enabled = false;
+#endif
+
+MemoryAccounting::Id
+MemoryAccounting::Register (std::string name)
+{
+  NS_LOG_FUNCTION (name);
+  Registry *registry = GetRegistry ();
+  std::map<std::string, Id>::const_iterator i = registry->names.find (name);
+  if (i != registry->names.end ())
+    {
+      return i->second;
+    }
+  Counter counter;
+  counter.name = name;
+  counter.bytes = 0;
+  counter.objects = 0;
+  counter.peakBytes = 0;
+  counter.peakObjects = 0;
+  counter.allocations = 0;
+  Id id = registry->counters.size ();
+  registry->counters.push_back (counter);
+  registry->names[name] = id;
+  return id;
+}
+
+MemoryAccounting::Id
+MemoryAccounting::Register (TypeId tid)
+{
+  NS_LOG_FUNCTION (tid);
+  Registry *registry = GetRegistry ();
+  uint16_t uid = tid.GetUid ();
+  if (uid >= registry->uids.size ())
+    {
+      registry->uids.resize (uid + 1, 0);
+    }
+  if (registry->uids[uid] == 0)
+    {
+      registry->uids[uid] = Register (tid.GetName ()) + 1;
+    }
+  Id id = registry->uids[uid] - 1;
+  return id;
+}
+
+void
+MemoryAccounting::Enable (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+  m_enabled = enable;
+}
+
+void
+MemoryAccounting::DoAllocate (Id id, uint64_t bytes)
+{
+  // No logging here: this is called for each packet.
+  Registry *registry = GetRegistry ();
+  NS_ASSERT (id < registry->counters.size ());
+  Counter &counter = registry->counters[id];
+  counter.bytes += bytes;
+  counter.objects++;
+  counter.allocations++;
+  counter.peakBytes = std::max (counter.peakBytes, counter.bytes);
+  counter.peakObjects = std::max (counter.peakObjects, counter.objects);
+}
+
+void
+MemoryAccounting::DoFree (Id id, uint64_t bytes)
+{
+  Registry *registry = GetRegistry ();
+  NS_ASSERT (id < registry->counters.size ());
+  Counter &counter = registry->counters[id];
+  counter.bytes -= std::min (counter.bytes, bytes);
+  if (counter.objects > 0)
+    {
+      counter.objects--;
+    }
+}
+
+MemoryAccounting::Counter
+MemoryAccounting::GetCounter (std::string name)
+{
+  NS_LOG_FUNCTION (name);
+  Registry *registry = GetRegistry ();
+  std::map<std::string, Id>::const_iterator i = registry->names.find (name);
+  if (i != registry->names.end ())
+    {
+      return registry->counters[i->second];
+    }
+  Counter counter;
+  counter.name = name;
+  counter.bytes = 0;
+  counter.objects = 0;
+  counter.peakBytes = 0;
+  counter.peakObjects = 0;
+  counter.allocations = 0;
+  return counter;
+}
+
+std::vector<MemoryAccounting::Counter>
+MemoryAccounting::GetCounters (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return GetRegistry ()->counters;
+}
+
+uint64_t
+MemoryAccounting::GetTotalBytes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Registry *registry = GetRegistry ();
+  uint64_t total = 0;
+  for (std::vector<Counter>::const_iterator i = registry->counters.begin ();
+       i != registry->counters.end (); ++i)
+    {
+      total += i->bytes;
+    }
+  return total;
+}
+
+void
+MemoryAccounting::Reset (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Registry *registry = GetRegistry ();
+  for (std::vector<Counter>::iterator i = registry->counters.begin ();
+       i != registry->counters.end (); ++i)
+    {
+      i->bytes = 0;
+      i->objects = 0;
+      i->peakBytes = 0;
+      i->peakObjects = 0;
+      i->allocations = 0;
+    }
+}
+
+void
+MemoryAccounting::Print (std::ostream &os)
+{
+  NS_LOG_FUNCTION (&os);
+  std::vector<Counter> counters;
+  uint64_t bytes = 0;
+  uint64_t objects = 0;
+  for (std::vector<Counter>::const_iterator i = GetRegistry ()->counters.begin ();
+       i != GetRegistry ()->counters.end (); ++i)
+    {
+      if (i->allocations != 0)
+        {
+          counters.push_back (*i);
+          bytes += i->bytes;
+          objects += i->objects;
+        }
+    }
+  std::sort (counters.begin (), counters.end (), &ComparePeak);
+
+  std::ios::fmtflags flags = os.flags ();
+  os << std::left << std::setw (40) << "Memory accounting" << std::right
+     << std::setw (14) << "bytes"
+     << std::setw (14) << "objects"
+     << std::setw (14) << "peak bytes"
+     << std::setw (14) << "peak objects"
+     << std::setw (14) << "allocations"
+     << std::endl;
+  for (std::vector<Counter>::const_iterator i = counters.begin (); i != counters.end (); ++i)
+    {
+      os << std::left << std::setw (40) << i->name << std::right
+         << std::setw (14) << i->bytes
+         << std::setw (14) << i->objects
+         << std::setw (14) << i->peakBytes
+         << std::setw (14) << i->peakObjects
+         << std::setw (14) << i->allocations
+         << std::endl;
+    }
+  os << std::left << std::setw (40) << "Total" << std::right
+     << std::setw (14) << bytes
+     << std::setw (14) << objects
+     << std::endl;
+  os.flags (flags);
+}
+
+} // namespace ns3
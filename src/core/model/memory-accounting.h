@@ -0,0 +1,219 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MEMORY_ACCOUNTING_H
+#define MEMORY_ACCOUNTING_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "type-id.h"
+
+/**
+ * \file
+ * \ingroup object
+ * ns3::MemoryAccounting declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup object
+ *
+ * \brief Opt-in accounting of the memory used by each subsystem.
+ *
+ * Each counter is identified by a name, and records the number of
+ * bytes and of objects currently allocated, their peak values, and
+ * the total number of allocations.  The code which owns some memory
+ * registers a counter once, and reports its allocations and frees:
+ *
+ * \code
+ *   static MemoryAccounting::Id id = MemoryAccounting::Register ("ns3::Buffer");
+ *   MemoryAccounting::Allocate (id, size);
+ *   ...
+ *   MemoryAccounting::Free (id, size);
+ * \endcode
+ *
+ * The following are accounted:
+ *   - every Object created by CreateObject() or ObjectFactory, in the
+ *     counter of its TypeId, with the size recorded by
+ *     NS_OBJECT_ENSURE_REGISTERED;
+ *   - the packets, and the buffers, metadata and byte tags they hold;
+ *   - the entries of the ARP and NDISC caches, and of the IPv4 static
+ *     routing tables.
+ *
+ * Accounting is disabled by default, and costs one test of a global
+ * flag per allocation.  It is enabled by Enable(), or by setting the
+ * \c NS_MEMORY_ACCOUNTING environment variable; only the memory
+ * allocated while it is enabled is counted, and the counters do not
+ * change while it is disabled.  When it is enabled, the counters are
+ * printed to std::clog by Simulator::Destroy().
+ *
+ * The counters are not protected against concurrent updates.
+ */
+class MemoryAccounting
+{
+public:
+  /** The identifier of a counter. */
+  typedef uint32_t Id;
+
+  /** The value of a counter. */
+  struct Counter
+  {
+    /** The counter name. */
+    std::string name;
+    /** Number of bytes allocated. */
+    uint64_t bytes;
+    /** Number of objects allocated. */
+    uint64_t objects;
+    /** Largest number of bytes allocated. */
+    uint64_t peakBytes;
+    /** Largest number of objects allocated. */
+    uint64_t peakObjects;
+    /** Total number of allocations. */
+    uint64_t allocations;
+  };
+
+  /**
+   * Get the counter of a name, creating it if needed.
+   *
+   * \param [in] name The counter name.
+   * \returns The counter identifier.
+   */
+  static Id Register (std::string name);
+  /**
+   * Get the counter of the objects of a TypeId, creating it if needed.
+   *
+   * \param [in] tid The TypeId.
+   * \returns The identifier of the counter named after \p tid.
+   */
+  static Id Register (TypeId tid);
+
+  /**
+   * Enable or disable the accounting.
+   *
+   * \param [in] enable \c true to start counting, \c false to stop.
+   */
+  static void Enable (bool enable);
+  /**
+   * Check whether the accounting is enabled.
+   * \returns \c true if the allocations are counted.
+   */
+  static bool IsEnabled (void);
+
+  /**
+   * Count an allocation.
+   *
+   * \param [in] id The counter.
+   * \param [in] bytes The size of the allocation.
+   */
+  static void Allocate (Id id, uint64_t bytes);
+  /**
+   * Count a free.
+   *
+   * Frees of memory allocated before the accounting was enabled are
+   * ignored once the counter drops to zero.
+   *
+   * \param [in] id The counter.
+   * \param [in] bytes The size of the allocation freed.
+   */
+  static void Free (Id id, uint64_t bytes);
+
+  /**
+   * Get the value of a counter.
+   *
+   * \param [in] name The counter name.
+   * \returns The counter value, all zeroes if no such counter exists.
+   */
+  static Counter GetCounter (std::string name);
+  /**
+   * Get the value of all the counters.
+   * \returns The counters, in registration order.
+   */
+  static std::vector<Counter> GetCounters (void);
+  /**
+   * Get the number of bytes allocated in all the counters.
+   * \returns The sum of the bytes of all the counters.
+   */
+  static uint64_t GetTotalBytes (void);
+  /** Set all the counters to zero. */
+  static void Reset (void);
+  /**
+   * Print the counters which recorded an allocation, as a table
+   * sorted by decreasing peak size.
+   *
+   * \param [in,out] os The output stream.
+   */
+  static void Print (std::ostream &os);
+
+private:
+  /**
+   * Count an allocation, when the accounting is enabled.
+   *
+   * \param [in] id The counter.
+   * \param [in] bytes The size of the allocation.
+   */
+  static void DoAllocate (Id id, uint64_t bytes);
+  /**
+   * Count a free, when the accounting is enabled.
+   *
+   * \param [in] id The counter.
+   * \param [in] bytes The size of the allocation freed.
+   */
+  static void DoFree (Id id, uint64_t bytes);
+
+  /** Whether the accounting is enabled. */
+  static bool m_enabled;
+};
+
+} // namespace ns3
+
+
+/***************************************************************
+ *  Implementation of the inline functions declared above.
+ ***************************************************************/
+
+namespace ns3 {
+
+inline bool
+MemoryAccounting::IsEnabled (void)
+{
+  return m_enabled;
+}
+
+inline void
+MemoryAccounting::Allocate (Id id, uint64_t bytes)
+{
+  if (m_enabled)
+    {
+      DoAllocate (id, bytes);
+    }
+}
+
+inline void
+MemoryAccounting::Free (Id id, uint64_t bytes)
+{
+  if (m_enabled)
+    {
+      DoFree (id, bytes);
+    }
+}
+
+} // namespace ns3
+
+#endif /* MEMORY_ACCOUNTING_H */
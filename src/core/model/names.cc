@@ -16,13 +16,18 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <map>
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <vector>
 #include "object.h"
 #include "log.h"
 #include "assert.h"
 #include "abort.h"
 #include "names.h"
 #include "singleton.h"
+#include "config.h"
+#include "hash.h"
 
 /**
  * \file
@@ -38,6 +43,10 @@ NS_LOG_COMPONENT_DEFINE ("Names");
 /**
  * \ingroup config
  *  Node in the naming tree.
+ *
+ * The nodes are not linked to their children: they are found with
+ * the hash tables of NamesPriv, through which every NameNode is
+ * chained by its parent and name, and by its object.
  */
 class NameNode
 {
@@ -55,9 +64,10 @@ public:
    *
    * \param [in] parent The parent NameNode.
    * \param [in] name The name of this NameNode
+   * \param [in] hash The hash of \p name.
    * \param [in] object The object corresponding to this NameNode.
    */
-  NameNode (NameNode *parent, std::string name, Ptr<Object> object);
+  NameNode (NameNode *parent, std::string name, uint32_t hash, Ptr<Object> object);
   /**
    * Assignment operator.
    *
@@ -73,15 +83,30 @@ public:
   NameNode *m_parent;
   /** The name of this NameNode. */
   std::string m_name;
+  /** The hash of m_name. */
+  uint32_t m_hash;
   /** The object corresponding to this NameNode. */
   Ptr<Object> m_object;
 
-  /** Children of this NameNode. */
-  std::map<std::string, NameNode *> m_nameMap;
+  /** Next NameNode in the same bucket of the index by name. */
+  NameNode *m_nextByName;
+  /** Next NameNode in the same bucket of the index by object. */
+  NameNode *m_nextByObject;
+
+  /** The full path of this NameNode, built by NamesPriv::GetPath(). */
+  std::string m_path;
+  /** The NamesPriv generation m_path was built in. */
+  uint32_t m_pathGeneration;
 };
 
 NameNode::NameNode ()
-  : m_parent (0), m_name (""), m_object (0)
+  : m_parent (0),
+    m_name (""),
+    m_hash (0),
+    m_object (0),
+    m_nextByName (0),
+    m_nextByObject (0),
+    m_pathGeneration (0)
 {
 }
 
@@ -89,8 +114,12 @@ NameNode::NameNode (const NameNode &nameNode)
 {
   m_parent = nameNode.m_parent;
   m_name = nameNode.m_name;
+  m_hash = nameNode.m_hash;
   m_object = nameNode.m_object;
-  m_nameMap = nameNode.m_nameMap;
+  m_nextByName = nameNode.m_nextByName;
+  m_nextByObject = nameNode.m_nextByObject;
+  m_path = nameNode.m_path;
+  m_pathGeneration = nameNode.m_pathGeneration;
 }
 
 NameNode &
@@ -98,13 +127,23 @@ NameNode::operator = (const NameNode &rhs)
 {
   m_parent = rhs.m_parent;
   m_name = rhs.m_name;
+  m_hash = rhs.m_hash;
   m_object = rhs.m_object;
-  m_nameMap = rhs.m_nameMap;
+  m_nextByName = rhs.m_nextByName;
+  m_nextByObject = rhs.m_nextByObject;
+  m_path = rhs.m_path;
+  m_pathGeneration = rhs.m_pathGeneration;
   return *this;
 }
 
-NameNode::NameNode (NameNode *parent, std::string name, Ptr<Object> object)
-  : m_parent (parent), m_name (name), m_object (object)
+NameNode::NameNode (NameNode *parent, std::string name, uint32_t hash, Ptr<Object> object)
+  : m_parent (parent),
+    m_name (name),
+    m_hash (hash),
+    m_object (object),
+    m_nextByName (0),
+    m_nextByObject (0),
+    m_pathGeneration (0)
 {
   NS_LOG_FUNCTION (this << parent << name << object);
 }
@@ -117,6 +156,12 @@ NameNode::~NameNode ()
 /**
  * \ingroup config
  * The singleton root Names object.
+ *
+ * The names are indexed by two chained hash tables: one by parent
+ * NameNode and name, which resolves each segment of a path, and one
+ * by object, for the reverse lookups.  Both tables grow with the
+ * number of names, so that the lookups take constant time with many
+ * thousands of named objects.
  */
 class NamesPriv : public Singleton<NamesPriv>
 {
@@ -141,6 +186,12 @@ public:
    * \return \c true if the object was named successfully.
    */
   bool Add (Ptr<Object> context, std::string name, Ptr<Object> object);
+  /**
+   * \copydoc Names::Add(std::string,const std::vector<Ptr<Object> >&)
+   * \return \c true if all the objects were named successfully, \c false
+   *         with none of them named otherwise.
+   */
+  bool Add (std::string prefix, const std::vector<Ptr<Object> > &objects);
 
   /**
    * \copydoc Names::Rename(std::string,std::string)
@@ -192,20 +243,96 @@ private:
    */
   bool IsDuplicateName (NameNode *node, std::string name);
 
+  /**
+   * Find a child of a NameNode.
+   *
+   * \param [in] node The parent NameNode.
+   * \param [in] name The name of the child, which need not be
+   *             null-terminated.
+   * \param [in] size The length of \p name.
+   * \returns The child NameNode, or 0 if there is none.
+   */
+  NameNode *FindChild (NameNode *node, const char *name, std::size_t size);
+  /**
+   * Hash a name.
+   *
+   * \param [in] name The name.
+   * \param [in] size The length of \p name.
+   * \returns The hash of the name.
+   */
+  uint32_t Hash (const char *name, std::size_t size);
+  /**
+   * Get the bucket of the index by name of a child.
+   *
+   * \param [in] parent The parent NameNode.
+   * \param [in] hash The hash of the name of the child.
+   * \returns The index of the bucket in m_byName.
+   */
+  uint32_t GetNameBucket (const NameNode *parent, uint32_t hash) const;
+  /**
+   * Get the bucket of the index by object of an object.
+   *
+   * \param [in] object The object.
+   * \returns The index of the bucket in m_byObject.
+   */
+  uint32_t GetObjectBucket (const Object *object) const;
+  /**
+   * Add a new NameNode to both indexes.
+   *
+   * \param [in] parent The parent NameNode.
+   * \param [in] name The name of the object.
+   * \param [in] hash The hash of \p name.
+   * \param [in] object The object to name.
+   */
+  void Insert (NameNode *parent, const std::string &name, uint32_t hash, Ptr<Object> object);
+  /**
+   * Remove a NameNode from the index by name.
+   *
+   * \param [in] node The NameNode to remove.
+   */
+  void UnlinkName (NameNode *node);
+  /**
+   * Make sure the indexes can hold a number of names without
+   * growing.
+   *
+   * \param [in] n The number of names.
+   */
+  void Reserve (uint32_t n);
+  /**
+   * Get the full path of a NameNode, rebuilding it if a rename may
+   * have changed it.
+   *
+   * \param [in] node The NameNode.
+   * \returns The full path of \p node.
+   */
+  const std::string &GetPath (NameNode *node);
+
   /** The root NameNode. */
   NameNode m_root;
 
-  /** Map from object pointers to their NameNodes. */
-  std::map<Ptr<Object>, NameNode *> m_objectMap;
+  /** Buckets of NameNodes, chained by m_nextByName. */
+  std::vector<NameNode *> m_byName;
+  /** Buckets of NameNodes, chained by m_nextByObject. */
+  std::vector<NameNode *> m_byObject;
+  /** The number of NameNodes, excluding m_root. */
+  uint32_t m_size;
+  /** Incremented by each rename, to invalidate the paths of the NameNodes. */
+  uint32_t m_generation;
+  /** The name hasher. */
+  Hasher m_hasher;
 };
 
 NamesPriv::NamesPriv ()
+  : m_size (0),
+    m_generation (1)
 {
   NS_LOG_FUNCTION (this);
 
   m_root.m_parent = 0;
   m_root.m_name = "Names";
   m_root.m_object = 0;
+  m_root.m_path = "/Names";
+  Reserve (0);
 }
 
 NamesPriv::~NamesPriv ()
@@ -220,21 +347,142 @@ NamesPriv::Clear (void)
 {
   NS_LOG_FUNCTION (this);
   //
-  // Every name is associated with an object in the object map, so freeing the
-  // NameNodes in this map will free all of the memory allocated for the NameNodes
+  // Every name is associated with an object in the object index, so freeing
+  // the NameNodes in this index will free all of the memory allocated for
+  // the NameNodes
   //
-  for (std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
+  for (std::vector<NameNode *>::iterator i = m_byObject.begin (); i != m_byObject.end (); ++i)
     {
-      delete i->second;
-      i->second = 0;
+      NameNode *node = *i;
+      while (node != 0)
+        {
+          NameNode *next = node->m_nextByObject;
+          delete node;
+          node = next;
+        }
+      *i = 0;
     }
-
-  m_objectMap.clear ();
+  std::fill (m_byName.begin (), m_byName.end (), (NameNode *)0);
+  m_size = 0;
 
   m_root.m_parent = 0;
   m_root.m_name = "Names";
   m_root.m_object = 0;
-  m_root.m_nameMap.clear ();
+}
+
+uint32_t
+NamesPriv::Hash (const char *name, std::size_t size)
+{
+  return m_hasher.clear ().GetHash32 (name, size);
+}
+
+uint32_t
+NamesPriv::GetNameBucket (const NameNode *parent, uint32_t hash) const
+{
+  // Spread the parent address, whose low bits are all zero
+  uint32_t mix = static_cast<uint32_t> (reinterpret_cast<uintptr_t> (parent) >> 4) * 2654435761U;
+  return (hash ^ mix) & (m_byName.size () - 1);
+}
+
+uint32_t
+NamesPriv::GetObjectBucket (const Object *object) const
+{
+  uint32_t mix = static_cast<uint32_t> (reinterpret_cast<uintptr_t> (object) >> 4) * 2654435761U;
+  return (mix >> 7) & (m_byObject.size () - 1);
+}
+
+void
+NamesPriv::Reserve (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  uint32_t buckets = 64;
+  while (buckets < n)
+    {
+      buckets *= 2;
+    }
+  if (buckets <= m_byObject.size ())
+    {
+      return;
+    }
+  NS_LOG_LOGIC ("Rehashing " << m_size << " names in " << buckets << " buckets");
+
+  // Collect the nodes before resizing the buckets
+  std::vector<NameNode *> nodes;
+  nodes.reserve (m_size);
+  for (std::vector<NameNode *>::const_iterator i = m_byObject.begin (); i != m_byObject.end (); ++i)
+    {
+      for (NameNode *node = *i; node != 0; node = node->m_nextByObject)
+        {
+          nodes.push_back (node);
+        }
+    }
+  m_byName.assign (buckets, 0);
+  m_byObject.assign (buckets, 0);
+  for (std::vector<NameNode *>::const_iterator i = nodes.begin (); i != nodes.end (); ++i)
+    {
+      NameNode *node = *i;
+      uint32_t bucket = GetNameBucket (node->m_parent, node->m_hash);
+      node->m_nextByName = m_byName[bucket];
+      m_byName[bucket] = node;
+      bucket = GetObjectBucket (PeekPointer (node->m_object));
+      node->m_nextByObject = m_byObject[bucket];
+      m_byObject[bucket] = node;
+    }
+}
+
+void
+NamesPriv::Insert (NameNode *parent, const std::string &name, uint32_t hash, Ptr<Object> object)
+{
+  NS_LOG_FUNCTION (this << parent << name << object);
+  Reserve (m_size + 1);
+  NameNode *node = new NameNode (parent, name, hash, object);
+  uint32_t bucket = GetNameBucket (parent, hash);
+  node->m_nextByName = m_byName[bucket];
+  m_byName[bucket] = node;
+  bucket = GetObjectBucket (PeekPointer (object));
+  node->m_nextByObject = m_byObject[bucket];
+  m_byObject[bucket] = node;
+  m_size++;
+}
+
+void
+NamesPriv::UnlinkName (NameNode *node)
+{
+  NS_LOG_FUNCTION (this << node);
+  NameNode **link = &m_byName[GetNameBucket (node->m_parent, node->m_hash)];
+  while (*link != node)
+    {
+      NS_ASSERT_MSG (*link != 0, "NamesPriv::UnlinkName(): Internal error: node not indexed");
+      link = &(*link)->m_nextByName;
+    }
+  *link = node->m_nextByName;
+  node->m_nextByName = 0;
+}
+
+NameNode *
+NamesPriv::FindChild (NameNode *node, const char *name, std::size_t size)
+{
+  uint32_t hash = Hash (name, size);
+  for (NameNode *child = m_byName[GetNameBucket (node, hash)]; child != 0; child = child->m_nextByName)
+    {
+      if (child->m_parent == node && child->m_hash == hash
+          && child->m_name.compare (0, std::string::npos, name, size) == 0)
+        {
+          return child;
+        }
+    }
+  return 0;
+}
+
+const std::string &
+NamesPriv::GetPath (NameNode *node)
+{
+  if (node != &m_root && node->m_pathGeneration != m_generation)
+    {
+      node->m_path = GetPath (node->m_parent) + "/" + node->m_name;
+      node->m_pathGeneration = m_generation;
+    }
+  return node->m_path;
 }
 
 bool
@@ -338,10 +586,72 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
       return false;
     }
 
-  NameNode *newNode = new NameNode (node, name, object);
-  node->m_nameMap[name] = newNode;
-  m_objectMap[object] = newNode;
+  Insert (node, name, Hash (name.data (), name.size ()), object);
+  return true;
+}
+
+bool
+NamesPriv::Add (std::string prefix, const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (this << prefix << objects.size ());
+  //
+  // Split the prefix like Add (name, object) does, then resolve the path
+  // once for all the objects.
+  //
+  if (prefix.find ("/Names") != 0)
+    {
+      if (prefix.find ("/") == 0)
+        {
+          NS_ASSERT_MSG (false, "NamesPriv::Add(): Prefix begins with '/' but not \"/Names\"");
+          return false;
+        }
+      prefix = "/Names/" + prefix;
+    }
+  std::string::size_type i = prefix.rfind ("/");
+  NS_ASSERT_MSG (i != 0, "NamesPriv::Add(): Can't find a name in the prefix string");
+  std::string path = prefix.substr (0, i);
+  std::string base = prefix.substr (i + 1);
+
+  NameNode *node = &m_root;
+  if (path != "/Names")
+    {
+      node = IsNamed (Find (path));
+      if (node == 0)
+        {
+          NS_ASSERT_MSG (false, "NamesPriv::Add(): path must point to a previously named node");
+          return false;
+        }
+    }
+
+  //
+  // Check all the objects and the names first, so that either all the
+  // objects are named or none is.
+  //
+  std::vector<std::string> names;
+  names.reserve (objects.size ());
+  std::set<Object *> seen;
+  for (uint32_t j = 0; j < objects.size (); j++)
+    {
+      std::ostringstream oss;
+      oss << base << j;
+      names.push_back (oss.str ());
+      if (IsNamed (objects[j]) || !seen.insert (PeekPointer (objects[j])).second)
+        {
+          NS_LOG_LOGIC ("Object " << j << " is already named");
+          return false;
+        }
+      if (IsDuplicateName (node, names[j]))
+        {
+          NS_LOG_LOGIC ("Name " << names[j] << " is already taken");
+          return false;
+        }
+    }
 
+  Reserve (m_size + objects.size ());
+  for (uint32_t j = 0; j < objects.size (); j++)
+    {
+      Insert (node, names[j], Hash (names[j].data (), names[j].size ()), objects[j]);
+    }
   return true;
 }
 
@@ -442,27 +752,30 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       return false;
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (oldname);
-  if (i == node->m_nameMap.end ())
+  NameNode *changeNode = FindChild (node, oldname.data (), oldname.size ());
+  if (changeNode == 0)
     {
-      NS_LOG_LOGIC ("Old name does not exist in name map");
+      NS_LOG_LOGIC ("Old name does not exist in name index");
       return false;
     }
   else
     {
-      NS_LOG_LOGIC ("Old name exists in name map");
+      NS_LOG_LOGIC ("Old name exists in name index");
 
       //
       // The rename process consists of:
-      // 1.  Geting the pointer to the name node from the map and remembering it;
-      // 2.  Removing the map entry corresponding to oldname from the map;
-      // 3.  Changing the name string in the name node;
-      // 4.  Adding the name node back in the map under the newname.
+      // 1.  Removing the name node from the index by name;
+      // 2.  Changing the name string in the name node;
+      // 3.  Adding the name node back in the index under the newname;
+      // 4.  Invalidating the paths of the name node and its descendants.
       //
-      NameNode *changeNode = i->second;
-      node->m_nameMap.erase (i);
+      UnlinkName (changeNode);
       changeNode->m_name = newname;
-      node->m_nameMap[newname] = changeNode;
+      changeNode->m_hash = Hash (newname.data (), newname.size ());
+      uint32_t bucket = GetNameBucket (node, changeNode->m_hash);
+      changeNode->m_nextByName = m_byName[bucket];
+      m_byName[bucket] = changeNode;
+      m_generation++;
       return true;
     }
 }
@@ -472,16 +785,16 @@ NamesPriv::FindName (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *node = IsNamed (object);
+  if (node == 0)
     {
-      NS_LOG_LOGIC ("Object does not exist in object map");
+      NS_LOG_LOGIC ("Object does not exist in object index");
       return "";
     }
   else
     {
-      NS_LOG_LOGIC ("Object exists in object map");
-      return i->second->m_name;
+      NS_LOG_LOGIC ("Object exists in object index");
+      return node->m_name;
     }
 }
 
@@ -490,26 +803,18 @@ NamesPriv::FindPath (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *node = IsNamed (object);
+  if (node == 0)
     {
-      NS_LOG_LOGIC ("Object does not exist in object map");
+      NS_LOG_LOGIC ("Object does not exist in object index");
       return "";
     }
 
-  NameNode *p = i->second;
-  NS_ASSERT_MSG (p, "NamesPriv::FindFullName(): Internal error: Invalid NameNode pointer from map");
-
-  std::string path;
-
-  do
-    {
-      path = "/" + p->m_name + path;
-      NS_LOG_LOGIC ("path is " << path);
-    }
-  while ((p = p->m_parent) != 0);
-
-  return path;
+  //
+  // The path of each node is built once from the path of its parent, and
+  // kept until a node is renamed.
+  //
+  return GetPath (node);
 }
 
 
@@ -554,57 +859,36 @@ NamesPriv::Find (std::string path)
   // the /Names name space and we have eaten the leading slash. e.g., 
   // remaining = "ClientNode/eth0"
   //
-  // The start of the search is always at the root of the name space.
+  // The start of the search is always at the root of the name space.  Each
+  // segment is looked up in place, without copying it.
   //
+  std::string::size_type start = 0;
   for (;;)
     {
-      NS_LOG_LOGIC ("Looking for the object of name " << remaining);
-      offset = remaining.find ("/");
-      if (offset == std::string::npos)
+      offset = remaining.find ('/', start);
+      std::string::size_type end = offset == std::string::npos ? remaining.size () : offset;
+      node = FindChild (node, remaining.data () + start, end - start);
+      if (node == 0)
         {
-          //
-          // There are no remaining slashes so this is the last segment of the 
-          // specified name.  We're done when we find it
-          //
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (remaining);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              NS_LOG_LOGIC ("Name parsed, found object");
-              return i->second->m_object;
-            }
+          NS_LOG_LOGIC ("Name does not exist in name index");
+          return 0;
         }
-      else
+      if (offset == std::string::npos)
         {
           //
-          // There are more slashes so this is an intermediate segment of the 
-          // specified name.  We need to "recurse" when we find this segment.
+          // There are no remaining slashes so this was the last segment of the 
+          // specified name.
           //
-          offset = remaining.find ("/");
-          std::string segment = remaining.substr (0, offset);
-
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (segment);
-          if (i == node->m_nameMap.end ())
-            {
-              NS_LOG_LOGIC ("Name does not exist in name map");
-              return 0;
-            }
-          else
-            {
-              node = i->second;
-              remaining = remaining.substr (offset + 1);
-              NS_LOG_LOGIC ("Intermediate segment parsed");
-              continue;
-            }
+          NS_LOG_LOGIC ("Name parsed, found object");
+          return node->m_object;
         }
+      //
+      // There are more slashes so this is an intermediate segment of the 
+      // specified name.
+      //
+      NS_LOG_LOGIC ("Intermediate segment parsed");
+      start = offset + 1;
     }
-
-  NS_ASSERT_MSG (node, "NamesPriv::Find(): Internal error:  this can't happen");
-  return 0;
 }
 
 Ptr<Object>
@@ -641,16 +925,16 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
         }
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
-  if (i == node->m_nameMap.end ())
+  NameNode *child = FindChild (node, name.data (), name.size ());
+  if (child == 0)
     {
-      NS_LOG_LOGIC ("Name does not exist in name map");
+      NS_LOG_LOGIC ("Name does not exist in name index");
       return 0;
     }
   else
     {
-      NS_LOG_LOGIC ("Name exists in name map");
-      return i->second->m_object;
+      NS_LOG_LOGIC ("Name exists in name index");
+      return child->m_object;
     }
 }
 
@@ -659,17 +943,17 @@ NamesPriv::IsNamed (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
-    {
-      NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
-      return 0;
-    }
-  else
+  for (NameNode *node = m_byObject[GetObjectBucket (PeekPointer (object))];
+       node != 0; node = node->m_nextByObject)
     {
-      NS_LOG_LOGIC ("Object exists in object map, returning NameNode " << &i->second);
-      return i->second;
+      if (node->m_object == object)
+        {
+          NS_LOG_LOGIC ("Object exists in object index, returning NameNode " << node);
+          return node;
+        }
     }
+  NS_LOG_LOGIC ("Object does not exist in object index, returning NameNode 0");
+  return 0;
 }
 
 bool
@@ -677,15 +961,14 @@ NamesPriv::IsDuplicateName (NameNode *node, std::string name)
 {
   NS_LOG_FUNCTION (this << node << name);
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
-  if (i == node->m_nameMap.end ())
+  if (FindChild (node, name.data (), name.size ()) == 0)
     {
-      NS_LOG_LOGIC ("Name does not exist in name map");
+      NS_LOG_LOGIC ("Name does not exist in name index");
       return false;
     }
   else
     {
-      NS_LOG_LOGIC ("Name exists in name map");
+      NS_LOG_LOGIC ("Name exists in name index");
       return true;
     }
 }
@@ -696,6 +979,16 @@ Names::Add (std::string name, Ptr<Object> object)
   NS_LOG_FUNCTION (name << object);
   bool result = NamesPriv::Get ()->Add (name, object);
   NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding name " << name);
+  Config::InvalidateCompiledPaths ();
+}
+
+void
+Names::Add (std::string prefix, const std::vector<Ptr<Object> > &objects)
+{
+  NS_LOG_FUNCTION (prefix << objects.size ());
+  bool result = NamesPriv::Get ()->Add (prefix, objects);
+  NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding names with prefix " << prefix);
+  Config::InvalidateCompiledPaths ();
 }
 
 void
@@ -704,6 +997,7 @@ Names::Rename (std::string oldpath, std::string newname)
   NS_LOG_FUNCTION (oldpath << newname);
   bool result = NamesPriv::Get ()->Rename (oldpath, newname);
   NS_ABORT_MSG_UNLESS (result, "Names::Rename(): Error renaming " << oldpath << " to " << newname);
+  Config::InvalidateCompiledPaths ();
 }
 
 void
@@ -712,6 +1006,7 @@ Names::Add (std::string path, std::string name, Ptr<Object> object)
   NS_LOG_FUNCTION (path << name << object);
   bool result = NamesPriv::Get ()->Add (path, name, object);
   NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding " << path << " " << name);
+  Config::InvalidateCompiledPaths ();
 }
 
 void
@@ -720,6 +1015,7 @@ Names::Rename (std::string path, std::string oldname, std::string newname)
   NS_LOG_FUNCTION (path << oldname << newname);
   bool result = NamesPriv::Get ()->Rename (path, oldname, newname);
   NS_ABORT_MSG_UNLESS (result, "Names::Rename (): Error renaming " << path << " " << oldname << " to " << newname);
+  Config::InvalidateCompiledPaths ();
 }
 
 void
@@ -728,6 +1024,7 @@ Names::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
   NS_LOG_FUNCTION (context << name << object);
   bool result = NamesPriv::Get ()->Add (context, name, object);
   NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding name " << name << " under context " << &context);
+  Config::InvalidateCompiledPaths ();
 }
 
 void
@@ -737,6 +1034,7 @@ Names::Rename (Ptr<Object> context, std::string oldname, std::string newname)
   bool result = NamesPriv::Get ()->Rename (context, oldname, newname);
   NS_ABORT_MSG_UNLESS (result, "Names::Rename (): Error renaming " << oldname << " to " << newname << " under context " <<
                        &context);
+  Config::InvalidateCompiledPaths ();
 }
 
 std::string
@@ -757,7 +1055,8 @@ void
 Names::Clear (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  return NamesPriv::Get ()->Clear ();
+  NamesPriv::Get ()->Clear ();
+  Config::InvalidateCompiledPaths ();
 }
 
 Ptr<Object>
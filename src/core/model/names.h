@@ -19,6 +19,8 @@
 #ifndef OBJECT_NAMES_H
 #define OBJECT_NAMES_H
 
+#include <string>
+#include <vector>
 #include "ptr.h"
 #include "object.h"
 
@@ -171,6 +173,45 @@ public:
    */
   static void Add (Ptr<Object> context, std::string name, Ptr<Object> object);
 
+  /**
+   * \brief Name many objects at once.
+   *
+   * Each object is named after the prefix followed by its index in
+   * \p objects, starting at zero: Names::Add ("client", objects)
+   * names the objects "client0", "client1", and so on.  The prefix
+   * may contain a path, as in Names::Add ("/Names/server/eth",
+   * devices), which names the devices "eth0", "eth1", ... under the
+   * object named "/Names/server".
+   *
+   * This is equivalent to calling Names::Add (std::string,Ptr<Object>)
+   * for each object, but the path is only resolved once, and the
+   * compiled Config paths are only invalidated once.
+   *
+   * \param [in] prefix The path and the prefix of the names.
+   * \param [in] objects The objects to name.
+   */
+  static void Add (std::string prefix, const std::vector<Ptr<Object> > &objects);
+
+  /**
+   * \brief Name all the objects of a container at once.
+   *
+   * For example, to name the nodes of a NodeContainer "vehicle0",
+   * "vehicle1", and so on:
+   * \code
+   *   Names::Add ("vehicle", nodes.Begin (), nodes.End ());
+   * \endcode
+   *
+   * \see Names::Add (std::string,const std::vector<Ptr<Object> >&)
+   *
+   * \tparam ITERATOR \deduced An iterator over smart pointers
+   *          to objects.
+   * \param [in] prefix The path and the prefix of the names.
+   * \param [in] begin The first object to name.
+   * \param [in] end Past the last object to name.
+   */
+  template <typename ITERATOR>
+  static void Add (std::string prefix, ITERATOR begin, ITERATOR end);
+
   /**
    * \brief Rename a previously associated name.
    *
@@ -450,6 +491,19 @@ private:
 };
 
   
+template <typename ITERATOR>
+/* static */
+void
+Names::Add (std::string prefix, ITERATOR begin, ITERATOR end)
+{
+  std::vector<Ptr<Object> > objects;
+  for (ITERATOR i = begin; i != end; ++i)
+    {
+      objects.push_back (*i);
+    }
+  Add (prefix, objects);
+}
+
 template <typename T>
 /* static */
 Ptr<T> 
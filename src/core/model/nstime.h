@@ -441,6 +441,19 @@ public:
   }
   inline static Time FromDouble (double value, enum Unit unit)
   {
+    struct Information *info = PeekInformation (unit);
+    // Fast path: an integral value in a unit no finer than the
+    // current resolution converts exactly with an integer product.
+    if (info->fromMul
+        && value >= -info->fromIntegerLimit
+        && value <= info->fromIntegerLimit)
+      {
+        int64_t v = static_cast<int64_t> (value);
+        if (v == value)
+          {
+            return Time (v * info->factor);
+          }
+      }
     return From (int64x64_t (value), unit);
   }
   inline static Time From (const int64x64_t & value, enum Unit unit)
@@ -490,6 +503,15 @@ public:
   }
   inline double ToDouble (enum Unit unit) const
   {
+    struct Information *info = PeekInformation (unit);
+    // Fast path: converting to a unit no coarser than the current
+    // resolution is an exact integer product, as long as it fits.
+    if (info->toMul
+        && m_data >= -info->toIntegerLimit
+        && m_data <= info->toIntegerLimit)
+      {
+        return static_cast<double> (m_data * info->factor);
+      }
     return To (unit).GetDouble ();
   }
   inline int64x64_t To (enum Unit unit) const
@@ -538,6 +560,8 @@ private:
     bool toMul;                     //!< Multiply when converting To, otherwise divide
     bool fromMul;                   //!< Multiple when converting From, otherwise divide
     int64_t factor;                 //!< Ratio of this unit / current unit
+    int64_t toIntegerLimit;         //!< Largest magnitude converted To this unit with integer arithmetic
+    double fromIntegerLimit;        //!< Largest magnitude converted From this unit with integer arithmetic
     int64x64_t timeTo;              //!< Multiplier to convert to this unit
     int64x64_t timeFrom;            //!< Multiplier to convert from this unit
   };
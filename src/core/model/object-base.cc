@@ -21,6 +21,7 @@
 #include "log.h"
 #include "trace-source-accessor.h"
 #include "attribute-construction-list.h"
+#include "attribute-bundle.h"
 #include "string.h"
 #include "ns3/core-config.h"
 #ifdef HAVE_STDLIB_H
@@ -172,6 +173,14 @@ ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
   NotifyConstructionCompleted ();
 }
 
+void
+ObjectBase::ConstructSelf (const AttributeBundle &attributes)
+{
+  NS_LOG_FUNCTION (this << &attributes);
+  attributes.Apply (this);
+  NotifyConstructionCompleted ();
+}
+
 bool
 ObjectBase::DoSet (Ptr<const AttributeAccessor> accessor, 
                    Ptr<const AttributeChecker> checker,
@@ -54,6 +54,7 @@
 namespace ns3 {
 
 class AttributeConstructionList;
+class AttributeBundle;
 
 /**
  * \ingroup object
@@ -213,6 +214,17 @@ protected:
    *        the member variables of this object's instance.
    */
   void ConstructSelf (const AttributeConstructionList &attributes);
+  /**
+   * Complete construction of ObjectBase from the values of all its
+   * attributes.
+   *
+   * This is the fast path of ConstructSelf(const AttributeConstructionList &),
+   * used by ObjectFactory::Create().
+   *
+   * \param [in] attributes The values of all the attributes set at
+   *        construction, as resolved by ObjectFactory.
+   */
+  void ConstructSelf (const AttributeBundle &attributes);
 
 private:
   /**
@@ -32,11 +32,15 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE("ObjectFactory");
 
 ObjectFactory::ObjectFactory ()
+  : m_bundleGeneration (0),
+    m_created (false)
 {
   NS_LOG_FUNCTION (this);
 }
 
 ObjectFactory::ObjectFactory (std::string typeId)
+  : m_bundleGeneration (0),
+    m_created (false)
 {
   NS_LOG_FUNCTION (this << typeId);
   SetTypeId (typeId);
@@ -47,18 +51,24 @@ ObjectFactory::SetTypeId (TypeId tid)
 {
   NS_LOG_FUNCTION (this << tid.GetName ());
   m_tid = tid;
+  m_bundleGeneration = 0;
+  m_created = false;
 }
 void
 ObjectFactory::SetTypeId (std::string tid)
 {
   NS_LOG_FUNCTION (this << tid);
   m_tid = TypeId::LookupByName (tid);
+  m_bundleGeneration = 0;
+  m_created = false;
 }
 void
 ObjectFactory::SetTypeId (const char *tid)
 {
   NS_LOG_FUNCTION (this << tid);
   m_tid = TypeId::LookupByName (tid);
+  m_bundleGeneration = 0;
+  m_created = false;
 }
 void
 ObjectFactory::Set (std::string name, const AttributeValue &value)
@@ -82,6 +92,8 @@ ObjectFactory::Set (std::string name, const AttributeValue &value)
       return;
     }
   m_parameters.Add (name, info.checker, value.Copy ());
+  m_bundleGeneration = 0;
+  m_created = false;
 }
 
 TypeId 
@@ -100,7 +112,27 @@ ObjectFactory::Create (void) const
   Object *derived = dynamic_cast<Object *> (base);
   NS_ASSERT (derived != 0);
   derived->SetTypeId (m_tid);
-  derived->Construct (m_parameters);
+  uint32_t generation = TypeId::GetAttributeGeneration ();
+  if (m_bundleGeneration == generation && m_bundle.IsEnvironmentCurrent ())
+    {
+      derived->Construct (m_bundle);
+    }
+  else if (m_created)
+    {
+      // The factory is reused: resolve the values once for all the
+      // following objects.
+      m_bundle.SetTypeId (m_tid);
+      m_bundle.SetConstructionValues (m_parameters);
+      m_bundleGeneration = generation;
+      derived->Construct (m_bundle);
+    }
+  else
+    {
+      // Resolving the values costs more than constructing a single
+      // object, which is all many factories are used for.
+      derived->Construct (m_parameters);
+      m_created = true;
+    }
   Ptr<Object> object = Ptr<Object> (derived, false);
   return object;
 }
@@ -184,6 +216,8 @@ std::istream & operator >> (std::istream &is, ObjectFactory &factory)
               else
                 {
                   factory.m_parameters.Add (name, info.checker, val);
+                  factory.m_bundleGeneration = 0;
+                  factory.m_created = false;
                 }
             }
         }
@@ -20,6 +20,7 @@
 #ifndef OBJECT_FACTORY_H
 #define OBJECT_FACTORY_H
 
+#include "attribute-bundle.h"
 #include "attribute-construction-list.h"
 #include "object.h"
 #include "type-id.h"
@@ -42,6 +43,15 @@ class AttributeValue;
  * This class can also hold a set of attributes to set
  * automatically during the object construction.
  *
+ * The values of all the attributes of the objects created, from
+ * Set(), the \c NS_ATTRIBUTE_DEFAULT environment variable or the
+ * attribute initial values, are resolved and validated by the second
+ * Create() (the first one constructs its object as CreateObject()
+ * does, to keep single-use factories cheap), and kept in an AttributeBundle until the factory, the
+ * attribute initial values (see TypeId::GetAttributeGeneration()) or the
+ * environment variable are changed, so that the following objects are constructed without
+ * attribute lookups or string parsing.
+ *
  * \see attribute_ObjectFactory
  */
 class ObjectFactory
@@ -136,6 +146,15 @@ private:
    * objects by this factory.
    */
   AttributeConstructionList m_parameters;  
+  /** The values of all the attributes, as resolved by the last Create(). */
+  mutable AttributeBundle m_bundle;
+  /**
+   * The attribute generation m_bundle was resolved at, or 0 if it
+   * must be resolved.
+   */
+  mutable uint32_t m_bundleGeneration;
+  /** Whether Create() was called since the factory was last changed. */
+  mutable bool m_created;
 };
 
 std::ostream & operator << (std::ostream &os, const ObjectFactory &factory);
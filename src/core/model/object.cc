@@ -25,6 +25,8 @@
 #include "attribute.h"
 #include "log.h"
 #include "string.h"
+#include "memory-accounting.h"
+#include <algorithm>
 #include <vector>
 #include <sstream>
 #include <cstdlib>
@@ -46,6 +48,56 @@ NS_LOG_COMPONENT_DEFINE ("Object");
 
 NS_OBJECT_ENSURE_REGISTERED (Object);
 
+namespace {
+
+/** Per-TypeId counters of aggregate lookups. */
+struct LookupStatistics
+{
+  /** Default constructor. */
+  LookupStatistics ()
+    : lookups (0),
+      hits (0)
+  {}
+  uint64_t lookups;                     //!< Number of lookups.
+  uint64_t hits;                        //!< Number of lookup cache hits.
+};
+
+/** \c true if aggregate lookups are being counted. */
+bool g_lookupStatisticsEnabled = false;
+
+/**
+ * Get the aggregate lookup counters, indexed by TypeId uid.
+ * \returns The counters.
+ */
+std::vector<LookupStatistics> *
+GetLookupStatistics (void)
+{
+  static std::vector<LookupStatistics> statistics;
+  return &statistics;
+}
+
+/**
+ * Record an aggregate lookup.
+ * \param [in] uid The uid of the requested TypeId.
+ * \param [in] hit \c true if the lookup was answered by the cache.
+ */
+void
+RecordLookup (uint16_t uid, bool hit)
+{
+  std::vector<LookupStatistics> *statistics = GetLookupStatistics ();
+  if (uid >= statistics->size ())
+    {
+      statistics->resize (uid + 1);
+    }
+  (*statistics)[uid].lookups++;
+  if (hit)
+    {
+      (*statistics)[uid].hits++;
+    }
+}
+
+} // anonymous namespace
+
 Object::AggregateIterator::AggregateIterator ()
   : m_object (0),
     m_current (0)
@@ -98,16 +150,22 @@ Object::Object ()
     m_disposed (false),
     m_initialized (false),
     m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
-    m_getObjectCount (0)
+    m_getObjectCount (0),
+    m_accountedSize (0)
 {
   NS_LOG_FUNCTION (this);
   m_aggregates->n = 1;
+  m_aggregates->cache = 0;
   m_aggregates->buffer[0] = this;
 }
 Object::~Object () 
 {
   // remove this object from the aggregate list
   NS_LOG_FUNCTION (this);
+  if (m_accountedSize != 0)
+    {
+      MemoryAccounting::Free (MemoryAccounting::Register (m_tid), m_accountedSize);
+    }
   uint32_t n = m_aggregates->n;
   for (uint32_t i = 0; i < n; i++)
     {
@@ -120,10 +178,16 @@ Object::~Object ()
           m_aggregates->n--;
         }
     }
+  // the cache may point to this object: flush it.
+  if (m_aggregates->cache != 0)
+    {
+      std::memset (m_aggregates->cache, 0, sizeof (struct LookupCache));
+    }
   // finally, if all objects have been removed from the list,
   // delete the aggregate list
   if (m_aggregates->n == 0)
     {
+      std::free (m_aggregates->cache);
       std::free (m_aggregates);
     }
   m_aggregates = 0;
@@ -133,15 +197,37 @@ Object::Object (const Object &o)
     m_disposed (false),
     m_initialized (false),
     m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
-    m_getObjectCount (0)
+    m_getObjectCount (0),
+    m_accountedSize (0)
 {
   m_aggregates->n = 1;
+  m_aggregates->cache = 0;
   m_aggregates->buffer[0] = this;
 }
 void
+Object::AccountMemory (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (MemoryAccounting::IsEnabled ())
+    {
+      // The size is recorded by NS_OBJECT_ENSURE_REGISTERED, and is
+      // zero for the classes which do not use it.
+      m_accountedSize = std::max<std::size_t> (m_tid.GetSize (), sizeof (Object));
+      MemoryAccounting::Allocate (MemoryAccounting::Register (m_tid), m_accountedSize);
+    }
+}
+void
 Object::Construct (const AttributeConstructionList &attributes)
 {
   NS_LOG_FUNCTION (this << &attributes);
+  AccountMemory ();
+  ConstructSelf (attributes);
+}
+void
+Object::Construct (const AttributeBundle &attributes)
+{
+  NS_LOG_FUNCTION (this << &attributes);
+  AccountMemory ();
   ConstructSelf (attributes);
 }
 
@@ -151,6 +237,29 @@ Object::DoGetObject (TypeId tid) const
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
+  uint16_t uid = tid.GetUid ();
+  struct LookupCache *cache = m_aggregates->cache;
+  if (cache == 0)
+    {
+      cache = (struct LookupCache *) std::calloc (1, sizeof (struct LookupCache));
+      m_aggregates->cache = cache;
+    }
+  struct LookupCache::Entry *entry = &cache->entries[uid & (LOOKUP_CACHE_SIZE - 1)];
+  if (entry->uid == uid)
+    {
+      if (g_lookupStatisticsEnabled)
+        {
+          RecordLookup (uid, true);
+        }
+      return entry->object;
+    }
+  if (g_lookupStatisticsEnabled)
+    {
+      RecordLookup (uid, false);
+    }
+
+  entry->uid = uid;
+  entry->object = 0;
   uint32_t n = m_aggregates->n;
   TypeId objectTid = Object::GetTypeId ();
   for (uint32_t i = 0; i < n; i++)
@@ -173,7 +282,8 @@ Object::DoGetObject (TypeId tid) const
           current->m_getObjectCount++;
           // then, update the sort
           UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
+          // finally, remember and return the match
+          entry->object = current;
           return const_cast<Object *> (current);
         }
     }
@@ -264,6 +374,7 @@ Object::AggregateObject (Ptr<Object> o)
   struct Aggregates *aggregates = 
     (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(total-1)*sizeof(Object*));
   aggregates->n = total;
+  aggregates->cache = 0;
 
   // copy our buffer to the new buffer
   std::memcpy (&aggregates->buffer[0], 
@@ -307,7 +418,10 @@ Object::AggregateObject (Ptr<Object> o)
     }
 
   // Now that we are done with them, we can free our old aggregate buffers
+  // and their lookup caches
+  std::free (a->cache);
   std::free (a);
+  std::free (b->cache);
   std::free (b);
 }
 /**
@@ -327,6 +441,65 @@ Object::GetAggregateIterator (void) const
   return AggregateIterator (this);
 }
 
+void
+Object::EnableLookupStatistics (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+  g_lookupStatisticsEnabled = enable;
+}
+
+uint64_t
+Object::GetLookupCount (TypeId tid)
+{
+  NS_LOG_FUNCTION (tid);
+  std::vector<LookupStatistics> *statistics = GetLookupStatistics ();
+  if (tid.GetUid () >= statistics->size ())
+    {
+      return 0;
+    }
+  return (*statistics)[tid.GetUid ()].lookups;
+}
+
+uint64_t
+Object::GetLookupCacheHitCount (TypeId tid)
+{
+  NS_LOG_FUNCTION (tid);
+  std::vector<LookupStatistics> *statistics = GetLookupStatistics ();
+  if (tid.GetUid () >= statistics->size ())
+    {
+      return 0;
+    }
+  return (*statistics)[tid.GetUid ()].hits;
+}
+
+void
+Object::ResetLookupStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  GetLookupStatistics ()->clear ();
+}
+
+void
+Object::PrintLookupStatistics (std::ostream &os)
+{
+  NS_LOG_FUNCTION (&os);
+  std::vector<LookupStatistics> *statistics = GetLookupStatistics ();
+  for (uint32_t uid = 1; uid < statistics->size (); uid++)
+    {
+      const LookupStatistics &s = (*statistics)[uid];
+      if (s.lookups == 0)
+        {
+          continue;
+        }
+      TypeId tid;
+      tid.SetUid (uid);
+      os << tid.GetName ()
+         << " lookups=" << s.lookups
+         << " hits=" << s.hits
+         << std::endl;
+    }
+}
+
 void 
 Object::SetTypeId (TypeId tid)
 {
@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <string>
 #include <vector>
+#include <ostream>
 #include "ptr.h"
 #include "attribute.h"
 #include "object-base.h"
@@ -43,6 +44,7 @@ class Object;
 class AttributeAccessor;
 class AttributeValue;
 class TraceSourceAccessor;
+class AttributeBundle;
 
 /**
  * \ingroup core
@@ -219,6 +221,43 @@ private:
    */
   void Initialize (void);
 
+  /**
+   * Enable or disable the per-TypeId accounting of aggregate lookups.
+   *
+   * \param [in] enable \c true to start counting, \c false to stop.
+   *
+   * When enabled, every lookup which reaches the aggregate lookup cache
+   * (every GetObject() call which is not satisfied by a plain
+   * dynamic_cast of the first aggregate) is counted against the
+   * requested TypeId, together with the number of these lookups which
+   * were answered by the cache.  Counting is disabled by default.
+   */
+  static void EnableLookupStatistics (bool enable);
+  /**
+   * Get the number of aggregate lookups recorded for a TypeId.
+   *
+   * \param [in] tid The requested TypeId.
+   * \returns The number of lookups of \pname{tid} since the statistics
+   *          were last reset.
+   */
+  static uint64_t GetLookupCount (TypeId tid);
+  /**
+   * Get the number of aggregate lookups for a TypeId answered by the cache.
+   *
+   * \param [in] tid The requested TypeId.
+   * \returns The number of lookups of \pname{tid} which hit the
+   *          aggregate lookup cache since the statistics were last reset.
+   */
+  static uint64_t GetLookupCacheHitCount (TypeId tid);
+  /** Clear all the aggregate lookup counters. */
+  static void ResetLookupStatistics (void);
+  /**
+   * Print the aggregate lookup counters, one TypeId per line.
+   *
+   * \param [in,out] os The output stream.
+   */
+  static void PrintLookupStatistics (std::ostream &os);
+
 protected:
   /**
    * Notify all Objects aggregated to this one of a new Object being
@@ -316,6 +355,31 @@ private:
   friend class AggregateIterator;
   friend struct ObjectDeleter;
 
+  /** The number of entries in a LookupCache. Must be a power of two. */
+  enum { LOOKUP_CACHE_SIZE = 16 };
+
+  /**
+   * A direct-mapped cache of the results of DoGetObject().
+   *
+   * Entries are indexed by the low bits of the uid of the requested
+   * TypeId, so a lookup is a single probe.  Both hits and misses are
+   * recorded: a null \c object means that no aggregate matches the
+   * TypeId.  The cache is discarded whenever the aggregate changes
+   * (AggregateObject() builds a new Aggregates buffer) and flushed when
+   * one of the aggregated Objects is destroyed.
+   */
+  struct LookupCache {
+    /** A cache entry. */
+    struct Entry {
+      /** The uid of the requested TypeId, zero if the entry is empty. */
+      uint16_t uid;
+      /** The matching aggregate, or zero if there is none. */
+      Object *object;
+    };
+    /** The cache entries. */
+    struct Entry entries[LOOKUP_CACHE_SIZE];
+  };
+
   /**
    * The list of Objects aggregated to this one.
    *
@@ -331,6 +395,11 @@ private:
   struct Aggregates {
     /** The number of entries in \c buffer. */
     uint32_t n;
+    /**
+     * The lookup cache shared by all the Objects in \c buffer,
+     * allocated on the first DoGetObject() call.
+     */
+    struct LookupCache *cache;
     /** The array of Objects. */
     Object *buffer[1];
   };
@@ -381,6 +450,18 @@ private:
    * registered with the associated TypeId.
   */
   void Construct (const AttributeConstructionList &attributes);
+  /**
+   * Initialize all member variables registered as Attributes of this
+   * TypeId from their values resolved by ObjectFactory.
+   *
+   * \param [in] attributes The values of all the attributes.
+   */
+  void Construct (const AttributeBundle &attributes);
+  /**
+   * Account the memory of this Object in the MemoryAccounting counter
+   * of its TypeId, if the accounting is enabled.
+   */
+  void AccountMemory (void);
 
   /**
    * Keep the list of aggregates in most-recently-used order
@@ -428,6 +509,11 @@ private:
    * the array of aggregates in most-frequently accessed order.
    */
   uint32_t m_getObjectCount;
+  /**
+   * The size accounted for this Object by MemoryAccounting, or 0
+   * if it was not accounted.
+   */
+  uint32_t m_accountedSize;
 };
 
 template <typename T>
@@ -0,0 +1,307 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>    // sysconf
+
+#include "progress-monitor.h"
+#include "simulator.h"
+#include "simulator-impl.h"
+#include "system-wall-clock-ms.h"
+#include "boolean.h"
+#include "fatal-error.h"
+#include "log.h"
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::ProgressMonitor implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ProgressMonitor");
+
+NS_OBJECT_ENSURE_REGISTERED (ProgressMonitor);
+
+TypeId
+ProgressMonitor::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ProgressMonitor")
+    .SetParent<Object> ()
+    .SetGroupName ("Core")
+    .AddConstructor<ProgressMonitor> ()
+    .AddAttribute ("Interval",
+                   "The wall clock time between two samples.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&ProgressMonitor::m_interval),
+                   MakeTimeChecker (MilliSeconds (1)))
+    .AddAttribute ("StopTime",
+                   "The simulation time the simulation stops at, used to "
+                   "estimate the time left, or 0 if unknown.",
+                   TimeValue (Time (0)),
+                   MakeTimeAccessor (&ProgressMonitor::m_stopTime),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("Print",
+                   "Whether to print the samples to std::clog.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&ProgressMonitor::m_print),
+                   MakeBooleanChecker ())
+    .AddAttribute ("StallTimeout",
+                   "The wall clock time without progress of the simulation "
+                   "time after which the simulation is stalled, "
+                   "or 0 to disable the stall detection.",
+                   TimeValue (Time (0)),
+                   MakeTimeAccessor (&ProgressMonitor::m_stallTimeout),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("AbortOnStall",
+                   "Whether to abort the program when the simulation stalls.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ProgressMonitor::m_abortOnStall),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("Sample",
+                     "A progress sample, reported from the monitor thread.",
+                     MakeTraceSourceAccessor (&ProgressMonitor::m_sampleTrace),
+                     "ns3::ProgressMonitor::SampleTracedCallback")
+    .AddTraceSource ("Stall",
+                     "The simulation stalled, reported from the monitor thread.",
+                     MakeTraceSourceAccessor (&ProgressMonitor::m_stallTrace),
+                     "ns3::ProgressMonitor::SampleTracedCallback")
+  ;
+  return tid;
+}
+
+ProgressMonitor::ProgressMonitor ()
+  : m_stalled (false)
+{
+  NS_LOG_FUNCTION (this);
+  m_lastSample.events = 0;
+  m_lastSample.pendingEvents = 0;
+  m_lastSample.residentSetSize = 0;
+  m_lastSample.eventRate = 0;
+  m_lastSample.speed = 0;
+  m_lastSample.eta = Seconds (-1);
+}
+
+ProgressMonitor::~ProgressMonitor ()
+{
+  NS_LOG_FUNCTION (this);
+  Stop ();
+}
+
+void
+ProgressMonitor::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Stop ();
+  Object::DoDispose ();
+}
+
+void
+ProgressMonitor::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_thread == 0, "ProgressMonitor already started");
+  m_simulator = Simulator::GetImplementation ();
+  {
+    CriticalSection cs (m_mutex);
+    m_stalled = false;
+  }
+  m_stop.SetCondition (false);
+  m_thread = Create<SystemThread> (MakeCallback (&ProgressMonitor::Run, this));
+  m_thread->Start ();
+}
+
+void
+ProgressMonitor::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_thread == 0)
+    {
+      return;
+    }
+  m_stop.SetCondition (true);
+  m_stop.Signal ();
+  m_thread->Join ();
+  m_thread = 0;
+  m_simulator = 0;
+}
+
+bool
+ProgressMonitor::IsRunning (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_thread != 0;
+}
+
+ProgressMonitor::Sample
+ProgressMonitor::GetLastSample (void) const
+{
+  NS_LOG_FUNCTION (this);
+  CriticalSection cs (m_mutex);
+  return m_lastSample;
+}
+
+bool
+ProgressMonitor::IsStalled (void) const
+{
+  NS_LOG_FUNCTION (this);
+  CriticalSection cs (m_mutex);
+  return m_stalled;
+}
+
+uint64_t
+ProgressMonitor::GetResidentSetSize (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  // The second field of statm is the resident set size, in pages.
+  std::ifstream statm ("/proc/self/statm");
+  uint64_t size;
+  uint64_t resident;
+  if (!(statm >> size >> resident))
+    {
+      return 0;
+    }
+  long pageSize = sysconf (_SC_PAGESIZE);
+  if (pageSize <= 0)
+    {
+      return 0;
+    }
+  return resident * pageSize;
+}
+
+ProgressMonitor::Sample
+ProgressMonitor::TakeSample (const Sample &previous, int64_t wallMs) const
+{
+  // Called from the monitor thread: no logging here.
+  Sample sample;
+  sample.wallTime = MilliSeconds (wallMs);
+  sample.simulationTime = m_simulator->Now ();
+  sample.events = m_simulator->GetEventCount ();
+  sample.pendingEvents = m_simulator->GetPendingEventCount ();
+  sample.residentSetSize = GetResidentSetSize ();
+  double wall = (sample.wallTime - previous.wallTime).GetSeconds ();
+  if (wall > 0)
+    {
+      sample.eventRate = (sample.events - previous.events) / wall;
+      sample.speed = (sample.simulationTime - previous.simulationTime).GetSeconds () / wall;
+    }
+  else
+    {
+      sample.eventRate = 0;
+      sample.speed = 0;
+    }
+  sample.eta = Seconds (-1);
+  return sample;
+}
+
+void
+ProgressMonitor::Run (void)
+{
+  // Runs in the monitor thread: no logging here, the log is not
+  // thread-safe.
+  SystemWallClockMs clock;
+  clock.Start ();
+  Sample first = TakeSample (m_lastSample, 0);
+  first.eventRate = 0;
+  first.speed = 0;
+  Sample previous = first;
+  Time progressWall = first.wallTime;
+
+  while (m_stop.TimedWait (m_interval.GetNanoSeconds ()))
+    {
+      Sample sample = TakeSample (previous, clock.End ());
+
+      if (m_stopTime.IsStrictlyPositive ())
+        {
+          double simulated = (sample.simulationTime - first.simulationTime).GetSeconds ();
+          double wall = (sample.wallTime - first.wallTime).GetSeconds ();
+          if (sample.simulationTime >= m_stopTime)
+            {
+              sample.eta = Time (0);
+            }
+          else if (simulated > 0 && wall > 0)
+            {
+              double left = (m_stopTime - sample.simulationTime).GetSeconds ();
+              sample.eta = Seconds (left * wall / simulated);
+            }
+        }
+
+      if (sample.simulationTime != previous.simulationTime)
+        {
+          progressWall = sample.wallTime;
+        }
+      bool stalled = m_stallTimeout.IsStrictlyPositive ()
+        && sample.wallTime - progressWall >= m_stallTimeout;
+      bool stall;
+      {
+        CriticalSection cs (m_mutex);
+        stall = stalled && !m_stalled;
+        m_stalled = stalled;
+        m_lastSample = sample;
+      }
+
+      if (m_print)
+        {
+          std::ostringstream oss;
+          oss << "Progress: " << sample << std::endl;
+          std::clog << oss.str () << std::flush;
+        }
+      m_sampleTrace (sample);
+      if (stall)
+        {
+          m_stallTrace (sample);
+          if (m_abortOnStall)
+            {
+              NS_FATAL_ERROR ("Simulation stalled at " << sample.simulationTime.As (Time::S)
+                              << " for " << (sample.wallTime - progressWall).As (Time::S));
+            }
+        }
+      previous = sample;
+    }
+}
+
+std::ostream &
+operator << (std::ostream &os, const ProgressMonitor::Sample &sample)
+{
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << std::fixed << std::setprecision (3)
+     << "wall=" << sample.wallTime.GetSeconds () << "s"
+     << " sim=" << sample.simulationTime.GetSeconds () << "s"
+     << " events=" << sample.events
+     << " pending=" << sample.pendingEvents
+     << std::setprecision (0)
+     << " rate=" << sample.eventRate << "ev/s"
+     << std::setprecision (3)
+     << " speed=" << sample.speed;
+  if (!sample.eta.IsNegative ())
+    {
+      os << std::setprecision (0) << " eta=" << sample.eta.GetSeconds () << "s";
+    }
+  if (sample.residentSetSize != 0)
+    {
+      os << std::setprecision (1) << " rss=" << sample.residentSetSize / 1048576.0 << "MiB";
+    }
+  os.flags (flags);
+  os.precision (precision);
+  return os;
+}
+
+} // namespace ns3
@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PROGRESS_MONITOR_H
+#define PROGRESS_MONITOR_H
+
+#include <ostream>
+
+#include "nstime.h"
+#include "object.h"
+#include "ptr.h"
+#include "system-condition.h"
+#include "system-mutex.h"
+#include "system-thread.h"
+#include "traced-callback.h"
+
+/**
+ * @file
+ * @ingroup simulator
+ * ns3::ProgressMonitor declaration.
+ */
+
+namespace ns3 {
+
+class SimulatorImpl;
+
+/**
+ * @ingroup simulator
+ * @brief Report the progress of a simulation from a side thread.
+ *
+ * Every Interval of wall clock time, the monitor thread samples the
+ * number of events executed, the number of events in the event list,
+ * the simulation time and the resident set size of the process, and
+ * derives the event rate and the speed of the simulation (simulated
+ * seconds per wall clock second) over the last interval.  When the
+ * StopTime of the simulation is set, the sample also holds the
+ * estimated wall clock time left, from the average speed since
+ * Start().
+ *
+ * The event loop is not touched: the monitor reads the counters of
+ * the simulator implementation without synchronization, so a sample
+ * can be slightly stale, but the simulation runs exactly as without
+ * the monitor.
+ *
+ * The samples are printed to std::clog when Print is set, reported by
+ * the Sample trace source, and the last one can be read with
+ * GetLastSample().  When the simulation time has not advanced for
+ * StallTimeout of wall clock time, the Stall trace source is fired
+ * and, if AbortOnStall is set, the program is aborted, so that a batch
+ * of runs does not wait forever on a stuck one.
+ *
+ * The trace sources are invoked from the monitor thread: the
+ * callbacks must not schedule events or use the objects of the
+ * simulation.
+ *
+ * The simplest way to get progress reports is to set the
+ * \c ProgressInterval global value, for example from the command line
+ * with <tt>--ProgressInterval=10s</tt>: Simulator::Run() then runs a
+ * monitor with this interval, configured by the ProgressMonitor
+ * attribute defaults, e.g.
+ * <tt>--ns3::ProgressMonitor::StopTime=600s</tt>.
+ */
+class ProgressMonitor : public Object
+{
+public:
+  /**
+   * Get the registered TypeId for this class.
+   * @returns The TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  ProgressMonitor ();
+  /** Destructor. */
+  virtual ~ProgressMonitor ();
+
+  /** A progress sample. */
+  struct Sample
+  {
+    /** Wall clock time since Start(). */
+    Time wallTime;
+    /** Simulation time. */
+    Time simulationTime;
+    /** Number of events executed. */
+    uint64_t events;
+    /** Number of events in the event list. */
+    uint64_t pendingEvents;
+    /** Resident set size of the process in bytes, or 0 if unknown. */
+    uint64_t residentSetSize;
+    /** Events executed per wall clock second, over the last interval. */
+    double eventRate;
+    /** Simulated seconds per wall clock second, over the last interval. */
+    double speed;
+    /** Estimated wall clock time to StopTime, or negative if unknown. */
+    Time eta;
+  };
+
+  /**
+   * TracedCallback signature for the progress samples.
+   *
+   * @param [in] sample The progress sample.
+   */
+  typedef void (* SampleTracedCallback)(const Sample &sample);
+
+  /**
+   * Start the monitor thread.
+   *
+   * The monitor samples the current simulator implementation, and
+   * must be started from the main thread.
+   */
+  void Start (void);
+  /** Stop the monitor thread, and wait for it to exit. */
+  void Stop (void);
+  /**
+   * Check whether the monitor thread runs.
+   * @returns @c true between Start() and Stop().
+   */
+  bool IsRunning (void) const;
+
+  /**
+   * Get the last sample.
+   * @returns The last sample taken, or an empty sample if none was.
+   */
+  Sample GetLastSample (void) const;
+  /**
+   * Check whether the simulation is stalled.
+   * @returns @c true if the simulation time has not advanced for
+   *          StallTimeout at the last sample.
+   */
+  bool IsStalled (void) const;
+
+  /**
+   * Read the resident set size of the process.
+   * @returns The resident set size in bytes, or 0 if unknown.
+   */
+  static uint64_t GetResidentSetSize (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /** The body of the monitor thread. */
+  void Run (void);
+  /**
+   * Take a sample.
+   * @param [in] previous The previous sample.
+   * @param [in] wallMs The wall clock time since Start(), in ms.
+   * @returns The new sample.
+   */
+  Sample TakeSample (const Sample &previous, int64_t wallMs) const;
+
+  /** Wall clock time between two samples. */
+  Time m_interval;
+  /** Simulation time the simulation stops at, or zero if unknown. */
+  Time m_stopTime;
+  /** Whether to print the samples to std::clog. */
+  bool m_print;
+  /** Wall clock time without progress before a stall, or zero. */
+  Time m_stallTimeout;
+  /** Whether to abort the program on a stall. */
+  bool m_abortOnStall;
+
+  /** The simulator implementation sampled. */
+  Ptr<SimulatorImpl> m_simulator;
+  /** The monitor thread. */
+  Ptr<SystemThread> m_thread;
+  /** Set to stop the monitor thread. */
+  SystemCondition m_stop;
+  /** Protects m_lastSample and m_stalled. */
+  mutable SystemMutex m_mutex;
+  /** The last sample taken. */
+  Sample m_lastSample;
+  /** Whether the simulation is stalled. */
+  bool m_stalled;
+
+  /** Trace of the samples. */
+  TracedCallback<const Sample &> m_sampleTrace;
+  /** Trace of the stalls. */
+  TracedCallback<const Sample &> m_stallTrace;
+};
+
+/**
+ * @ingroup simulator
+ * Print a progress sample on one line.
+ *
+ * @param [in,out] os The output stream.
+ * @param [in] sample The sample.
+ * @returns The output stream.
+ */
+std::ostream & operator << (std::ostream &os, const ProgressMonitor::Sample &sample);
+
+} // namespace ns3
+
+#endif /* PROGRESS_MONITOR_H */
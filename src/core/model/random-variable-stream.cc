@@ -33,8 +33,12 @@
 #include "log.h"
 #include "rng-stream.h"
 #include "rng-seed-manager.h"
+#include "checkpointer.h"
+#include <algorithm>  // fill
 #include <cmath>
 #include <iostream>
+#include <map>
+#include <set>
 
 /**
  * \file
@@ -48,6 +52,45 @@ NS_LOG_COMPONENT_DEFINE ("RandomVariableStream");
 
 NS_OBJECT_ENSURE_REGISTERED (RandomVariableStream);
 
+namespace {
+
+/** The random variable streams, by the index of their RngStream. */
+typedef std::multimap<uint64_t, RandomVariableStream *> Streams;
+
+/**
+ * Get the random variable streams, to save them in a checkpoint.
+ * \returns The streams.
+ */
+Streams *
+GetStreams (void)
+{
+  // Never deleted, as random variables may belong to static objects.
+  static Streams *streams = new Streams ();
+  return streams;
+}
+
+/**
+ * Remove a random variable stream from the streams.
+ * \param [in] index The index of its RngStream.
+ * \param [in] stream The random variable stream.
+ */
+void
+RemoveStream (uint64_t index, RandomVariableStream *stream)
+{
+  Streams *streams = GetStreams ();
+  std::pair<Streams::iterator, Streams::iterator> range = streams->equal_range (index);
+  for (Streams::iterator i = range.first; i != range.second; ++i)
+    {
+      if (i->second == stream)
+        {
+          streams->erase (i);
+          return;
+        }
+    }
+}
+
+} // anonymous namespace
+
 TypeId 
 RandomVariableStream::GetTypeId (void)
 {
@@ -72,13 +115,18 @@ RandomVariableStream::GetTypeId (void)
 }
 
 RandomVariableStream::RandomVariableStream()
-  : m_rng (0)
+  : m_rng (0),
+    m_index (0)
 {
   NS_LOG_FUNCTION (this);
 }
 RandomVariableStream::~RandomVariableStream()
 {
   NS_LOG_FUNCTION (this);
+  if (m_rng != 0)
+    {
+      RemoveStream (m_index, this);
+    }
   delete m_rng;
 }
 
@@ -100,6 +148,10 @@ RandomVariableStream::SetStream (int64_t stream)
   NS_LOG_FUNCTION (this << stream);
   // negative values are not legal.
   NS_ASSERT (stream >= -1);
+  if (m_rng != 0)
+    {
+      RemoveStream (m_index, this);
+    }
   delete m_rng;
   if (stream == -1)
     {
@@ -110,6 +162,7 @@ RandomVariableStream::SetStream (int64_t stream)
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              nextStream,
                              RngSeedManager::GetRun ());
+      m_index = nextStream;
     }
   else
     {
@@ -120,8 +173,10 @@ RandomVariableStream::SetStream (int64_t stream)
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              target,
                              RngSeedManager::GetRun ());
+      m_index = target;
     }
   m_stream = stream;
+  GetStreams ()->insert (std::make_pair (m_index, this));
 }
 int64_t
 RandomVariableStream::GetStream(void) const
@@ -130,6 +185,16 @@ RandomVariableStream::GetStream(void) const
   return m_stream;
 }
 
+void
+RandomVariableStream::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      values[i] = GetValue ();
+    }
+}
+
 RngStream *
 RandomVariableStream::Peek(void) const
 {
@@ -137,6 +202,106 @@ RandomVariableStream::Peek(void) const
   return m_rng;
 }
 
+void
+RandomVariableStream::DoSaveState (CheckpointWriter &writer) const
+{
+  NS_LOG_FUNCTION (this << &writer);
+}
+
+void
+RandomVariableStream::DoRestoreState (CheckpointReader &reader)
+{
+  NS_LOG_FUNCTION (this << &reader);
+}
+
+void
+RandomVariableStream::SaveAll (CheckpointWriter &writer)
+{
+  NS_LOG_FUNCTION (&writer);
+  writer.WriteU32 (RngSeedManager::GetSeed ());
+  writer.WriteU64 (RngSeedManager::GetRun ());
+  writer.WriteU64 (RngSeedManager::PeekNextStreamIndex ());
+
+  Streams *streams = GetStreams ();
+  writer.WriteU64 (streams->size ());
+  for (Streams::const_iterator i = streams->begin (); i != streams->end (); ++i)
+    {
+      const RandomVariableStream *stream = i->second;
+      if (i != streams->begin () && (--Streams::const_iterator (i))->first == i->first)
+        {
+          NS_FATAL_ERROR ("Checkpointer: several random variables use the RNG stream "
+                          << i->first << ", which can not be told apart in a checkpoint");
+        }
+      writer.WriteU64 (i->first);
+      writer.WriteString (stream->GetInstanceTypeId ().GetName ());
+      double state[6];
+      stream->m_rng->GetState (state);
+      for (int j = 0; j < 6; ++j)
+        {
+          writer.WriteDouble (state[j]);
+        }
+      stream->DoSaveState (writer);
+    }
+}
+
+void
+RandomVariableStream::RestoreAll (CheckpointReader &reader)
+{
+  NS_LOG_FUNCTION (&reader);
+  uint32_t seed = reader.ReadU32 ();
+  uint64_t run = reader.ReadU64 ();
+  if (seed != RngSeedManager::GetSeed () || run != RngSeedManager::GetRun ())
+    {
+      NS_FATAL_ERROR ("Checkpointer: the checkpoint was taken with the RNG seed " << seed
+                      << " and run " << run << ", not with the seed " << RngSeedManager::GetSeed ()
+                      << " and run " << RngSeedManager::GetRun ());
+    }
+  RngSeedManager::SetNextStreamIndex (reader.ReadU64 ());
+
+  Streams *streams = GetStreams ();
+  std::set<uint64_t> restored;
+  uint64_t n = reader.ReadU64 ();
+  for (uint64_t i = 0; i < n; ++i)
+    {
+      uint64_t index = reader.ReadU64 ();
+      std::string type = reader.ReadString ();
+      std::pair<Streams::iterator, Streams::iterator> range = streams->equal_range (index);
+      if (range.first == range.second)
+        {
+          NS_FATAL_ERROR ("Checkpointer: the " << type << " of the RNG stream " << index
+                          << " in the checkpoint is not created by this simulation");
+        }
+      RandomVariableStream *stream = range.first->second;
+      if (++range.first != range.second)
+        {
+          NS_FATAL_ERROR ("Checkpointer: several random variables use the RNG stream "
+                          << index << ", which can not be told apart in a checkpoint");
+        }
+      if (stream->GetInstanceTypeId ().GetName () != type)
+        {
+          NS_FATAL_ERROR ("Checkpointer: the RNG stream " << index << " is used by a " << type
+                          << " in the checkpoint, and by a "
+                          << stream->GetInstanceTypeId ().GetName () << " in this simulation");
+        }
+      double state[6];
+      for (int j = 0; j < 6; ++j)
+        {
+          state[j] = reader.ReadDouble ();
+        }
+      stream->m_rng->SetState (state);
+      stream->DoRestoreState (reader);
+      restored.insert (index);
+    }
+  for (Streams::const_iterator i = streams->begin (); i != streams->end (); ++i)
+    {
+      if (restored.find (i->first) == restored.end ())
+        {
+          NS_FATAL_ERROR ("Checkpointer: the " << i->second->GetInstanceTypeId ().GetName ()
+                          << " of the RNG stream " << i->first << " is not in the checkpoint");
+        }
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED(UniformRandomVariable);
 
 TypeId 
@@ -207,6 +372,23 @@ UniformRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_min, m_max + 1);
 }
+void
+UniformRandomVariable::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  Peek ()->RandU01 (values, n);
+  const double min = m_min;
+  const double max = m_max;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      double v = min + values[i] * (max - min);
+      if (IsAntithetic ())
+        {
+          v = min + (max - v);
+        }
+      values[i] = v;
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ConstantRandomVariable);
 
@@ -262,6 +444,12 @@ ConstantRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_constant);
 }
+void
+ConstantRandomVariable::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  std::fill (values, values + n, m_constant);
+}
 
 NS_OBJECT_ENSURE_REGISTERED(SequentialRandomVariable);
 
@@ -363,6 +551,24 @@ SequentialRandomVariable::GetInteger (void)
   return (uint32_t)GetValue ();
 }
 
+void
+SequentialRandomVariable::DoSaveState (CheckpointWriter &writer) const
+{
+  NS_LOG_FUNCTION (this << &writer);
+  writer.WriteDouble (m_current);
+  writer.WriteU32 (m_currentConsecutive);
+  writer.WriteU8 (m_isCurrentSet);
+}
+
+void
+SequentialRandomVariable::DoRestoreState (CheckpointReader &reader)
+{
+  NS_LOG_FUNCTION (this << &reader);
+  m_current = reader.ReadDouble ();
+  m_currentConsecutive = reader.ReadU32 ();
+  m_isCurrentSet = reader.ReadU8 ();
+}
+
 NS_OBJECT_ENSURE_REGISTERED(ExponentialRandomVariable);
 
 TypeId 
@@ -444,6 +650,35 @@ ExponentialRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_bound);
 }
+void
+ExponentialRandomVariable::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  const double mean = m_mean;
+  const double bound = m_bound;
+  // Draw the uniforms for the values still missing, then transform
+  // them in place.  A rejected draw leaves a hole which is closed by
+  // the next accepted one, so the uniforms are consumed in the same
+  // order as by GetValue(void), and never more of them.
+  uint32_t filled = 0;
+  while (filled < n)
+    {
+      Peek ()->RandU01 (values + filled, n - filled);
+      for (uint32_t i = filled; i < n; ++i)
+        {
+          double v = values[i];
+          if (IsAntithetic ())
+            {
+              v = (1 - v);
+            }
+          double r = -mean*std::log (v);
+          if (bound == 0 || r <= bound)
+            {
+              values[filled++] = r;
+            }
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ParetoRandomVariable);
 
@@ -755,6 +990,22 @@ NormalRandomVariable::GetInteger (void)
   return (uint32_t)GetValue (m_mean, m_variance, m_bound);
 }
 
+void
+NormalRandomVariable::DoSaveState (CheckpointWriter &writer) const
+{
+  NS_LOG_FUNCTION (this << &writer);
+  writer.WriteU8 (m_nextValid);
+  writer.WriteDouble (m_next);
+}
+
+void
+NormalRandomVariable::DoRestoreState (CheckpointReader &reader)
+{
+  NS_LOG_FUNCTION (this << &reader);
+  m_nextValid = reader.ReadU8 ();
+  m_next = reader.ReadDouble ();
+}
+
 NS_OBJECT_ENSURE_REGISTERED(LogNormalRandomVariable);
 
 TypeId 
@@ -1005,6 +1256,22 @@ GammaRandomVariable::GetInteger (void)
   return (uint32_t)GetValue (m_alpha, m_beta);
 }
 
+void
+GammaRandomVariable::DoSaveState (CheckpointWriter &writer) const
+{
+  NS_LOG_FUNCTION (this << &writer);
+  writer.WriteU8 (m_nextValid);
+  writer.WriteDouble (m_next);
+}
+
+void
+GammaRandomVariable::DoRestoreState (CheckpointReader &reader)
+{
+  NS_LOG_FUNCTION (this << &reader);
+  m_nextValid = reader.ReadU8 ();
+  m_next = reader.ReadDouble ();
+}
+
 double 
 GammaRandomVariable::GetNormalValue (double mean, double variance, double bound)
 {
@@ -1506,6 +1773,20 @@ DeterministicRandomVariable::GetInteger (void)
   return (uint32_t)GetValue ();
 }
 
+void
+DeterministicRandomVariable::DoSaveState (CheckpointWriter &writer) const
+{
+  NS_LOG_FUNCTION (this << &writer);
+  writer.WriteU64 (m_next);
+}
+
+void
+DeterministicRandomVariable::DoRestoreState (CheckpointReader &reader)
+{
+  NS_LOG_FUNCTION (this << &reader);
+  m_next = reader.ReadU64 ();
+}
+
 NS_OBJECT_ENSURE_REGISTERED(EmpiricalRandomVariable);
 
 // ValueCDF methods
@@ -70,6 +70,8 @@ namespace ns3 {
  */
   
 class RngStream;
+class CheckpointWriter;
+class CheckpointReader;
 
 /**
  * \ingroup randomvariable
@@ -149,12 +151,61 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Get the next \p n random values drawn from the distribution.
+   *
+   * The values are the same as those returned by \p n successive
+   * calls to GetValue(void), so bulk and single draws can be mixed
+   * without changing the stream sequence.  Subclasses override this
+   * to amortize the per-value overhead; the default simply calls
+   * GetValue(void) \p n times.
+   *
+   * \param [out] values The array to fill, of at least \p n elements.
+   * \param [in] n The number of values to draw.
+   */
+  virtual void GetValues (double *values, uint32_t n);
+
+  /**
+   * \brief Write the state of every random variable stream to a
+   * checkpoint.
+   *
+   * A stream is identified by the index of its RngStream, which must
+   * not be shared with another random variable.
+   *
+   * \param [in,out] writer The checkpoint.
+   */
+  static void SaveAll (CheckpointWriter &writer);
+  /**
+   * \brief Restore the state of every random variable stream from a
+   * checkpoint.
+   *
+   * The simulation must have created the same random variables, with
+   * the same streams, as the one which took the checkpoint: a stream
+   * of the checkpoint without its random variable, or the reverse,
+   * is a fatal error.
+   *
+   * \param [in,out] reader The checkpoint.
+   */
+  static void RestoreAll (CheckpointReader &reader);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RNG stream.
    */
   RngStream *Peek(void) const;
 
+  /**
+   * \brief Write the state of the distribution, other than the RNG
+   * stream, to a checkpoint.  The default writes nothing.
+   * \param [in,out] writer The checkpoint.
+   */
+  virtual void DoSaveState (CheckpointWriter &writer) const;
+  /**
+   * \brief Restore the state written by DoSaveState().
+   * \param [in,out] reader The checkpoint.
+   */
+  virtual void DoRestoreState (CheckpointReader &reader);
+
 private:
   /**
    * Copy constructor.  These objects are not copyable.
@@ -186,6 +237,9 @@ private:
   /** The stream number for this RNG stream. */
   int64_t m_stream;
 
+  /** The index of the underlying RNG stream, unique to each stream number. */
+  uint64_t m_index;
+
 };  // class RandomVariableStream
 
   
@@ -293,6 +347,7 @@ public:
    * \note The upper limit is included in the output range.
    */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, uint32_t n);
   
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
@@ -352,6 +407,7 @@ public:
   virtual double GetValue (void);
   /* \note This RNG always returns the same value. */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, uint32_t n);
 
 private:
   /** The constant value returned by this RNG stream. */
@@ -441,6 +497,10 @@ public:
   virtual uint32_t GetInteger (void);
 
 private:
+  // Inherited from RandomVariableStream
+  virtual void DoSaveState (CheckpointWriter &writer) const;
+  virtual void DoRestoreState (CheckpointReader &reader);
+
   /** The first value of the sequence. */
   double m_min;
 
@@ -585,6 +645,7 @@ public:
   // Inherited from RandomVariableStream
   virtual double GetValue (void);
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, uint32_t n);
 
 private:
   /** The mean value of the unbounded exponential distribution. */
@@ -1244,6 +1305,10 @@ public:
   virtual uint32_t GetInteger (void);
 
 private:
+  // Inherited from RandomVariableStream
+  virtual void DoSaveState (CheckpointWriter &writer) const;
+  virtual void DoRestoreState (CheckpointReader &reader);
+
   /** The mean value for the normal distribution returned by this RNG stream. */
   double m_mean;
 
@@ -1603,6 +1668,10 @@ public:
   virtual uint32_t GetInteger (void);
 
 private:
+  // Inherited from RandomVariableStream
+  virtual void DoSaveState (CheckpointWriter &writer) const;
+  virtual void DoRestoreState (CheckpointReader &reader);
+
   /**
    * \brief Returns a random double from a normal distribution with the specified mean, variance, and bound.
    * \param [in] mean Mean value for the normal distribution.
@@ -2405,6 +2474,10 @@ public:
   virtual uint32_t GetInteger (void);
 
 private:
+  // Inherited from RandomVariableStream
+  virtual void DoSaveState (CheckpointWriter &writer) const;
+  virtual void DoRestoreState (CheckpointReader &reader);
+
   /** Position in the array of values. */
   uint64_t   m_count;
 
@@ -107,6 +107,8 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+  virtual uint64_t GetPendingEventCount (void) const;
 
   /** \copydoc ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
   void ScheduleRealtimeWithContext (uint32_t context, Time const &delay, EventImpl *event);
@@ -154,6 +156,25 @@ public:
    */
   Time GetHardLimit (void) const;
 
+  /**
+   * Replace the synchronizer.
+   *
+   * This can only be done before the simulation runs.
+   *
+   * \param [in] tid The TypeId of the new Synchronizer.
+   */
+  void SetSynchronizerType (TypeId tid);
+  /**
+   * Get the type of the synchronizer.
+   * \returns The TypeId of the Synchronizer in use.
+   */
+  TypeId GetSynchronizerType (void) const;
+  /**
+   * Get the synchronizer, for example to connect to its trace sources.
+   * \returns The Synchronizer in use.
+   */
+  Ptr<Synchronizer> GetSynchronizer (void) const;
+
 private:
   /**
    * Is the simulator running?
@@ -194,6 +215,8 @@ private:
   Ptr<Scheduler> m_events;
   /**< Number of events in the event list. */
   int m_unscheduledEvents;
+  /**< Number of events executed. */
+  uint64_t m_eventCount;
   /**< Unique id for the next event to be scheduled. */
   uint32_t m_uid;
   /**< Unique id of the current event. */
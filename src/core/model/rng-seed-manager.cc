@@ -99,4 +99,18 @@ uint64_t RngSeedManager::GetNextStreamIndex (void)
   return next;
 }
 
+uint64_t
+RngSeedManager::PeekNextStreamIndex (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_nextStreamIndex;
+}
+
+void
+RngSeedManager::SetNextStreamIndex (uint64_t index)
+{
+  NS_LOG_FUNCTION (index);
+  g_nextStreamIndex = index;
+}
+
 } // namespace ns3
@@ -70,6 +70,31 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Generate the next \p n random numbers for this stream.
+   * Uniformly distributed between 0 and 1.
+   *
+   * This produces exactly the same sequence as \p n successive
+   * calls to RandU01(void), but keeps the generator state in
+   * registers for the whole batch.
+   *
+   * \param [out] values The array to fill, of at least \p n elements.
+   * \param [in] n The number of randoms to generate.
+   */
+  void RandU01 (double *values, uint32_t n);
+
+  /**
+   * Get the state of the generator, to save it in a checkpoint.
+   *
+   * \param [out] state The state vector.
+   */
+  void GetState (double state[6]) const;
+  /**
+   * Set the state of the generator, restored from a checkpoint.
+   *
+   * \param [in] state The state vector, returned by GetState().
+   */
+  void SetState (const double state[6]);
 
 private:
   /**
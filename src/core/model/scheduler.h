@@ -22,6 +22,7 @@
 #define SCHEDULER_H
 
 #include <stdint.h>
+#include <vector>
 #include "object.h"
 
 /**
@@ -104,6 +105,16 @@ public:
    * \param [in] ev Event to store in the event list
    */
   virtual void Insert (const Event &ev) = 0;
+  /**
+   * Insert several new Events in the schedule.
+   *
+   * The default implementation calls Insert() for each event;
+   * subclasses can insert the whole batch at once.
+   *
+   * \param [in] events The events to store in the event list, in
+   *             any order.
+   */
+  virtual void InsertBatch (const std::vector<Event> &events);
   /**
    * Test if the schedule is empty.
    *
@@ -42,4 +42,16 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+void
+SimulatorImpl::ScheduleBatch (EventBatch &batch)
+{
+  NS_LOG_FUNCTION (this << batch.GetN ());
+  for (uint32_t i = 0; i < batch.GetN (); i++)
+    {
+      const EventBatch::Entry &entry = batch.Get (i);
+      ScheduleWithContext (entry.context, TimeStep (entry.delay), entry.event);
+    }
+  batch.Forget ();
+}
+
 } // namespace ns3
@@ -23,6 +23,7 @@
 
 #include "event-impl.h"
 #include "event-id.h"
+#include "event-batch.h"
 #include "nstime.h"
 #include "object.h"
 #include "object-factory.h"
@@ -67,6 +68,15 @@ public:
   virtual EventId Schedule (Time const &delay, EventImpl *event) = 0;
   /** \copydoc Simulator::ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
   virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event) = 0;
+  /**
+   * Schedule all the events of a batch.
+   *
+   * The default implementation calls ScheduleWithContext() for each
+   * event; subclasses can insert the whole batch at once.
+   *
+   * \param [in,out] batch The events to schedule, left empty.
+   */
+  virtual void ScheduleBatch (EventBatch &batch);
   /** \copydoc Simulator::ScheduleNow(const Ptr<EventImpl>&) */
   virtual EventId ScheduleNow (EventImpl *event) = 0;
   /** \copydoc Simulator::ScheduleDestroy(const Ptr<EventImpl>&) */
@@ -99,6 +109,10 @@ public:
   virtual uint32_t GetSystemId () const = 0; 
   /** \copydoc Simulator::GetContext */
   virtual uint32_t GetContext (void) const = 0;
+  /** \copydoc Simulator::GetEventCount */
+  virtual uint64_t GetEventCount (void) const = 0;
+  /** \copydoc Simulator::GetPendingEventCount */
+  virtual uint64_t GetPendingEventCount (void) const = 0;
 };
 
 } // namespace ns3
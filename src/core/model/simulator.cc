@@ -30,6 +30,12 @@
 #include "global-value.h"
 #include "assert.h"
 #include "log.h"
+#include "memory-accounting.h"
+#include "nstime.h"
+#ifdef HAVE_PTHREAD_H
+#include "progress-monitor.h"
+#include "log-binary-sink.h"
+#endif
 
 #include <cmath>
 #include <fstream>
@@ -75,6 +81,19 @@ static GlobalValue g_schedTypeImpl = GlobalValue ("SchedulerType",
                                                   TypeIdValue (MapScheduler::GetTypeId ()),
                                                   MakeTypeIdChecker ());
 
+/**
+ * \ingroup simulator
+ * The wall clock interval of the progress reports of Simulator::Run().
+ *
+ * When positive, Simulator::Run() runs a ProgressMonitor with this
+ * Interval, configured by the ProgressMonitor attribute defaults.
+ */
+static GlobalValue g_progressInterval ("ProgressInterval",
+                                       "The wall clock time between two progress reports "
+                                       "of the simulation, or 0 to disable them",
+                                       TimeValue (Seconds (0)),
+                                       MakeTimeChecker (Seconds (0)));
+
 /**
  * \ingroup logging
  * Default TimePrinter implementation.
@@ -154,6 +173,9 @@ static SimulatorImpl * GetImpl (void)
 // Simulator::Now which would call Simulator::GetImpl, and, thus, get us 
 // in an infinite recursion until the stack explodes.
 //
+#ifdef HAVE_PTHREAD_H
+      LogBinarySink::SetRecordedPrinters (&TimePrinter, &NodePrinter);
+#endif
       LogSetTimePrinter (&TimePrinter);
       LogSetNodePrinter (&NodePrinter);
     }
@@ -177,6 +199,12 @@ Simulator::Destroy (void)
    */
   LogSetTimePrinter (0);
   LogSetNodePrinter (0);
+  if (MemoryAccounting::IsEnabled ())
+    {
+      // Report the memory used at the end of the simulation, before
+      // the destroy events release it.
+      MemoryAccounting::Print (std::clog);
+    }
   (*pimpl)->Destroy ();
   (*pimpl)->Unref ();
   *pimpl = 0;
@@ -201,6 +229,19 @@ Simulator::Run (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
   Time::ClearMarkedTimes ();
+#ifdef HAVE_PTHREAD_H
+  TimeValue interval;
+  g_progressInterval.GetValue (interval);
+  if (interval.Get ().IsStrictlyPositive ())
+    {
+      Ptr<ProgressMonitor> monitor = CreateObject<ProgressMonitor> ();
+      monitor->SetAttribute ("Interval", interval);
+      monitor->Start ();
+      GetImpl ()->Run ();
+      monitor->Dispose ();
+      return;
+    }
+#endif /* HAVE_PTHREAD_H */
   GetImpl ()->Run ();
 }
 
@@ -251,6 +292,15 @@ Simulator::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *
 {
   return GetImpl ()->ScheduleWithContext (context, delay, impl);
 }
+void
+Simulator::ScheduleWithContext (EventBatch &batch)
+{
+  NS_LOG_FUNCTION (batch.GetN ());
+  if (!batch.IsEmpty ())
+    {
+      GetImpl ()->ScheduleBatch (batch);
+    }
+}
 EventId
 Simulator::ScheduleDestroy (const Ptr<EventImpl> &ev)
 {
@@ -345,6 +395,20 @@ Simulator::GetContext (void)
   return GetImpl ()->GetContext ();
 }
 
+uint64_t
+Simulator::GetEventCount (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return GetImpl ()->GetEventCount ();
+}
+
+uint64_t
+Simulator::GetPendingEventCount (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return GetImpl ()->GetPendingEventCount ();
+}
+
 uint32_t
 Simulator::GetSystemId (void)
 {
@@ -382,6 +446,9 @@ Simulator::SetImplementation (Ptr<SimulatorImpl> impl)
 // Simulator::Now which would call Simulator::GetImpl, and, thus, get us 
 // in an infinite recursion until the stack explodes.
 //
+#ifdef HAVE_PTHREAD_H
+  LogBinarySink::SetRecordedPrinters (&TimePrinter, &NodePrinter);
+#endif
   LogSetTimePrinter (&TimePrinter);
   LogSetNodePrinter (&NodePrinter);
 }
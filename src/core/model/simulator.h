@@ -21,6 +21,7 @@
 #ifndef SIMULATOR_H
 #define SIMULATOR_H
 
+#include "event-batch.h"
 #include "event-id.h"
 #include "event-impl.h"
 #include "make-event.h"
@@ -121,6 +122,9 @@ public:
    * After this method has been invoked, it is actually possible
    * to restart a new simulation with a set of calls to Simulator::Run,
    * Simulator::Schedule and Simulator::ScheduleWithContext.
+   *
+   * When MemoryAccounting is enabled, its counters are printed to
+   * std::clog before the destroy events are executed.
    */
   static void Destroy (void);
 
@@ -144,6 +148,9 @@ public:
    *   - The user called Simulator::Stop with a stop time and the
    *     expiration time of the next event to be processed
    *     is greater than or equal to the stop time.
+   *
+   * When the \c ProgressInterval global value is positive, the
+   * progress of the simulation is reported by a ProgressMonitor.
    */
   static void Run (void);
 
@@ -1115,6 +1122,24 @@ public:
    */
   static uint32_t GetContext (void);
 
+  /**
+   * Get the number of events executed.
+   *
+   * @return The number of events executed since the simulator was
+   *          created, not counting the events run by Destroy().
+   */
+  static uint64_t GetEventCount (void);
+
+  /**
+   * Get the number of events in the event list.
+   *
+   * @return The number of events scheduled and not yet executed,
+   *          including the cancelled ones which are still in the
+   *          event list, and not counting the events scheduled with
+   *          ScheduleDestroy().
+   */
+  static uint64_t GetPendingEventCount (void);
+
   /**
    * Schedule a future event execution (in the same context).
    *
@@ -1135,6 +1160,18 @@ public:
    */
   static void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
 
+  /**
+   * Schedule all the events of a batch, each in its own context.
+   * This method is thread-safe: it can be called from any thread.
+   *
+   * The events are inserted in the event list in one operation, and
+   * run as if they were scheduled one at a time, in the order of the
+   * batch.  The batch is left empty.
+   *
+   * @param [in,out] batch The events to schedule.
+   */
+  static void ScheduleWithContext (EventBatch &batch);
+
   /**
    * Schedule an event to run at the end of the simulation, after
    * the Stop() time or condition has been reached.
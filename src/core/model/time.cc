@@ -23,8 +23,10 @@
 #include "abort.h"
 #include "system-mutex.h"
 #include "log.h"
+#include <algorithm>  // min
 #include <cmath>
 #include <iomanip>  // showpos
+#include <limits>
 #include <sstream>
 
 /**
@@ -222,6 +224,12 @@ Time::SetResolution (enum Unit unit, struct Resolution *resolution,
       NS_LOG_DEBUG ("SetResolution factor " << factor << " real factor " << realFactor);
       struct Information *info = &resolution->info[i];
       info->factor = factor;
+      // Integer fast path limits: the product by factor must not overflow,
+      // and From values must be exactly representable as doubles (2^53).
+      const int64_t maxInt = std::numeric_limits<int64_t>::max ();
+      info->toIntegerLimit = maxInt / factor;
+      info->fromIntegerLimit = std::min (static_cast<double> (maxInt / factor),
+                                         9007199254740992.0);
       // here we could equivalently check for realFactor == 1.0 but it's better
       // to avoid checking equality of doubles
       if (shift == 0 && quotient == 1)
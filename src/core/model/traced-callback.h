@@ -21,7 +21,7 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
 #include "callback.h"
 
 /**
@@ -30,6 +30,58 @@
  * ns3::TracedCallback declaration and template implementation.
  */
 
+/**
+ * \ingroup tracing
+ * Fire a TracedCallback, evaluating the arguments only if
+ * a Callback is connected.
+ *
+ * \code
+ *   NS_TRACE (m_macTxTrace, (packet));
+ * \endcode
+ * is equivalent to <tt>m_macTxTrace (packet)</tt>, but on an
+ * unconnected trace source it does not build the arguments at all,
+ * not even the Ptr copies needed to pass them by value.
+ *
+ * \param [in] source The TracedCallback to fire.
+ * \param [in] args The parenthesized list of arguments.
+ */
+#define NS_TRACE(source, args)                  \
+  do                                            \
+    {                                           \
+      if (!(source).IsEmpty ())                 \
+        {                                       \
+          (source) args;                        \
+        }                                       \
+    }                                           \
+  while (false)
+
+/**
+ * \ingroup tracing
+ * Fire a TracedCallback as NS_TRACE() does, unless \c NS3_TRACING_DISABLE
+ * is defined.
+ *
+ * \c NS3_TRACING_DISABLE is defined for the whole build by the
+ * \c --disable-trace-sources configure option, or by a compilation
+ * unit before it includes any ns-3 header.  The trace sources fired
+ * with this macro are then compiled out entirely, and never fire even
+ * when a Callback is connected to them.  Use it only for the
+ * per-packet trace sources which nothing in ns-3 depends on: the
+ * sources which feed the pcap and ascii traces of the helpers, the
+ * flow monitor or the visualizers must be fired with NS_TRACE().
+ *
+ * \param [in] source The TracedCallback to fire.
+ * \param [in] args The parenthesized list of arguments.
+ */
+#ifdef NS3_TRACING_DISABLE
+#define NS_TRACE_OPTIONAL(source, args)         \
+  do                                            \
+    {                                           \
+    }                                           \
+  while (false)
+#else
+#define NS_TRACE_OPTIONAL(source, args) NS_TRACE (source, args)
+#endif
+
 namespace ns3 {
 
 /**
@@ -46,6 +98,15 @@ namespace ns3 {
  * calling one of the \c operator() forms with the appropriate
  * number of arguments.
  *
+ * The first Callback of the chain is stored inline and the others,
+ * if any, in a contiguous array, so an unconnected TracedCallback
+ * costs two pointer tests and connecting one Callback allocates
+ * nothing beyond the Callback itself.  A Callback may connect or
+ * disconnect Callbacks while the chain is invoked: those disconnected
+ * are nulled in place, and the chain compacted once the outermost
+ * invocation returns, so the others are each called once, in order.  Use NS_TRACE() on per-packet
+ * paths to also skip evaluating the arguments when nothing is connected.
+ *
  * \tparam T1 \explicit Type of the first argument to the functor.
  * \tparam T2 \explicit Type of the second argument to the functor.
  * \tparam T3 \explicit Type of the third argument to the functor.
@@ -64,6 +125,27 @@ class TracedCallback
 public:
   /** Constructor. */
   TracedCallback ();
+  /**
+   * Copy constructor.
+   *
+   * \param [in] o The TracedCallback to copy.
+   */
+  TracedCallback (const TracedCallback &o);
+  /**
+   * Assignment operator.
+   *
+   * \param [in] o The TracedCallback to copy.
+   * \returns This TracedCallback.
+   */
+  TracedCallback & operator = (const TracedCallback &o);
+  /** Destructor. */
+  ~TracedCallback ();
+  /**
+   * Check if no Callback is connected.
+   *
+   * \returns \c true if the chain of Callbacks is empty.
+   */
+  bool IsEmpty (void) const;
   /**
    * Append a Callback to the chain (without a context).
    *
@@ -222,21 +304,39 @@ public:
 
   
 private:
+  /** The type of the Callbacks in the chain. */
+  typedef Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> CallbackType;
+  /** Container type for the Callbacks after the first one. */
+  typedef std::vector<CallbackType> CallbackVector;
+
   /**
-   * Container type for holding the chain of Callbacks.
+   * Append a Callback to the chain.
    *
-   * \tparam T1 \deduced Type of the first argument to the functor.
-   * \tparam T2 \deduced Type of the second argument to the functor.
-   * \tparam T3 \deduced Type of the third argument to the functor.
-   * \tparam T4 \deduced Type of the fourth argument to the functor.
-   * \tparam T5 \deduced Type of the fifth argument to the functor.
-   * \tparam T6 \deduced Type of the sixth argument to the functor.
-   * \tparam T7 \deduced Type of the seventh argument to the functor.
-   * \tparam T8 \deduced Type of the eighth argument to the functor.
+   * \param [in] cb The Callback to append.
    */
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
-  /** The chain of Callbacks. */
-  CallbackList m_callbackList;
+  void Append (const CallbackType & cb);
+  /**
+   * Rebuild the chain without the null Callbacks and those equal
+   * to a Callback.
+   *
+   * \param [in] callback The Callback to remove, or 0 to only remove
+   *            the null Callbacks.
+   */
+  void Compact (const CallbackBase *callback);
+  /**
+   * End an invocation of the chain, compacting it if it was the
+   * outermost one and Callbacks were disconnected meanwhile.
+   */
+  void EndInvoke (void) const;
+
+  /** The first Callback of the chain, null if the chain is empty. */
+  CallbackType m_first;
+  /** The rest of the chain, allocated when a second Callback is connected. */
+  CallbackVector *m_more;
+  /** The number of invocations of the chain in progress. */
+  mutable uint32_t m_invoking;
+  /** Whether Callbacks were nulled in place during an invocation. */
+  bool m_nulled;
 };
 
 } // namespace ns3
@@ -253,8 +353,102 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_first (),
+    m_more (0),
+    m_invoking (0),
+    m_nulled (false)
+{
+}
+
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback (const TracedCallback &o)
+  : m_first (o.m_first),
+    m_more (0),
+    m_invoking (0),
+    m_nulled (false)
+{
+  if (o.m_more != 0)
+    {
+      m_more = new CallbackVector (*o.m_more);
+    }
+  if (o.m_nulled)
+    {
+      Compact (0);
+    }
+}
+
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8> &
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator = (const TracedCallback &o)
+{
+  if (this != &o)
+    {
+      m_first = o.m_first;
+      delete m_more;
+      m_more = 0;
+      if (o.m_more != 0)
+        {
+          m_more = new CallbackVector (*o.m_more);
+        }
+      m_nulled = o.m_nulled;
+      if (m_nulled && m_invoking == 0)
+        {
+          Compact (0);
+        }
+    }
+  return *this;
+}
+
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::~TracedCallback ()
+{
+  delete m_more;
+  m_more = 0;
+}
+
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+  return m_first.IsNull () && m_more == 0;
+}
+
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Append (const CallbackType & cb)
 {
+  if (cb.IsNull ())
+    {
+      // Nothing to call: a null Callback is never part of the chain.
+      return;
+    }
+  if (m_first.IsNull () && m_more == 0)
+    {
+      m_first = cb;
+    }
+  else
+    {
+      if (m_more == 0)
+        {
+          m_more = new CallbackVector ();
+        }
+      m_more->push_back (cb);
+    }
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -266,7 +460,7 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBa
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   if (!cb.Assign (callback))
     NS_FATAL_ERROR_NO_MSG();
-  m_callbackList.push_back (cb);
+  Append (cb);
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -279,7 +473,7 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback,
   if (!cb.Assign (callback))
     NS_FATAL_ERROR ("when connecting to " << path);
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
-  m_callbackList.push_back (realCb);
+  Append (realCb);
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -288,18 +482,79 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const CallbackBase & callback)
 {
-  for (typename CallbackList::iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); /* empty */)
+  if (m_invoking == 0)
     {
-      if ((*i).IsEqual (callback))
+      Compact (&callback);
+      return;
+    }
+  // The chain is being invoked: null the Callbacks in place, so that
+  // the invocation goes on with the next ones.
+  if (!m_first.IsNull () && m_first.IsEqual (callback))
+    {
+      m_first = CallbackType ();
+      m_nulled = true;
+    }
+  if (m_more != 0)
+    {
+      for (typename CallbackVector::iterator i = m_more->begin ();
+           i != m_more->end (); i++)
         {
-          i = m_callbackList.erase (i);
+          if (!(*i).IsNull () && (*i).IsEqual (callback))
+            {
+              *i = CallbackType ();
+              m_nulled = true;
+            }
         }
-      else
+    }
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Compact (const CallbackBase *callback)
+{
+  // Rebuild the chain from the Callbacks to keep, in order.
+  CallbackVector kept;
+  if (!m_first.IsNull () && (callback == 0 || !m_first.IsEqual (*callback)))
+    {
+      kept.push_back (m_first);
+    }
+  if (m_more != 0)
+    {
+      for (typename CallbackVector::const_iterator i = m_more->begin ();
+           i != m_more->end (); i++)
         {
-          i++;
+          if (!(*i).IsNull () && (callback == 0 || !(*i).IsEqual (*callback)))
+            {
+              kept.push_back (*i);
+            }
         }
     }
+  m_first = CallbackType ();
+  delete m_more;
+  m_more = 0;
+  m_nulled = false;
+  for (typename CallbackVector::const_iterator i = kept.begin ();
+       i != kept.end (); i++)
+    {
+      Append (*i);
+    }
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::EndInvoke (void) const
+{
+  m_invoking--;
+  if (m_invoking == 0 && m_nulled)
+    {
+      // The chain is only logically const: compacting it leaves the
+      // same Callbacks to invoke.
+      const_cast<TracedCallback *> (this)->Compact (0);
+    }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -318,118 +573,226 @@ template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (IsEmpty ())
+    {
+      return;
+    }
+  m_invoking++;
+  const CallbackType *cb = &m_first;
+  std::size_t i = 0;
+  while (cb != 0)
     {
-      (*i)();
+      if (!cb->IsNull ())
+        {
+          (*cb)();
+        }
+      // Index the rest of the chain, so a Callback may connect another one.
+      cb = (m_more != 0 && i < m_more->size ()) ? &(*m_more)[i++] : 0;
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (IsEmpty ())
+    {
+      return;
+    }
+  m_invoking++;
+  const CallbackType *cb = &m_first;
+  std::size_t i = 0;
+  while (cb != 0)
     {
-      (*i)(a1);
+      if (!cb->IsNull ())
+        {
+          (*cb)(a1);
+        }
+      // Index the rest of the chain, so a Callback may connect another one.
+      cb = (m_more != 0 && i < m_more->size ()) ? &(*m_more)[i++] : 0;
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (IsEmpty ())
+    {
+      return;
+    }
+  m_invoking++;
+  const CallbackType *cb = &m_first;
+  std::size_t i = 0;
+  while (cb != 0)
     {
-      (*i)(a1, a2);
+      if (!cb->IsNull ())
+        {
+          (*cb)(a1, a2);
+        }
+      // Index the rest of the chain, so a Callback may connect another one.
+      cb = (m_more != 0 && i < m_more->size ()) ? &(*m_more)[i++] : 0;
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (IsEmpty ())
+    {
+      return;
+    }
+  m_invoking++;
+  const CallbackType *cb = &m_first;
+  std::size_t i = 0;
+  while (cb != 0)
     {
-      (*i)(a1, a2, a3);
+      if (!cb->IsNull ())
+        {
+          (*cb)(a1, a2, a3);
+        }
+      // Index the rest of the chain, so a Callback may connect another one.
+      cb = (m_more != 0 && i < m_more->size ()) ? &(*m_more)[i++] : 0;
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (IsEmpty ())
+    {
+      return;
+    }
+  m_invoking++;
+  const CallbackType *cb = &m_first;
+  std::size_t i = 0;
+  while (cb != 0)
     {
-      (*i)(a1, a2, a3, a4);
+      if (!cb->IsNull ())
+        {
+          (*cb)(a1, a2, a3, a4);
+        }
+      // Index the rest of the chain, so a Callback may connect another one.
+      cb = (m_more != 0 && i < m_more->size ()) ? &(*m_more)[i++] : 0;
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (IsEmpty ())
+    {
+      return;
+    }
+  m_invoking++;
+  const CallbackType *cb = &m_first;
+  std::size_t i = 0;
+  while (cb != 0)
     {
-      (*i)(a1, a2, a3, a4, a5);
+      if (!cb->IsNull ())
+        {
+          (*cb)(a1, a2, a3, a4, a5);
+        }
+      // Index the rest of the chain, so a Callback may connect another one.
+      cb = (m_more != 0 && i < m_more->size ()) ? &(*m_more)[i++] : 0;
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (IsEmpty ())
+    {
+      return;
+    }
+  m_invoking++;
+  const CallbackType *cb = &m_first;
+  std::size_t i = 0;
+  while (cb != 0)
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      if (!cb->IsNull ())
+        {
+          (*cb)(a1, a2, a3, a4, a5, a6);
+        }
+      // Index the rest of the chain, so a Callback may connect another one.
+      cb = (m_more != 0 && i < m_more->size ()) ? &(*m_more)[i++] : 0;
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (IsEmpty ())
+    {
+      return;
+    }
+  m_invoking++;
+  const CallbackType *cb = &m_first;
+  std::size_t i = 0;
+  while (cb != 0)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      if (!cb->IsNull ())
+        {
+          (*cb)(a1, a2, a3, a4, a5, a6, a7);
+        }
+      // Index the rest of the chain, so a Callback may connect another one.
+      cb = (m_more != 0 && i < m_more->size ()) ? &(*m_more)[i++] : 0;
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (IsEmpty ())
+    {
+      return;
+    }
+  m_invoking++;
+  const CallbackType *cb = &m_first;
+  std::size_t i = 0;
+  while (cb != 0)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      if (!cb->IsNull ())
+        {
+          (*cb)(a1, a2, a3, a4, a5, a6, a7, a8);
+        }
+      // Index the rest of the chain, so a Callback may connect another one.
+      cb = (m_more != 0 && i < m_more->size ()) ? &(*m_more)[i++] : 0;
     }
+  EndInvoke ();
 }
 
 } // namespace ns3
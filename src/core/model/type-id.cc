@@ -53,6 +53,12 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
  * Information records are stored in a vector.  Name and hash lookup
  * are performed by maps to the vector index.
  *
+ * The attributes and trace sources of a type and of its parents are
+ * also indexed by the hash of their name.  These indexes are only
+ * built when a type is first searched for an attribute or a trace
+ * source by name, and are rebuilt if attributes or trace sources
+ * were registered since.
+ *
  * \internal
  * <b>Hash Chaining</b>
  *
@@ -78,6 +84,8 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
 class IidManager : public Singleton<IidManager>
 {
 public:
+  /** Constructor. */
+  IidManager ();
   /**
    * Create a new unique type id.
    * \param [in] name The name of this type id.
@@ -172,6 +180,12 @@ public:
    * \returns The total number.
    */
   uint32_t GetRegisteredN (void) const;
+  /**
+   * Get the attribute generation.
+   * \returns The number of changes to the attributes, their initial
+   *          values and the type id parents.
+   */
+  uint32_t GetAttributeGeneration (void) const;
   /**
    * Get a type id by index.
    *
@@ -263,6 +277,23 @@ public:
    */
   bool MustHideFromDocumentation (uint16_t uid) const;
 
+  /**
+   * Find an attribute by name in a type id and its parents.
+   * \param [in] uid The id.
+   * \param [in] name The attribute name.
+   * \param [out] info The attribute information, if found.
+   * \returns \c true if the attribute was found.
+   */
+  bool LookupAttribute (uint16_t uid, std::string name,
+                        struct TypeId::AttributeInformation *info);
+  /**
+   * Find a trace source by name in a type id and its parents.
+   * \param [in] uid The id.
+   * \param [in] name The trace source name.
+   * \returns The trace source accessor, or 0 if not found.
+   */
+  Ptr<const TraceSourceAccessor> LookupTraceSource (uint16_t uid, std::string name);
+
 private:
   /**
    * Check if a type id has a given TraceSource.
@@ -283,8 +314,15 @@ private:
    * \param [in] name The type id name.
    * \returns The hashed value of \p name.
    */
-  static TypeId::hash_t Hasher (const std::string name);
+  static TypeId::hash_t Hasher (const std::string &name);
 
+  /**
+   * Type of the by-name index of the attributes or the trace sources
+   * of a type id and its parents.  The name hash maps to the type id
+   * and the index of the attribute or trace source in that type id,
+   * or to type id 0 if several names have this hash.
+   */
+  typedef std::map<TypeId::hash_t, std::pair<uint16_t, uint32_t> > memberindex_t;
   /** The information record about a single type id. */
   struct IidInformation {
     /** The type id name. */
@@ -307,6 +345,12 @@ private:
     std::vector<struct TypeId::AttributeInformation> attributes;
     /** The container of TraceSources. */
     std::vector<struct TypeId::TraceSourceInformation> traceSources;
+    /** The attributes of this type id and its parents, by name hash. */
+    memberindex_t attributeIndex;
+    /** The trace sources of this type id and its parents, by name hash. */
+    memberindex_t traceSourceIndex;
+    /** The value of m_generation when the indexes were built, or 0. */
+    uint32_t indexGeneration;
   };
   /** Iterator type. */
   typedef std::vector<struct IidInformation>::const_iterator Iterator;
@@ -317,6 +361,14 @@ private:
    * \returns The information record.
    */
   struct IidManager::IidInformation *LookupInformation (uint16_t uid) const;
+  /**
+   * Retrieve the information record for a type, after building its
+   * attribute and trace source indexes if they are missing or out
+   * of date.
+   * \param [in] uid The id.
+   * \returns The information record.
+   */
+  struct IidManager::IidInformation *LookupIndexedInformation (uint16_t uid);
 
   /** The container of all type id records. */
   std::vector<struct IidInformation> m_information;
@@ -331,6 +383,17 @@ private:
   /** The by-hash index. */
   hashmap_t m_hashmap;
 
+  /**
+   * Incremented whenever the parent, attributes or trace sources of
+   * a type id change, to invalidate the attribute and trace source
+   * indexes.
+   */
+  uint32_t m_generation;
+  /**
+   * Incremented with m_generation, and whenever the initial value of
+   * an attribute changes, to invalidate the cached construction values.
+   */
+  uint32_t m_attributeGeneration;
 
   enum {
     /**
@@ -344,12 +407,19 @@ private:
 };
 
 
+IidManager::IidManager ()
+  : m_generation (1),
+    m_attributeGeneration (1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
 //static
 TypeId::hash_t
-IidManager::Hasher (const std::string name)
+IidManager::Hasher (const std::string &name)
 {
   static ns3::Hasher hasher ( Create<Hash::Function::Murmur3> () );
-  return hasher.clear ().GetHash32 (name);
+  return hasher.clear ().GetHash32 (name.c_str (), name.size ());
 }
   
 uint16_t
@@ -413,6 +483,7 @@ IidManager::AllocateUid (std::string name)
   information.size = (std::size_t)(-1);
   information.hasConstructor = false;
   information.mustHideFromDocumentation = false;
+  information.indexGeneration = 0;
   m_information.push_back (information);
   uint32_t uid = m_information.size ();
   NS_ASSERT (uid <= 0xffff);
@@ -438,6 +509,8 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
   information->parent = parent;
+  m_generation++;
+  m_attributeGeneration++;
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -563,6 +636,12 @@ IidManager::GetRegisteredN (void) const
   NS_LOG_FUNCTION (this);
   return m_information.size ();
 }
+uint32_t
+IidManager::GetAttributeGeneration (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_attributeGeneration;
+}
 uint16_t 
 IidManager::GetRegistered (uint32_t i) const
 {
@@ -623,6 +702,8 @@ IidManager::AddAttribute (uint16_t uid,
   info.accessor = accessor;
   info.checker = checker;
   information->attributes.push_back (info);
+  m_generation++;
+  m_attributeGeneration++;
 }
 void 
 IidManager::SetAttributeInitialValue(uint16_t uid,
@@ -633,6 +714,7 @@ IidManager::SetAttributeInitialValue(uint16_t uid,
   struct IidInformation *information = LookupInformation (uid);
   NS_ASSERT (i < information->attributes.size ());
   information->attributes[i].initialValue = initialValue;
+  m_attributeGeneration++;
 }
 
 
@@ -701,6 +783,7 @@ IidManager::AddTraceSource (uint16_t uid,
   source.accessor = accessor;
   source.callback = callback;
   information->traceSources.push_back (source);
+  m_generation++;
 }
 uint32_t 
 IidManager::GetTraceSourceN (uint16_t uid) const
@@ -717,6 +800,136 @@ IidManager::GetTraceSource(uint16_t uid, uint32_t i) const
   NS_ASSERT (i < information->traceSources.size ());
   return information->traceSources[i];
 }
+
+struct IidManager::IidInformation *
+IidManager::LookupIndexedInformation (uint16_t uid)
+{
+  NS_LOG_FUNCTION (this << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  if (information->indexGeneration == m_generation)
+    {
+      return information;
+    }
+  information->attributeIndex.clear ();
+  information->traceSourceIndex.clear ();
+  while (true)
+    {
+      struct IidInformation *current = LookupInformation (uid);
+      for (uint32_t i = 0; i < current->attributes.size (); i++)
+        {
+          TypeId::hash_t hash = Hasher (current->attributes[i].name);
+          std::pair<memberindex_t::iterator, bool> inserted =
+            information->attributeIndex.insert (std::make_pair (hash, std::make_pair (uid, i)));
+          if (!inserted.second)
+            {
+              // Hash collision: fall back to a search by name
+              inserted.first->second.first = 0;
+            }
+        }
+      for (uint32_t i = 0; i < current->traceSources.size (); i++)
+        {
+          TypeId::hash_t hash = Hasher (current->traceSources[i].name);
+          std::pair<memberindex_t::iterator, bool> inserted =
+            information->traceSourceIndex.insert (std::make_pair (hash, std::make_pair (uid, i)));
+          if (!inserted.second)
+            {
+              inserted.first->second.first = 0;
+            }
+        }
+      if (current->parent == uid)
+        {
+          // top of inheritance tree
+          break;
+        }
+      uid = current->parent;
+    }
+  information->indexGeneration = m_generation;
+  return information;
+}
+
+bool
+IidManager::LookupAttribute (uint16_t uid, std::string name,
+                             struct TypeId::AttributeInformation *info)
+{
+  NS_LOG_FUNCTION (this << uid << name << info);
+  struct IidInformation *information = LookupIndexedInformation (uid);
+  memberindex_t::const_iterator it = information->attributeIndex.find (Hasher (name));
+  if (it == information->attributeIndex.end ())
+    {
+      return false;
+    }
+  if (it->second.first != 0)
+    {
+      const struct TypeId::AttributeInformation &found =
+        LookupInformation (it->second.first)->attributes[it->second.second];
+      if (found.name != name)
+        {
+          return false;
+        }
+      *info = found;
+      return true;
+    }
+  // Several names with this hash
+  while (true)
+    {
+      for (std::vector<struct TypeId::AttributeInformation>::const_iterator i = information->attributes.begin ();
+           i != information->attributes.end (); ++i)
+        {
+          if (i->name == name)
+            {
+              *info = *i;
+              return true;
+            }
+        }
+      struct IidInformation *parent = LookupInformation (information->parent);
+      if (parent == information)
+        {
+          return false;
+        }
+      information = parent;
+    }
+}
+
+Ptr<const TraceSourceAccessor>
+IidManager::LookupTraceSource (uint16_t uid, std::string name)
+{
+  NS_LOG_FUNCTION (this << uid << name);
+  struct IidInformation *information = LookupIndexedInformation (uid);
+  memberindex_t::const_iterator it = information->traceSourceIndex.find (Hasher (name));
+  if (it == information->traceSourceIndex.end ())
+    {
+      return 0;
+    }
+  if (it->second.first != 0)
+    {
+      const struct TypeId::TraceSourceInformation &found =
+        LookupInformation (it->second.first)->traceSources[it->second.second];
+      if (found.name != name)
+        {
+          return 0;
+        }
+      return found.accessor;
+    }
+  // Several names with this hash
+  while (true)
+    {
+      for (std::vector<struct TypeId::TraceSourceInformation>::const_iterator i = information->traceSources.begin ();
+           i != information->traceSources.end (); ++i)
+        {
+          if (i->name == name)
+            {
+              return i->accessor;
+            }
+        }
+      struct IidInformation *parent = LookupInformation (information->parent);
+      if (parent == information)
+        {
+          return 0;
+        }
+      information = parent;
+    }
+}
+
 bool 
 IidManager::MustHideFromDocumentation (uint16_t uid) const
 {
@@ -793,6 +1006,12 @@ TypeId::GetRegisteredN (void)
   NS_LOG_FUNCTION_NOARGS ();
   return IidManager::Get ()->GetRegisteredN ();
 }
+uint32_t
+TypeId::GetAttributeGeneration (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return IidManager::Get ()->GetAttributeGeneration ();
+}
 TypeId 
 TypeId::GetRegistered (uint32_t i)
 {
@@ -804,22 +1023,7 @@ bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute(i);
-          if (tmp.name == name)
-            {
-              *info = tmp;
-              return true;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return false;
+  return IidManager::Get ()->LookupAttribute (m_tid, name, info);
 }
 
 TypeId 
@@ -1030,21 +1234,7 @@ Ptr<const TraceSourceAccessor>
 TypeId::LookupTraceSourceByName (std::string name) const
 {
   NS_LOG_FUNCTION (this << name);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetTraceSourceN (); i++)
-        {
-          struct TypeId::TraceSourceInformation info = tid.GetTraceSource (i);
-          if (info.name == name)
-            {
-              return info.accessor;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return 0;
+  return IidManager::Get ()->LookupTraceSource (m_tid, name);
 }
 
 uint16_t 
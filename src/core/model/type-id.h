@@ -142,6 +142,18 @@ public:
    * \returns The number of TypeId instances registered.
    */
   static uint32_t GetRegisteredN (void);
+  /**
+   * Get the attribute generation.
+   *
+   * The generation changes whenever an attribute is added to a
+   * TypeId, the initial value of an attribute is changed (by
+   * Config::SetDefault() for instance), or the parent of a TypeId is
+   * set, so that cached attribute values, like those of an
+   * AttributeBundle used by ObjectFactory, can be revalidated.
+   *
+   * \returns The attribute generation.
+   */
+  static uint32_t GetAttributeGeneration (void);
   /**
    * Get a TypeId by index.
    *
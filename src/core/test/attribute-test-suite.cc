@@ -33,7 +33,12 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/pointer.h"
 #include "ns3/object-factory.h"
+#include "ns3/attribute-bundle.h"
 #include "ns3/nstime.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_STDLIB_H
+#include <cstdlib>
+#endif
 
 using namespace ns3;
 
@@ -1399,6 +1404,164 @@ CallbackValueTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_gotCbValue, 2, "Callback Attribute set to null callback unexpectedly fired");
 }
 
+// ===========================================================================
+// Test the pre-parsed attribute values of AttributeBundle and ObjectFactory.
+// ===========================================================================
+class AttributeBundleTestCase : public TestCase
+{
+public:
+  AttributeBundleTestCase (std::string description);
+  virtual ~AttributeBundleTestCase () {}
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+AttributeBundleTestCase::AttributeBundleTestCase (std::string description)
+  : TestCase (description)
+{
+}
+
+void
+AttributeBundleTestCase::DoTeardown (void)
+{
+  Config::Reset ();
+}
+
+void
+AttributeBundleTestCase::DoRun (void)
+{
+  IntegerValue integer;
+  DoubleValue real;
+  PointerValue first;
+  PointerValue second;
+
+  //
+  // The values set on a factory are parsed once, but the objects
+  // created from strings are created for each object.
+  //
+  ObjectFactory factory;
+  factory.SetTypeId (AttributeObjectTest::GetTypeId ());
+  factory.Set ("TestInt16", StringValue ("3"));
+  factory.Set ("TestRandom", StringValue ("ns3::UniformRandomVariable[Min=0.|Max=1.]"));
+  Ptr<AttributeObjectTest> p = factory.Create<AttributeObjectTest> ();
+  Ptr<AttributeObjectTest> q = factory.Create<AttributeObjectTest> ();
+  p->GetAttribute ("TestInt16", integer);
+  NS_TEST_ASSERT_MSG_EQ (integer.Get (), 3, "Factory value not set");
+  q->GetAttribute ("TestInt16", integer);
+  NS_TEST_ASSERT_MSG_EQ (integer.Get (), 3, "Factory value not set on the second object");
+  p->GetAttribute ("TestRandom", first);
+  q->GetAttribute ("TestRandom", second);
+  NS_TEST_ASSERT_MSG_NE (first.GetObject (), 0, "Random variable not created");
+  NS_TEST_ASSERT_MSG_NE (first.GetObject (), second.GetObject (), "Random variable shared by two objects");
+  p->GetAttribute ("PointerInitialized", first);
+  q->GetAttribute ("PointerInitialized", second);
+  NS_TEST_ASSERT_MSG_NE (first.GetObject (), second.GetObject (), "Initial object shared by two objects");
+  q->GetAttribute ("TestInt16SetGet", integer);
+  NS_TEST_ASSERT_MSG_EQ (integer.Get (), 6, "Initial value not set through the setter");
+
+  //
+  // Changing an initial value is seen by the next object created.
+  //
+  Config::SetDefault ("ns3::AttributeObjectTest::TestFloat", DoubleValue (2.5));
+  p = factory.Create<AttributeObjectTest> ();
+  p->GetAttribute ("TestFloat", real);
+  NS_TEST_ASSERT_MSG_EQ (real.Get (), 2.5, "New initial value not used by the factory");
+  factory.Set ("TestFloat", DoubleValue (4.5));
+  p = factory.Create<AttributeObjectTest> ();
+  p->GetAttribute ("TestFloat", real);
+  NS_TEST_ASSERT_MSG_EQ (real.Get (), 4.5, "New factory value not used");
+
+  //
+  // A bundle sets its values on existing objects.
+  //
+  AttributeBundle bundle (AttributeObjectTest::GetTypeId ());
+  bundle.Set ("TestInt16WithBounds", StringValue ("7"));
+  bundle.Set ("TestBoolA", BooleanValue (true));
+  bundle.Set ("TestInt16WithBounds", IntegerValue (8));
+  NS_TEST_ASSERT_MSG_EQ (bundle.GetN (), 2, "Value not replaced");
+  NS_TEST_ASSERT_MSG_EQ (bundle.SetFailSafe ("TestInt16WithBounds", IntegerValue (20)), false,
+                         "Value out of bounds accepted");
+  NS_TEST_ASSERT_MSG_EQ (bundle.SetFailSafe ("NoSuchAttribute", IntegerValue (1)), false,
+                         "Unknown attribute accepted");
+  NS_TEST_ASSERT_MSG_EQ (bundle.GetN (), 2, "Invalid value added");
+
+  std::vector<Ptr<AttributeObjectTest> > objects;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      objects.push_back (CreateObject<AttributeObjectTest> ());
+    }
+  bundle.Apply (objects.begin (), objects.end ());
+  for (uint32_t i = 0; i < objects.size (); i++)
+    {
+      BooleanValue boolean;
+      objects[i]->GetAttribute ("TestInt16WithBounds", integer);
+      NS_TEST_ASSERT_MSG_EQ (integer.Get (), 8, "Bundle value not set on object " << i);
+      objects[i]->GetAttribute ("TestBoolA", boolean);
+      NS_TEST_ASSERT_MSG_EQ (boolean.Get (), true, "Bundle value not set on object " << i);
+    }
+
+  bundle.Clear ();
+  bundle.Set ("TestRandom", StringValue ("ns3::ConstantRandomVariable[Constant=2.0]"));
+  bundle.Apply (objects[0]);
+  bundle.Apply (objects[1]);
+  objects[0]->GetAttribute ("TestRandom", first);
+  objects[1]->GetAttribute ("TestRandom", second);
+  NS_TEST_ASSERT_MSG_NE (first.GetObject (), second.GetObject (), "Random variable shared by two objects");
+
+  //
+  // The object an initial value points to is shared, by the first
+  // object a factory creates as by the next ones.
+  //
+  Ptr<Derived> initial = CreateObject<Derived> ();
+  Config::SetDefault ("ns3::AttributeObjectTest::Pointer", PointerValue (initial));
+  ObjectFactory shared;
+  shared.SetTypeId (AttributeObjectTest::GetTypeId ());
+  p = shared.Create<AttributeObjectTest> ();
+  q = shared.Create<AttributeObjectTest> ();
+  p->GetAttribute ("Pointer", first);
+  q->GetAttribute ("Pointer", second);
+  NS_TEST_ASSERT_MSG_EQ (first.GetObject (), initial, "Initial object not set on the first object");
+  NS_TEST_ASSERT_MSG_EQ (second.GetObject (), first.GetObject (),
+                         "First and second objects of a factory constructed differently");
+  p = CreateObject<AttributeObjectTest> ();
+  p->GetAttribute ("Pointer", first);
+  NS_TEST_ASSERT_MSG_EQ (first.GetObject (), second.GetObject (),
+                         "CreateObject and a reused factory constructed differently");
+  Config::SetDefault ("ns3::AttributeObjectTest::Pointer", PointerValue ());
+
+#ifdef HAVE_GETENV
+  //
+  // A change of the environment variable is seen by the next object
+  // created.
+  //
+  char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+  std::string saved = envVar != 0 ? std::string (envVar) : std::string ();
+  setenv ("NS_ATTRIBUTE_DEFAULT", "ns3::AttributeObjectTest::TestInt16=11", 1);
+  p = factory.Create<AttributeObjectTest> ();
+  p->GetAttribute ("TestInt16", integer);
+  NS_TEST_ASSERT_MSG_EQ (integer.Get (), 3, "Environment value used instead of the factory value");
+  p->GetAttribute ("TestInt16WithBounds", integer);
+  NS_TEST_ASSERT_MSG_EQ (integer.Get (), -2, "Unexpected initial value");
+  setenv ("NS_ATTRIBUTE_DEFAULT", "ns3::AttributeObjectTest::TestInt16WithBounds=4", 1);
+  p = factory.Create<AttributeObjectTest> ();
+  p->GetAttribute ("TestInt16WithBounds", integer);
+  NS_TEST_ASSERT_MSG_EQ (integer.Get (), 4, "New environment value not used by the factory");
+  if (envVar != 0)
+    {
+      setenv ("NS_ATTRIBUTE_DEFAULT", saved.c_str (), 1);
+    }
+  else
+    {
+      unsetenv ("NS_ATTRIBUTE_DEFAULT");
+    }
+  p = factory.Create<AttributeObjectTest> ();
+  p->GetAttribute ("TestInt16WithBounds", integer);
+  NS_TEST_ASSERT_MSG_EQ (integer.Get (), -2, "Environment value used after it was removed");
+#endif /* HAVE_GETENV */
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -1425,6 +1588,7 @@ AttributesTestSuite::AttributesTestSuite ()
   AddTestCase (new IntegerTraceSourceAttributeTestCase ("Ensure TracedValue<uint8_t> can be set like IntegerValue"), TestCase::QUICK);
   AddTestCase (new IntegerTraceSourceTestCase ("Ensure TracedValue<uint8_t> also works as trace source"), TestCase::QUICK);
   AddTestCase (new TracedCallbackTestCase ("Ensure TracedCallback<double, int, float> works as trace source"), TestCase::QUICK);
+  AddTestCase (new AttributeBundleTestCase ("Check AttributeBundle and the values cached by ObjectFactory"), TestCase::QUICK);
 }
 
 static AttributesTestSuite attributesTestSuite;
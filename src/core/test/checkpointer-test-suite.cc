@@ -0,0 +1,496 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/checkpointer.h"
+#include "ns3/make-event.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+namespace {
+
+/** A value drawn by a CheckpointerTestModel. */
+struct Draw
+{
+  uint32_t model;  //!< The model which drew it.
+  uint32_t count;  //!< The number of the draw in the model.
+  int64_t ts;      //!< The time of the draw.
+  uint32_t uid;    //!< The unique id of the event which drew it.
+  double value;    //!< The value drawn.
+};
+
+/**
+ * Compare two draws.
+ * @param [in] a The first draw.
+ * @param [in] b The second draw.
+ * @returns @c true if they are identical.
+ */
+bool
+operator == (const Draw &a, const Draw &b)
+{
+  return a.model == b.model && a.count == b.count && a.ts == b.ts
+         && a.uid == b.uid && a.value == b.value;
+}
+
+/**
+ * A model which draws normal values at random times, cancels and
+ * reschedules a timeout, and saves its state in the checkpoints.
+ * Two models draw at the same times often, so that the order of their
+ * events depends on their unique ids.
+ */
+class CheckpointerTestModel : public Checkpointable
+{
+public:
+  /**
+   * Constructor.
+   * @param [in] id The id of the model.
+   * @param [in] draws The draws of all the models.
+   */
+  CheckpointerTestModel (uint32_t id, std::vector<Draw> *draws);
+  /** Schedule the first draw. */
+  void Start (void);
+
+  // Inherited
+  virtual void SaveState (CheckpointWriter &writer) const;
+  virtual void RestoreState (CheckpointReader &reader);
+
+private:
+  /** Draw a value, and schedule the next draw and the timeout. */
+  void DoDraw (void);
+  /** Record a timeout. */
+  void Timeout (void);
+
+  uint32_t m_id;                          //!< The id of the model.
+  std::vector<Draw> *m_draws;             //!< The draws.
+  Ptr<UniformRandomVariable> m_delay;     //!< The delay of the draws.
+  Ptr<NormalRandomVariable> m_value;      //!< The values drawn.
+  uint32_t m_count;                       //!< The number of draws.
+  uint32_t m_timeouts;                    //!< The number of timeouts.
+  EventId m_draw;                         //!< The next draw.
+  EventId m_timeout;                      //!< The timeout.
+};
+
+CheckpointerTestModel::CheckpointerTestModel (uint32_t id, std::vector<Draw> *draws)
+  : m_id (id),
+    m_draws (draws),
+    m_delay (CreateObject<UniformRandomVariable> ()),
+    m_value (CreateObject<NormalRandomVariable> ()),
+    m_count (0),
+    m_timeouts (0)
+{
+}
+
+void
+CheckpointerTestModel::Start (void)
+{
+  m_draw = Simulator::Schedule (MilliSeconds (1), &CheckpointerTestModel::DoDraw, this);
+}
+
+void
+CheckpointerTestModel::DoDraw (void)
+{
+  Draw draw;
+  draw.model = m_id;
+  draw.count = m_count++;
+  draw.ts = Simulator::Now ().GetTimeStep ();
+  draw.uid = m_draw.GetUid ();
+  draw.value = m_value->GetValue ();
+  m_draws->push_back (draw);
+  m_draw = Simulator::Schedule (MilliSeconds (m_delay->GetInteger (1, 4)),
+                                &CheckpointerTestModel::DoDraw, this);
+  Simulator::Cancel (m_timeout);
+  m_timeout = Simulator::Schedule (MilliSeconds (3), &CheckpointerTestModel::Timeout, this);
+}
+
+void
+CheckpointerTestModel::Timeout (void)
+{
+  Draw draw;
+  draw.model = m_id + 100;
+  draw.count = m_timeouts++;
+  draw.ts = Simulator::Now ().GetTimeStep ();
+  draw.uid = m_timeout.GetUid ();
+  draw.value = 0;
+  m_draws->push_back (draw);
+}
+
+void
+CheckpointerTestModel::SaveState (CheckpointWriter &writer) const
+{
+  writer.WriteU32 (m_count);
+  writer.WriteU32 (m_timeouts);
+  writer.WriteEvent (m_draw);
+  writer.WriteEvent (m_timeout);
+}
+
+void
+CheckpointerTestModel::RestoreState (CheckpointReader &reader)
+{
+  m_count = reader.ReadU32 ();
+  m_timeouts = reader.ReadU32 ();
+  m_draw = reader.ReadEvent (MakeEvent (&CheckpointerTestModel::DoDraw, this));
+  m_timeout = reader.ReadEvent (MakeEvent (&CheckpointerTestModel::Timeout, this));
+}
+
+/** A model without state. */
+class CheckpointerEmptyModel : public Checkpointable
+{
+public:
+  // Inherited
+  virtual void SaveState (CheckpointWriter &writer) const
+  {
+  }
+  virtual void RestoreState (CheckpointReader &reader)
+  {
+  }
+};
+
+/**
+ * Check whether a file exists.
+ * @param [in] filename The file.
+ * @returns @c true if it exists.
+ */
+bool
+Exists (std::string filename)
+{
+  std::ifstream is (filename.c_str ());
+  return is.is_open ();
+}
+
+} // anonymous namespace
+
+
+/**
+ * Check that a restored checkpoint continues the simulation
+ * bit-exactly: same events, in the same order, with the same random
+ * numbers, as the original run.
+ */
+class CheckpointerRestoreTestCase : public TestCase
+{
+public:
+  CheckpointerRestoreTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Run the simulation, as a new process would.
+   * @param [in] load The checkpoint to restore, or empty to start
+   *             from the beginning.
+   * @param [out] draws The draws.
+   */
+  void RunSimulation (std::string load, std::vector<Draw> &draws);
+
+  /** The file the checkpoints are written to. */
+  std::string m_filename;
+  /** The next automatic stream when the test starts. */
+  uint64_t m_nextStream;
+  /** The number of events run by the simulation. */
+  uint64_t m_eventCount;
+  /** The time the checkpoint was restored at. */
+  Time m_restoredAt;
+};
+
+CheckpointerRestoreTestCase::CheckpointerRestoreTestCase ()
+  : TestCase ("Check that a restored checkpoint continues the simulation bit-exactly")
+{
+}
+
+void
+CheckpointerRestoreTestCase::RunSimulation (std::string load, std::vector<Draw> &draws)
+{
+  // The automatic streams of a new process.
+  RngSeedManager::SetNextStreamIndex (m_nextStream);
+  CheckpointerTestModel a (1, &draws);
+  CheckpointerTestModel b (2, &draws);
+  Ptr<Checkpointer> checkpointer = CreateObject<Checkpointer> ();
+  checkpointer->SetAttribute ("Interval", TimeValue (MilliSeconds (700)));
+  checkpointer->SetAttribute ("Filename", StringValue (m_filename));
+  checkpointer->AddModel ("a", &a);
+  checkpointer->AddModel ("b", &b);
+  a.Start ();
+  b.Start ();
+  if (load.empty ())
+    {
+      checkpointer->Start ();
+      checkpointer->SetStopTime (Seconds (2));
+    }
+  else
+    {
+      checkpointer->Load (load);
+      m_restoredAt = Simulator::Now ();
+    }
+  Simulator::Run ();
+  m_eventCount = Simulator::GetEventCount ();
+  checkpointer->Dispose ();
+  Simulator::Destroy ();
+}
+
+void
+CheckpointerRestoreTestCase::DoRun (void)
+{
+  m_filename = CreateTempDirFilename ("restore.ckpt");
+  m_nextStream = RngSeedManager::PeekNextStreamIndex ();
+
+  std::vector<Draw> original;
+  RunSimulation ("", original);
+  uint64_t originalEventCount = m_eventCount;
+  NS_TEST_ASSERT_MSG_EQ (Exists (m_filename), true, "No checkpoint written");
+  NS_TEST_ASSERT_MSG_EQ (Exists (m_filename + ".tmp"), false, "Temporary checkpoint left");
+
+  // The last checkpoint, at 1.4 s, is restored.
+  std::vector<Draw> restored;
+  RunSimulation (m_filename, restored);
+  NS_TEST_ASSERT_MSG_EQ (m_restoredAt, MilliSeconds (1400), "Wrong checkpoint restored");
+  NS_TEST_ASSERT_MSG_EQ (m_eventCount, originalEventCount, "Wrong number of events run");
+  NS_TEST_ASSERT_MSG_GT (restored.size (), 100, "Too few draws after the checkpoint");
+  NS_TEST_ASSERT_MSG_GT (original.size (), restored.size (), "No draws before the checkpoint");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (restored.front ().ts, MilliSeconds (1400).GetTimeStep (),
+                               "Draw before the checkpoint");
+
+  uint32_t offset = original.size () - restored.size ();
+  for (uint32_t i = 0; i < restored.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((restored[i] == original[offset + i]), true,
+                             "Draw " << i << " after the checkpoint differs");
+    }
+  std::remove (m_filename.c_str ());
+}
+
+
+/**
+ * Check that the periodic checkpoints go on in a restored simulation,
+ * and that a restored simulation can change its end.
+ */
+class CheckpointerPeriodicTestCase : public TestCase
+{
+public:
+  CheckpointerPeriodicTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+CheckpointerPeriodicTestCase::CheckpointerPeriodicTestCase ()
+  : TestCase ("Check that the periodic checkpoints go on after a restore")
+{
+}
+
+void
+CheckpointerPeriodicTestCase::DoRun (void)
+{
+  std::string first = CreateTempDirFilename ("first.ckpt");
+  std::string second = CreateTempDirFilename ("second.ckpt");
+
+  Ptr<Checkpointer> checkpointer = CreateObject<Checkpointer> ();
+  checkpointer->SetAttribute ("Interval", TimeValue (Seconds (1)));
+  checkpointer->SetAttribute ("Filename", StringValue (first));
+  checkpointer->Start ();
+  checkpointer->SetStopTime (Seconds (3.5));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (3.5), "Wrong end");
+  checkpointer->Dispose ();
+  Simulator::Destroy ();
+
+  checkpointer = CreateObject<Checkpointer> ();
+  checkpointer->SetAttribute ("Filename", StringValue (second));
+  checkpointer->Load (first);
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (3), "Wrong checkpoint restored");
+  checkpointer->SetStopTime (Seconds (4.5));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (4.5), "Wrong end after the restore");
+  checkpointer->Dispose ();
+  Simulator::Destroy ();
+
+  checkpointer = CreateObject<Checkpointer> ();
+  checkpointer->Load (second);
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (4), "No periodic checkpoint after the restore");
+  checkpointer->Dispose ();
+  Simulator::Destroy ();
+
+  std::remove (first.c_str ());
+  std::remove (second.c_str ());
+}
+
+
+/**
+ * Check that what can not be checkpointed is reported, with a fatal
+ * error which names it.
+ */
+class CheckpointerUnsupportedTestCase : public TestCase
+{
+public:
+  CheckpointerUnsupportedTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Run a checkpoint in a child, as it ends with a fatal error.
+   * @param [in] scenario The checkpoint to run.
+   * @returns The error output of the child if it was killed, or
+   *          "exited" if it exited.
+   */
+  std::string RunChild (void (*scenario)(std::string));
+
+  /** The checkpoint file. */
+  std::string m_filename;
+
+  /**
+   * Save with an unsupported reason.
+   * @param [in] filename The checkpoint file.
+   */
+  static void SaveUnsupported (std::string filename);
+  /**
+   * Save with an unsupported reason removed.
+   * @param [in] filename The checkpoint file.
+   */
+  static void SaveSupported (std::string filename);
+  /**
+   * Save with an event which no model saves.
+   * @param [in] filename The checkpoint file.
+   */
+  static void SaveUnsavedEvent (std::string filename);
+  /**
+   * Load with a model which is not in the checkpoint.
+   * @param [in] filename The checkpoint file.
+   */
+  static void LoadMissingModel (std::string filename);
+  /**
+   * Load a file which is not a checkpoint.
+   * @param [in] filename The checkpoint file.
+   */
+  static void LoadNotCheckpoint (std::string filename);
+};
+
+CheckpointerUnsupportedTestCase::CheckpointerUnsupportedTestCase ()
+  : TestCase ("Check that what can not be checkpointed is reported")
+{
+}
+
+std::string
+CheckpointerUnsupportedTestCase::RunChild (void (*scenario)(std::string))
+{
+  int fds[2];
+  if (pipe (fds) != 0)
+    {
+      return "no pipe";
+    }
+  pid_t pid = fork ();
+  if (pid == 0)
+    {
+      close (fds[0]);
+      dup2 (fds[1], STDERR_FILENO);
+      scenario (m_filename);
+      _exit (0);
+    }
+  close (fds[1]);
+  std::string output;
+  char buffer[256];
+  ssize_t n;
+  while ((n = read (fds[0], buffer, sizeof (buffer))) > 0)
+    {
+      output.append (buffer, n);
+    }
+  close (fds[0]);
+  int status = 0;
+  waitpid (pid, &status, 0);
+  return WIFSIGNALED (status) ? output : "exited";
+}
+
+void
+CheckpointerUnsupportedTestCase::SaveUnsupported (std::string filename)
+{
+  Checkpointer::AddUnsupported ("a test");
+  Checkpointer::AddUnsupported ("a test");
+  Checkpointer::RemoveUnsupported ("a test");
+  CreateObject<Checkpointer> ()->Save (filename);
+}
+
+void
+CheckpointerUnsupportedTestCase::SaveSupported (std::string filename)
+{
+  Checkpointer::AddUnsupported ("a test");
+  Checkpointer::RemoveUnsupported ("a test");
+  CreateObject<Checkpointer> ()->Save (filename);
+}
+
+void
+CheckpointerUnsupportedTestCase::SaveUnsavedEvent (std::string filename)
+{
+  Simulator::Schedule (Seconds (2), &Simulator::Stop);
+  CreateObject<Checkpointer> ()->Save (filename);
+}
+
+void
+CheckpointerUnsupportedTestCase::LoadMissingModel (std::string filename)
+{
+  CheckpointerEmptyModel model;
+  Ptr<Checkpointer> checkpointer = CreateObject<Checkpointer> ();
+  checkpointer->AddModel ("model", &model);
+  checkpointer->Load (filename);
+}
+
+void
+CheckpointerUnsupportedTestCase::LoadNotCheckpoint (std::string filename)
+{
+  std::ofstream os (filename.c_str ());
+  os << "not a checkpoint";
+  os.close ();
+  CreateObject<Checkpointer> ()->Load (filename);
+}
+
+void
+CheckpointerUnsupportedTestCase::DoRun (void)
+{
+  m_filename = CreateTempDirFilename ("unsupported.ckpt");
+  std::string output = RunChild (&SaveUnsupported);
+  NS_TEST_ASSERT_MSG_NE (output.find ("can not be checkpointed: a test"), std::string::npos,
+                         "Reason not reported: " << output);
+  output = RunChild (&SaveUnsavedEvent);
+  NS_TEST_ASSERT_MSG_NE (output.find ("1 pending events are not saved by any model, "
+                                      "the first at +2000000000.0ns"), std::string::npos,
+                         "Unsaved event not reported: " << output);
+  NS_TEST_ASSERT_MSG_EQ (RunChild (&SaveSupported), "exited", "Checkpoint refused");
+  output = RunChild (&LoadMissingModel);
+  NS_TEST_ASSERT_MSG_NE (output.find ("the model model is not in the checkpoint"), std::string::npos,
+                         "Missing model not reported: " << output);
+  output = RunChild (&LoadNotCheckpoint);
+  NS_TEST_ASSERT_MSG_NE (output.find ("is not a checkpoint"), std::string::npos,
+                         "Wrong file not reported: " << output);
+  std::remove (m_filename.c_str ());
+}
+
+
+static class CheckpointerTestSuite : public TestSuite
+{
+public:
+  CheckpointerTestSuite ()
+    : TestSuite ("checkpointer", UNIT)
+  {
+    AddTestCase (new CheckpointerRestoreTestCase (), TestCase::QUICK);
+    AddTestCase (new CheckpointerPeriodicTestCase (), TestCase::QUICK);
+    AddTestCase (new CheckpointerUnsupportedTestCase (), TestCase::QUICK);
+  }
+} g_checkpointerTestSuite;
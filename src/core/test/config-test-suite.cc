@@ -669,6 +669,87 @@ ObjectVectorTraceConfigTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_path, "/NodeA/NodeB/NodesB/1/Source", "Trace 1 did not provide expected context");
 }
 
+// ===========================================================================
+// Test for Config paths compiled once and applied many times.
+// ===========================================================================
+class CompiledPathConfigTestCase : public TestCase
+{
+public:
+  CompiledPathConfigTestCase ();
+  virtual ~CompiledPathConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+CompiledPathConfigTestCase::CompiledPathConfigTestCase ()
+  : TestCase ("Check that compiled Config paths cache their matches until the namespace changes")
+{
+}
+
+void
+CompiledPathConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeA (a);
+  Ptr<ConfigTestObject> obj0 = CreateObject<ConfigTestObject> ();
+  Ptr<ConfigTestObject> obj1 = CreateObject<ConfigTestObject> ();
+  a->AddNodeA (obj0);
+  a->AddNodeA (obj1);
+
+  Config::CompiledPath path ("/NodeA/NodesA/*/B");
+  NS_TEST_ASSERT_MSG_EQ (path.GetLeaf (), "B", "Unexpected leaf of compiled path");
+  NS_TEST_ASSERT_MSG_EQ (path.IsResolved (), false, "Compiled path resolved before first use");
+
+  path.Set (IntegerValue (-3));
+  NS_TEST_ASSERT_MSG_EQ (path.IsResolved (), true, "Compiled path not resolved after first use");
+  obj0->GetAttribute ("B", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -3, "Object Attribute \"B\" not set through compiled path");
+  obj1->GetAttribute ("B", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -3, "Object Attribute \"B\" not set through compiled path");
+  uint32_t n = path.GetMatches ().GetN ();
+
+  //
+  // An object added behind the back of the Config system is not seen
+  // until the cached matches are invalidated.
+  //
+  Ptr<ConfigTestObject> obj2 = CreateObject<ConfigTestObject> ();
+  a->AddNodeA (obj2);
+  path.Set (IntegerValue (-4));
+  obj2->GetAttribute ("B", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), 9, "Object Attribute \"B\" unexpectedly set");
+  obj0->GetAttribute ("B", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -4, "Object Attribute \"B\" not set through cached matches");
+
+  Config::InvalidateCompiledPaths ();
+  NS_TEST_ASSERT_MSG_EQ (path.IsResolved (), false, "Compiled path not invalidated");
+  path.Set (IntegerValue (-5));
+  NS_TEST_ASSERT_MSG_EQ (path.GetMatches ().GetN (), n + 1, "New object not matched after invalidation");
+  obj2->GetAttribute ("B", iv);
+  NS_TEST_ASSERT_MSG_EQ (iv.Get (), -5, "Object Attribute \"B\" not set after invalidation");
+
+  //
+  // Changes of the root namespace invalidate the cached matches too.
+  //
+  Config::UnregisterRootNamespaceObject (root);
+  NS_TEST_ASSERT_MSG_EQ (path.IsResolved (), false, "Compiled path not invalidated by a root change");
+  NS_TEST_ASSERT_MSG_EQ (path.GetMatches ().GetN (), n - 2, "Unregistered root still matched");
+
+  //
+  // And so does clearing the names.
+  //
+  Names::Add ("CompiledPathObject", obj0);
+  Config::CompiledPath named ("/Names/CompiledPathObject/B");
+  NS_TEST_ASSERT_MSG_EQ (named.GetMatches ().GetN (), 1, "Named object not matched");
+  Names::Clear ();
+  NS_TEST_ASSERT_MSG_EQ (named.IsResolved (), false, "Compiled path not invalidated by Names::Clear");
+  NS_TEST_ASSERT_MSG_EQ (named.GetMatches ().GetN (), 0, "Cleared name still matched");
+}
+
 // ===========================================================================
 // Test for the ability to search attributes of parent classes
 // when Resolver searches for attributes in a derived class object.
@@ -737,6 +818,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase, TestCase::QUICK);
   AddTestCase (new ObjectVectorConfigTestCase, TestCase::QUICK);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase, TestCase::QUICK);
+  AddTestCase (new CompiledPathConfigTestCase, TestCase::QUICK);
 }
 
 static ConfigTestSuite configTestSuite;
@@ -0,0 +1,348 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/event-profiler.h"
+#include "ns3/make-event.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace ns3;
+
+/** Object whose methods are profiled. */
+class ProfiledBase
+{
+public:
+  ProfiledBase () : m_count (0) {}
+  virtual ~ProfiledBase () {}
+  /** Virtual event handler. */
+  virtual void Handle (void)
+  {
+    m_count++;
+  }
+  /**
+   * Non-virtual event handler.
+   * \param [in] n The amount to add to the count.
+   */
+  void Add (uint32_t n)
+  {
+    m_count += n;
+  }
+  /** Number of times the handlers ran. */
+  uint32_t m_count;
+};
+
+/** Object which overrides a profiled method. */
+class ProfiledDerived : public ProfiledBase
+{
+public:
+  virtual void Handle (void)
+  {
+    m_count += 10;
+  }
+};
+
+/** Second base class of ProfiledMulti. */
+class ProfiledOther
+{
+public:
+  ProfiledOther () : m_other (0) {}
+  virtual ~ProfiledOther () {}
+  /** Virtual event handler of the second base. */
+  virtual void Other (void)
+  {
+    m_other++;
+  }
+  /** Number of times the handler ran. */
+  uint32_t m_other;
+};
+
+/** Object whose profiled method belongs to a base which is not the primary one. */
+class ProfiledMulti : public ProfiledBase, public ProfiledOther
+{
+public:
+  virtual void Other (void)
+  {
+    m_other += 10;
+  }
+};
+
+/**
+ * Event handler function.
+ * \param [in,out] count The count to increment.
+ */
+void
+ProfiledFunction (uint32_t *count)
+{
+  (*count)++;
+}
+
+/**
+ * Get the site of an event, and release the event.
+ * \param [in] event The event.
+ * \returns The site of the event.
+ */
+static EventImpl::Site
+GetSiteAndUnref (EventImpl *event)
+{
+  EventImpl::Site site;
+  event->GetSite (site);
+  event->Unref ();
+  return site;
+}
+
+
+class EventProfilerSiteTestCase : public TestCase
+{
+public:
+  EventProfilerSiteTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+EventProfilerSiteTestCase::EventProfilerSiteTestCase ()
+  : TestCase ("Check the sites of events")
+{
+}
+
+void
+EventProfilerSiteTestCase::DoRun (void)
+{
+  ProfiledBase base;
+  ProfiledDerived derived;
+  uint32_t count = 0;
+
+  EventImpl::Site baseHandle = GetSiteAndUnref (MakeEvent (&ProfiledBase::Handle, &base));
+  EventImpl::Site derivedHandle = GetSiteAndUnref (MakeEvent (&ProfiledBase::Handle, &derived));
+  EventImpl::Site derivedHandle2 = GetSiteAndUnref (MakeEvent (&ProfiledDerived::Handle, &derived));
+  EventImpl::Site baseAdd = GetSiteAndUnref (MakeEvent (&ProfiledBase::Add, &base, 1));
+  EventImpl::Site derivedAdd = GetSiteAndUnref (MakeEvent (&ProfiledBase::Add, &derived, 2));
+  EventImpl::Site function = GetSiteAndUnref (MakeEvent (&ProfiledFunction, &count));
+  EventImpl::Site function2 = GetSiteAndUnref (MakeEvent (&ProfiledFunction, &count));
+
+  NS_TEST_ASSERT_MSG_EQ ((*baseHandle.object == typeid (ProfiledBase)), true,
+                         "Wrong object type");
+  NS_TEST_ASSERT_MSG_EQ ((*derivedHandle.object == typeid (ProfiledDerived)), true,
+                         "Object type is not the dynamic type");
+  NS_TEST_ASSERT_MSG_NE (baseHandle.function, 0, "Unknown virtual method");
+  NS_TEST_ASSERT_MSG_NE (derivedHandle.function, 0, "Unknown virtual method");
+  NS_TEST_ASSERT_MSG_NE (baseHandle.function, derivedHandle.function,
+                         "Overriding method not resolved");
+  NS_TEST_ASSERT_MSG_EQ (derivedHandle.function, derivedHandle2.function,
+                         "Same method resolved differently");
+
+  NS_TEST_ASSERT_MSG_NE (baseAdd.function, 0, "Unknown method");
+  NS_TEST_ASSERT_MSG_EQ (baseAdd.function, derivedAdd.function,
+                         "Same method on two objects");
+  NS_TEST_ASSERT_MSG_NE (baseAdd.function, baseHandle.function,
+                         "Two methods with the same address");
+
+  ProfiledOther other;
+  ProfiledMulti multi;
+  EventImpl::Site otherOther = GetSiteAndUnref (MakeEvent (&ProfiledOther::Other, &other));
+  EventImpl::Site multiOther = GetSiteAndUnref (MakeEvent (&ProfiledOther::Other, &multi));
+  EventImpl::Site multiOther2 = GetSiteAndUnref (MakeEvent (&ProfiledMulti::Other, &multi));
+  // Through the second base, the virtual table holds a thunk adjusting
+  // the object pointer before the overriding method, so only check
+  // that the right virtual table is read.
+  NS_TEST_ASSERT_MSG_NE (multiOther.function, 0, "Unknown virtual method of a second base");
+  NS_TEST_ASSERT_MSG_NE (multiOther.function, baseHandle.function,
+                         "Method of a second base resolved in the primary base");
+  NS_TEST_ASSERT_MSG_NE (multiOther.function, otherOther.function,
+                         "Overriding method of a second base not resolved");
+  NS_TEST_ASSERT_MSG_NE (multiOther2.function, 0, "Unknown overriding method");
+  NS_TEST_ASSERT_MSG_NE (multiOther2.function, baseHandle.function,
+                         "Overriding method resolved in the wrong virtual table");
+
+  NS_TEST_ASSERT_MSG_EQ (function.object, 0, "Object type for a function");
+  NS_TEST_ASSERT_MSG_NE (function.function, 0, "Unknown function");
+  NS_TEST_ASSERT_MSG_EQ (function.function, function2.function,
+                         "Same function with two arguments");
+  NS_TEST_ASSERT_MSG_EQ ((*function.event == *function2.event), true,
+                         "Same event type");
+}
+
+
+class EventProfilerWriteTestCase : public TestCase
+{
+public:
+  EventProfilerWriteTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+EventProfilerWriteTestCase::EventProfilerWriteTestCase ()
+  : TestCase ("Check the event profile report and folded stacks")
+{
+}
+
+void
+EventProfilerWriteTestCase::DoRun (void)
+{
+  ProfiledBase base;
+  ProfiledDerived derived;
+  uint32_t count = 0;
+  EventProfiler profiler;
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      EventImpl *event = MakeEvent (&ProfiledBase::Handle, &derived);
+      profiler.Invoke (event, i);
+      event->Unref ();
+    }
+  EventImpl *event = MakeEvent (&ProfiledBase::Add, &base, 5);
+  profiler.Invoke (event, 7);
+  event->Unref ();
+  event = MakeEvent (&ProfiledFunction, &count);
+  profiler.Invoke (event, 0xffffffff);
+  event->Unref ();
+  event = MakeEvent (&ProfiledFunction, &count);
+  event->Cancel ();
+  profiler.Invoke (event, 1);
+  event->Unref ();
+
+  NS_TEST_ASSERT_MSG_EQ (derived.m_count, 30, "Events not invoked");
+  NS_TEST_ASSERT_MSG_EQ (base.m_count, 5, "Event not invoked");
+  NS_TEST_ASSERT_MSG_EQ (count, 1, "Cancelled event invoked");
+
+  std::ostringstream report;
+  profiler.Write (report, EventProfiler::REPORT);
+  NS_TEST_ASSERT_MSG_EQ (report.str ().find ("# Event profile: 5 events, 1 cancelled,"), 0,
+                         "Wrong report header:\n" << report.str ());
+  NS_TEST_ASSERT_MSG_NE (report.str ().find ("[ProfiledDerived]"), std::string::npos,
+                         "Missing object type:\n" << report.str ());
+  NS_TEST_ASSERT_MSG_NE (report.str ().find ("[ProfiledBase]"), std::string::npos,
+                         "Missing object type:\n" << report.str ());
+
+  std::ostringstream folded;
+  profiler.Write (folded, EventProfiler::FOLDED);
+  std::istringstream is (folded.str ());
+  std::string line;
+  uint32_t lines = 0;
+  uint32_t derivedLines = 0;
+  bool noContext = false;
+  while (std::getline (is, line))
+    {
+      lines++;
+      std::string::size_type space = line.rfind (' ');
+      NS_TEST_ASSERT_MSG_NE (space, std::string::npos, "No count in " << line);
+      NS_TEST_ASSERT_MSG_EQ (line.find_first_not_of ("0123456789", space + 1), std::string::npos,
+                             "Bad count in " << line);
+      if (line.find (";ProfiledDerived;") != std::string::npos)
+        {
+          derivedLines++;
+        }
+      if (line.compare (0, 11, "context -1;") == 0)
+        {
+          noContext = true;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines, 5, "Wrong number of stacks:\n" << folded.str ());
+  NS_TEST_ASSERT_MSG_EQ (derivedLines, 3, "One stack per context:\n" << folded.str ());
+  NS_TEST_ASSERT_MSG_EQ (noContext, true, "Missing event without context:\n" << folded.str ());
+
+  profiler.Clear ();
+  std::ostringstream empty;
+  profiler.Write (empty, EventProfiler::FOLDED);
+  NS_TEST_ASSERT_MSG_EQ (empty.str (), "", "Profile not cleared");
+}
+
+
+class EventProfilerSimulatorTestCase : public TestCase
+{
+public:
+  EventProfilerSimulatorTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Schedule a few events and run them with the profiler enabled.
+   * \param [in] format The profile format.
+   * \returns The profile.
+   */
+  std::string Profile (std::string format);
+  /** Count the events. */
+  ProfiledBase m_base;
+};
+
+EventProfilerSimulatorTestCase::EventProfilerSimulatorTestCase ()
+  : TestCase ("Check that the simulator writes the event profile")
+{
+}
+
+std::string
+EventProfilerSimulatorTestCase::Profile (std::string format)
+{
+  std::string filename = CreateTempDirFilename ("event-profile.txt");
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFile", StringValue (filename));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFormat", StringValue (format));
+
+  Simulator::ScheduleWithContext (1, Seconds (1), &ProfiledBase::Add, &m_base, 1);
+  Simulator::ScheduleWithContext (2, Seconds (2), &ProfiledBase::Add, &m_base, 1);
+  Simulator::ScheduleWithContext (2, Seconds (3), &ProfiledBase::Add, &m_base, 1);
+  EventId cancelled = Simulator::Schedule (Seconds (4), &ProfiledBase::Add, &m_base, 1);
+  Simulator::Cancel (cancelled);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFile", StringValue (""));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFormat", StringValue ("Report"));
+
+  std::ifstream is (filename.c_str ());
+  std::ostringstream profile;
+  profile << is.rdbuf ();
+  return profile.str ();
+}
+
+void
+EventProfilerSimulatorTestCase::DoRun (void)
+{
+  std::string report = Profile ("Report");
+  NS_TEST_ASSERT_MSG_EQ (m_base.m_count, 3, "Events not invoked");
+  NS_TEST_ASSERT_MSG_EQ (report.find ("# Event profile: 3 events, 1 cancelled,"), 0,
+                         "Wrong report:\n" << report);
+
+  std::string folded = Profile ("Folded");
+  NS_TEST_ASSERT_MSG_EQ (m_base.m_count, 6, "Events not invoked");
+  NS_TEST_ASSERT_MSG_EQ (folded.find ("context 1;ProfiledBase;"), 0,
+                         "Wrong folded stacks:\n" << folded);
+  NS_TEST_ASSERT_MSG_NE (folded.find ("\ncontext 2;ProfiledBase;"), std::string::npos,
+                         "Wrong folded stacks:\n" << folded);
+
+  // Profiling is off by default
+  Simulator::Schedule (Seconds (1), &ProfiledBase::Add, &m_base, 1);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_base.m_count, 7, "Event not invoked");
+}
+
+
+static class EventProfilerTestSuite : public TestSuite
+{
+public:
+  EventProfilerTestSuite ()
+    : TestSuite ("event-profiler", UNIT)
+  {
+    AddTestCase (new EventProfilerSiteTestCase (), TestCase::QUICK);
+    AddTestCase (new EventProfilerWriteTestCase (), TestCase::QUICK);
+    AddTestCase (new EventProfilerSimulatorTestCase (), TestCase::QUICK);
+  }
+} g_eventProfilerTestSuite;
@@ -0,0 +1,242 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/hybrid-synchronizer.h"
+#include "ns3/realtime-simulator-impl.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+
+#include <vector>
+
+using namespace ns3;
+
+class HybridSynchronizerWaitTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] timerFd Whether to sleep with a timerfd.
+   */
+  HybridSynchronizerWaitTestCase (bool timerFd);
+private:
+  virtual void DoRun (void);
+  /**
+   * Count the wakeups.
+   * \param [in] latency The wakeup latency.
+   */
+  void Wakeup (Time latency);
+  /**
+   * Count the events.
+   * \param [in] jitter The event jitter.
+   */
+  void Jitter (Time jitter);
+
+  bool m_timerFd;      //!< Whether to sleep with a timerfd.
+  uint32_t m_wakeups;  //!< Number of wakeups.
+  uint32_t m_events;   //!< Number of events.
+  Time m_minJitter;    //!< Smallest event jitter.
+};
+
+HybridSynchronizerWaitTestCase::HybridSynchronizerWaitTestCase (bool timerFd)
+  : TestCase (timerFd ? "Check the waits of the synchronizer, with a timerfd"
+              : "Check the waits of the synchronizer, with a condition variable"),
+    m_timerFd (timerFd),
+    m_wakeups (0),
+    m_events (0),
+    m_minJitter (Seconds (1000))
+{
+}
+
+void
+HybridSynchronizerWaitTestCase::Wakeup (Time latency)
+{
+  m_wakeups++;
+}
+
+void
+HybridSynchronizerWaitTestCase::Jitter (Time jitter)
+{
+  m_events++;
+  m_minJitter = Min (m_minJitter, jitter);
+}
+
+void
+HybridSynchronizerWaitTestCase::DoRun (void)
+{
+  Ptr<HybridSynchronizer> synchronizer = CreateObject<HybridSynchronizer> ();
+  synchronizer->SetAttribute ("UseTimerFd", BooleanValue (m_timerFd));
+  synchronizer->TraceConnectWithoutContext
+    ("WakeupLatency", MakeCallback (&HybridSynchronizerWaitTestCase::Wakeup, this));
+  synchronizer->TraceConnectWithoutContext
+    ("Jitter", MakeCallback (&HybridSynchronizerWaitTestCase::Jitter, this));
+  synchronizer->SetOrigin (0);
+
+  uint64_t delay = MilliSeconds (2).GetTimeStep ();
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      uint64_t now = synchronizer->GetCurrentRealtime ();
+      synchronizer->SetCondition (false);
+      NS_TEST_ASSERT_MSG_EQ (synchronizer->Synchronize (now, delay), true, "Wait interrupted");
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (synchronizer->GetCurrentRealtime (), now + delay,
+                                   "Wait ended before the deadline");
+      synchronizer->EventStart ();
+      synchronizer->EventEnd ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_events, 20, "Wrong number of events");
+  // The first waits sleep, the others only if the wakeup latency is
+  // small enough.
+  NS_TEST_ASSERT_MSG_GT (m_wakeups, 0, "No sleep");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_wakeups, 20, "More sleeps than waits");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_minJitter, Time (0), "Event run before its deadline");
+
+  std::vector<uint64_t> histogram = synchronizer->GetJitterHistogram ();
+  NS_TEST_ASSERT_MSG_EQ (histogram.size (), 100, "Wrong number of bins");
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < histogram.size (); i++)
+    {
+      total += histogram[i];
+    }
+  NS_TEST_ASSERT_MSG_EQ (total, 20, "Events missing from the histogram");
+
+  Time threshold = synchronizer->GetSpinThreshold ();
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (threshold, MicroSeconds (10), "Threshold below its minimum");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (threshold, MilliSeconds (2), "Threshold above its maximum");
+
+  // A signal interrupts the wait
+  uint64_t now = synchronizer->GetCurrentRealtime ();
+  synchronizer->SetCondition (false);
+  synchronizer->Signal ();
+  NS_TEST_ASSERT_MSG_EQ (synchronizer->Synchronize (now, Seconds (10).GetTimeStep ()), false,
+                         "Wait not interrupted");
+  NS_TEST_ASSERT_MSG_LT (synchronizer->GetCurrentRealtime (), now + Seconds (5).GetTimeStep (),
+                         "Wait interrupted late");
+
+  // Events within one tick are not waited for
+  synchronizer->SetAttribute ("Tick", TimeValue (Seconds (5)));
+  now = synchronizer->GetCurrentRealtime ();
+  synchronizer->SetCondition (false);
+  NS_TEST_ASSERT_MSG_EQ (synchronizer->Synchronize (now, Seconds (1).GetTimeStep ()), true,
+                         "Event within one tick not run");
+  NS_TEST_ASSERT_MSG_LT (synchronizer->GetCurrentRealtime (), now + Seconds (1).GetTimeStep (),
+                         "Waited for an event within one tick");
+  synchronizer->EventStart ();
+  NS_TEST_ASSERT_MSG_LT (m_minJitter, Time (0), "Early event not reported early");
+  synchronizer->Dispose ();
+}
+
+
+class HybridSynchronizerSimulatorTestCase : public TestCase
+{
+public:
+  HybridSynchronizerSimulatorTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /** Record the real time of an event. */
+  void Event (void);
+  /**
+   * Count the histogram traces.
+   * \param [in] histogram The jitter histogram.
+   */
+  void Histogram (const std::vector<uint64_t> &histogram);
+
+  std::vector<Time> m_lateness;  //!< How late each event ran.
+  uint64_t m_histogramEvents;    //!< Number of events in the last histogram.
+};
+
+HybridSynchronizerSimulatorTestCase::HybridSynchronizerSimulatorTestCase ()
+  : TestCase ("Check that the realtime simulator runs with the hybrid synchronizer"),
+    m_histogramEvents (0)
+{
+}
+
+void
+HybridSynchronizerSimulatorTestCase::Event (void)
+{
+  Ptr<RealtimeSimulatorImpl> impl = Simulator::GetImplementation ()->GetObject<RealtimeSimulatorImpl> ();
+  m_lateness.push_back (impl->RealtimeNow () - Simulator::Now ());
+}
+
+void
+HybridSynchronizerSimulatorTestCase::Histogram (const std::vector<uint64_t> &histogram)
+{
+  m_histogramEvents = 0;
+  for (uint32_t i = 0; i < histogram.size (); i++)
+    {
+      m_histogramEvents += histogram[i];
+    }
+}
+
+void
+HybridSynchronizerSimulatorTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+                      TypeIdValue (TypeId::LookupByName ("ns3::WallClockSynchronizer")));
+  Config::SetDefault ("ns3::HybridSynchronizer::HistogramInterval", UintegerValue (1000));
+}
+
+void
+HybridSynchronizerSimulatorTestCase::DoRun (void)
+{
+  Simulator::Destroy ();
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+                      TypeIdValue (HybridSynchronizer::GetTypeId ()));
+  Config::SetDefault ("ns3::HybridSynchronizer::HistogramInterval", UintegerValue (5));
+
+  Ptr<RealtimeSimulatorImpl> impl = Simulator::GetImplementation ()->GetObject<RealtimeSimulatorImpl> ();
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Not a realtime simulator");
+  NS_TEST_ASSERT_MSG_EQ (impl->GetSynchronizerType (), HybridSynchronizer::GetTypeId (),
+                         "Wrong synchronizer");
+  impl->GetSynchronizer ()->TraceConnectWithoutContext
+    ("JitterHistogram", MakeCallback (&HybridSynchronizerSimulatorTestCase::Histogram, this));
+
+  for (uint32_t i = 1; i <= 10; i++)
+    {
+      Simulator::Schedule (MilliSeconds (i), &HybridSynchronizerSimulatorTestCase::Event, this);
+    }
+  Simulator::Stop (MilliSeconds (11));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_lateness.size (), 10, "Events not run");
+  for (uint32_t i = 0; i < m_lateness.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (m_lateness[i], Time (0), "Event " << i << " run early");
+    }
+  // The histogram is traced after 5 and 10 of the 11 events, with the
+  // stop event.
+  NS_TEST_ASSERT_MSG_EQ (m_histogramEvents, 10, "Histogram not traced");
+}
+
+
+static class HybridSynchronizerTestSuite : public TestSuite
+{
+public:
+  HybridSynchronizerTestSuite ()
+    : TestSuite ("hybrid-synchronizer", UNIT)
+  {
+    AddTestCase (new HybridSynchronizerWaitTestCase (false), TestCase::QUICK);
+    AddTestCase (new HybridSynchronizerWaitTestCase (true), TestCase::QUICK);
+    AddTestCase (new HybridSynchronizerSimulatorTestCase (), TestCase::QUICK);
+  }
+} g_hybridSynchronizerTestSuite;
@@ -1182,6 +1182,63 @@ Int64x64DoubleTestCase::DoRun (void)
 }
 
 
+class Int64x64DoubleFastTestCase : public TestCase
+{
+public:
+  Int64x64DoubleFastTestCase ();
+  virtual void DoRun (void);
+  void Check (const double value);
+};
+
+Int64x64DoubleFastTestCase::Int64x64DoubleFastTestCase ()
+  : TestCase ("Construct from double matches construct from long double.")
+{
+}
+
+void
+Int64x64DoubleFastTestCase::Check (const double value)
+{
+  const int64x64_t fast = int64x64_t (value);
+  const int64x64_t exact = int64x64_t (static_cast<long double> (value));
+  NS_TEST_ASSERT_MSG_EQ (fast.GetHigh (), exact.GetHigh (),
+			 "High part of " << value);
+  NS_TEST_ASSERT_MSG_EQ (fast.GetLow (), exact.GetLow (),
+			 "Low part of " << value);
+}
+
+void
+Int64x64DoubleFastTestCase::DoRun (void)
+{
+  std::cout << std::endl;
+  std::cout << GetParent ()->GetName () << " Double fast path: "
+	    << GetName ()
+	    << std::endl;
+
+  Check (0.0);
+  Check (-0.0);
+  Check (std::numeric_limits<double>::min ());
+  Check (-std::numeric_limits<double>::min ());
+  Check (9223372036854774784.0);   // largest double below 2^63
+  Check (-9223372036854775808.0);  // -2^63
+  for (int64_t i = -1000; i <= 1000; ++i)
+    {
+      const double step = 0.137;
+      Check (i * step);
+      Check (i / 1024.0);
+      Check (i * 1e-9);
+      Check (i * 1e15 + 0.25);
+    }
+  for (int e = -60; e <= 62; ++e)
+    {
+      const double p = std::ldexp (1.0, e);
+      Check (p);
+      Check (-p);
+      Check (p * (1 - std::numeric_limits<double>::epsilon ()));
+      Check (-p * (1 + std::numeric_limits<double>::epsilon ()));
+    }
+}
+
+
 class Int64x64ImplTestCase : public TestCase
 {
 public:
@@ -1241,6 +1298,7 @@ public:
     AddTestCase (new Int64x64Bug1786TestCase (), TestCase::QUICK);
     AddTestCase (new Int64x64InvertTestCase (), TestCase::QUICK);
     AddTestCase (new Int64x64DoubleTestCase (), TestCase::QUICK);
+    AddTestCase (new Int64x64DoubleFastTestCase (), TestCase::QUICK);
   }
 }  g_int64x64TestSuite;
 
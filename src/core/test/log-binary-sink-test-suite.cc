@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/log-binary-sink.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LogBinarySinkTestSuite");
+
+namespace {
+
+/**
+ * Log a few lines with every kind of prefix.
+ * \param [in] value A value to log.
+ */
+void
+LogEvent (uint32_t value)
+{
+  NS_LOG_FUNCTION (value);
+  NS_LOG_INFO ("value " << value << " of " << 3.25);
+  NS_LOG_LOGIC ("logic line");
+  NS_LOG_UNCOND ("unconditional line");
+}
+
+/** Schedule the logging events and run the simulation. */
+void
+RunScenario (void)
+{
+  LogEvent (0);
+  Simulator::Schedule (Seconds (1.5), &LogEvent, 1);
+  Simulator::ScheduleWithContext (3, MilliSeconds (2500), &LogEvent, 2);
+  Simulator::ScheduleWithContext (0xffffffff, Seconds (4), &LogEvent, 3);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * A time printer other than the default one.
+ * \param [in,out] os The output stream to print the time on.
+ */
+void
+CustomTimePrinter (std::ostream &os)
+{
+  os << "t=" << Simulator::Now ().GetMilliSeconds () << "ms";
+}
+
+} // anonymous namespace
+
+
+class LogBinarySinkDecodeTestCase : public TestCase
+{
+public:
+  LogBinarySinkDecodeTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+LogBinarySinkDecodeTestCase::LogBinarySinkDecodeTestCase ()
+  : TestCase ("Check that a decoded binary log matches the text log")
+{
+}
+
+void
+LogBinarySinkDecodeTestCase::DoRun (void)
+{
+  LogComponentEnable ("LogBinarySinkTestSuite",
+                      (enum LogLevel)(LOG_LEVEL_ALL | LOG_PREFIX_ALL));
+
+  // Reference: the text backend, captured from std::clog
+  std::ostringstream text;
+  std::streambuf *clogBuffer = std::clog.rdbuf (text.rdbuf ());
+  RunScenario ();
+  std::clog.rdbuf (clogBuffer);
+
+  std::string filename = CreateTempDirFilename ("log-binary-sink.bin");
+  LogBinarySink::Enable (filename);
+  NS_TEST_ASSERT_MSG_EQ (LogBinarySink::IsEnabled (), true, "Sink not enabled");
+  RunScenario ();
+  LogBinarySink::Disable ();
+  NS_TEST_ASSERT_MSG_EQ (LogBinarySink::IsEnabled (), false, "Sink not disabled");
+
+  LogComponentDisable ("LogBinarySinkTestSuite", LOG_LEVEL_ALL);
+
+  std::ifstream is (filename.c_str (), std::ios::binary);
+  std::ostringstream decoded;
+  NS_TEST_ASSERT_MSG_EQ (LogBinarySink::Decode (is, decoded), true,
+                         "Could not decode " << filename);
+  NS_TEST_ASSERT_MSG_NE (text.str ().find ("2.5s 3 "), std::string::npos,
+                         "Missing prefixes in the text log");
+  NS_TEST_ASSERT_MSG_EQ (decoded.str (), text.str (),
+                         "Decoded binary log differs from the text log");
+  is.close ();
+
+  // A sink which records nothing, like the one log-binary-decode
+  // disables, leaves the log as it was.
+  LogBinarySink::Enable (filename);
+  LogBinarySink::Disable ();
+  std::ifstream again (filename.c_str (), std::ios::binary);
+  std::ostringstream redecoded;
+  NS_TEST_ASSERT_MSG_EQ (LogBinarySink::Decode (again, redecoded), true,
+                         "Could not decode " << filename << " again");
+  NS_TEST_ASSERT_MSG_EQ (redecoded.str (), text.str (),
+                         "Log replaced by a sink which recorded nothing");
+
+  // A new file is still completed as an empty log.
+  std::string empty = CreateTempDirFilename ("log-binary-sink-empty.bin");
+  std::remove (empty.c_str ());
+  LogBinarySink::Enable (empty);
+  LogBinarySink::Disable ();
+  std::ifstream emptyIs (empty.c_str (), std::ios::binary);
+  std::ostringstream emptyDecoded;
+  NS_TEST_ASSERT_MSG_EQ (LogBinarySink::Decode (emptyIs, emptyDecoded), true,
+                         "Could not decode the empty log " << empty);
+  NS_TEST_ASSERT_MSG_EQ (emptyDecoded.str (), "", "Unexpected lines in the empty log");
+
+  std::istringstream garbage ("not a binary log");
+  std::ostringstream ignored;
+  NS_TEST_ASSERT_MSG_EQ (LogBinarySink::Decode (garbage, ignored), false,
+                         "Decoded a file which is not a binary log");
+}
+
+
+class LogBinarySinkPrinterTestCase : public TestCase
+{
+public:
+  LogBinarySinkPrinterTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+LogBinarySinkPrinterTestCase::LogBinarySinkPrinterTestCase ()
+  : TestCase ("Check that the binary log keeps the printers set by the user")
+{
+}
+
+void
+LogBinarySinkPrinterTestCase::DoRun (void)
+{
+  LogComponentEnable ("LogBinarySinkTestSuite",
+                      (enum LogLevel)(LOG_LEVEL_INFO | LOG_PREFIX_TIME));
+
+  std::string filename = CreateTempDirFilename ("log-binary-sink-printer.bin");
+  LogBinarySink::Enable (filename);
+  Simulator::Now ();  // installs the default printers
+  LogSetTimePrinter (&CustomTimePrinter);
+  Simulator::Schedule (Seconds (1.5), &LogEvent, 1);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  LogBinarySink::Disable ();
+
+  LogComponentDisable ("LogBinarySinkTestSuite", LOG_LEVEL_ALL);
+
+  std::ifstream is (filename.c_str (), std::ios::binary);
+  std::ostringstream decoded;
+  NS_TEST_ASSERT_MSG_EQ (LogBinarySink::Decode (is, decoded), true,
+                         "Could not decode " << filename);
+  NS_TEST_ASSERT_MSG_NE (decoded.str ().find ("t=1500ms "), std::string::npos,
+                         "The custom time printer was not used: " << decoded.str ());
+}
+
+
+static class LogBinarySinkTestSuite : public TestSuite
+{
+public:
+  LogBinarySinkTestSuite ()
+    : TestSuite ("log-binary-sink", UNIT)
+  {
+    AddTestCase (new LogBinarySinkDecodeTestCase (), TestCase::QUICK);
+    AddTestCase (new LogBinarySinkPrinterTestCase (), TestCase::QUICK);
+  }
+} g_logBinarySinkTestSuite;
@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/memory-accounting.h"
+#include "ns3/object.h"
+#include "ns3/object-factory.h"
+
+#include <sstream>
+#include <string>
+
+using namespace ns3;
+
+namespace {
+
+/** An Object with some payload, to be accounted. */
+class AccountedObject : public Object
+{
+public:
+  /**
+   * Register this type.
+   * \returns The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::MemoryAccountingTest::AccountedObject")
+      .SetParent<Object> ()
+      .SetGroupName ("Core")
+      .AddConstructor<AccountedObject> ()
+    ;
+    return tid;
+  }
+private:
+  /** Payload. */
+  uint8_t m_payload[1000];
+};
+
+NS_OBJECT_ENSURE_REGISTERED (AccountedObject);
+
+} // anonymous namespace
+
+
+class MemoryAccountingCounterTestCase : public TestCase
+{
+public:
+  MemoryAccountingCounterTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+MemoryAccountingCounterTestCase::MemoryAccountingCounterTestCase ()
+  : TestCase ("Check the named counters")
+{
+}
+
+void
+MemoryAccountingCounterTestCase::DoRun (void)
+{
+  MemoryAccounting::Id id = MemoryAccounting::Register ("test-counter");
+  NS_TEST_ASSERT_MSG_EQ (MemoryAccounting::Register ("test-counter"), id,
+                         "Registered twice");
+
+  // Nothing is counted while the accounting is disabled.
+  MemoryAccounting::Enable (false);
+  MemoryAccounting::Allocate (id, 100);
+  NS_TEST_ASSERT_MSG_EQ (MemoryAccounting::GetCounter ("test-counter").allocations, 0,
+                         "Allocation counted while disabled");
+
+  MemoryAccounting::Enable (true);
+  MemoryAccounting::Allocate (id, 100);
+  MemoryAccounting::Allocate (id, 50);
+  MemoryAccounting::Free (id, 100);
+  MemoryAccounting::Allocate (id, 20);
+  MemoryAccounting::Enable (false);
+
+  MemoryAccounting::Counter counter = MemoryAccounting::GetCounter ("test-counter");
+  NS_TEST_ASSERT_MSG_EQ (counter.name, "test-counter", "Wrong name");
+  NS_TEST_ASSERT_MSG_EQ (counter.bytes, 70, "Wrong bytes");
+  NS_TEST_ASSERT_MSG_EQ (counter.objects, 2, "Wrong objects");
+  NS_TEST_ASSERT_MSG_EQ (counter.peakBytes, 150, "Wrong peak bytes");
+  NS_TEST_ASSERT_MSG_EQ (counter.peakObjects, 2, "Wrong peak objects");
+  NS_TEST_ASSERT_MSG_EQ (counter.allocations, 3, "Wrong allocations");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (MemoryAccounting::GetTotalBytes (), 70, "Wrong total");
+
+  std::ostringstream oss;
+  MemoryAccounting::Print (oss);
+  NS_TEST_ASSERT_MSG_NE (oss.str ().find ("test-counter"), std::string::npos,
+                         "Counter not printed");
+
+  // Frees of memory allocated before enabling do not underflow.
+  MemoryAccounting::Enable (true);
+  MemoryAccounting::Free (id, 1000);
+  MemoryAccounting::Free (id, 1000);
+  MemoryAccounting::Free (id, 1000);
+  MemoryAccounting::Enable (false);
+  counter = MemoryAccounting::GetCounter ("test-counter");
+  NS_TEST_ASSERT_MSG_EQ (counter.bytes, 0, "Bytes underflow");
+  NS_TEST_ASSERT_MSG_EQ (counter.objects, 0, "Objects underflow");
+
+  MemoryAccounting::Reset ();
+  counter = MemoryAccounting::GetCounter ("test-counter");
+  NS_TEST_ASSERT_MSG_EQ (counter.peakBytes, 0, "Not reset");
+  NS_TEST_ASSERT_MSG_EQ (MemoryAccounting::GetCounter ("no-such-counter").bytes, 0,
+                         "Unknown counter not empty");
+}
+
+
+class MemoryAccountingObjectTestCase : public TestCase
+{
+public:
+  MemoryAccountingObjectTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+MemoryAccountingObjectTestCase::MemoryAccountingObjectTestCase ()
+  : TestCase ("Check the accounting of the objects by TypeId")
+{
+}
+
+void
+MemoryAccountingObjectTestCase::DoRun (void)
+{
+  std::string name = AccountedObject::GetTypeId ().GetName ();
+  MemoryAccounting::Reset ();
+  MemoryAccounting::Enable (true);
+  Ptr<AccountedObject> a = CreateObject<AccountedObject> ();
+  ObjectFactory factory;
+  factory.SetTypeId (AccountedObject::GetTypeId ());
+  Ptr<Object> b = factory.Create ();
+  Ptr<Object> c = factory.Create ();
+
+  MemoryAccounting::Counter counter = MemoryAccounting::GetCounter (name);
+  NS_TEST_ASSERT_MSG_EQ (counter.objects, 3, "Objects not accounted");
+  NS_TEST_ASSERT_MSG_EQ (counter.bytes, 3 * sizeof (AccountedObject), "Wrong size");
+
+  b = 0;
+  c = 0;
+  counter = MemoryAccounting::GetCounter (name);
+  NS_TEST_ASSERT_MSG_EQ (counter.objects, 1, "Objects not released");
+  NS_TEST_ASSERT_MSG_EQ (counter.peakObjects, 3, "Wrong peak");
+
+  // The objects accounted are released even after the accounting is
+  // disabled, the others are never counted.
+  MemoryAccounting::Enable (false);
+  Ptr<AccountedObject> d = CreateObject<AccountedObject> ();
+  MemoryAccounting::Enable (true);
+  d = 0;
+  a = 0;
+  counter = MemoryAccounting::GetCounter (name);
+  NS_TEST_ASSERT_MSG_EQ (counter.objects, 0, "Objects left");
+  NS_TEST_ASSERT_MSG_EQ (counter.bytes, 0, "Bytes left");
+  NS_TEST_ASSERT_MSG_EQ (counter.allocations, 3, "Wrong allocations");
+  MemoryAccounting::Enable (false);
+  MemoryAccounting::Reset ();
+}
+
+
+static class MemoryAccountingTestSuite : public TestSuite
+{
+public:
+  MemoryAccountingTestSuite ()
+    : TestSuite ("memory-accounting", UNIT)
+  {
+    AddTestCase (new MemoryAccountingCounterTestCase (), TestCase::QUICK);
+    AddTestCase (new MemoryAccountingObjectTestCase (), TestCase::QUICK);
+  }
+} g_memoryAccountingTestSuite;
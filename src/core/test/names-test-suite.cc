@@ -17,6 +17,9 @@
 #include "ns3/test.h"
 #include "ns3/names.h"
 
+#include <sstream>
+#include <vector>
+
 using namespace ns3;
 
 // ===========================================================================
@@ -929,6 +932,102 @@ AlternateFindTestCase::DoRun (void)
                          "Unexpectedly able to GetObject<TestObject> on an AlternateTestObject");
 }
 
+// ===========================================================================
+// Test case to make sure that the Object Name Service can name the objects
+// of a container at once, and keeps finding them by name and by object
+// when there are many of them, when they are renamed, and when names
+// collide in its hash indexes:
+//
+//   Add (std::string prefix, ITERATOR begin, ITERATOR end);
+// ===========================================================================
+class BulkAddTestCase : public TestCase
+{
+public:
+  BulkAddTestCase ();
+  virtual ~BulkAddTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+BulkAddTestCase::BulkAddTestCase ()
+  : TestCase ("Check bulk Names::Add, and lookups with many names")
+{
+}
+
+BulkAddTestCase::~BulkAddTestCase ()
+{
+}
+
+void
+BulkAddTestCase::DoTeardown (void)
+{
+  Names::Clear ();
+}
+
+void
+BulkAddTestCase::DoRun (void)
+{
+  std::vector<Ptr<TestObject> > nodes;
+  std::vector<Ptr<Object> > devices;
+  for (uint32_t i = 0; i < 3000; i++)
+    {
+      nodes.push_back (CreateObject<TestObject> ());
+    }
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      devices.push_back (CreateObject<TestObject> ());
+    }
+
+  Names::Add ("Vehicle", nodes.begin (), nodes.end ());
+  Names::Add ("/Names/Vehicle1234/eth", devices);
+
+  NS_TEST_ASSERT_MSG_EQ (Names::FindName (nodes[0]), "Vehicle0", "Wrong name of the first object");
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (nodes[2999]), "/Names/Vehicle2999",
+                         "Wrong path of the last object");
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (devices[1]), "/Names/Vehicle1234/eth1",
+                         "Wrong path of a child object");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("Vehicle1234/eth0"), devices[0],
+                         "Could not find a child object");
+
+  bool found = true;
+  for (uint32_t i = 0; i < nodes.size (); i++)
+    {
+      std::ostringstream oss;
+      oss << "/Names/Vehicle" << i;
+      found = found && Names::Find<TestObject> (oss.str ()) == nodes[i];
+      found = found && Names::FindPath (nodes[i]) == oss.str ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (found, true, "Could not find all the objects named in bulk");
+
+  //
+  // Renaming an object changes the path of its children.
+  //
+  Names::Rename ("Vehicle1234", "Car");
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (devices[1]), "/Names/Car/eth1",
+                         "Path not updated by the rename of the parent");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("Vehicle1234"), 0,
+                         "Found an object under its old name");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("/Names/Car/eth1"), devices[1],
+                         "Could not find a child under the new name of its parent");
+
+  //
+  // "daemon" and "unerring" have the same hash, and must still be told
+  // apart.
+  //
+  Ptr<TestObject> daemon = CreateObject<TestObject> ();
+  Ptr<TestObject> unerring = CreateObject<TestObject> ();
+  Names::Add ("daemon", daemon);
+  Names::Add ("unerring", unerring);
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("daemon"), daemon, "Hash collision not resolved");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("unerring"), unerring, "Hash collision not resolved");
+  Names::Rename ("daemon", "demon");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("unerring"), unerring,
+                         "Lost a colliding name after a rename");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("demon"), daemon, "Renamed object not found");
+}
+
 class NamesTestSuite : public TestSuite
 {
 public:
@@ -952,6 +1051,7 @@ NamesTestSuite::NamesTestSuite ()
   AddTestCase (new FullyQualifiedFindTestCase, TestCase::QUICK);
   AddTestCase (new RelativeFindTestCase, TestCase::QUICK);
   AddTestCase (new AlternateFindTestCase, TestCase::QUICK);
+  AddTestCase (new BulkAddTestCase, TestCase::QUICK);
 }
 
 static NamesTestSuite namesTestSuite;
@@ -359,6 +359,74 @@ AggregateObjectTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (baseA, 0, "Unable to GetObject on released object");
 }
 
+// ===========================================================================
+// Test case to make sure that the aggregate lookup cache stays coherent.
+// ===========================================================================
+class AggregateLookupCacheTestCase : public TestCase
+{
+public:
+  AggregateLookupCacheTestCase ();
+  virtual ~AggregateLookupCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AggregateLookupCacheTestCase::AggregateLookupCacheTestCase ()
+  : TestCase ("Check the aggregate lookup cache and its statistics")
+{
+}
+
+AggregateLookupCacheTestCase::~AggregateLookupCacheTestCase ()
+{
+}
+
+void
+AggregateLookupCacheTestCase::DoRun (void)
+{
+  Object::ResetLookupStatistics ();
+  Object::EnableLookupStatistics (true);
+
+  Ptr<BaseA> baseA = CreateObject<BaseA> ();
+  Ptr<DerivedB> derivedB = CreateObject<DerivedB> ();
+
+  //
+  // A miss must be remembered as a miss, and must be forgotten as soon as
+  // the aggregate changes.
+  //
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), 0, "Cached lookup unexpectedly found a BaseB");
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLookupCount (BaseB::GetTypeId ()), 2, "Lookups of BaseB not counted");
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLookupCacheHitCount (BaseB::GetTypeId ()), 1, "Second lookup of BaseB not cached");
+
+  baseA->AggregateObject (derivedB);
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), derivedB, "Stale cache entry after AggregateObject");
+
+  //
+  // Repeated lookups through any member of the aggregate must be answered
+  // by the shared cache and return the same Object.  The DerivedB is now
+  // the most frequently used aggregate, so the BaseA lookups cannot be
+  // answered by the dynamic_cast fast path of GetObject().
+  //
+  NS_TEST_ASSERT_MSG_EQ (derivedB->GetObject<BaseA> (), baseA, "Lookup returns different Ptr");
+  uint64_t hits = Object::GetLookupCacheHitCount (BaseA::GetTypeId ());
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), derivedB, "Cached lookup returns different Ptr");
+      NS_TEST_ASSERT_MSG_EQ (derivedB->GetObject<BaseA> (), baseA, "Cached lookup returns different Ptr");
+    }
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLookupCacheHitCount (BaseA::GetTypeId ()), hits + 10, "Repeated lookups not cached");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedA> (), 0, "Unexpectedly found a DerivedA");
+
+  Object::EnableLookupStatistics (false);
+  uint64_t lookups = Object::GetLookupCount (BaseA::GetTypeId ());
+  NS_TEST_ASSERT_MSG_EQ (derivedB->GetObject<BaseA> (), baseA, "Lookup returns different Ptr");
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLookupCount (BaseA::GetTypeId ()), lookups, "Lookup counted while disabled");
+
+  Object::ResetLookupStatistics ();
+  NS_TEST_ASSERT_MSG_EQ (Object::GetLookupCount (BaseA::GetTypeId ()), 0, "Statistics not reset");
+}
+
 // ===========================================================================
 // Test case to make sure that an Object factory can create Objects
 // ===========================================================================
@@ -445,6 +513,7 @@ ObjectTestSuite::ObjectTestSuite ()
 {
   AddTestCase (new CreateObjectTestCase, TestCase::QUICK);
   AddTestCase (new AggregateObjectTestCase, TestCase::QUICK);
+  AddTestCase (new AggregateLookupCacheTestCase, TestCase::QUICK);
   AddTestCase (new ObjectFactoryTestCase, TestCase::QUICK);
 }
 
@@ -0,0 +1,274 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/progress-monitor.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/boolean.h"
+#include "ns3/config.h"
+#include "ns3/global-value.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * Keep the processor busy.
+ * \param [in] ms The wall clock time to spin for, in ms.
+ */
+void
+Spin (int64_t ms)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+  while (clock.End () < ms)
+    {
+    }
+}
+
+} // anonymous namespace
+
+
+class ProgressMonitorCountTestCase : public TestCase
+{
+public:
+  ProgressMonitorCountTestCase ();
+private:
+  virtual void DoRun (void);
+  /** Check the counters from an event. */
+  void Check (void);
+  /** Number of events scheduled. */
+  uint64_t m_events;
+};
+
+ProgressMonitorCountTestCase::ProgressMonitorCountTestCase ()
+  : TestCase ("Check the event counters of the simulator"),
+    m_events (10)
+{
+}
+
+void
+ProgressMonitorCountTestCase::Check (void)
+{
+  // This event is executed, but the event counter is incremented
+  // before it runs.
+  uint64_t done = Simulator::GetEventCount ();
+  NS_TEST_EXPECT_MSG_EQ (done + Simulator::GetPendingEventCount (), m_events,
+                         "Events lost at " << Simulator::Now ());
+}
+
+void
+ProgressMonitorCountTestCase::DoRun (void)
+{
+  for (uint64_t i = 0; i < m_events; i++)
+    {
+      Simulator::Schedule (Seconds (i), &ProgressMonitorCountTestCase::Check, this);
+    }
+  NS_TEST_ASSERT_MSG_EQ (Simulator::GetEventCount (), 0, "Events executed before Run");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::GetPendingEventCount (), m_events, "Events not pending");
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (Simulator::GetEventCount (), m_events, "Wrong event count");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::GetPendingEventCount (), 0, "Events left");
+  Simulator::Destroy ();
+}
+
+
+class ProgressMonitorSampleTestCase : public TestCase
+{
+public:
+  ProgressMonitorSampleTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Count the samples.
+   * \param [in] sample The sample.
+   */
+  void Sample (const ProgressMonitor::Sample &sample);
+  /** Number of samples. */
+  uint32_t m_samples;
+  /** Whether the samples were consistent. */
+  bool m_consistent;
+  /** Simulation time of the previous sample. */
+  Time m_last;
+};
+
+ProgressMonitorSampleTestCase::ProgressMonitorSampleTestCase ()
+  : TestCase ("Check the progress samples"),
+    m_samples (0),
+    m_consistent (true)
+{
+}
+
+void
+ProgressMonitorSampleTestCase::Sample (const ProgressMonitor::Sample &sample)
+{
+  m_samples++;
+  m_consistent = m_consistent
+    && sample.simulationTime >= m_last
+    && sample.events <= 40
+    && sample.speed >= 0;
+  m_last = sample.simulationTime;
+}
+
+void
+ProgressMonitorSampleTestCase::DoRun (void)
+{
+  Ptr<ProgressMonitor> monitor = CreateObject<ProgressMonitor> ();
+  monitor->SetAttribute ("Interval", TimeValue (MilliSeconds (50)));
+  monitor->SetAttribute ("StopTime", TimeValue (Seconds (40)));
+  monitor->SetAttribute ("Print", BooleanValue (false));
+  monitor->TraceConnectWithoutContext ("Sample",
+                                       MakeCallback (&ProgressMonitorSampleTestCase::Sample, this));
+
+  // 40 events of 10ms each, one per simulated second.
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      Simulator::Schedule (Seconds (i + 1), &Spin, 10);
+    }
+  monitor->Start ();
+  NS_TEST_ASSERT_MSG_EQ (monitor->IsRunning (), true, "Monitor not running");
+  Simulator::Run ();
+  monitor->Stop ();
+  NS_TEST_ASSERT_MSG_EQ (monitor->IsRunning (), false, "Monitor still running");
+
+  // The monitor thread is joined: its results can be read.
+  NS_TEST_ASSERT_MSG_GT (m_samples, 0, "No sample");
+  NS_TEST_ASSERT_MSG_EQ (m_consistent, true, "Inconsistent samples");
+  ProgressMonitor::Sample last = monitor->GetLastSample ();
+  NS_TEST_ASSERT_MSG_GT (last.events, 0, "No event in the last sample");
+  NS_TEST_ASSERT_MSG_EQ (last.simulationTime.IsStrictlyPositive (), true,
+                         "No simulation time in the last sample");
+  NS_TEST_ASSERT_MSG_EQ (last.eta.IsPositive (), true, "No ETA with a StopTime");
+  NS_TEST_ASSERT_MSG_EQ (monitor->IsStalled (), false, "Stalled without StallTimeout");
+
+  std::ostringstream oss;
+  oss << last;
+  NS_TEST_ASSERT_MSG_NE (oss.str ().find ("eta="), std::string::npos, "ETA not printed");
+  NS_TEST_ASSERT_MSG_GT (ProgressMonitor::GetResidentSetSize (), 0, "No resident set size");
+
+  monitor->Dispose ();
+  Simulator::Destroy ();
+}
+
+
+class ProgressMonitorStallTestCase : public TestCase
+{
+public:
+  ProgressMonitorStallTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Count the stalls.
+   * \param [in] sample The sample.
+   */
+  void Stall (const ProgressMonitor::Sample &sample);
+  /** Number of stalls. */
+  uint32_t m_stalls;
+  /** Simulation time of the stall. */
+  Time m_stallTime;
+};
+
+ProgressMonitorStallTestCase::ProgressMonitorStallTestCase ()
+  : TestCase ("Check the stall detection"),
+    m_stalls (0)
+{
+}
+
+void
+ProgressMonitorStallTestCase::Stall (const ProgressMonitor::Sample &sample)
+{
+  m_stalls++;
+  m_stallTime = sample.simulationTime;
+}
+
+void
+ProgressMonitorStallTestCase::DoRun (void)
+{
+  Ptr<ProgressMonitor> monitor = CreateObject<ProgressMonitor> ();
+  monitor->SetAttribute ("Interval", TimeValue (MilliSeconds (20)));
+  monitor->SetAttribute ("StallTimeout", TimeValue (MilliSeconds (100)));
+  monitor->SetAttribute ("Print", BooleanValue (false));
+  monitor->TraceConnectWithoutContext ("Stall",
+                                       MakeCallback (&ProgressMonitorStallTestCase::Stall, this));
+
+  // One event which does not return for a long time.
+  Simulator::Schedule (Seconds (3), &Spin, 400);
+  monitor->Start ();
+  Simulator::Run ();
+  monitor->Stop ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_stalls, 1, "The stall should be reported once");
+  NS_TEST_ASSERT_MSG_EQ (m_stallTime, Seconds (3), "Stall at the wrong time");
+  monitor->Dispose ();
+  Simulator::Destroy ();
+}
+
+
+class ProgressMonitorGlobalValueTestCase : public TestCase
+{
+public:
+  ProgressMonitorGlobalValueTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+ProgressMonitorGlobalValueTestCase::ProgressMonitorGlobalValueTestCase ()
+  : TestCase ("Check the ProgressInterval global value")
+{
+}
+
+void
+ProgressMonitorGlobalValueTestCase::DoRun (void)
+{
+  Config::SetGlobal ("ProgressInterval", TimeValue (MilliSeconds (20)));
+  Simulator::Schedule (Seconds (1), &Spin, 100);
+
+  // The monitor is stopped when Simulator::Run returns.
+  std::ostringstream oss;
+  std::streambuf *clogBuffer = std::clog.rdbuf (oss.rdbuf ());
+  Simulator::Run ();
+  std::clog.rdbuf (clogBuffer);
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_NE (oss.str ().find ("Progress: "), std::string::npos,
+                         "No progress report");
+}
+
+void
+ProgressMonitorGlobalValueTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("ProgressInterval", TimeValue (Seconds (0)));
+}
+
+
+static class ProgressMonitorTestSuite : public TestSuite
+{
+public:
+  ProgressMonitorTestSuite ()
+    : TestSuite ("progress-monitor", UNIT)
+  {
+    AddTestCase (new ProgressMonitorCountTestCase (), TestCase::QUICK);
+    AddTestCase (new ProgressMonitorSampleTestCase (), TestCase::QUICK);
+    AddTestCase (new ProgressMonitorStallTestCase (), TestCase::QUICK);
+    AddTestCase (new ProgressMonitorGlobalValueTestCase (), TestCase::QUICK);
+  }
+} g_progressMonitorTestSuite;
@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/test.h"
+#include "ns3/rng-stream.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+// ===========================================================================
+// Test case for the bulk RandU01 of RngStream
+// ===========================================================================
+class RngStreamBulkTestCase : public TestCase
+{
+public:
+  static const uint32_t N_VALUES = 1000;
+
+  RngStreamBulkTestCase ();
+  virtual ~RngStreamBulkTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RngStreamBulkTestCase::RngStreamBulkTestCase ()
+  : TestCase ("Bulk RandU01 matches successive RandU01 calls")
+{
+}
+
+RngStreamBulkTestCase::~RngStreamBulkTestCase ()
+{
+}
+
+void
+RngStreamBulkTestCase::DoRun (void)
+{
+  RngStream bulk (12345, 3, 2);
+  RngStream single (bulk);
+  double values[N_VALUES];
+  const uint32_t sizes[] = { 1, 5, 0, 128, N_VALUES };
+  for (uint32_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+    {
+      bulk.RandU01 (values, sizes[s]);
+      for (uint32_t i = 0; i < sizes[s]; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (values[i], single.RandU01 (),
+                                 "value " << i << " of batch " << s);
+        }
+      NS_TEST_ASSERT_MSG_EQ (bulk.RandU01 (), single.RandU01 (),
+                             "value after batch " << s);
+    }
+}
+
+// ===========================================================================
+// Test case for the bulk GetValues interface
+// ===========================================================================
+class RandomVariableStreamBulkTestCase : public TestCase
+{
+public:
+  static const uint32_t N_VALUES = 1000;
+
+  RandomVariableStreamBulkTestCase ();
+  virtual ~RandomVariableStreamBulkTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that GetValues on \p bulk returns the same sequence as
+   * GetValue on \p single, in batches of several sizes.
+   */
+  void Check (Ptr<RandomVariableStream> bulk,
+              Ptr<RandomVariableStream> single,
+              std::string name);
+};
+
+RandomVariableStreamBulkTestCase::RandomVariableStreamBulkTestCase ()
+  : TestCase ("Bulk GetValues matches successive GetValue calls")
+{
+}
+
+RandomVariableStreamBulkTestCase::~RandomVariableStreamBulkTestCase ()
+{
+}
+
+void
+RandomVariableStreamBulkTestCase::Check (Ptr<RandomVariableStream> bulk,
+                                         Ptr<RandomVariableStream> single,
+                                         std::string name)
+{
+  bulk->SetStream (17);
+  single->SetStream (17);
+  double values[N_VALUES];
+  const uint32_t sizes[] = { 1, 7, 0, 64, 3, N_VALUES };
+  for (uint32_t s = 0; s < sizeof (sizes) / sizeof (sizes[0]); ++s)
+    {
+      bulk->GetValues (values, sizes[s]);
+      for (uint32_t i = 0; i < sizes[s]; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (values[i], single->GetValue (),
+                                 name << " value " << i << " of batch " << s);
+        }
+      // Single draws after a batch continue the same sequence.
+      NS_TEST_ASSERT_MSG_EQ (bulk->GetValue (), single->GetValue (),
+                             name << " value after batch " << s);
+    }
+}
+
+void
+RandomVariableStreamBulkTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> u1 = CreateObject<UniformRandomVariable> ();
+  Ptr<UniformRandomVariable> u2 = CreateObject<UniformRandomVariable> ();
+  u1->SetAttribute ("Min", DoubleValue (-3.0));
+  u1->SetAttribute ("Max", DoubleValue (5.0));
+  u2->SetAttribute ("Min", DoubleValue (-3.0));
+  u2->SetAttribute ("Max", DoubleValue (5.0));
+  Check (u1, u2, "Uniform");
+  u1->SetAttribute ("Antithetic", BooleanValue (true));
+  u2->SetAttribute ("Antithetic", BooleanValue (true));
+  Check (u1, u2, "Antithetic uniform");
+
+  Ptr<ExponentialRandomVariable> e1 = CreateObject<ExponentialRandomVariable> ();
+  Ptr<ExponentialRandomVariable> e2 = CreateObject<ExponentialRandomVariable> ();
+  Check (e1, e2, "Exponential");
+  // A tight bound rejects many draws.
+  e1->SetAttribute ("Bound", DoubleValue (0.5));
+  e2->SetAttribute ("Bound", DoubleValue (0.5));
+  Check (e1, e2, "Bounded exponential");
+
+  Ptr<ConstantRandomVariable> c1 = CreateObject<ConstantRandomVariable> ();
+  Ptr<ConstantRandomVariable> c2 = CreateObject<ConstantRandomVariable> ();
+  c1->SetAttribute ("Constant", DoubleValue (7.0));
+  c2->SetAttribute ("Constant", DoubleValue (7.0));
+  Check (c1, c2, "Constant");
+
+  // The default implementation, here with a generator which caches
+  // values between calls.
+  Ptr<NormalRandomVariable> n1 = CreateObject<NormalRandomVariable> ();
+  Ptr<NormalRandomVariable> n2 = CreateObject<NormalRandomVariable> ();
+  Check (n1, n2, "Normal");
+}
+
+class RandomVariableStreamBulkTestSuite : public TestSuite
+{
+public:
+  RandomVariableStreamBulkTestSuite ();
+};
+
+RandomVariableStreamBulkTestSuite::RandomVariableStreamBulkTestSuite ()
+  : TestSuite ("random-variable-stream-bulk", UNIT)
+{
+  AddTestCase (new RngStreamBulkTestCase, TestCase::QUICK);
+  AddTestCase (new RandomVariableStreamBulkTestCase, TestCase::QUICK);
+}
+
+static RandomVariableStreamBulkTestSuite randomVariableStreamBulkTestSuite;
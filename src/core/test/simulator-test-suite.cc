@@ -24,6 +24,8 @@
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
 
+#include <vector>
+
 using namespace ns3;
 
 class SimulatorEventsTestCase : public TestCase
@@ -459,6 +461,127 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorBatchTestCase : public TestCase
+{
+public:
+  SimulatorBatchTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Record (uint32_t id);
+  void ScheduleFromEvent (void);
+  void Add (uint32_t id, uint32_t us);
+  void AddToBatch (EventBatch &batch, uint32_t id, uint32_t us);
+
+  /** An event expected or run: its id, time and context. */
+  struct Run
+  {
+    uint32_t id;
+    uint64_t ts;
+    uint32_t context;
+  };
+  std::vector<struct Run> m_expected;
+  std::vector<struct Run> m_runs;
+  ObjectFactory m_schedulerFactory;
+};
+
+SimulatorBatchTestCase::SimulatorBatchTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that batches of events run in order with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorBatchTestCase::Record (uint32_t id)
+{
+  struct Run run;
+  run.id = id;
+  run.ts = Simulator::Now ().GetTimeStep ();
+  run.context = Simulator::GetContext ();
+  m_runs.push_back (run);
+}
+
+void
+SimulatorBatchTestCase::Add (uint32_t id, uint32_t us)
+{
+  // Events run by time, and in scheduling order at the same time:
+  // keep the expected runs sorted that way.
+  struct Run run;
+  run.id = id;
+  run.ts = (Simulator::Now () + MicroSeconds (us)).GetTimeStep ();
+  run.context = id;
+  std::vector<struct Run>::iterator i = m_expected.begin ();
+  while (i != m_expected.end () && i->ts <= run.ts)
+    {
+      i++;
+    }
+  m_expected.insert (i, run);
+}
+
+void
+SimulatorBatchTestCase::AddToBatch (EventBatch &batch, uint32_t id, uint32_t us)
+{
+  Add (id, us);
+  batch.Add (id, MicroSeconds (us), &SimulatorBatchTestCase::Record, this, id);
+}
+
+void
+SimulatorBatchTestCase::ScheduleFromEvent (void)
+{
+  EventBatch batch;
+  AddToBatch (batch, 200, 1);
+  AddToBatch (batch, 201, 0);
+  AddToBatch (batch, 202, 1);
+  Simulator::ScheduleWithContext (batch);
+}
+
+void
+SimulatorBatchTestCase::DoRun (void)
+{
+  Simulator::SetScheduler (m_schedulerFactory);
+  m_expected.clear ();
+  m_runs.clear ();
+
+  Add (0, 5);
+  Simulator::ScheduleWithContext (0, MicroSeconds (5), &SimulatorBatchTestCase::Record, this, 0);
+  Add (1, 3);
+  Simulator::ScheduleWithContext (1, MicroSeconds (3), &SimulatorBatchTestCase::Record, this, 1);
+
+  // A batch larger than the event list, then a smaller one.
+  EventBatch batch;
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      AddToBatch (batch, 100 + i, (i * 7) % 10);
+    }
+  NS_TEST_ASSERT_MSG_EQ (batch.GetN (), 20, "Wrong batch size");
+  Simulator::ScheduleWithContext (batch);
+  NS_TEST_ASSERT_MSG_EQ (batch.IsEmpty (), true, "Batch not emptied");
+  AddToBatch (batch, 2, 3);
+  AddToBatch (batch, 3, 0);
+  Simulator::ScheduleWithContext (batch);
+
+  Add (4, 3);
+  Simulator::ScheduleWithContext (4, MicroSeconds (3), &SimulatorBatchTestCase::Record, this, 4);
+  // A batch scheduled while the simulation runs.
+  Simulator::Schedule (MicroSeconds (4), &SimulatorBatchTestCase::ScheduleFromEvent, this);
+
+  // The events of a batch which is not scheduled never run.
+  {
+    EventBatch dropped;
+    dropped.Add (6, MicroSeconds (1), &SimulatorBatchTestCase::Record, this, 6);
+  }
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_runs.size (), m_expected.size (), "Wrong number of events run");
+  for (uint32_t i = 0; i < m_runs.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_runs[i].id, m_expected[i].id, "Wrong order at " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_runs[i].ts, m_expected[i].ts, "Wrong time at " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_runs[i].context, m_expected[i].context, "Wrong context at " << i);
+    }
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -469,11 +592,15 @@ public:
     factory.SetTypeId (ListScheduler::GetTypeId ());
 
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorBatchTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (MapScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorBatchTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (HeapScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorBatchTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorBatchTestCase (factory), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -230,6 +230,52 @@ TimeInputOutputTestCase::DoRun (void)
   std::cout << std::endl;
 }
     
+class TimeFastPathTestCase : public TestCase
+{
+public:
+  TimeFastPathTestCase ();
+private:
+  virtual void DoRun (void);
+  void Check (double value, enum Time::Unit unit);
+};
+
+TimeFastPathTestCase::TimeFastPathTestCase ()
+  : TestCase ("Checks the fast conversion paths match the exact ones")
+{
+}
+
+void
+TimeFastPathTestCase::Check (double value, enum Time::Unit unit)
+{
+  // The reference goes through the long double int64x64_t constructor,
+  // which does not take the fast path.
+  Time fast = Time::FromDouble (value, unit);
+  Time exact = Time::From (int64x64_t (static_cast<long double> (value)), unit);
+  NS_TEST_ASSERT_MSG_EQ (fast.GetTimeStep (), exact.GetTimeStep (),
+                         "FromDouble (" << value << ", " << unit << ")");
+  NS_TEST_ASSERT_MSG_EQ (fast.ToDouble (unit), fast.To (unit).GetDouble (),
+                         "ToDouble (" << unit << ") of " << fast);
+}
+
+void
+TimeFastPathTestCase::DoRun (void)
+{
+  const double values[] = {
+    0.0, 1.0, -1.0, 2.0, 10.0, -10.0, 1000.0, 123456789.0,
+    0.5, -0.5, 0.137, 1.25, -3.75, 1e-9, 1e-15, 1.5e-12,
+    4503599627370496.0, 9007199254740992.0, -9007199254740992.0,
+    1e10, -1e12, 1e15
+  };
+  const uint32_t nValues = sizeof (values) / sizeof (values[0]);
+  for (int unit = Time::Y; unit < Time::LAST; unit++)
+    {
+      for (uint32_t i = 0; i < nValues; i++)
+        {
+          Check (values[i], static_cast<enum Time::Unit> (unit));
+        }
+    }
+}
+
 static class TimeTestSuite : public TestSuite
 {
 public:
@@ -238,6 +284,7 @@ public:
   {
     AddTestCase (new TimeWithSignTestCase (), TestCase::QUICK);
     AddTestCase (new TimeInputOutputTestCase (), TestCase::QUICK);
+    AddTestCase (new TimeFastPathTestCase (), TestCase::QUICK);
     // This should be last, since it changes the resolution
     AddTestCase (new TimeSimpleTestCase (), TestCase::QUICK);
   }
@@ -19,6 +19,8 @@
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
 
+#include <string>
+
 using namespace ns3;
 
 class BasicTracedCallbackTestCase : public TestCase
@@ -108,6 +110,163 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ChainTracedCallbackTestCase : public TestCase
+{
+public:
+  ChainTracedCallbackTestCase ();
+  virtual ~ChainTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  static void Record (std::string *calls, int id, int arg);
+  void Disconnect (int arg);
+  int Argument (void);
+
+  std::string m_calls;
+  int m_evaluations;
+  TracedCallback<int> *m_trace;
+  Callback<void, int> m_disconnected;
+  Callback<void, int> m_later;
+};
+
+ChainTracedCallbackTestCase::ChainTracedCallbackTestCase ()
+  : TestCase ("Check TracedCallback chain order, copies and NS_TRACE")
+{
+}
+
+void
+ChainTracedCallbackTestCase::Record (std::string *calls, int id, int arg)
+{
+  *calls += static_cast<char> ('0' + id);
+}
+
+void
+ChainTracedCallbackTestCase::Disconnect (int arg)
+{
+  m_calls += 'd';
+  m_trace->DisconnectWithoutContext (m_disconnected);
+  m_trace->DisconnectWithoutContext (m_later);
+}
+
+int
+ChainTracedCallbackTestCase::Argument (void)
+{
+  m_evaluations++;
+  return 0;
+}
+
+void
+ChainTracedCallbackTestCase::DoRun (void)
+{
+  TracedCallback<int> trace;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "New trace source not empty");
+
+  //
+  // Callbacks bound to different ids compare different.
+  // They must be called in the order they were connected.
+  //
+  for (int i = 1; i <= 4; i++)
+    {
+      trace.ConnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Record, &m_calls, i));
+    }
+  Callback<void, int> five = MakeBoundCallback (&ChainTracedCallbackTestCase::Record, &m_calls, 5);
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "Connected trace source empty");
+  m_calls = "";
+  trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "1234", "Callbacks not called in order");
+
+  //
+  // A copy has its own chain.
+  //
+  TracedCallback<int> copy = trace;
+  copy.ConnectWithoutContext (five);
+  m_calls = "";
+  copy (5);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "12345", "Copy lost or reordered Callbacks");
+  m_calls = "";
+  trace (5);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "1234", "Connecting to a copy changed the original");
+
+  //
+  // Disconnecting removes every copy of a Callback and keeps the
+  // order of the others.
+  //
+  copy.DisconnectWithoutContext (five);
+  copy.ConnectWithoutContext (five);
+  copy.ConnectWithoutContext (five);
+  m_calls = "";
+  copy (7);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "123455", "Duplicate Callbacks not kept");
+  copy.DisconnectWithoutContext (five);
+  m_calls = "";
+  copy (7);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "1234", "Duplicate Callbacks not all removed");
+
+  trace.DisconnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Record, &m_calls, 1));
+  m_calls = "";
+  trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "234", "Disconnecting the first Callback reordered the others");
+
+  //
+  // A Callback disconnecting an earlier and a later one while the chain
+  // is invoked: the later one is not called, the others are called
+  // once, in order.
+  //
+  TracedCallback<int> changing;
+  for (int i = 1; i <= 2; i++)
+    {
+      changing.ConnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Record, &m_calls, i));
+    }
+  changing.ConnectWithoutContext (MakeCallback (&ChainTracedCallbackTestCase::Disconnect, this));
+  for (int i = 3; i <= 5; i++)
+    {
+      changing.ConnectWithoutContext (MakeBoundCallback (&ChainTracedCallbackTestCase::Record, &m_calls, i));
+    }
+  m_trace = &changing;
+  m_disconnected = MakeBoundCallback (&ChainTracedCallbackTestCase::Record, &m_calls, 1);
+  m_later = MakeBoundCallback (&ChainTracedCallbackTestCase::Record, &m_calls, 4);
+  m_calls = "";
+  changing (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "12d35", "Callbacks skipped or repeated while disconnecting");
+  m_calls = "";
+  changing (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "2d35", "Disconnected Callbacks still called");
+  m_trace = 0;
+
+  TracedCallback<int> single;
+  single.ConnectWithoutContext (five);
+  single.ConnectWithoutContext (five);
+  single.DisconnectWithoutContext (five);
+  NS_TEST_ASSERT_MSG_EQ (single.IsEmpty (), true, "Disconnected trace source not empty");
+
+  //
+  // NS_TRACE only evaluates the arguments if a Callback is connected.
+  //
+  m_evaluations = 0;
+  m_calls = "";
+  NS_TRACE (single, (Argument ()));
+  NS_TEST_ASSERT_MSG_EQ (m_evaluations, 0, "Arguments of an empty trace source evaluated");
+  single.ConnectWithoutContext (five);
+  NS_TRACE (single, (Argument ()));
+  NS_TEST_ASSERT_MSG_EQ (m_evaluations, 1, "Arguments not evaluated once");
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "5", "Trace source not fired");
+
+  //
+  // NS_TRACE_OPTIONAL is compiled out by NS3_TRACING_DISABLE,
+  // NS_TRACE never is.
+  //
+  m_evaluations = 0;
+  m_calls = "";
+  NS_TRACE_OPTIONAL (single, (Argument ()));
+#ifdef NS3_TRACING_DISABLE
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "", "Disabled trace source fired");
+#else
+  NS_TEST_ASSERT_MSG_EQ (m_evaluations, 1, "Arguments not evaluated once");
+  NS_TEST_ASSERT_MSG_EQ (m_calls, "5", "Trace source not fired");
+#endif
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -118,6 +277,7 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ChainTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
@@ -25,6 +25,10 @@
 #include "ns3/type-id.h"
 #include "ns3/test.h"
 #include "ns3/log.h"
+#include "ns3/object-base.h"
+#include "ns3/uinteger.h"
+#include "ns3/traced-callback.h"
+#include "ns3/trace-source-accessor.h"
 
 using namespace std;
 
@@ -188,6 +192,113 @@ CollisionTestCase::DoRun (void)
 }
   
   
+//----------------------------
+//
+// Attribute and trace source lookup test
+
+/** Holder of the attributes and trace sources of the lookup test. */
+class LookupTestObject : public ObjectBase
+{
+public:
+  /** The attribute value. */
+  uint32_t m_value;
+  /** The trace source. */
+  TracedCallback<uint32_t> m_trace;
+};
+
+class AttributeLookupTestCase : public TestCase
+{
+public:
+  AttributeLookupTestCase ();
+  virtual ~AttributeLookupTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Add an attribute to a TypeId.
+   * \param [in] tid The TypeId.
+   * \param [in] name The attribute name.
+   */
+  void AddAttribute (TypeId tid, std::string name);
+  /**
+   * Add a trace source to a TypeId.
+   * \param [in] tid The TypeId.
+   * \param [in] name The trace source name.
+   */
+  void AddTraceSource (TypeId tid, std::string name);
+};
+
+AttributeLookupTestCase::AttributeLookupTestCase ()
+  : TestCase ("Check attribute and trace source lookup by name")
+{
+}
+
+AttributeLookupTestCase::~AttributeLookupTestCase ()
+{
+}
+
+void
+AttributeLookupTestCase::AddAttribute (TypeId tid, std::string name)
+{
+  tid.AddAttribute (name, "An attribute.",
+                    UintegerValue (0),
+                    MakeUintegerAccessor (&LookupTestObject::m_value),
+                    MakeUintegerChecker<uint32_t> ());
+}
+
+void
+AttributeLookupTestCase::AddTraceSource (TypeId tid, std::string name)
+{
+  tid.AddTraceSource (name, "A trace source.",
+                      MakeTraceSourceAccessor (&LookupTestObject::m_trace),
+                      "ns3::TracedValueCallback::Uint32");
+}
+
+void
+AttributeLookupTestCase::DoRun (void)
+{
+  TypeId parent = TypeId ("ns3::TypeIdTestLookupParent")
+    .SetParent (ObjectBase::GetTypeId ());
+  TypeId child = TypeId ("ns3::TypeIdTestLookupChild")
+    .SetParent (parent);
+  // "daemon" and "unerring" have the same Murmur3 hash
+  AddAttribute (parent, "daemon");
+  AddAttribute (child, "Child");
+  AddAttribute (child, "unerring");
+  AddTraceSource (parent, "ParentTrace");
+  AddTraceSource (child, "ChildTrace");
+
+  const char *names[] = { "daemon", "Child", "unerring" };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      struct TypeId::AttributeInformation info;
+      NS_TEST_ASSERT_MSG_EQ (child.LookupAttributeByName (names[i], &info), true,
+                             "Attribute " << names[i] << " not found");
+      NS_TEST_ASSERT_MSG_EQ (info.name, names[i], "Wrong attribute found");
+    }
+  struct TypeId::AttributeInformation info;
+  NS_TEST_ASSERT_MSG_EQ (child.LookupAttributeByName ("Missing", &info), false,
+                         "Found a missing attribute");
+  NS_TEST_ASSERT_MSG_EQ (parent.LookupAttributeByName ("Child", &info), false,
+                         "Found a child attribute in the parent");
+  NS_TEST_ASSERT_MSG_EQ (parent.LookupAttributeByName ("unerring", &info), false,
+                         "Found an attribute from its hash");
+  NS_TEST_ASSERT_MSG_NE (child.LookupTraceSourceByName ("ParentTrace"), 0,
+                         "Parent trace source not found");
+  NS_TEST_ASSERT_MSG_NE (child.LookupTraceSourceByName ("ChildTrace"), 0,
+                         "Trace source not found");
+  NS_TEST_ASSERT_MSG_EQ (parent.LookupTraceSourceByName ("ChildTrace"), 0,
+                         "Found a child trace source in the parent");
+
+  // Attributes registered after a lookup are found
+  AddAttribute (parent, "Late");
+  AddTraceSource (parent, "LateTrace");
+  NS_TEST_ASSERT_MSG_EQ (child.LookupAttributeByName ("Late", &info), true,
+                         "Late attribute not found");
+  NS_TEST_ASSERT_MSG_NE (child.LookupTraceSourceByName ("LateTrace"), 0,
+                         "Late trace source not found");
+}
+
+
 //----------------------------
 //
 // Performance test
@@ -298,6 +409,7 @@ TypeIdTestSuite::TypeIdTestSuite ()
   // as chained.
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
+  AddTestCase (new AttributeLookupTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;  
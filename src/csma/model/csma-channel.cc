@@ -224,18 +224,21 @@ CsmaChannel::TransmitEnd ()
 
   std::vector<CsmaDeviceRec>::iterator it;
   uint32_t devId = 0;
+  EventBatch batch;
+  batch.Reserve (m_deviceList.size ());
   for (it = m_deviceList.begin (); it < m_deviceList.end (); it++)
     {
       if (it->IsActive ())
         {
           // schedule reception events
-          Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
-                                          m_delay,
-                                          &CsmaNetDevice::Receive, it->devicePtr,
-                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+          batch.Add (it->devicePtr->GetNode ()->GetId (),
+                     m_delay,
+                     &CsmaNetDevice::Receive, it->devicePtr,
+                     m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
         }
       devId++;
     }
+  Simulator::ScheduleWithContext (batch);
 
   // also schedule for the tx side to go back to IDLE
   Simulator::Schedule (m_delay, &CsmaChannel::PropagationCompleteEvent,
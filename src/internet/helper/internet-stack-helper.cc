@@ -234,10 +234,7 @@ InternetStackHelper::InternetStackHelper ()
   : m_routing (0),
     m_routingv6 (0),
     m_ipv4Enabled (true),
-    m_ipv6Enabled (true),
-    m_ipv4ArpJitterEnabled (true),
-    m_ipv6NsRsJitterEnabled (true)
-
+    m_ipv6Enabled (true)
 {
   Initialize ();
 }
@@ -247,6 +244,13 @@ void
 InternetStackHelper::Initialize ()
 {
   SetTcp ("ns3::TcpL4Protocol");
+  m_arpFactory = ObjectFactory ("ns3::ArpL3Protocol");
+  m_ipv4Factory = ObjectFactory ("ns3::Ipv4L3Protocol");
+  m_icmpv4Factory = ObjectFactory ("ns3::Icmpv4L4Protocol");
+  m_ipv6Factory = ObjectFactory ("ns3::Ipv6L3Protocol");
+  m_icmpv6Factory = ObjectFactory ("ns3::Icmpv6L4Protocol");
+  m_trafficControlFactory = ObjectFactory ("ns3::TrafficControlLayer");
+  m_udpFactory = ObjectFactory ("ns3::UdpL4Protocol");
   Ipv4StaticRoutingHelper staticRouting;
   Ipv4GlobalRoutingHelper globalRouting;
   Ipv4ListRoutingHelper listRouting;
@@ -270,8 +274,13 @@ InternetStackHelper::InternetStackHelper (const InternetStackHelper &o)
   m_ipv4Enabled = o.m_ipv4Enabled;
   m_ipv6Enabled = o.m_ipv6Enabled;
   m_tcpFactory = o.m_tcpFactory;
-  m_ipv4ArpJitterEnabled = o.m_ipv4ArpJitterEnabled;
-  m_ipv6NsRsJitterEnabled = o.m_ipv6NsRsJitterEnabled;
+  m_arpFactory = o.m_arpFactory;
+  m_ipv4Factory = o.m_ipv4Factory;
+  m_icmpv4Factory = o.m_icmpv4Factory;
+  m_ipv6Factory = o.m_ipv6Factory;
+  m_icmpv6Factory = o.m_icmpv6Factory;
+  m_trafficControlFactory = o.m_trafficControlFactory;
+  m_udpFactory = o.m_udpFactory;
 }
 
 InternetStackHelper &
@@ -295,8 +304,6 @@ InternetStackHelper::Reset (void)
   m_routingv6 = 0;
   m_ipv4Enabled = true;
   m_ipv6Enabled = true;
-  m_ipv4ArpJitterEnabled = true;
-  m_ipv6NsRsJitterEnabled = true;
   Initialize ();
 }
 
@@ -327,12 +334,20 @@ void InternetStackHelper::SetIpv6StackInstall (bool enable)
 
 void InternetStackHelper::SetIpv4ArpJitter (bool enable)
 {
-  m_ipv4ArpJitterEnabled = enable;
+  m_arpFactory = ObjectFactory ("ns3::ArpL3Protocol");
+  if (enable == false)
+    {
+      m_arpFactory.Set ("RequestJitter", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+    }
 }
 
 void InternetStackHelper::SetIpv6NsRsJitter (bool enable)
 {
-  m_ipv6NsRsJitterEnabled = enable;
+  m_icmpv6Factory = ObjectFactory ("ns3::Icmpv6L4Protocol");
+  if (enable == false)
+    {
+      m_icmpv6Factory.Set ("SolicitationJitter", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
+    }
 }
 
 int64_t
@@ -409,10 +424,8 @@ InternetStackHelper::InstallAll (void) const
 }
 
 void
-InternetStackHelper::CreateAndAggregateObjectFromTypeId (Ptr<Node> node, const std::string typeId)
+InternetStackHelper::CreateAndAggregateObject (Ptr<Node> node, const ObjectFactory &factory)
 {
-  ObjectFactory factory;
-  factory.SetTypeId (typeId);
   Ptr<Object> protocol = factory.Create <Object> ();
   node->AggregateObject (protocol);
 }
@@ -429,15 +442,9 @@ InternetStackHelper::Install (Ptr<Node> node) const
           return;
         }
 
-      CreateAndAggregateObjectFromTypeId (node, "ns3::ArpL3Protocol");
-      CreateAndAggregateObjectFromTypeId (node, "ns3::Ipv4L3Protocol");
-      CreateAndAggregateObjectFromTypeId (node, "ns3::Icmpv4L4Protocol");
-      if (m_ipv4ArpJitterEnabled == false)
-        {
-          Ptr<ArpL3Protocol> arp = node->GetObject<ArpL3Protocol> ();
-          NS_ASSERT (arp);
-          arp->SetAttribute ("RequestJitter", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
-        }
+      CreateAndAggregateObject (node, m_arpFactory);
+      CreateAndAggregateObject (node, m_ipv4Factory);
+      CreateAndAggregateObject (node, m_icmpv4Factory);
       // Set routing
       Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
       Ptr<Ipv4RoutingProtocol> ipv4Routing = m_routing->Create (node);
@@ -454,14 +461,8 @@ InternetStackHelper::Install (Ptr<Node> node) const
           return;
         }
 
-      CreateAndAggregateObjectFromTypeId (node, "ns3::Ipv6L3Protocol");
-      CreateAndAggregateObjectFromTypeId (node, "ns3::Icmpv6L4Protocol");
-      if (m_ipv6NsRsJitterEnabled == false)
-        {
-          Ptr<Icmpv6L4Protocol> icmpv6l4 = node->GetObject<Icmpv6L4Protocol> ();
-          NS_ASSERT (icmpv6l4);
-          icmpv6l4->SetAttribute ("SolicitationJitter", StringValue ("ns3::ConstantRandomVariable[Constant=0.0]"));
-        }
+      CreateAndAggregateObject (node, m_ipv6Factory);
+      CreateAndAggregateObject (node, m_icmpv6Factory);
       // Set routing
       Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
       Ptr<Ipv6RoutingProtocol> ipv6Routing = m_routingv6->Create (node);
@@ -474,8 +475,8 @@ InternetStackHelper::Install (Ptr<Node> node) const
 
   if (m_ipv4Enabled || m_ipv6Enabled)
     {
-      CreateAndAggregateObjectFromTypeId (node, "ns3::TrafficControlLayer");
-      CreateAndAggregateObjectFromTypeId (node, "ns3::UdpL4Protocol");
+      CreateAndAggregateObject (node, m_trafficControlFactory);
+      CreateAndAggregateObject (node, m_udpFactory);
       node->AggregateObject (m_tcpFactory.Create<Object> ());
       Ptr<PacketSocketFactory> factory = CreateObject<PacketSocketFactory> ();
       node->AggregateObject (factory);
@@ -291,11 +291,50 @@ private:
   const Ipv6RoutingHelper *m_routingv6;
 
   /**
-   * \brief create an object from its TypeId and aggregates it to the node
+   * \brief ARP objects factory
+   */
+  ObjectFactory m_arpFactory;
+
+  /**
+   * \brief IPv4 objects factory
+   */
+  ObjectFactory m_ipv4Factory;
+
+  /**
+   * \brief ICMPv4 objects factory
+   */
+  ObjectFactory m_icmpv4Factory;
+
+  /**
+   * \brief IPv6 objects factory
+   */
+  ObjectFactory m_ipv6Factory;
+
+  /**
+   * \brief ICMPv6 objects factory
+   */
+  ObjectFactory m_icmpv6Factory;
+
+  /**
+   * \brief TrafficControlLayer objects factory
+   */
+  ObjectFactory m_trafficControlFactory;
+
+  /**
+   * \brief UDP objects factory
+   */
+  ObjectFactory m_udpFactory;
+
+  /**
+   * \brief create an object from a factory and aggregates it to the node
+   *
+   * The factories are kept by the helper, so that the attribute values
+   * of the protocols are resolved once, rather than for each node.
+   *
    * \param node the node
-   * \param typeId the object TypeId
+   * \param factory the object factory
    */
-  static void CreateAndAggregateObjectFromTypeId (Ptr<Node> node, const std::string typeId);
+  static void CreateAndAggregateObject (Ptr<Node> node, const ObjectFactory &factory);
 
   /**
    * \brief checks if there is an hook to a Pcap wrapper
@@ -335,15 +374,6 @@ private:
    */
   bool m_ipv6Enabled;
 
-  /**
-   * \brief IPv4 ARP Jitter state (enabled/disabled) ?
-   */
-  bool m_ipv4ArpJitterEnabled;
-
-  /**
-   * \brief IPv6 IPv6 NS and RS Jitter state (enabled/disabled) ?
-   */
-  bool m_ipv6NsRsJitterEnabled;
 };
 
 } // namespace ns3
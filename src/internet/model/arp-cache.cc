@@ -22,6 +22,7 @@
 #include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 #include "ns3/log.h"
+#include "ns3/memory-accounting.h"
 #include "ns3/node.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/names.h"
@@ -34,6 +35,17 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("ArpCache");
 
+/**
+ * Get the MemoryAccounting counter of the ARP cache entries.
+ * \returns The counter.
+ */
+static MemoryAccounting::Id
+GetEntryAccounting (void)
+{
+  static MemoryAccounting::Id id = MemoryAccounting::Register ("ns3::ArpCache::Entry");
+  return id;
+}
+
 NS_OBJECT_ENSURE_REGISTERED (ArpCache);
 
 TypeId 
@@ -343,6 +355,13 @@ ArpCache::Entry::Entry (ArpCache *arp)
     m_retries (0)
 {
   NS_LOG_FUNCTION (this << arp);
+  MemoryAccounting::Allocate (GetEntryAccounting (), sizeof (Entry));
+}
+
+ArpCache::Entry::~Entry ()
+{
+  NS_LOG_FUNCTION (this);
+  MemoryAccounting::Free (GetEntryAccounting (), sizeof (Entry));
 }
 
 
@@ -183,6 +183,8 @@ public:
      * \param arp The ArpCache this entry belongs to
      */
     Entry (ArpCache *arp);
+    /** Destructor */
+    ~Entry ();
 
     /**
      * \brief Changes the state of this entry to dead
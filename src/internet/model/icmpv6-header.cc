@@ -259,16 +259,16 @@ uint32_t Icmpv6NS::GetSerializedSize () const
 void Icmpv6NS::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION (this << &start);
-  uint8_t buff_target[16];
   uint16_t checksum = 0;
   Buffer::Iterator i = start;
+  Buffer::Span span (i, 24);
 
-  i.WriteU8 (GetType ());
-  i.WriteU8 (GetCode ());
-  i.WriteU16 (0);
-  i.WriteHtonU32 (m_reserved);
-  m_target.Serialize (buff_target);
-  i.Write (buff_target, 16);
+  span.WriteU8 (GetType ());
+  span.WriteU8 (GetCode ());
+  span.WriteU16 (0);
+  span.WriteHtonU32 (m_reserved);
+  WriteTo (span, m_target);
+  span.Commit ();
 
   if (m_calcChecksum)
     {
@@ -283,15 +283,15 @@ void Icmpv6NS::Serialize (Buffer::Iterator start) const
 uint32_t Icmpv6NS::Deserialize (Buffer::Iterator start)
 {
   NS_LOG_FUNCTION (this << &start);
-  uint8_t buf[16];
   Buffer::Iterator i = start;
+  Buffer::Span span (i, 24);
 
-  SetType (i.ReadU8 ());
-  SetCode (i.ReadU8 ());
-  m_checksum = i.ReadU16 ();
-  m_reserved = i.ReadNtohU32 ();
-  i.Read (buf, 16);
-  m_target.Set (buf);
+  SetType (span.ReadU8 ());
+  SetCode (span.ReadU8 ());
+  m_checksum = span.ReadU16 ();
+  m_reserved = span.ReadNtohU32 ();
+  ReadFrom (span, m_target);
+  span.Commit ();
 
   return GetSerializedSize ();
 }
@@ -406,14 +406,14 @@ uint32_t Icmpv6NA::GetSerializedSize () const
 void Icmpv6NA::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION (this << &start);
-  uint8_t buff_target[16];
   uint16_t checksum = 0;
   Buffer::Iterator i = start;
+  Buffer::Span span (i, 24);
   uint32_t reserved = m_reserved;
 
-  i.WriteU8 (GetType ());
-  i.WriteU8 (GetCode ());
-  i.WriteU16 (0);
+  span.WriteU8 (GetType ());
+  span.WriteU8 (GetCode ());
+  span.WriteU16 (0);
 
   if (m_flagR)
     {
@@ -430,9 +430,9 @@ void Icmpv6NA::Serialize (Buffer::Iterator start) const
       reserved |= (uint32_t)(1<< 29);
     }
 
-  i.WriteHtonU32 (reserved);
-  m_target.Serialize (buff_target);
-  i.Write (buff_target, 16);
+  span.WriteHtonU32 (reserved);
+  WriteTo (span, m_target);
+  span.Commit ();
 
   if (m_calcChecksum)
     {
@@ -447,13 +447,13 @@ void Icmpv6NA::Serialize (Buffer::Iterator start) const
 uint32_t Icmpv6NA::Deserialize (Buffer::Iterator start)
 {
   NS_LOG_FUNCTION (this << &start);
-  uint8_t buf[16];
   Buffer::Iterator i = start;
+  Buffer::Span span (i, 24);
 
-  SetType (i.ReadU8 ());
-  SetCode (i.ReadU8 ());
-  m_checksum = i.ReadU16 ();
-  m_reserved = i.ReadNtohU32 ();
+  SetType (span.ReadU8 ());
+  SetCode (span.ReadU8 ());
+  m_checksum = span.ReadU16 ();
+  m_reserved = span.ReadNtohU32 ();
 
   m_flagR = false;
   m_flagS = false;
@@ -474,8 +474,8 @@ uint32_t Icmpv6NA::Deserialize (Buffer::Iterator start)
       m_flagO = true;
     }
 
-  i.Read (buf, 16);
-  m_target.Set (buf);
+  ReadFrom (span, m_target);
+  span.Commit ();
 
   return GetSerializedSize ();
 }
@@ -631,12 +631,13 @@ void Icmpv6RA::Serialize (Buffer::Iterator start) const
   NS_LOG_FUNCTION (this << &start);
   uint16_t checksum = 0;
   Buffer::Iterator i = start;
+  Buffer::Span span (i, 16);
   uint8_t flags = 0;
 
-  i.WriteU8 (GetType ());
-  i.WriteU8 (GetCode ());
-  i.WriteHtonU16 (0);
-  i.WriteU8 (m_curHopLimit);
+  span.WriteU8 (GetType ());
+  span.WriteU8 (GetCode ());
+  span.WriteHtonU16 (0);
+  span.WriteU8 (m_curHopLimit);
 
   if (m_flagM)
     {
@@ -652,10 +653,11 @@ void Icmpv6RA::Serialize (Buffer::Iterator start) const
     {
       flags |= (uint8_t)(1<< 5);
     }
-  i.WriteU8 (flags);
-  i.WriteHtonU16 (GetLifeTime ());
-  i.WriteHtonU32 (GetReachableTime ());
-  i.WriteHtonU32 (GetRetransmissionTime ());
+  span.WriteU8 (flags);
+  span.WriteHtonU16 (GetLifeTime ());
+  span.WriteHtonU32 (GetReachableTime ());
+  span.WriteHtonU32 (GetRetransmissionTime ());
+  span.Commit ();
 
   i = start;
   checksum = i.CalculateIpChecksum (i.GetSize (), GetChecksum ());
@@ -669,12 +671,13 @@ uint32_t Icmpv6RA::Deserialize (Buffer::Iterator start)
 {
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
+  Buffer::Span span (i, 16);
 
-  SetType (i.ReadU8 ());
-  SetCode (i.ReadU8 ());
-  m_checksum = i.ReadU16 ();
-  SetCurHopLimit (i.ReadU8 ());
-  m_flags = i.ReadU8 ();
+  SetType (span.ReadU8 ());
+  SetCode (span.ReadU8 ());
+  m_checksum = span.ReadU16 ();
+  SetCurHopLimit (span.ReadU8 ());
+  m_flags = span.ReadU8 ();
   m_flagM = false;
   m_flagO = false;
   m_flagH = false;
@@ -693,9 +696,10 @@ uint32_t Icmpv6RA::Deserialize (Buffer::Iterator start)
     {
       m_flagH = true;
     }
-  SetLifeTime (i.ReadNtohU16 ());
-  SetReachableTime (i.ReadNtohU32 ());
-  SetRetransmissionTime (i.ReadNtohU32 ());
+  SetLifeTime (span.ReadNtohU16 ());
+  SetReachableTime (span.ReadNtohU32 ());
+  SetRetransmissionTime (span.ReadNtohU32 ());
+  span.Commit ();
 
   return GetSerializedSize ();
 }
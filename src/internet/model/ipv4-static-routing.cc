@@ -25,6 +25,7 @@
 
 #include <iomanip>
 #include "ns3/log.h"
+#include "ns3/memory-accounting.h"
 #include "ns3/names.h"
 #include "ns3/packet.h"
 #include "ns3/node.h"
@@ -40,6 +41,17 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4StaticRouting");
 
+/**
+ * Get the MemoryAccounting counter of the static routes.
+ * \returns The counter.
+ */
+static MemoryAccounting::Id
+GetRouteAccounting (void)
+{
+  static MemoryAccounting::Id id = MemoryAccounting::Register ("ns3::Ipv4StaticRouting::Route");
+  return id;
+}
+
 NS_OBJECT_ENSURE_REGISTERED (Ipv4StaticRouting);
 
 TypeId
@@ -68,6 +80,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
 {
   NS_LOG_FUNCTION (this << network << " " << networkMask << " " << nextHop << " " << interface << " " << metric);
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+  MemoryAccounting::Allocate (GetRouteAccounting (), sizeof (Ipv4RoutingTableEntry));
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         nextHop,
@@ -83,6 +96,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
 {
   NS_LOG_FUNCTION (this << network << " " << networkMask << " " << interface << " " << metric);
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+  MemoryAccounting::Allocate (GetRouteAccounting (), sizeof (Ipv4RoutingTableEntry));
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         interface);
@@ -125,6 +139,7 @@ Ipv4StaticRouting::AddMulticastRoute (Ipv4Address origin,
 {
   NS_LOG_FUNCTION (this << origin << " " << group << " " << inputInterface << " " << &outputInterfaces);
   Ipv4MulticastRoutingTableEntry *route = new Ipv4MulticastRoutingTableEntry ();
+  MemoryAccounting::Allocate (GetRouteAccounting (), sizeof (Ipv4MulticastRoutingTableEntry));
   *route = Ipv4MulticastRoutingTableEntry::CreateMulticastRoute (origin, group, 
                                                                  inputInterface, outputInterfaces);
   m_multicastRoutes.push_back (route);
@@ -138,6 +153,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
 {
   NS_LOG_FUNCTION (this << outputInterface);
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+  MemoryAccounting::Allocate (GetRouteAccounting (), sizeof (Ipv4RoutingTableEntry));
   Ipv4Address network = Ipv4Address ("224.0.0.0");
   Ipv4Mask networkMask = Ipv4Mask ("240.0.0.0");
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
@@ -192,6 +208,7 @@ Ipv4StaticRouting::RemoveMulticastRoute (Ipv4Address origin,
           group == route->GetGroup () &&
           inputInterface == route->GetInputInterface ())
         {
+          MemoryAccounting::Free (GetRouteAccounting (), sizeof (Ipv4MulticastRoutingTableEntry));
           delete *i;
           m_multicastRoutes.erase (i);
           return true;
@@ -211,6 +228,7 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
     {
       if (tmp  == index)
         {
+          MemoryAccounting::Free (GetRouteAccounting (), sizeof (Ipv4MulticastRoutingTableEntry));
           delete *i;
           m_multicastRoutes.erase (i);
           return;
@@ -447,6 +465,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
+          MemoryAccounting::Free (GetRouteAccounting (), sizeof (Ipv4RoutingTableEntry));
           delete j->first;
           m_networkRoutes.erase (j);
           return;
@@ -573,12 +592,14 @@ Ipv4StaticRouting::DoDispose (void)
        j != m_networkRoutes.end (); 
        j = m_networkRoutes.erase (j)) 
     {
+      MemoryAccounting::Free (GetRouteAccounting (), sizeof (Ipv4RoutingTableEntry));
       delete (j->first);
     }
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
     {
+      MemoryAccounting::Free (GetRouteAccounting (), sizeof (Ipv4MulticastRoutingTableEntry));
       delete (*i);
     }
   m_ipv4 = 0;
@@ -613,6 +634,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
+          MemoryAccounting::Free (GetRouteAccounting (), sizeof (Ipv4RoutingTableEntry));
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
@@ -660,6 +682,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
+          MemoryAccounting::Free (GetRouteAccounting (), sizeof (Ipv4RoutingTableEntry));
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
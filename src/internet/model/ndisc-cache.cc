@@ -19,6 +19,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/memory-accounting.h"
 #include "ns3/uinteger.h"
 #include "ns3/node.h"
 #include "ns3/names.h"
@@ -33,6 +34,17 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE ("NdiscCache");
 
+/**
+ * Get the MemoryAccounting counter of the NDISC cache entries.
+ * \returns The counter.
+ */
+static MemoryAccounting::Id
+GetEntryAccounting (void)
+{
+  static MemoryAccounting::Id id = MemoryAccounting::Register ("ns3::NdiscCache::Entry");
+  return id;
+}
+
 NS_OBJECT_ENSURE_REGISTERED (NdiscCache);
 
 TypeId NdiscCache::GetTypeId ()
@@ -211,6 +223,13 @@ NdiscCache::Entry::Entry (NdiscCache* nd)
     m_nsRetransmit (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  MemoryAccounting::Allocate (GetEntryAccounting (), sizeof (Entry));
+}
+
+NdiscCache::Entry::~Entry ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  MemoryAccounting::Free (GetEntryAccounting (), sizeof (Entry));
 }
 
 void NdiscCache::Entry::SetRouter (bool router)
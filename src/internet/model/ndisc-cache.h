@@ -149,6 +149,8 @@ public:
      * \param nd The NdiscCache this entry belongs to.
      */
     Entry (NdiscCache* nd);
+    /** Destructor. */
+    ~Entry ();
 
     /**
      * \brief Changes the state to this entry to INCOMPLETE.
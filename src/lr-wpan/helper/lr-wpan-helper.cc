@@ -47,6 +47,10 @@ AsciiLrWpanMacTransmitSinkWithContext (
   std::string context,
   Ptr<const Packet> p)
 {
+  if (!AsciiTraceHelper::IsSampled (stream, p, PcapHelper::DLT_IEEE802_15_4))
+    {
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -60,6 +64,10 @@ AsciiLrWpanMacTransmitSinkWithoutContext (
   Ptr<OutputStreamWrapper> stream,
   Ptr<const Packet> p)
 {
+  if (!AsciiTraceHelper::IsSampled (stream, p, PcapHelper::DLT_IEEE802_15_4))
+    {
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -27,7 +27,9 @@
 #include "ns3/simulator.h"
 #include "ns3/names.h"
 #include "ns3/string.h"
+#include "ns3/checkpointer.h"
 #include <iostream>
+#include <sstream>
 
 namespace ns3 {
 
@@ -252,6 +254,21 @@ MobilityHelper::EnableAsciiAll (Ptr<OutputStreamWrapper> stream)
 {
   EnableAscii (stream, NodeContainer::GetGlobal ());
 }
+void
+MobilityHelper::EnableCheckpoint (Ptr<Checkpointer> checkpointer, NodeContainer n)
+{
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<MobilityModel> mobility = (*i)->GetObject<MobilityModel> ();
+      if (mobility == 0)
+        {
+          NS_FATAL_ERROR ("Node " << (*i)->GetId () << " has no mobility model");
+        }
+      std::ostringstream oss;
+      oss << "mobility/" << (*i)->GetId ();
+      checkpointer->AddModel (oss.str (), PeekPointer (mobility));
+    }
+}
 int64_t
 MobilityHelper::AssignStreams (NodeContainer c, int64_t stream)
 {
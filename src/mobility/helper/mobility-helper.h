@@ -32,6 +32,7 @@ namespace ns3 {
 
 class PositionAllocator;
 class MobilityModel;
+class Checkpointer;
 
 /**
  * \ingroup mobility
@@ -246,6 +247,14 @@ public:
    * stdc++ output stream.
    */
   static void EnableAsciiAll (Ptr<OutputStreamWrapper> stream);
+  /**
+   * \param checkpointer the checkpointer
+   * \param n node container
+   *
+   * Add the mobility model of each of the nodes in the input
+   * container to the checkpointer, with the name "mobility/<nodeid>".
+   */
+  static void EnableCheckpoint (Ptr<Checkpointer> checkpointer, NodeContainer n);
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by the mobility models (including any position allocators assigned
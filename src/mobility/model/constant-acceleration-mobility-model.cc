@@ -78,5 +78,23 @@ ConstantAccelerationMobilityModel::SetVelocityAndAcceleration (const Vector &vel
   NotifyCourseChange ();
 }
 
+void
+ConstantAccelerationMobilityModel::SaveState (CheckpointWriter &writer) const
+{
+  writer.WriteTime (m_baseTime);
+  writer.WriteVector (m_basePosition);
+  writer.WriteVector (m_baseVelocity);
+  writer.WriteVector (m_acceleration);
+}
+
+void
+ConstantAccelerationMobilityModel::RestoreState (CheckpointReader &reader)
+{
+  m_baseTime = reader.ReadTime ();
+  m_basePosition = reader.ReadVector ();
+  m_baseVelocity = reader.ReadVector ();
+  m_acceleration = reader.ReadVector ();
+}
+
 
 } // namespace ns3
@@ -49,6 +49,10 @@ public:
    */
   void SetVelocityAndAcceleration (const Vector &velocity, const Vector &acceleration);
 
+  // Inherited from MobilityModel
+  virtual void SaveState (CheckpointWriter &writer) const;
+  virtual void RestoreState (CheckpointReader &reader);
+
 private:
   virtual Vector DoGetPosition (void) const;
   virtual void DoSetPosition (const Vector &position);
@@ -58,4 +58,15 @@ ConstantPositionMobilityModel::DoGetVelocity (void) const
   return Vector (0.0, 0.0, 0.0);
 }
 
+void
+ConstantPositionMobilityModel::SaveState (CheckpointWriter &writer) const
+{
+  writer.WriteVector (m_position);
+}
+void
+ConstantPositionMobilityModel::RestoreState (CheckpointReader &reader)
+{
+  m_position = reader.ReadVector ();
+}
+
 } // namespace ns3
@@ -43,6 +43,10 @@ public:
   ConstantPositionMobilityModel ();
   virtual ~ConstantPositionMobilityModel ();
 
+  // Inherited from MobilityModel
+  virtual void SaveState (CheckpointWriter &writer) const;
+  virtual void RestoreState (CheckpointReader &reader);
+
 private:
   virtual Vector DoGetPosition (void) const;
   virtual void DoSetPosition (const Vector &position);
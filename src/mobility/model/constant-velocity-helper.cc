@@ -21,6 +21,7 @@
 #include "ns3/rectangle.h"
 #include "ns3/box.h"
 #include "ns3/log.h"
+#include "ns3/checkpointer.h"
 #include "constant-velocity-helper.h"
 
 namespace ns3 {
@@ -132,4 +133,24 @@ ConstantVelocityHelper::Unpause (void)
   m_paused = false;
 }
 
+void
+ConstantVelocityHelper::SaveState (CheckpointWriter &writer) const
+{
+  NS_LOG_FUNCTION (this);
+  writer.WriteTime (m_lastUpdate);
+  writer.WriteVector (m_position);
+  writer.WriteVector (m_velocity);
+  writer.WriteU8 (m_paused);
+}
+
+void
+ConstantVelocityHelper::RestoreState (CheckpointReader &reader)
+{
+  NS_LOG_FUNCTION (this);
+  m_lastUpdate = reader.ReadTime ();
+  m_position = reader.ReadVector ();
+  m_velocity = reader.ReadVector ();
+  m_paused = reader.ReadU8 ();
+}
+
 } // namespace ns3
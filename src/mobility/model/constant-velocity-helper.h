@@ -27,6 +27,8 @@
 namespace ns3 {
 
 class Rectangle;
+class CheckpointWriter;
+class CheckpointReader;
 
 /**
  * \ingroup mobility
@@ -93,6 +95,16 @@ public:
    * Update position, if not paused, from last position and time of last update
    */
   void Update (void) const;
+  /**
+   * Write the position, velocity and pause state to a checkpoint
+   * \param writer the checkpoint
+   */
+  void SaveState (CheckpointWriter &writer) const;
+  /**
+   * Read the state written by SaveState
+   * \param reader the checkpoint
+   */
+  void RestoreState (CheckpointReader &reader);
 private:
   mutable Time m_lastUpdate; //!< time of last update
   mutable Vector m_position; //!< state variable for current position
@@ -69,4 +69,15 @@ ConstantVelocityMobilityModel::DoGetVelocity (void) const
   return m_helper.GetVelocity ();
 }
 
+void
+ConstantVelocityMobilityModel::SaveState (CheckpointWriter &writer) const
+{
+  m_helper.SaveState (writer);
+}
+void
+ConstantVelocityMobilityModel::RestoreState (CheckpointReader &reader)
+{
+  m_helper.RestoreState (reader);
+}
+
 } // namespace ns3
@@ -54,6 +54,10 @@ public:
    * Unit is meters/s
    */
   void SetVelocity (const Vector &speed);
+
+  // Inherited from MobilityModel
+  virtual void SaveState (CheckpointWriter &writer) const;
+  virtual void RestoreState (CheckpointReader &reader);
 private:
   virtual Vector DoGetPosition (void) const;
   virtual void DoSetPosition (const Vector &position);
@@ -218,6 +218,31 @@ GaussMarkovMobilityModel::DoGetVelocity (void) const
   return m_helper.GetVelocity ();
 }
 
+void
+GaussMarkovMobilityModel::SaveState (CheckpointWriter &writer) const
+{
+  m_helper.SaveState (writer);
+  writer.WriteDouble (m_meanVelocity);
+  writer.WriteDouble (m_meanDirection);
+  writer.WriteDouble (m_meanPitch);
+  writer.WriteDouble (m_Velocity);
+  writer.WriteDouble (m_Direction);
+  writer.WriteDouble (m_Pitch);
+  writer.WriteEvent (m_event);
+}
+void
+GaussMarkovMobilityModel::RestoreState (CheckpointReader &reader)
+{
+  m_helper.RestoreState (reader);
+  m_meanVelocity = reader.ReadDouble ();
+  m_meanDirection = reader.ReadDouble ();
+  m_meanPitch = reader.ReadDouble ();
+  m_Velocity = reader.ReadDouble ();
+  m_Direction = reader.ReadDouble ();
+  m_Pitch = reader.ReadDouble ();
+  m_event = reader.ReadEvent (MakeEvent (&GaussMarkovMobilityModel::Start, this));
+}
+
 int64_t
 GaussMarkovMobilityModel::DoAssignStreams (int64_t stream)
 {
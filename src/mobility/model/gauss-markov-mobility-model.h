@@ -86,6 +86,10 @@ public:
    */
   static TypeId GetTypeId (void);
   GaussMarkovMobilityModel ();
+
+  // Inherited from MobilityModel
+  virtual void SaveState (CheckpointWriter &writer) const;
+  virtual void RestoreState (CheckpointReader &reader);
 private:
   /**
    * Initialize the model and calculate new velocity, direction, and pitch
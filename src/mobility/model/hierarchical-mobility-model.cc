@@ -162,6 +162,17 @@ HierarchicalMobilityModel::DoGetVelocity (void) const
     }
 }
 
+void
+HierarchicalMobilityModel::SaveState (CheckpointWriter &writer) const
+{
+  m_child->SaveState (writer);
+}
+void
+HierarchicalMobilityModel::RestoreState (CheckpointReader &reader)
+{
+  m_child->RestoreState (reader);
+}
+
 void 
 HierarchicalMobilityModel::ParentChanged (Ptr<const MobilityModel> model)
 {
@@ -97,6 +97,19 @@ public:
    */
   void SetParent (Ptr<MobilityModel> model);
 
+  /**
+   * Write the state of the child model.  The parent model, which can
+   * be shared by several hierarchical models, is not written: add it
+   * to the checkpointer on its own.
+   * \param writer the checkpoint
+   */
+  virtual void SaveState (CheckpointWriter &writer) const;
+  /**
+   * Read the state of the child model.
+   * \param reader the checkpoint
+   */
+  virtual void RestoreState (CheckpointReader &reader);
+
 private:
   virtual Vector DoGetPosition (void) const;
   virtual void DoSetPosition (const Vector &position);
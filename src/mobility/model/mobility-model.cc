@@ -22,6 +22,7 @@
 
 #include "mobility-model.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/fatal-error.h"
 
 namespace ns3 {
 
@@ -113,5 +114,17 @@ MobilityModel::DoAssignStreams (int64_t start)
   return 0;
 }
 
+void
+MobilityModel::SaveState (CheckpointWriter &writer) const
+{
+  NS_FATAL_ERROR (GetInstanceTypeId ().GetName () << " can not be saved in a checkpoint");
+}
+
+void
+MobilityModel::RestoreState (CheckpointReader &reader)
+{
+  NS_FATAL_ERROR (GetInstanceTypeId ().GetName () << " can not be restored from a checkpoint");
+}
+
 
 } // namespace ns3
@@ -23,6 +23,7 @@
 #include "ns3/vector.h"
 #include "ns3/object.h"
 #include "ns3/traced-callback.h"
+#include "ns3/checkpointer.h"
 
 namespace ns3 {
 
@@ -35,8 +36,12 @@ namespace ns3 {
  * metric international units.
  *
  * This is a base class for all specific mobility models.
+ *
+ * The mobility models can be added to an ns3::Checkpointer: those which
+ * do not override SaveState() and RestoreState() report a fatal error
+ * when a checkpoint is saved or restored.
  */
-class MobilityModel : public Object
+class MobilityModel : public Object, public Checkpointable
 {
 public:
   /**
@@ -85,6 +90,10 @@ public:
    * \param [in] model Value of the MobilityModel.
    */
   typedef void (* TracedCallback)(Ptr<const MobilityModel> model);
+
+  // Inherited from Checkpointable
+  virtual void SaveState (CheckpointWriter &writer) const;
+  virtual void RestoreState (CheckpointReader &reader);
   
 protected:
   /**
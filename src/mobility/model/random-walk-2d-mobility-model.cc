@@ -74,6 +74,11 @@ RandomWalk2dMobilityModel::GetTypeId (void)
   return tid;
 }
 
+RandomWalk2dMobilityModel::RandomWalk2dMobilityModel ()
+  : m_rebound (false)
+{
+}
+
 void
 RandomWalk2dMobilityModel::DoInitialize (void)
 {
@@ -117,6 +122,7 @@ RandomWalk2dMobilityModel::DoWalk (Time delayLeft)
   if (m_bounds.IsInside (nextPosition))
     {
       m_event = Simulator::Schedule (delayLeft, &RandomWalk2dMobilityModel::DoInitializePrivate, this);
+      m_rebound = false;
     }
   else
     {
@@ -124,6 +130,8 @@ RandomWalk2dMobilityModel::DoWalk (Time delayLeft)
       Time delay = Seconds ((nextPosition.x - position.x) / speed.x);
       m_event = Simulator::Schedule (delay, &RandomWalk2dMobilityModel::Rebound, this,
                                      delayLeft - delay);
+      m_rebound = true;
+      m_reboundLeft = delayLeft - delay;
     }
   NotifyCourseChange ();
 }
@@ -169,12 +177,37 @@ RandomWalk2dMobilityModel::DoSetPosition (const Vector &position)
   m_helper.SetPosition (position);
   Simulator::Remove (m_event);
   m_event = Simulator::ScheduleNow (&RandomWalk2dMobilityModel::DoInitializePrivate, this);
+  m_rebound = false;
 }
 Vector
 RandomWalk2dMobilityModel::DoGetVelocity (void) const
 {
   return m_helper.GetVelocity ();
 }
+void
+RandomWalk2dMobilityModel::SaveState (CheckpointWriter &writer) const
+{
+  m_helper.SaveState (writer);
+  writer.WriteU8 (m_rebound);
+  writer.WriteTime (m_reboundLeft);
+  writer.WriteEvent (m_event);
+}
+void
+RandomWalk2dMobilityModel::RestoreState (CheckpointReader &reader)
+{
+  m_helper.RestoreState (reader);
+  m_rebound = reader.ReadU8 ();
+  m_reboundLeft = reader.ReadTime ();
+  if (m_rebound)
+    {
+      m_event = reader.ReadEvent (MakeEvent (&RandomWalk2dMobilityModel::Rebound, this,
+                                             m_reboundLeft));
+    }
+  else
+    {
+      m_event = reader.ReadEvent (MakeEvent (&RandomWalk2dMobilityModel::DoInitializePrivate, this));
+    }
+}
 int64_t
 RandomWalk2dMobilityModel::DoAssignStreams (int64_t stream)
 {
@@ -51,12 +51,17 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+  RandomWalk2dMobilityModel ();
   /** An enum representing the different working modes of this module. */
   enum Mode  {
     MODE_DISTANCE,
     MODE_TIME
   };
 
+  // Inherited from MobilityModel
+  virtual void SaveState (CheckpointWriter &writer) const;
+  virtual void RestoreState (CheckpointReader &reader);
+
 private:
   /**
    * \brief Performs the rebound of the node if it reaches a boundary
@@ -81,6 +86,8 @@ private:
 
   ConstantVelocityHelper m_helper; //!< helper for this object
   EventId m_event; //!< stored event ID 
+  bool m_rebound; //!< whether m_event calls Rebound, or DoInitializePrivate
+  Time m_reboundLeft; //!< the time left passed to Rebound
   enum Mode m_mode; //!< whether in time or distance mode
   double m_modeDistance; //!< Change direction and speed after this distance
   Time m_modeTime; //!< Change current direction and speed after this delay
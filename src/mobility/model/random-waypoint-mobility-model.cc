@@ -55,6 +55,11 @@ RandomWaypointMobilityModel::GetTypeId (void)
   return tid;
 }
 
+RandomWaypointMobilityModel::RandomWaypointMobilityModel ()
+  : m_beginWalk (false)
+{
+}
+
 void
 RandomWaypointMobilityModel::BeginWalk (void)
 {
@@ -74,6 +79,7 @@ RandomWaypointMobilityModel::BeginWalk (void)
   m_event.Cancel ();
   m_event = Simulator::Schedule (travelDelay,
                                  &RandomWaypointMobilityModel::DoInitializePrivate, this);
+  m_beginWalk = false;
   NotifyCourseChange ();
 }
 
@@ -91,6 +97,7 @@ RandomWaypointMobilityModel::DoInitializePrivate (void)
   m_helper.Pause ();
   Time pause = Seconds (m_pause->GetValue ());
   m_event = Simulator::Schedule (pause, &RandomWaypointMobilityModel::BeginWalk, this);
+  m_beginWalk = true;
   NotifyCourseChange ();
 }
 
@@ -106,12 +113,34 @@ RandomWaypointMobilityModel::DoSetPosition (const Vector &position)
   m_helper.SetPosition (position);
   Simulator::Remove (m_event);
   m_event = Simulator::ScheduleNow (&RandomWaypointMobilityModel::DoInitializePrivate, this);
+  m_beginWalk = false;
 }
 Vector
 RandomWaypointMobilityModel::DoGetVelocity (void) const
 {
   return m_helper.GetVelocity ();
 }
+void
+RandomWaypointMobilityModel::SaveState (CheckpointWriter &writer) const
+{
+  m_helper.SaveState (writer);
+  writer.WriteU8 (m_beginWalk);
+  writer.WriteEvent (m_event);
+}
+void
+RandomWaypointMobilityModel::RestoreState (CheckpointReader &reader)
+{
+  m_helper.RestoreState (reader);
+  m_beginWalk = reader.ReadU8 ();
+  if (m_beginWalk)
+    {
+      m_event = reader.ReadEvent (MakeEvent (&RandomWaypointMobilityModel::BeginWalk, this));
+    }
+  else
+    {
+      m_event = reader.ReadEvent (MakeEvent (&RandomWaypointMobilityModel::DoInitializePrivate, this));
+    }
+}
 int64_t
 RandomWaypointMobilityModel::DoAssignStreams (int64_t stream)
 {
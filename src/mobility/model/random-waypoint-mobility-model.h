@@ -57,6 +57,11 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+  RandomWaypointMobilityModel ();
+
+  // Inherited from MobilityModel
+  virtual void SaveState (CheckpointWriter &writer) const;
+  virtual void RestoreState (CheckpointReader &reader);
 protected:
   virtual void DoInitialize (void);
 private:
@@ -78,6 +83,7 @@ private:
   Ptr<RandomVariableStream> m_speed; //!< random variable to generate speeds
   Ptr<RandomVariableStream> m_pause; //!< random variable to generate pauses
   EventId m_event; //!< event ID of next scheduled event
+  bool m_beginWalk; //!< whether m_event calls BeginWalk, or DoInitializePrivate
 };
 
 } // namespace ns3
@@ -95,7 +95,11 @@ WaypointMobilityModel::AddWaypoint (const Waypoint &waypoint)
 
   if ( !m_lazyNotify )
     {
-      Simulator::Schedule (waypoint.time, &WaypointMobilityModel::Update, this);
+      while ( !m_updates.empty () && m_updates.front ().IsExpired () )
+        {
+          m_updates.pop_front ();
+        }
+      m_updates.push_back (Simulator::Schedule (waypoint.time, &WaypointMobilityModel::Update, this));
     }
 }
 Waypoint
@@ -212,6 +216,50 @@ WaypointMobilityModel::DoGetVelocity (void) const
 {
   return m_velocity;
 }
+void
+WaypointMobilityModel::SaveState (CheckpointWriter &writer) const
+{
+  writer.WriteU8 (m_first);
+  writer.WriteTime (m_current.time);
+  writer.WriteVector (m_current.position);
+  writer.WriteTime (m_next.time);
+  writer.WriteVector (m_next.position);
+  writer.WriteVector (m_velocity);
+  writer.WriteU32 (m_waypoints.size ());
+  for (std::deque<Waypoint>::const_iterator i = m_waypoints.begin (); i != m_waypoints.end (); ++i)
+    {
+      writer.WriteTime (i->time);
+      writer.WriteVector (i->position);
+    }
+  writer.WriteU32 (m_updates.size ());
+  for (std::deque<EventId>::const_iterator i = m_updates.begin (); i != m_updates.end (); ++i)
+    {
+      writer.WriteEvent (*i);
+    }
+}
+void
+WaypointMobilityModel::RestoreState (CheckpointReader &reader)
+{
+  m_first = reader.ReadU8 ();
+  m_current.time = reader.ReadTime ();
+  m_current.position = reader.ReadVector ();
+  m_next.time = reader.ReadTime ();
+  m_next.position = reader.ReadVector ();
+  m_velocity = reader.ReadVector ();
+  m_waypoints.clear ();
+  uint32_t waypoints = reader.ReadU32 ();
+  for (uint32_t i = 0; i < waypoints; ++i)
+    {
+      Time time = reader.ReadTime ();
+      m_waypoints.push_back (Waypoint (time, reader.ReadVector ()));
+    }
+  m_updates.clear ();
+  uint32_t updates = reader.ReadU32 ();
+  for (uint32_t i = 0; i < updates; ++i)
+    {
+      m_updates.push_back (reader.ReadEvent (MakeEvent (&WaypointMobilityModel::Update, this)));
+    }
+}
 
 } // namespace ns3
 
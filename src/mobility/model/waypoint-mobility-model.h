@@ -24,6 +24,7 @@
 #include <deque>
 #include "mobility-model.h"
 #include "ns3/vector.h"
+#include "ns3/event-id.h"
 #include "waypoint.h"
 
 class WaypointMobilityModelNotifyTest;
@@ -128,6 +129,10 @@ public:
    */
   void EndMobility (void);
 
+  // Inherited from MobilityModel
+  virtual void SaveState (CheckpointWriter &writer) const;
+  virtual void RestoreState (CheckpointReader &reader);
+
 private:
   friend class ::WaypointMobilityModelNotifyTest; // To allow Update() calls and access to m_current
 
@@ -186,6 +191,11 @@ private:
    * \brief The current velocity vector
    */
   mutable Vector m_velocity;
+  /**
+   * \brief The Update events scheduled by AddWaypoint, saved in the
+   * checkpoints
+   */
+  std::deque<EventId> m_updates;
 };
 
 } // namespace ns3
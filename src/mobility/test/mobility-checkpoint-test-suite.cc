@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ns3/checkpointer.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/gauss-markov-mobility-model.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/pointer.h"
+#include "ns3/random-walk-2d-mobility-model.h"
+#include "ns3/random-waypoint-mobility-model.h"
+#include "ns3/rectangle.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/waypoint-mobility-model.h"
+
+using namespace ns3;
+
+namespace {
+
+/** A course change of a mobility model. */
+struct CourseChange
+{
+  uint32_t model;   //!< The index of the model.
+  int64_t ts;       //!< The time of the change.
+  Vector position;  //!< The position after the change.
+  Vector velocity;  //!< The velocity after the change.
+};
+
+/**
+ * Compare two course changes, bit for bit.
+ * @param [in] a The first change.
+ * @param [in] b The second change.
+ * @returns @c true if they are identical.
+ */
+bool
+operator == (const CourseChange &a, const CourseChange &b)
+{
+  return a.model == b.model && a.ts == b.ts
+         && a.position.x == b.position.x && a.position.y == b.position.y
+         && a.position.z == b.position.z && a.velocity.x == b.velocity.x
+         && a.velocity.y == b.velocity.y && a.velocity.z == b.velocity.z;
+}
+
+/**
+ * Record a course change.
+ * @param [in] changes The course changes.
+ * @param [in] index The index of the model.
+ * @param [in] model The model.
+ */
+void
+RecordCourseChange (std::vector<CourseChange> *changes, uint32_t index,
+                    Ptr<const MobilityModel> model)
+{
+  CourseChange change;
+  change.model = index;
+  change.ts = Simulator::Now ().GetTimeStep ();
+  change.position = model->GetPosition ();
+  change.velocity = model->GetVelocity ();
+  changes->push_back (change);
+}
+
+} // anonymous namespace
+
+
+/**
+ * Check that the mobility models restored from a checkpoint move
+ * exactly as in the original run.
+ */
+class MobilityCheckpointTestCase : public TestCase
+{
+public:
+  MobilityCheckpointTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Run the simulation, as a new process would.
+   * @param [in] load The checkpoint to restore, or empty to start
+   *             from the beginning.
+   * @param [out] changes The course changes.
+   */
+  void RunSimulation (std::string load, std::vector<CourseChange> &changes);
+
+  /** The file the checkpoints are written to. */
+  std::string m_filename;
+  /** The next automatic stream when the test starts. */
+  uint64_t m_nextStream;
+  /** The time the checkpoint was restored at. */
+  Time m_restoredAt;
+};
+
+MobilityCheckpointTestCase::MobilityCheckpointTestCase ()
+  : TestCase ("Check that the mobility models continue bit-exactly after a restore")
+{
+}
+
+void
+MobilityCheckpointTestCase::RunSimulation (std::string load, std::vector<CourseChange> &changes)
+{
+  // The automatic streams of a new process.
+  RngSeedManager::SetNextStreamIndex (m_nextStream);
+
+  std::vector<Ptr<MobilityModel> > models;
+  Ptr<RandomRectanglePositionAllocator> destinations = CreateObject<RandomRectanglePositionAllocator> ();
+  destinations->SetAttribute ("X", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=50.0]"));
+  destinations->SetAttribute ("Y", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=50.0]"));
+  Ptr<RandomWaypointMobilityModel> waypoint = CreateObject<RandomWaypointMobilityModel> ();
+  waypoint->SetAttribute ("Speed", StringValue ("ns3::UniformRandomVariable[Min=5.0|Max=10.0]"));
+  waypoint->SetAttribute ("Pause", StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=2.0]"));
+  waypoint->SetAttribute ("PositionAllocator", PointerValue (destinations));
+  models.push_back (waypoint);
+
+  // A small area, so that the walk rebounds often.
+  Ptr<RandomWalk2dMobilityModel> walk = CreateObject<RandomWalk2dMobilityModel> ();
+  walk->SetAttribute ("Bounds", RectangleValue (Rectangle (0.0, 10.0, 0.0, 10.0)));
+  walk->SetAttribute ("Mode", EnumValue (RandomWalk2dMobilityModel::MODE_TIME));
+  walk->SetAttribute ("Time", TimeValue (Seconds (3.0)));
+  walk->SetPosition (Vector (5.0, 5.0, 0.0));
+  models.push_back (walk);
+
+  Ptr<WaypointMobilityModel> path = CreateObject<WaypointMobilityModel> ();
+  for (uint32_t i = 0; i < 30; ++i)
+    {
+      path->AddWaypoint (Waypoint (Seconds (1.5 * i), Vector (i * i, 3.0 * i, 0.0)));
+    }
+  models.push_back (path);
+
+  Ptr<GaussMarkovMobilityModel> gaussMarkov = CreateObject<GaussMarkovMobilityModel> ();
+  gaussMarkov->SetAttribute ("TimeStep", TimeValue (Seconds (0.5)));
+  models.push_back (gaussMarkov);
+
+  Ptr<ConstantVelocityMobilityModel> constant = CreateObject<ConstantVelocityMobilityModel> ();
+  constant->SetPosition (Vector (1.0, 2.0, 3.0));
+  constant->SetVelocity (Vector (0.1, 0.2, 0.3));
+  models.push_back (constant);
+
+  NodeContainer nodes;
+  nodes.Create (models.size ());
+  for (uint32_t i = 0; i < models.size (); ++i)
+    {
+      nodes.Get (i)->AggregateObject (models[i]);
+      models[i]->TraceConnectWithoutContext ("CourseChange",
+                                             MakeBoundCallback (&RecordCourseChange, &changes, i));
+    }
+
+  Ptr<Checkpointer> checkpointer = CreateObject<Checkpointer> ();
+  checkpointer->SetAttribute ("Interval", TimeValue (Seconds (7)));
+  checkpointer->SetAttribute ("Filename", StringValue (m_filename));
+  MobilityHelper::EnableCheckpoint (checkpointer, nodes);
+  if (load.empty ())
+    {
+      checkpointer->Start ();
+      checkpointer->SetStopTime (Seconds (40));
+    }
+  else
+    {
+      checkpointer->Load (load);
+      m_restoredAt = Simulator::Now ();
+    }
+  Simulator::Run ();
+  for (uint32_t i = 0; i < models.size (); ++i)
+    {
+      // The final positions.
+      RecordCourseChange (&changes, i, models[i]);
+    }
+  checkpointer->Dispose ();
+  Simulator::Destroy ();
+}
+
+void
+MobilityCheckpointTestCase::DoRun (void)
+{
+  m_filename = CreateTempDirFilename ("mobility.ckpt");
+  m_nextStream = RngSeedManager::PeekNextStreamIndex ();
+
+  std::vector<CourseChange> original;
+  RunSimulation ("", original);
+
+  // The last checkpoint, at 35 s, is restored.
+  std::vector<CourseChange> restored;
+  RunSimulation (m_filename, restored);
+  NS_TEST_ASSERT_MSG_EQ (m_restoredAt, Seconds (35), "Wrong checkpoint restored");
+  NS_TEST_ASSERT_MSG_GT (restored.size (), 10, "Too few course changes after the checkpoint");
+  NS_TEST_ASSERT_MSG_GT (original.size (), restored.size (), "No course change before the checkpoint");
+
+  uint32_t offset = original.size () - restored.size ();
+  for (uint32_t i = 0; i < restored.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((restored[i] == original[offset + i]), true,
+                             "Course change " << i << " after the checkpoint differs");
+    }
+  std::remove (m_filename.c_str ());
+}
+
+
+/**
+ * The mobility checkpoint test suite.
+ */
+class MobilityCheckpointTestSuite : public TestSuite
+{
+public:
+  MobilityCheckpointTestSuite ();
+};
+
+MobilityCheckpointTestSuite::MobilityCheckpointTestSuite ()
+  : TestSuite ("mobility-checkpoint", UNIT)
+{
+  AddTestCase (new MobilityCheckpointTestCase, TestCase::QUICK);
+}
+
+static MobilityCheckpointTestSuite mobilityCheckpointTestSuite;
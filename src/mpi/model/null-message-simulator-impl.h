@@ -71,6 +71,8 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const;
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+  virtual uint64_t GetPendingEventCount (void) const;
 
   /**
    * \return singleton instance
@@ -179,6 +181,8 @@ private:
   // number of events that have been inserted but not yet scheduled,
   // not counting the "destroy" events; this is used for validation
   int m_unscheduledEvents;
+  // number of events executed
+  uint64_t m_eventCount;
 
   uint32_t     m_myId;        // MPI Rank
   uint32_t     m_systemCount; // MPI Size
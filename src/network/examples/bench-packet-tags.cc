@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <iomanip>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+/**
+ * \file
+ * \ingroup packet
+ * Benchmark of the packet tags of forwarded packets.
+ *
+ * Each packet is forwarded over a number of hops.  At each hop, the
+ * sender tags a copy of the packet, as the WiFi MAC does with its
+ * QoS, TX vector, SNR and flow id tags, and the receiver peeks and
+ * removes the tags.  The program reports the time and the number of
+ * PacketTagList allocations per hop; the tags beyond the inline ones
+ * of PacketTagList are allocated:
+ *
+ * \verbatim
+   ./waf --run="bench-packet-tags --tags=4"
+   ./waf --run="bench-packet-tags --tags=6"
+   \endverbatim
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** A tag of 4 bytes, standing for a protocol tag. */
+template <int N>
+class BenchTag : public Tag
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    std::ostringstream oss;
+    oss << "ns3::BenchTag<" << N << ">";
+    static TypeId tid = TypeId (oss.str ().c_str ())
+      .SetParent<Tag> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<BenchTag<N> > ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 4;
+  }
+  virtual void Serialize (TagBuffer i) const
+  {
+    i.WriteU32 (N);
+  }
+  virtual void Deserialize (TagBuffer i)
+  {
+    i.ReadU32 ();
+  }
+  virtual void Print (std::ostream &os) const
+  {
+  }
+};
+
+/** The largest number of tags. */
+const uint32_t MAX_TAGS = 8;
+
+/**
+ * Add, peek or remove the first tags.
+ *
+ * \param [in] p The packet.
+ * \param [in] n The number of tags.
+ * \param [in] op 0 to add, 1 to peek, 2 to remove the tags.
+ */
+void
+Tags (Ptr<Packet> p, uint32_t n, int op)
+{
+  BenchTag<0> t0; BenchTag<1> t1; BenchTag<2> t2; BenchTag<3> t3;
+  BenchTag<4> t4; BenchTag<5> t5; BenchTag<6> t6; BenchTag<7> t7;
+  Tag *tags[MAX_TAGS] = { &t0, &t1, &t2, &t3, &t4, &t5, &t6, &t7 };
+  for (uint32_t i = 0; i < n; i++)
+    {
+      switch (op)
+        {
+        case 0:
+          p->AddPacketTag (*tags[i]);
+          break;
+        case 1:
+          p->PeekPacketTag (*tags[i]);
+          break;
+        default:
+          p->RemovePacketTag (*tags[i]);
+          break;
+        }
+    }
+}
+
+} // anonymous namespace
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t packets = 1000000;
+  uint32_t hops = 4;
+  uint32_t tags = 4;
+
+  CommandLine cmd;
+  cmd.AddValue ("packets", "Number of packets forwarded", packets);
+  cmd.AddValue ("hops", "Number of hops of each packet", hops);
+  cmd.AddValue ("tags", "Number of tags added at each hop", tags);
+  cmd.Parse (argc, argv);
+
+  if (tags > MAX_TAGS)
+    {
+      NS_FATAL_ERROR ("At most " << MAX_TAGS << " tags");
+    }
+  MemoryAccounting::Enable (true);
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      Ptr<Packet> packet = Create<Packet> (1000);
+      for (uint32_t hop = 0; hop < hops; hop++)
+        {
+          Ptr<Packet> sent = packet->Copy ();
+          Tags (sent, tags, 0);
+          Ptr<Packet> received = sent->Copy ();
+          Tags (received, tags, 1);
+          Tags (received, tags, 2);
+          packet = received;
+        }
+    }
+  int64_t ms = clock.End ();
+
+  MemoryAccounting::Counter counter = MemoryAccounting::GetCounter ("ns3::PacketTagList");
+  uint64_t total = static_cast<uint64_t> (packets) * hops;
+  std::cout << tags << " tags: "
+            << std::fixed << std::setprecision (3)
+            << (ms * 1e6) / total << " ns/hop, "
+            << static_cast<double> (counter.allocations) / total << " tag allocations/hop"
+            << std::endl;
+  return 0;
+}
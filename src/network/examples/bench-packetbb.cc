@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/packetbb.h"
+
+/**
+ * \file
+ * \ingroup packetbb
+ * Benchmark of the PacketBB messages.
+ *
+ * Each packet holds messages shaped like the HELLO messages of a
+ * neighborhood discovery protocol: an originator, a hop limit, a
+ * sequence number, message TLVs and two address blocks with address
+ * TLVs.  The size of the value of the message TLVs can be raised to
+ * look like the signatures or the certificates carried by some
+ * protocols.  The program reports the messages per second built,
+ * serialized and deserialized:
+ *
+ * \verbatim
+   ./waf --run="bench-packetbb --packets=100000"
+   ./waf --run="bench-packetbb --packets=100000 --messages=4 --addresses=32"
+   ./waf --run="bench-packetbb --packets=100000 --value=256"
+   \endverbatim
+ */
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * Build a packet.
+ *
+ * \param [in] messages The number of messages.
+ * \param [in] addresses The number of addresses of each address block.
+ * \param [in] valueSize The size of the value of the message TLVs.
+ * \returns The packet.
+ */
+PbbPacket
+BuildPacket (uint32_t messages, uint32_t addresses, uint32_t valueSize)
+{
+  static const uint8_t value[1024] = { 1, 2, 3, 4 };
+  PbbPacket packet;
+  packet.SetSequenceNumber (1);
+  for (uint32_t m = 0; m < messages; m++)
+    {
+      Ptr<PbbMessageIpv4> message = Create<PbbMessageIpv4> ();
+      message->SetType (1);
+      message->SetOriginatorAddress (Ipv4Address (0x0a000001 + m));
+      message->SetHopLimit (255);
+      message->SetSequenceNumber (m);
+      for (uint8_t type = 0; type < 2; type++)
+        {
+          Ptr<PbbTlv> tlv = Create<PbbTlv> ();
+          tlv->SetType (type);
+          tlv->SetValue (value, valueSize);
+          message->TlvPushBack (tlv);
+        }
+      for (uint32_t b = 0; b < 2; b++)
+        {
+          Ptr<PbbAddressBlockIpv4> block = Create<PbbAddressBlockIpv4> ();
+          for (uint32_t i = 0; i < addresses; i++)
+            {
+              block->AddressPushBack (Ipv4Address (0x0a010000 + 256 * b + i));
+            }
+          for (uint32_t i = 0; i < addresses; i += 4)
+            {
+              Ptr<PbbAddressTlv> tlv = Create<PbbAddressTlv> ();
+              tlv->SetType (2);
+              tlv->SetIndexStart (i);
+              tlv->SetIndexStop (std::min (i + 3, addresses - 1));
+              tlv->SetValue (value, 1);
+              block->TlvPushBack (tlv);
+            }
+          message->AddressBlockPushBack (block);
+        }
+      packet.MessagePushBack (message);
+    }
+  return packet;
+}
+
+} // anonymous namespace
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t packets = 100000;
+  uint32_t messages = 2;
+  uint32_t addresses = 16;
+  uint32_t valueSize = 2;
+
+  CommandLine cmd;
+  cmd.AddValue ("packets", "Number of packets of each operation", packets);
+  cmd.AddValue ("messages", "Number of messages per packet", messages);
+  cmd.AddValue ("addresses", "Number of addresses per address block", addresses);
+  cmd.AddValue ("value", "Size of the value of the message TLVs, up to 1024 bytes", valueSize);
+  cmd.Parse (argc, argv);
+  valueSize = std::min<uint32_t> (valueSize, 1024);
+
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      BuildPacket (messages, addresses, valueSize);
+    }
+  int64_t buildMs = clock.End ();
+
+  PbbPacket packet = BuildPacket (messages, addresses, valueSize);
+  uint32_t size = packet.GetSerializedSize ();
+  clock.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      Buffer buffer;
+      buffer.AddAtStart (packet.GetSerializedSize ());
+      packet.Serialize (buffer.Begin ());
+    }
+  int64_t serializeMs = clock.End ();
+
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  packet.Serialize (buffer.Begin ());
+  clock.Start ();
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      PbbPacket copy;
+      copy.Deserialize (buffer.Begin ());
+    }
+  int64_t deserializeMs = clock.End ();
+
+  PbbPacket copy;
+  copy.Deserialize (buffer.Begin ());
+  if (copy != packet)
+    {
+      std::cerr << "The deserialized packet differs" << std::endl;
+      return 1;
+    }
+
+  double total = static_cast<double> (packets) * messages;
+  std::cout << messages << " messages of " << 2 * addresses << " addresses, "
+            << size << " bytes per packet" << std::endl
+            << std::fixed << std::setprecision (0)
+            << "build:       " << total * 1000 / std::max<int64_t> (buildMs, 1) << " messages/s" << std::endl
+            << "serialize:   " << total * 1000 / std::max<int64_t> (serializeMs, 1) << " messages/s" << std::endl
+            << "deserialize: " << total * 1000 / std::max<int64_t> (deserializeMs, 1) << " messages/s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+/**
+ * \file
+ * \ingroup network
+ * Benchmark of the pcap traces of many devices.
+ *
+ * The packets of random sizes are written to one pcap file per
+ * device, in turn, as the trace helpers do.  The program reports the
+ * time per packet spent in the simulation thread, including the
+ * closing of the files, and the size of the files, with the default
+ * writes, or the batched writes of the Asynchronous and
+ * CompressionLevel attributes of PcapFileWrapper:
+ *
+ * \verbatim
+   ./waf --run="bench-pcap-writer --files=200 --packets=1000000"
+   ./waf --run="bench-pcap-writer --files=200 --packets=1000000 --asynchronous=1"
+   ./waf --run="bench-pcap-writer --files=200 --packets=1000000 --asynchronous=1 --compression=1"
+   \endverbatim
+ */
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t files = 200;
+  uint32_t packets = 1000000;
+  bool asynchronous = false;
+  uint32_t compression = 0;
+  std::string prefix = "bench-pcap-writer";
+
+  CommandLine cmd;
+  cmd.AddValue ("files", "Number of pcap files", files);
+  cmd.AddValue ("packets", "Number of packets written", packets);
+  cmd.AddValue ("asynchronous", "Write the batches from a background thread", asynchronous);
+  cmd.AddValue ("compression", "gzip compression level, 0 for none", compression);
+  cmd.AddValue ("prefix", "Prefix of the pcap files", prefix);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::PcapFileWrapper::Asynchronous", BooleanValue (asynchronous));
+  Config::SetDefault ("ns3::PcapFileWrapper::CompressionLevel", UintegerValue (compression));
+
+  // The payloads repeat every few hundred bytes, the headers vary.
+  std::vector<uint8_t> payload (1500);
+  for (uint32_t i = 0; i < payload.size (); i++)
+    {
+      payload[i] = (i * 7) % 251;
+    }
+  Ptr<UniformRandomVariable> size = CreateObject<UniformRandomVariable> ();
+  size->SetAttribute ("Min", DoubleValue (60));
+  size->SetAttribute ("Max", DoubleValue (1500));
+  std::vector<Ptr<const Packet> > samples;
+  for (uint32_t i = 0; i < 1024; i++)
+    {
+      uint32_t n = size->GetInteger ();
+      Ptr<Packet> p = Create<Packet> (&payload[0], n);
+      uint8_t header[20];
+      for (uint32_t j = 0; j < sizeof (header); j++)
+        {
+          header[j] = static_cast<uint8_t> (size->GetInteger ());
+        }
+      p->AddAtEnd (Create<Packet> (header, sizeof (header)));
+      samples.push_back (p);
+    }
+
+  PcapHelper helper;
+  std::vector<Ptr<PcapFileWrapper> > wrappers;
+  std::vector<std::string> names;
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  for (uint32_t i = 0; i < files; i++)
+    {
+      std::ostringstream oss;
+      oss << prefix << "-" << i << ".pcap";
+      wrappers.push_back (helper.CreateFile (oss.str (), std::ios::out, PcapHelper::DLT_EN10MB));
+      names.push_back (oss.str () + (compression > 0 ? ".gz" : ""));
+    }
+  for (uint32_t i = 0; i < packets; i++)
+    {
+      wrappers[i % files]->Write (MicroSeconds (i * 10), samples[i % samples.size ()]);
+    }
+  for (uint32_t i = 0; i < files; i++)
+    {
+      wrappers[i]->Close ();
+    }
+  int64_t ms = clock.End ();
+
+  uint64_t bytes = 0;
+  for (uint32_t i = 0; i < files; i++)
+    {
+      FILE *file = std::fopen (names[i].c_str (), "rb");
+      if (file != 0)
+        {
+          std::fseek (file, 0, SEEK_END);
+          bytes += std::ftell (file);
+          std::fclose (file);
+        }
+      std::remove (names[i].c_str ());
+    }
+
+  std::cout << (asynchronous ? "asynchronous" : "synchronous")
+            << ", compression " << compression << ": "
+            << std::fixed << std::setprecision (1)
+            << (ms * 1e6) / packets << " ns/packet, "
+            << bytes / 1e6 << " MB"
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,258 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <list>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+/**
+ * \file
+ * \ingroup packet
+ * Benchmark of the packet concatenations of a TCP stream over WiFi.
+ *
+ * The sender segments application writes of random sizes into
+ * maximum size segments, as TcpTxBuffer does, adds the TCP, IP, LLC
+ * and WiFi MAC headers and the FCS, and hands a copy of each frame
+ * to the receiver.  The receiver removes them and concatenates the
+ * segments into reads of 64 KiB, as TcpRxBuffer does.  The program
+ * reports the time and the buffer data allocations per delivered
+ * byte, with contiguous or, with \c --scatterGather, scatter-gather
+ * packet buffers, and without packet metadata or with the metadata
+ * of Packet::EnablePrinting or Packet::EnableLazyPrinting:
+ *
+ * \verbatim
+   ./waf --run="bench-scatter-gather --megabytes=200"
+   ./waf --run="bench-scatter-gather --megabytes=200 --scatterGather=1"
+   ./waf --run="bench-scatter-gather --megabytes=200 --metadata=lazy"
+   \endverbatim
+ */
+
+using namespace ns3;
+
+namespace {
+
+/** A header of N bytes, standing for a protocol header. */
+template <int N>
+class BenchHeader : public Header
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    std::ostringstream oss;
+    oss << "ns3::BenchHeader<" << N << ">";
+    static TypeId tid = TypeId (oss.str ().c_str ())
+      .SetParent<Header> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<BenchHeader<N> > ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return N;
+  }
+  virtual void Serialize (Buffer::Iterator i) const
+  {
+    i.WriteU8 (N, N);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator i)
+  {
+    i.Next (N);
+    return N;
+  }
+  virtual void Print (std::ostream &os) const
+  {
+  }
+};
+
+/** The 4 bytes FCS of a WiFi frame. */
+class BenchTrailer : public Trailer
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchTrailer")
+      .SetParent<Trailer> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<BenchTrailer> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 4;
+  }
+  virtual void Serialize (Buffer::Iterator i) const
+  {
+    i.Prev (4);
+    i.WriteU32 (0);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator i)
+  {
+    i.Prev (4);
+    i.ReadU32 ();
+    return 4;
+  }
+  virtual void Print (std::ostream &os) const
+  {
+  }
+};
+
+/** The TCP maximum segment size. */
+const uint32_t MSS = 1448;
+/** The size of the application reads. */
+const uint32_t READ_SIZE = 65536;
+
+/**
+ * Build the next segment from the application writes, as
+ * TcpTxBuffer::CopyFromSequence does.
+ *
+ * \param [in,out] writes The pending application writes.
+ * \param [in,out] offset The offset of the next byte in the first write.
+ * \returns The segment.
+ */
+Ptr<Packet>
+Segment (std::list<Ptr<Packet> > &writes, uint32_t &offset)
+{
+  Ptr<Packet> segment = Create<Packet> ();
+  while (segment->GetSize () < MSS && !writes.empty ())
+    {
+      Ptr<Packet> write = writes.front ();
+      uint32_t size = std::min (MSS - segment->GetSize (), write->GetSize () - offset);
+      segment->AddAtEnd (write->CreateFragment (offset, size));
+      offset += size;
+      if (offset == write->GetSize ())
+        {
+          writes.pop_front ();
+          offset = 0;
+        }
+    }
+  return segment;
+}
+
+} // anonymous namespace
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t megabytes = 100;
+  bool scatterGather = false;
+  std::string metadata = "none";
+
+  CommandLine cmd;
+  cmd.AddValue ("megabytes", "Megabytes delivered", megabytes);
+  cmd.AddValue ("scatterGather", "Use scatter-gather packet buffers", scatterGather);
+  cmd.AddValue ("metadata", "Packet metadata: none, eager or lazy", metadata);
+  cmd.Parse (argc, argv);
+
+  if (scatterGather)
+    {
+      Packet::EnableScatterGather ();
+    }
+  if (metadata == "eager")
+    {
+      Packet::EnablePrinting ();
+    }
+  else if (metadata == "lazy")
+    {
+      Packet::EnableLazyPrinting ();
+    }
+  else if (metadata != "none")
+    {
+      NS_FATAL_ERROR ("Unknown metadata mode " << metadata);
+    }
+  Ptr<UniformRandomVariable> writeSize = CreateObject<UniformRandomVariable> ();
+  writeSize->SetAttribute ("Min", DoubleValue (100));
+  writeSize->SetAttribute ("Max", DoubleValue (4000));
+  std::vector<uint8_t> data (READ_SIZE);
+  std::vector<uint8_t> app (READ_SIZE);
+  std::list<Ptr<Packet> > writes;
+  uint32_t offset = 0;
+  uint64_t total = static_cast<uint64_t> (megabytes) * 1000000;
+  uint64_t delivered = 0;
+  Ptr<Packet> rx = Create<Packet> ();
+  SizeClassAllocator::Stats before = Buffer::GetPoolStats ();
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  while (delivered < total)
+    {
+      while (writes.size () < 4)
+        {
+          writes.push_back (Create<Packet> (&data[0], writeSize->GetInteger ()));
+        }
+      Ptr<Packet> frame = Segment (writes, offset);
+      frame->AddHeader (BenchHeader<20> ());
+      frame->AddHeader (BenchHeader<20> ());
+      frame->AddHeader (BenchHeader<8> ());
+      frame->AddHeader (BenchHeader<26> ());
+      frame->AddTrailer (BenchTrailer ());
+
+      Ptr<Packet> received = frame->Copy ();
+      BenchTrailer fcs;
+      received->RemoveTrailer (fcs);
+      BenchHeader<26> mac;
+      received->RemoveHeader (mac);
+      BenchHeader<8> llc;
+      received->RemoveHeader (llc);
+      BenchHeader<20> ip;
+      received->RemoveHeader (ip);
+      BenchHeader<20> tcp;
+      received->RemoveHeader (tcp);
+
+      rx->AddAtEnd (received);
+      if (rx->GetSize () >= READ_SIZE)
+        {
+          rx->CopyData (&app[0], READ_SIZE);
+          rx->RemoveAtStart (READ_SIZE);
+          delivered += READ_SIZE;
+        }
+    }
+  int64_t ms = clock.End ();
+  SizeClassAllocator::Stats after = Buffer::GetPoolStats ();
+
+  uint64_t allocations = after.hits + after.misses - before.hits - before.misses;
+  std::cout << (scatterGather ? "scatter-gather" : "contiguous") << " buffers, "
+            << metadata << " metadata: "
+            << std::fixed << std::setprecision (3)
+            << (ms * 1e6) / delivered << " ns/byte, "
+            << (allocations * 1e3) / delivered << " buffer allocations/KB"
+            << std::endl;
+  return 0;
+}
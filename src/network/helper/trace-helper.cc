@@ -35,6 +35,19 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("TraceHelper");
 
+namespace {
+
+//
+// The samplers of the device helper enabling a device, if any.  The
+// device helpers create the trace files of the device with PcapHelper
+// and AsciiTraceHelper, which attach these samplers to the files, see
+// PcapHelper::CreateFile and AsciiTraceHelper::CreateFileStream.
+//
+TraceSampler *g_pcapSampler = 0;   //!< Sampler of the pcap files created
+TraceSampler *g_asciiSampler = 0;  //!< Sampler of the ascii streams created
+
+} // anonymous namespace
+
 PcapHelper::PcapHelper ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -56,11 +69,20 @@ PcapHelper::CreateFile (
   NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection);
 
   Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+  if ((filemode & std::ios::in) == 0 && file->IsCompressed ()
+      && (filename.size () < 3 || filename.compare (filename.size () - 3, 3, ".gz") != 0))
+    {
+      filename += ".gz";
+    }
   file->Open (filename, filemode);
   NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for mode " << filemode);
 
   file->Init (dataLinkType, snapLen, tzCorrection);
   NS_ABORT_MSG_IF (file->Fail (), "Unable to Init " << filename);
+  if (g_pcapSampler != 0)
+    {
+      file->SetSampler (g_pcapSampler);
+    }
 
   //
   // Note that the pcap helper promptly forgets all about the pcap file.  We
@@ -187,12 +209,30 @@ AsciiTraceHelper::~AsciiTraceHelper ()
   NS_LOG_FUNCTION_NOARGS ();
 }
 
+bool
+AsciiTraceHelper::IsSampled (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
+{
+  Ptr<TraceSampler> sampler = stream->GetSampler ();
+  return sampler == 0 || sampler->IsSampled (Simulator::Now (), p);
+}
+
+bool
+AsciiTraceHelper::IsSampled (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t dataLinkType)
+{
+  Ptr<TraceSampler> sampler = stream->GetSampler ();
+  return sampler == 0 || sampler->IsSampled (Simulator::Now (), p, dataLinkType);
+}
+
 Ptr<OutputStreamWrapper>
 AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode filemode)
 {
   NS_LOG_FUNCTION (filename << filemode);
 
   Ptr<OutputStreamWrapper> StreamWrapper = Create<OutputStreamWrapper> (filename, filemode);
+  if (g_asciiSampler != 0)
+    {
+      StreamWrapper->SetSampler (g_asciiSampler);
+    }
 
   //
   // Note that the ascii trace helper promptly forgets all about the trace file.
@@ -310,6 +350,10 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!IsSampled (stream, p))
+    {
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -317,6 +361,10 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!IsSampled (stream, p))
+    {
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -336,6 +384,10 @@ void
 AsciiTraceHelper::DefaultDropSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!IsSampled (stream, p))
+    {
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -343,6 +395,10 @@ void
 AsciiTraceHelper::DefaultDropSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!IsSampled (stream, p))
+    {
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -363,6 +419,10 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!IsSampled (stream, p))
+    {
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -370,6 +430,10 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!IsSampled (stream, p))
+    {
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -387,6 +451,10 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!IsSampled (stream, p))
+    {
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -394,13 +462,27 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  if (!IsSampled (stream, p))
+    {
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
 void 
 PcapHelperForDevice::EnablePcap (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
+  if (!m_pcapDeviceFilter.IsNull () && !m_pcapDeviceFilter (nd))
+    {
+      return;
+    }
+  if (m_pcapSampler != 0 && !m_pcapSampler->IsNodeTraced (nd->GetNode ()->GetId ()))
+    {
+      return;
+    }
+  g_pcapSampler = PeekPointer (m_pcapSampler);
   EnablePcapInternal (prefix, nd, promiscuous, explicitFilename);
+  g_pcapSampler = 0;
 }
 
 void 
@@ -441,6 +523,18 @@ PcapHelperForDevice::EnablePcapAll (std::string prefix, bool promiscuous)
   EnablePcap (prefix, NodeContainer::GetGlobal (), promiscuous);
 }
 
+void
+PcapHelperForDevice::SetPcapDeviceFilter (Callback<bool, Ptr<NetDevice> > filter)
+{
+  m_pcapDeviceFilter = filter;
+}
+
+void
+PcapHelperForDevice::SetPcapSampler (Ptr<TraceSampler> sampler)
+{
+  m_pcapSampler = sampler;
+}
+
 void 
 PcapHelperForDevice::EnablePcap (std::string prefix, uint32_t nodeid, uint32_t deviceid, bool promiscuous)
 {
@@ -468,7 +562,7 @@ PcapHelperForDevice::EnablePcap (std::string prefix, uint32_t nodeid, uint32_t d
 void 
 AsciiTraceHelperForDevice::EnableAscii (std::string prefix, Ptr<NetDevice> nd, bool explicitFilename)
 {
-  EnableAsciiInternal (Ptr<OutputStreamWrapper> (), prefix, nd, explicitFilename);
+  EnableAsciiImpl (Ptr<OutputStreamWrapper> (), prefix, nd, explicitFilename);
 }
 
 //
@@ -477,7 +571,42 @@ AsciiTraceHelperForDevice::EnableAscii (std::string prefix, Ptr<NetDevice> nd, b
 void 
 AsciiTraceHelperForDevice::EnableAscii (Ptr<OutputStreamWrapper> stream, Ptr<NetDevice> nd)
 {
-  EnableAsciiInternal (stream, std::string (), nd, false);
+  EnableAsciiImpl (stream, std::string (), nd, false);
+}
+
+//
+// Private API
+//
+void
+AsciiTraceHelperForDevice::EnableAsciiImpl (
+  Ptr<OutputStreamWrapper> stream,
+  std::string prefix,
+  Ptr<NetDevice> nd,
+  bool explicitFilename)
+{
+  if (m_asciiSampler != 0)
+    {
+      if (!m_asciiSampler->IsNodeTraced (nd->GetNode ()->GetId ()))
+        {
+          return;
+        }
+      if (stream != 0)
+        {
+          stream->SetSampler (m_asciiSampler);
+        }
+    }
+  g_asciiSampler = PeekPointer (m_asciiSampler);
+  EnableAsciiInternal (stream, prefix, nd, explicitFilename);
+  g_asciiSampler = 0;
+}
+
+//
+// Public API
+//
+void
+AsciiTraceHelperForDevice::SetAsciiSampler (Ptr<TraceSampler> sampler)
+{
+  m_asciiSampler = sampler;
 }
 
 //
@@ -509,7 +638,7 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (
   bool explicitFilename)
 {
   Ptr<NetDevice> nd = Names::Find<NetDevice> (ndName);
-  EnableAsciiInternal (stream, prefix, nd, explicitFilename);
+  EnableAsciiImpl (stream, prefix, nd, explicitFilename);
 }
 
 //
@@ -539,7 +668,7 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (Ptr<OutputStreamWrapper> stream, std
   for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
     {
       Ptr<NetDevice> dev = *i;
-      EnableAsciiInternal (stream, prefix, dev, false);
+      EnableAsciiImpl (stream, prefix, dev, false);
     }
 }
 
@@ -645,7 +774,7 @@ AsciiTraceHelperForDevice::EnableAsciiImpl (
 
       Ptr<NetDevice> nd = node->GetDevice (deviceid);
 
-      EnableAsciiInternal (stream, prefix, nd, explicitFilename);
+      EnableAsciiImpl (stream, prefix, nd, explicitFilename);
       return;
     }
 }
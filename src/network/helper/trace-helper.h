@@ -20,11 +20,13 @@
 #define TRACE_HELPER_H
 
 #include "ns3/assert.h"
+#include "ns3/callback.h"
 #include "ns3/net-device-container.h"
 #include "ns3/node-container.h"
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/trace-sampler.h"
 
 namespace ns3 {
 
@@ -93,6 +95,16 @@ public:
 
   /**
    * @brief Create and initialize a pcap file.
+   *
+   * If the file is opened for writing with a non zero
+   * ns3::PcapFileWrapper::CompressionLevel, ".gz" is appended to
+   * the file name, unless already there.
+   *
+   * The files created while PcapHelperForDevice::EnablePcap() runs the
+   * EnablePcapInternal() of a device helper get the sampler set with
+   * PcapHelperForDevice::SetPcapSampler(), and only write the packets
+   * it selects: this is how the device helpers, which create their
+   * files with a PcapHelper of their own, receive the sampler.
    * 
    * @param filename file name
    * @param filemode file mode
@@ -208,6 +220,13 @@ public:
    * run into object lifetime issues.  Ns-3 has a nice reference counted object
    * that can solve the problem so we use one of those to carry the stream
    * around and deal with the lifetime issues.
+   *
+   * The streams created while AsciiTraceHelperForDevice::EnableAscii()
+   * runs the EnableAsciiInternal() of a device helper get the sampler
+   * set with AsciiTraceHelperForDevice::SetAsciiSampler(): this is how
+   * the device helpers, which create their streams with an
+   * AsciiTraceHelper of their own, receive the sampler.  The sinks
+   * check it with IsSampled().
    * 
    * @param filename file name
    * @param filemode file mode
@@ -449,6 +468,31 @@ public:
    * @param p the packet
    */
   static void DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> file, std::string context, Ptr<const Packet> p);
+
+  /**
+   * @brief Check if a sink writes a packet to a stream.
+   *
+   * The default sinks check it, and so must the sinks of the device
+   * helpers before they format a record, so that the sampler attached
+   * to the stream by AsciiTraceHelperForDevice::SetAsciiSampler()
+   * selects their packets too.
+   *
+   * @param stream the output stream
+   * @param p the packet, starting with a link header of the
+   *          DataLinkType attribute of the sampler
+   * @returns true if the stream has no sampler, or if it selects the packet
+   */
+  static bool IsSampled (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p);
+
+  /**
+   * @brief Check if a sink writes a packet to a stream.
+   *
+   * @param stream the output stream
+   * @param p the packet, starting with its link header
+   * @param dataLinkType the pcap data link type of the link header
+   * @returns true if the stream has no sampler, or if it selects the packet
+   */
+  static bool IsSampled (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t dataLinkType);
 };
 
 template <typename T> void
@@ -563,12 +607,18 @@ public:
    * @param nd Net device for which you want to enable tracing.
    * @param promiscuous If true capture all possible packets available at the device.
    * @param explicitFilename Treat the prefix as an explicit filename if true
+   *
+   * The files the implementation creates with PcapHelper::CreateFile()
+   * get the sampler set with SetPcapSampler().
    */
   virtual void EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename) = 0;
 
   /**
    * @brief Enable pcap output the indicated net device.
    *
+   * Nothing is done if the device does not pass the filter set with
+   * SetPcapDeviceFilter().
+   *
    * @param prefix Filename prefix to use for pcap files.
    * @param nd Net device for which you want to enable tracing.
    * @param promiscuous If true capture all possible packets available at the device.
@@ -626,6 +676,31 @@ public:
    * @param promiscuous If true capture all possible packets available at the device.
    */
   void EnablePcapAll (std::string prefix, bool promiscuous = false);
+
+  /**
+   * @brief Select the devices on which the EnablePcap methods enable pcap
+   * output, for instance to trace one device per node with EnablePcapAll.
+   *
+   * @param filter Callback returning true for the devices to trace, or a
+   * null callback to trace them all.
+   */
+  void SetPcapDeviceFilter (Callback<bool, Ptr<NetDevice> > filter);
+
+  /**
+   * @brief Sample the packets written by the EnablePcap methods enabled
+   * afterwards.
+   *
+   * The devices of the nodes the sampler does not trace are skipped, and
+   * the sampler is attached to the pcap files created for the others,
+   * which only write the packets it selects.
+   *
+   * @param sampler The sampler, or 0 to trace all the packets.
+   */
+  void SetPcapSampler (Ptr<TraceSampler> sampler);
+
+private:
+  Callback<bool, Ptr<NetDevice> > m_pcapDeviceFilter; //!< Devices to trace
+  Ptr<TraceSampler> m_pcapSampler; //!< Packets to trace
 };
 
 /**
@@ -662,6 +737,12 @@ public:
    * trace context could be important, so the device implementation is 
    * expected to TraceConnect.
    *
+   * The provided stream, and those the implementation creates with
+   * AsciiTraceHelper::CreateFileStream(), get the sampler set with
+   * SetAsciiSampler().  The sinks of the implementation which are not
+   * the default sinks of AsciiTraceHelper must check
+   * AsciiTraceHelper::IsSampled() before they write a record.
+   *
    * @param stream An OutputStreamWrapper representing an existing file to use
    *               when writing trace data.
    * @param prefix Filename prefix to use for ascii trace files.
@@ -792,6 +873,20 @@ public:
    */
   void EnableAscii (Ptr<OutputStreamWrapper> stream, uint32_t nodeid, uint32_t deviceid);
 
+  /**
+   * @brief Sample the packets written by the EnableAscii methods enabled
+   * afterwards.
+   *
+   * The devices of the nodes the sampler does not trace are skipped, and
+   * the sampler is attached to the streams of the others, provided or
+   * created, so that the sinks, which check AsciiTraceHelper::IsSampled(),
+   * only write the packets it selects.  A stream shared by several devices keeps
+   * the last sampler attached.
+   *
+   * @param sampler The sampler, or 0 to trace all the packets.
+   */
+  void SetAsciiSampler (Ptr<TraceSampler> sampler);
+
 private:
   /**
    * @brief Enable ascii trace output on the device specified by a global
@@ -857,6 +952,8 @@ private:
    * @param explicitFilename Treat the prefix as an explicit filename if true
    */
   void EnableAsciiImpl (Ptr<OutputStreamWrapper> stream, std::string prefix, Ptr<NetDevice> nd, bool explicitFilename);
+
+  Ptr<TraceSampler> m_asciiSampler; //!< Packets to trace
 };
 
 } // namespace ns3
@@ -20,6 +20,8 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/memory-accounting.h"
+#include <cstddef>
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -49,99 +51,65 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
+/**
+ * \ingroup packet
+ * Get the MemoryAccounting counter of the buffer data.
+ * \returns The counter.
+ */
+static MemoryAccounting::Id
+GetBufferAccounting (void)
+{
+  static MemoryAccounting::Id id = MemoryAccounting::Register ("ns3::Buffer");
+  return id;
+}
+
 
 uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
+/* The size classes of the pool: the smallest holds the data of an
+ * empty buffer, the largest a jumbo frame with room for its headers.
  */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
-{
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
-}
+SizeClassPool Buffer::g_pool = { "ns3::Buffer", 64, 65536, 16 * 1024 * 1024, 0 };
+SizeClassPool::LocalStaticDestructor Buffer::g_poolDestructor (&Buffer::g_pool);
 
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
-    {
-      Buffer::Deallocate (data);
-    }
-  else
-    {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
-    }
+  g_pool.Deallocate (data, data->m_size - 1 + sizeof (struct Buffer::Data));
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
-    {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
+  if (dataSize == 0)
     {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
+      dataSize = 1;
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
-  NS_ASSERT (data->m_count == 1);
+  /* the data of the size class block is all usable. */
+  uint32_t capacity;
+  void *block = g_pool.Allocate (dataSize - 1 + sizeof (struct Buffer::Data), capacity);
+  struct Buffer::Data *data = static_cast<struct Buffer::Data *> (block);
+  data->m_size = capacity - sizeof (struct Buffer::Data) + 1;
+  data->m_count = 1;
   return data;
 }
+
+void
+Buffer::SetPoolLimit (uint64_t limit)
+{
+  NS_LOG_FUNCTION (limit);
+  g_pool.SetLimit (limit);
+}
+
+SizeClassAllocator::Stats
+Buffer::GetPoolStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_pool.GetStats ();
+}
 #else /* BUFFER_FREE_LIST */
 void
 Buffer::Recycle (struct Buffer::Data *data)
@@ -157,6 +125,20 @@ Buffer::Create (uint32_t size)
   NS_LOG_FUNCTION (size);
   return Allocate (size);
 }
+
+void
+Buffer::SetPoolLimit (uint64_t limit)
+{
+  NS_LOG_FUNCTION (limit);
+}
+
+SizeClassAllocator::Stats
+Buffer::GetPoolStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SizeClassAllocator::Stats stats = { 0, 0, 0, 0, 0 };
+  return stats;
+}
 #endif /* BUFFER_FREE_LIST */
 
 struct Buffer::Data *
@@ -170,6 +152,7 @@ Buffer::Allocate (uint32_t reqSize)
   NS_ASSERT (reqSize >= 1);
   uint32_t size = reqSize - 1 + sizeof (struct Buffer::Data);
   uint8_t *b = new uint8_t [size];
+  MemoryAccounting::Allocate (GetBufferAccounting (), size);
   struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
   data->m_size = reqSize;
   data->m_count = 1;
@@ -181,6 +164,8 @@ Buffer::Deallocate (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
+  MemoryAccounting::Free (GetBufferAccounting (),
+                          data->m_size - 1 + sizeof (struct Buffer::Data));
   uint8_t *buf = reinterpret_cast<uint8_t *> (data);
   delete [] buf;
 }
@@ -206,6 +191,19 @@ Buffer::Buffer (uint32_t dataSize, bool initialize)
     }
 }
 
+Buffer::Buffer (struct Buffer::Data *data, uint32_t start, uint32_t end)
+  : m_data (data),
+    m_maxZeroAreaStart (0), // not a hint for the start of new buffers
+    m_zeroAreaStart (end),
+    m_zeroAreaEnd (end),
+    m_start (start),
+    m_end (end)
+{
+  NS_LOG_FUNCTION (this << data << start << end);
+  m_data->m_count++;
+  NS_ASSERT (CheckInternalState ());
+}
+
 bool
 Buffer::CheckInternalState (void) const
 {
@@ -244,7 +242,7 @@ void
 Buffer::Initialize (uint32_t zeroSize)
 {
   NS_LOG_FUNCTION (this << zeroSize);
-  m_data = Buffer::Create (0);
+  m_data = Buffer::Create (g_recommendedStart);
   m_start = std::min (m_data->m_size, g_recommendedStart);
   m_maxZeroAreaStart = m_start;
   m_zeroAreaStart = m_start;
@@ -1123,12 +1121,63 @@ void
 Buffer::Iterator::Read (uint8_t *buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  if (m_current + size <= m_zeroStart || m_current >= m_zeroEnd)
+    {
+      Span span (*this, size);
+      span.Read (buffer, size);
+      span.Commit ();
+      return;
+    }
   for (uint32_t i = 0; i < size; i++)
     {
       buffer[i] = ReadU8 ();
     }
 }
 
+void
+Buffer::Span::CopyOut (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_copy.resize (size);
+  if (size == 0)
+    {
+      m_start = 0;
+      return;
+    }
+  Iterator i = *m_iterator;
+  for (uint32_t j = 0; j < size; j++)
+    {
+      m_copy[j] = i.ReadU8 ();
+    }
+  m_start = &m_copy[0];
+}
+
+Buffer
+Buffer::Iterator::CreateFragment (uint32_t size) const
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ASSERT (m_current + size <= m_dataEnd);
+  // m_data is the m_data field of the storage of the buffer
+  struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data *>
+      (m_data - offsetof (struct Buffer::Data, m_data));
+  uint32_t end = m_current + size;
+  if (end <= m_zeroStart)
+    {
+      return Buffer (data, m_current, end);
+    }
+  if (m_current >= m_zeroEnd)
+    {
+      uint32_t zeroSize = m_zeroEnd - m_zeroStart;
+      return Buffer (data, m_current - zeroSize, end - zeroSize);
+    }
+  Buffer fragment;
+  fragment.AddAtStart (size);
+  Iterator i = *this;
+  i.Next (size);
+  fragment.Begin ().Write (*this, i);
+  return fragment;
+}
+
 uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size)
 {
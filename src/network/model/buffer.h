@@ -24,6 +24,7 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "size-class-allocator.h"
 
 #define BUFFER_FREE_LIST 1
 
@@ -92,6 +93,8 @@ namespace ns3 {
 class Buffer 
 {
 public:
+  class Span;
+
   /**
    * \brief iterator in a Buffer instance
    */
@@ -356,6 +359,18 @@ public:
      */
     inline void Read (Iterator start, uint32_t size);
 
+    /**
+     * \param size number of bytes of the fragment
+     * \return a Buffer holding the next size bytes of the
+     * underlying buffer
+     *
+     * The fragment shares the bytes of the underlying buffer, as
+     * Buffer::CreateFragment does, unless they overlap the "virtual
+     * zero area": they are then copied.  The fragment keeps the whole
+     * underlying buffer alive.  The Iterator is not moved.
+     */
+    Buffer CreateFragment (uint32_t size) const;
+
     /**
      * \brief Calculate the checksum.
      * \param size size of the buffer.
@@ -378,6 +393,7 @@ public:
 
 private:
     friend class Buffer;
+    friend class Span;
     /**
      * Constructor - initializes the iterator to point to the buffer start
      *
@@ -478,6 +494,192 @@ private:
     uint8_t *m_data;
   };
 
+  /**
+   * \brief a window of bytes of a Buffer, checked once
+   *
+   * The Iterator checks the bounds of each byte it reads or writes,
+   * and looks for the "virtual zero area" at each call.  A Span checks,
+   * when it is built, that the next \c size bytes of an Iterator are in
+   * the buffer, and then reads and writes them through a raw pointer,
+   * with only debug asserts.  Commit() moves the Iterator past the bytes
+   * used.  The headers write their fields through a Span rather than
+   * through one Iterator call each:
+   *
+   * \code
+   *   Buffer::Span span (i, 8);
+   *   span.WriteU8 (m_type);
+   *   span.WriteU8 (m_code);
+   *   span.WriteHtonU16 (m_length);
+   *   span.WriteHtonU32 (m_id);
+   *   span.Commit ();
+   * \endcode
+   *
+   * The bytes written must not overlap the "virtual zero area", as
+   * for the Iterator.  The bytes read may: they are then copied out of
+   * the buffer, and the Span must not be written.  The formats are
+   * those of the Iterator methods of the same names.
+   */
+  class Span
+  {
+public:
+    /**
+     * \param i the iterator at the start of the window
+     * \param size the number of bytes of the window
+     */
+    inline Span (Iterator &i, uint32_t size);
+
+    /**
+     * \param data data to write in buffer
+     */
+    inline void WriteU8 (uint8_t data);
+    /**
+     * \param data data to write in buffer
+     * \param len number of times data must be written in buffer
+     */
+    inline void WriteU8 (uint8_t data, uint32_t len);
+    /**
+     * \param data data to write in buffer, in the format of
+     * Iterator::WriteU16
+     */
+    inline void WriteU16 (uint16_t data);
+    /**
+     * \param data data to write in buffer, in the format of
+     * Iterator::WriteU32
+     */
+    inline void WriteU32 (uint32_t data);
+    /**
+     * \param data data to write in buffer, in the format of
+     * Iterator::WriteU64
+     */
+    inline void WriteU64 (uint64_t data);
+    /**
+     * \param data data to write in buffer in least significant byte order
+     */
+    inline void WriteHtolsbU16 (uint16_t data);
+    /**
+     * \param data data to write in buffer in least significant byte order
+     */
+    inline void WriteHtolsbU32 (uint32_t data);
+    /**
+     * \param data data to write in buffer in least significant byte order
+     */
+    inline void WriteHtolsbU64 (uint64_t data);
+    /**
+     * \param data data to write in buffer in network order
+     */
+    inline void WriteHtonU16 (uint16_t data);
+    /**
+     * \param data data to write in buffer in network order
+     */
+    inline void WriteHtonU32 (uint32_t data);
+    /**
+     * \param data data to write in buffer in network order
+     */
+    inline void WriteHtonU64 (uint64_t data);
+    /**
+     * \param buffer a byte buffer to copy in the internal buffer.
+     * \param size number of bytes to copy.
+     */
+    inline void Write (uint8_t const *buffer, uint32_t size);
+
+    /**
+     * \return the byte read in the buffer.
+     */
+    inline uint8_t ReadU8 (void);
+    /**
+     * \return the two bytes read in the format of Iterator::ReadU16
+     */
+    inline uint16_t ReadU16 (void);
+    /**
+     * \return the four bytes read in the format of Iterator::ReadU32
+     */
+    inline uint32_t ReadU32 (void);
+    /**
+     * \return the eight bytes read in the format of Iterator::ReadU64
+     */
+    inline uint64_t ReadU64 (void);
+    /**
+     * \return the two bytes read in least significant byte order
+     */
+    inline uint16_t ReadLsbtohU16 (void);
+    /**
+     * \return the four bytes read in least significant byte order
+     */
+    inline uint32_t ReadLsbtohU32 (void);
+    /**
+     * \return the eight bytes read in least significant byte order
+     */
+    inline uint64_t ReadLsbtohU64 (void);
+    /**
+     * \return the two bytes read in network order
+     */
+    inline uint16_t ReadNtohU16 (void);
+    /**
+     * \return the four bytes read in network order
+     */
+    inline uint32_t ReadNtohU32 (void);
+    /**
+     * \return the eight bytes read in network order
+     */
+    inline uint64_t ReadNtohU64 (void);
+    /**
+     * \param buffer buffer to copy data into
+     * \param size number of bytes to copy
+     */
+    inline void Read (uint8_t *buffer, uint32_t size);
+
+    /**
+     * \param size number of bytes to skip
+     * \return a pointer to the skipped bytes, to be read or written
+     * in place, as by Ipv6Address::Serialize (uint8_t *)
+     */
+    inline uint8_t * Next (uint32_t size);
+    /**
+     * \return the number of bytes left in the window
+     */
+    inline uint32_t GetRemainingSize (void) const;
+    /**
+     * Move the iterator past the bytes read or written.
+     */
+    inline void Commit (void);
+
+private:
+    /**
+     * Copy constructor, not implemented.
+     * \param o the span to copy
+     */
+    Span (Span const &o);
+    /**
+     * Assignment, not implemented.
+     * \param o the span to copy
+     * \returns this span
+     */
+    Span & operator = (Span const &o);
+    /**
+     * Copy the window, which overlaps the "virtual zero area", out of
+     * the buffer.
+     *
+     * \param size the number of bytes of the window
+     */
+    void CopyOut (uint32_t size);
+    /**
+     * \param size number of bytes to write
+     * \return a pointer to the bytes to write
+     */
+    inline uint8_t * WriteNext (uint32_t size);
+
+    /** the iterator moved by Commit (). */
+    Iterator *m_iterator;
+    /** the first byte of the window. */
+    uint8_t *m_start;
+    /** the next byte to read or write. */
+    uint8_t *m_current;
+    /** the end of the window. */
+    uint8_t *m_end;
+    /** the copy of a window which overlaps the "virtual zero area". */
+    std::vector<uint8_t> m_copy;
+  };
+
   /**
    * \return the number of bytes stored in this buffer.
    */
@@ -636,6 +838,23 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+  /**
+   * \brief Set the largest number of bytes of freed buffer data kept
+   * for reuse, besides the per-thread caches.
+   *
+   * The default is 16 MiB; zero disables the pooling.
+   *
+   * \param limit the limit in bytes
+   */
+  static void SetPoolLimit (uint64_t limit);
+  /**
+   * \brief Get the statistics of the pool of buffer data.
+   *
+   * \returns the hits, misses and pooled bytes of the pool, all zero
+   * if the pool is not used.
+   */
+  static SizeClassAllocator::Stats GetPoolStats (void);
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -679,6 +898,16 @@ private:
     uint8_t m_data[1];
   };
 
+  /**
+   * \brief Constructor of a buffer sharing the bytes of a data storage
+   *
+   * \param data the buffer data storage, whose reference count is
+   * incremented
+   * \param start the offset of the first byte in the storage
+   * \param end the offset past the last byte in the storage
+   */
+  Buffer (struct Buffer::Data *data, uint32_t start, uint32_t end);
+
   /**
    * \brief Create a full copy of the buffer, including
    * all the internal structures.
@@ -785,16 +1014,8 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  static struct SizeClassPool g_pool; //!< Pool of buffer data
+  static struct SizeClassPool::LocalStaticDestructor g_poolDestructor; //!< Destroy the allocator of g_pool
 #endif
 };
 
@@ -1041,6 +1262,254 @@ Buffer::Iterator::Read (Buffer::Iterator start, uint32_t size)
 }
 
 
+Buffer::Span::Span (Iterator &i, uint32_t size)
+  : m_iterator (&i)
+{
+  NS_ASSERT_MSG (i.m_current >= i.m_dataStart && i.m_current + size <= i.m_dataEnd,
+                 "span of " << size << " bytes out of the buffer at "
+                            << i.m_current << " in [" << i.m_dataStart << ","
+                            << i.m_dataEnd << ")");
+  if (i.m_current + size <= i.m_zeroStart)
+    {
+      m_start = &i.m_data[i.m_current];
+    }
+  else if (i.m_current >= i.m_zeroEnd)
+    {
+      m_start = &i.m_data[i.m_current - (i.m_zeroEnd - i.m_zeroStart)];
+    }
+  else
+    {
+      CopyOut (size);
+    }
+  m_current = m_start;
+  m_end = m_start + size;
+}
+
+uint8_t *
+Buffer::Span::Next (uint32_t size)
+{
+  NS_ASSERT_MSG (m_current + size <= m_end, "span overflow");
+  uint8_t *buffer = m_current;
+  m_current += size;
+  return buffer;
+}
+
+uint8_t *
+Buffer::Span::WriteNext (uint32_t size)
+{
+  NS_ASSERT_MSG (m_copy.empty (), "write to a span of the zero area");
+  return Next (size);
+}
+
+uint32_t
+Buffer::Span::GetRemainingSize (void) const
+{
+  return m_end - m_current;
+}
+
+void
+Buffer::Span::Commit (void)
+{
+  m_iterator->m_current += m_current - m_start;
+}
+
+void
+Buffer::Span::WriteU8 (uint8_t data)
+{
+  *WriteNext (1) = data;
+}
+
+void
+Buffer::Span::WriteU8 (uint8_t data, uint32_t len)
+{
+  std::memset (WriteNext (len), data, len);
+}
+
+void
+Buffer::Span::WriteU16 (uint16_t data)
+{
+  WriteHtolsbU16 (data);
+}
+
+void
+Buffer::Span::WriteU32 (uint32_t data)
+{
+  WriteHtolsbU32 (data);
+}
+
+void
+Buffer::Span::WriteU64 (uint64_t data)
+{
+  WriteHtolsbU64 (data);
+}
+
+void
+Buffer::Span::WriteHtolsbU16 (uint16_t data)
+{
+  uint8_t *buffer = WriteNext (2);
+  buffer[0] = (data >> 0) & 0xff;
+  buffer[1] = (data >> 8) & 0xff;
+}
+
+void
+Buffer::Span::WriteHtolsbU32 (uint32_t data)
+{
+  uint8_t *buffer = WriteNext (4);
+  buffer[0] = (data >> 0) & 0xff;
+  buffer[1] = (data >> 8) & 0xff;
+  buffer[2] = (data >> 16) & 0xff;
+  buffer[3] = (data >> 24) & 0xff;
+}
+
+void
+Buffer::Span::WriteHtolsbU64 (uint64_t data)
+{
+  uint8_t *buffer = WriteNext (8);
+  for (uint32_t j = 0; j < 8; j++)
+    {
+      buffer[j] = (data >> (8 * j)) & 0xff;
+    }
+}
+
+void
+Buffer::Span::WriteHtonU16 (uint16_t data)
+{
+  uint8_t *buffer = WriteNext (2);
+  buffer[0] = (data >> 8) & 0xff;
+  buffer[1] = (data >> 0) & 0xff;
+}
+
+void
+Buffer::Span::WriteHtonU32 (uint32_t data)
+{
+  uint8_t *buffer = WriteNext (4);
+  buffer[0] = (data >> 24) & 0xff;
+  buffer[1] = (data >> 16) & 0xff;
+  buffer[2] = (data >> 8) & 0xff;
+  buffer[3] = (data >> 0) & 0xff;
+}
+
+void
+Buffer::Span::WriteHtonU64 (uint64_t data)
+{
+  uint8_t *buffer = WriteNext (8);
+  for (uint32_t j = 0; j < 8; j++)
+    {
+      buffer[j] = (data >> (56 - 8 * j)) & 0xff;
+    }
+}
+
+void
+Buffer::Span::Write (uint8_t const *buffer, uint32_t size)
+{
+  std::memcpy (WriteNext (size), buffer, size);
+}
+
+uint8_t
+Buffer::Span::ReadU8 (void)
+{
+  return *Next (1);
+}
+
+uint16_t
+Buffer::Span::ReadU16 (void)
+{
+  return ReadLsbtohU16 ();
+}
+
+uint32_t
+Buffer::Span::ReadU32 (void)
+{
+  return ReadLsbtohU32 ();
+}
+
+uint64_t
+Buffer::Span::ReadU64 (void)
+{
+  return ReadLsbtohU64 ();
+}
+
+uint16_t
+Buffer::Span::ReadLsbtohU16 (void)
+{
+  uint8_t *buffer = Next (2);
+  uint16_t retval = buffer[1];
+  retval <<= 8;
+  retval |= buffer[0];
+  return retval;
+}
+
+uint32_t
+Buffer::Span::ReadLsbtohU32 (void)
+{
+  uint8_t *buffer = Next (4);
+  uint32_t retval = buffer[3];
+  retval <<= 8;
+  retval |= buffer[2];
+  retval <<= 8;
+  retval |= buffer[1];
+  retval <<= 8;
+  retval |= buffer[0];
+  return retval;
+}
+
+uint64_t
+Buffer::Span::ReadLsbtohU64 (void)
+{
+  uint8_t *buffer = Next (8);
+  uint64_t retval = 0;
+  for (uint32_t j = 8; j > 0; j--)
+    {
+      retval <<= 8;
+      retval |= buffer[j - 1];
+    }
+  return retval;
+}
+
+uint16_t
+Buffer::Span::ReadNtohU16 (void)
+{
+  uint8_t *buffer = Next (2);
+  uint16_t retval = buffer[0];
+  retval <<= 8;
+  retval |= buffer[1];
+  return retval;
+}
+
+uint32_t
+Buffer::Span::ReadNtohU32 (void)
+{
+  uint8_t *buffer = Next (4);
+  uint32_t retval = buffer[0];
+  retval <<= 8;
+  retval |= buffer[1];
+  retval <<= 8;
+  retval |= buffer[2];
+  retval <<= 8;
+  retval |= buffer[3];
+  return retval;
+}
+
+uint64_t
+Buffer::Span::ReadNtohU64 (void)
+{
+  uint8_t *buffer = Next (8);
+  uint64_t retval = 0;
+  for (uint32_t j = 0; j < 8; j++)
+    {
+      retval <<= 8;
+      retval |= buffer[j];
+    }
+  return retval;
+}
+
+void
+Buffer::Span::Read (uint8_t *buffer, uint32_t size)
+{
+  std::memcpy (buffer, Next (size), size);
+}
+
+
 Buffer::Buffer (Buffer const&o)
   : m_data (o.m_data),
     m_maxZeroAreaStart (o.m_zeroAreaStart),
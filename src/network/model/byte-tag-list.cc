@@ -19,6 +19,7 @@
  */
 #include "byte-tag-list.h"
 #include "ns3/log.h"
+#include "ns3/memory-accounting.h"
 #include <vector>
 #include <cstring>
 
@@ -30,6 +31,18 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("ByteTagList");
 
+/**
+ * \ingroup packet
+ * Get the MemoryAccounting counter of the byte tags.
+ * \returns The counter.
+ */
+static MemoryAccounting::Id
+GetByteTagAccounting (void)
+{
+  static MemoryAccounting::Id id = MemoryAccounting::Register ("ns3::ByteTagList");
+  return id;
+}
+
 /**
  * \ingroup packet
  *
@@ -355,10 +368,16 @@ ByteTagList::Allocate (uint32_t size)
           data->dirty = 0;
           return data;
         }
+      MemoryAccounting::Free (GetByteTagAccounting (),
+                              data->size + sizeof (struct ByteTagListData) - 4);
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
     }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
+  // Record the size actually allocated, so that it can be reused.
+  size = std::max (size, g_maxSize);
+  uint8_t *buffer = new uint8_t [size + sizeof (struct ByteTagListData) - 4];
+  MemoryAccounting::Allocate (GetByteTagAccounting (),
+                              size + sizeof (struct ByteTagListData) - 4);
   struct ByteTagListData *data = (struct ByteTagListData *)buffer;
   data->count = 1;
   data->size = size;
@@ -381,6 +400,8 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
       if (g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
+          MemoryAccounting::Free (GetByteTagAccounting (),
+                                  data->size + sizeof (struct ByteTagListData) - 4);
           uint8_t *buffer = (uint8_t *)data;
           delete [] buffer;
         }
@@ -398,6 +419,8 @@ ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   uint8_t *buffer = new uint8_t [size + sizeof (struct ByteTagListData) - 4];
+  MemoryAccounting::Allocate (GetByteTagAccounting (),
+                              size + sizeof (struct ByteTagListData) - 4);
   struct ByteTagListData *data = (struct ByteTagListData *)buffer;
   data->count = 1;
   data->size = size;
@@ -416,6 +439,8 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
+      MemoryAccounting::Free (GetByteTagAccounting (),
+                              data->size + sizeof (struct ByteTagListData) - 4);
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
     }
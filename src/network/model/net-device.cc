@@ -24,11 +24,49 @@
 #include "ns3/uinteger.h"
 #include "net-device.h"
 #include "packet.h"
+#include "ns3/packet-burst.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("NetDevice");
 
+/* The size classes of the pool, from the base class items to the
+ * items of the queue discs which carry an IP header.
+ */
+SizeClassPool QueueItem::g_pool = { "ns3::QueueItem", 32, 512, 1024 * 1024, 0 };
+SizeClassPool::LocalStaticDestructor QueueItem::g_poolDestructor (&QueueItem::g_pool);
+
+void *
+QueueItem::operator new (size_t size)
+{
+  // No function logging: this is called for each packet.
+  uint32_t capacity;
+  return g_pool.Allocate (size, capacity);
+}
+
+void
+QueueItem::operator delete (void *p, size_t size)
+{
+  if (p != 0)
+    {
+      g_pool.Deallocate (p, g_pool.GetCapacity (size));
+    }
+}
+
+void
+QueueItem::SetPoolLimit (uint64_t limit)
+{
+  NS_LOG_FUNCTION (limit);
+  g_pool.SetLimit (limit);
+}
+
+SizeClassAllocator::Stats
+QueueItem::GetPoolStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_pool.GetStats ();
+}
+
 QueueItem::QueueItem (Ptr<Packet> p)
 {
   m_packet = p;
@@ -231,4 +269,18 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+NetDevice::SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      if (!Send (*i, dest, protocolNumber))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
 } // namespace ns3
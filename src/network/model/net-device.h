@@ -29,6 +29,7 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "address.h"
+#include "size-class-allocator.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
 
@@ -37,6 +38,7 @@ namespace ns3 {
 class Node;
 class Channel;
 class Packet;
+class PacketBurst;
 
 /**
  * \ingroup network
@@ -51,6 +53,11 @@ class Packet;
  * information. An item of the base class only contains a packet. Subclasses
  * can be derived from this base class to allow items to contain additional
  * information.
+ *
+ * The items, including those of the subclasses, are allocated from a
+ * pool of memory blocks, so that the items enqueued and dequeued by a
+ * busy device reuse the same memory instead of calling the system
+ * allocator for each packet.
  */
 class QueueItem : public SimpleRefCount<QueueItem>
 {
@@ -91,6 +98,34 @@ public:
    */
   typedef void (* TracedCallback) (Ptr<const QueueItem> item);
 
+  /**
+   * \brief Allocate an item from the pool of queue items.
+   * \param size the size of the item
+   * \returns the memory of the item
+   */
+  static void * operator new (size_t size);
+  /**
+   * \brief Return an item to the pool of queue items.
+   * \param p the memory of the item
+   * \param size the size of the item
+   */
+  static void operator delete (void *p, size_t size);
+  /**
+   * \brief Set the largest number of bytes of free items kept in the pool.
+   *
+   * The default is 1 MiB; 0 disables the pooling.
+   *
+   * \param limit the limit in bytes
+   */
+  static void SetPoolLimit (uint64_t limit);
+  /**
+   * \brief Get the statistics of the pool of queue items.
+   *
+   * \returns the hits, misses and pooled bytes of the pool, all zero
+   * if no item was created yet.
+   */
+  static SizeClassAllocator::Stats GetPoolStats (void);
+
 private:
   /**
    * \brief Default constructor
@@ -113,6 +148,9 @@ private:
   QueueItem &operator = (const QueueItem &);
 
   Ptr<Packet> m_packet;
+
+  static struct SizeClassPool g_pool; //!< Pool of queue items
+  static struct SizeClassPool::LocalStaticDestructor g_poolDestructor; //!< Destroy the allocator of g_pool
 };
 
 /**
@@ -502,6 +540,22 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param burst packets sent from above down to Network Device, in order
+   * \param dest mac address of the destination (already resolved)
+   * \param protocolNumber identifies the type of payload contained in
+   *        the packets. Used to call the right L3Protocol when the packets
+   *        are received.
+   *
+   *  Called from higher layer to send several packets into Network Device
+   *  to the specified destination Address at once.  The default
+   *  implementation calls Send for each packet, and stops at the first
+   *  packet which is not accepted; devices which transmit back-to-back
+   *  packets with fewer calls and events override it.
+   *
+   * \return whether all the packets were accepted
+   */
+  virtual bool SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber);
   /**
    * \returns the node base class which contains this network
    *          interface.
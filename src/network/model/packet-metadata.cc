@@ -19,9 +19,11 @@
  */
 #include <utility>
 #include <list>
+#include <vector>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/memory-accounting.h"
 #include "packet-metadata.h"
 #include "buffer.h"
 #include "header.h"
@@ -31,12 +33,39 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
+/**
+ * \ingroup packet
+ * Get the MemoryAccounting counter of the packet metadata.
+ * \returns The counter.
+ */
+static MemoryAccounting::Id
+GetMetadataAccounting (void)
+{
+  static MemoryAccounting::Id id = MemoryAccounting::Register ("ns3::PacketMetadata");
+  return id;
+}
+
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+bool PacketMetadata::m_lazy = false;
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+PacketMetadata::LogFreeList PacketMetadata::m_logFreeList;
+
+/**
+ * \ingroup packet
+ * The number of entries of a log beyond which it is applied to the
+ * list of items, to bound the memory held by the packets which are
+ * never read.
+ */
+static const uint32_t MAX_LOG_DEPTH = 256;
+/**
+ * \ingroup packet
+ * The largest number of free log entries kept.
+ */
+static const uint32_t MAX_FREE_LOG_ENTRIES = 4096;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -48,6 +77,17 @@ PacketMetadata::DataFreeList::~DataFreeList ()
   PacketMetadata::m_enable = false;
 }
 
+PacketMetadata::LogFreeList::~LogFreeList ()
+{
+  NS_LOG_FUNCTION (this);
+  for (iterator i = begin (); i != end (); i++)
+    {
+      MemoryAccounting::Free (GetMetadataAccounting (), sizeof (struct LogEntry));
+      delete *i;
+    }
+  PacketMetadata::m_enable = false;
+}
+
 void 
 PacketMetadata::Enable (void)
 {
@@ -68,6 +108,15 @@ PacketMetadata::EnableChecking (void)
   NS_LOG_FUNCTION_NOARGS ();
   Enable ();
   m_enableChecking = true;
+  m_lazy = false;
+}
+
+void
+PacketMetadata::EnableLazy (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Enable ();
+  m_lazy = !m_enableChecking;
 }
 
 void
@@ -626,6 +675,7 @@ PacketMetadata::Allocate (uint32_t n)
     }
   size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
   uint8_t *buf = new uint8_t [size];
+  MemoryAccounting::Allocate (GetMetadataAccounting (), size);
   struct PacketMetadata::Data *data = (struct PacketMetadata::Data *)buf;
   data->m_size = n;
   data->m_count = 1;
@@ -636,6 +686,8 @@ void
 PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
+  MemoryAccounting::Free (GetMetadataAccounting (), sizeof (struct Data)
+                          + data->m_size - PACKET_METADATA_DATA_M_DATA_SIZE);
   uint8_t *buf = (uint8_t *)data;
   delete [] buf;
 }
@@ -669,14 +721,26 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
-
+  uint16_t chunkUid = m_chunkUid;
+  m_chunkUid++;
+  if (IsLogged ())
+    {
+      Log (LOG_ADD_HEADER, uid, size, chunkUid, 0);
+      return;
+    }
+  Materialize ();
+  AddHeaderItem (uid, size, chunkUid);
+}
+void
+PacketMetadata::AddHeaderItem (uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+  NS_LOG_FUNCTION (this << uid << size << chunkUid);
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
   item.prev = 0xffff;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = chunkUid;
   uint16_t written = AddSmall (&item);
   UpdateHead (written);
 }
@@ -691,6 +755,29 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_lazy && m_log != 0)
+    {
+      // removing an item does not copy the list: the removal is
+      // logged only to come after the operations already logged.
+      if (m_log->op == LOG_ADD_HEADER &&
+          m_log->typeUid == uid && m_log->size == size)
+        {
+          // the header just added is removed whole.
+          PopLog ();
+        }
+      else
+        {
+          Log (LOG_REMOVE_HEADER, uid, size, 0, 0);
+        }
+      return;
+    }
+  Materialize ();
+  RemoveHeaderItem (uid, size);
+}
+void
+PacketMetadata::RemoveHeaderItem (uint32_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << uid << size);
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -739,16 +826,29 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  uint16_t chunkUid = m_chunkUid;
+  m_chunkUid++;
+  if (IsLogged ())
+    {
+      Log (LOG_ADD_TRAILER, uid, size, chunkUid, 0);
+      return;
+    }
+  Materialize ();
+  AddTrailerItem (uid, size, chunkUid);
+  NS_ASSERT (IsStateOk ());
+}
+void
+PacketMetadata::AddTrailerItem (uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+  NS_LOG_FUNCTION (this << uid << size << chunkUid);
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = chunkUid;
   uint16_t written = AddSmall (&item);
   UpdateTail (written);
-  NS_ASSERT (IsStateOk ());
 }
 void 
 PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
@@ -761,6 +861,29 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_lazy && m_log != 0)
+    {
+      // removing an item does not copy the list: the removal is
+      // logged only to come after the operations already logged.
+      if (m_log->op == LOG_ADD_TRAILER &&
+          m_log->typeUid == uid && m_log->size == size)
+        {
+          // the trailer just added is removed whole.
+          PopLog ();
+        }
+      else
+        {
+          Log (LOG_REMOVE_TRAILER, uid, size, 0, 0);
+        }
+      return;
+    }
+  Materialize ();
+  RemoveTrailerItem (uid, size);
+}
+void
+PacketMetadata::RemoveTrailerItem (uint32_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << uid << size);
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -808,6 +931,27 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       m_metadataSkipped = true;
       return;
     }
+  if (IsLogged () || (m_lazy && o.m_log != 0))
+    {
+      if (m_log == 0 && m_tail == 0xffff)
+        {
+          // We have no items so 'AddAtEnd' is 
+          // equivalent to self-assignment.
+          *this = o;
+          return;
+        }
+      Log (LOG_ADD_AT_END, 0, 0, 0, new PacketMetadata (o));
+      return;
+    }
+  Materialize ();
+  o.Materialize ();
+  AddItemsAtEnd (o);
+}
+void
+PacketMetadata::AddItemsAtEnd (PacketMetadata const&o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  NS_ASSERT (IsStateOk ());
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -896,6 +1040,22 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
+  if (IsLogged ())
+    {
+      if (start > 0)
+        {
+          Log (LOG_REMOVE_AT_START, 0, start, 0, 0);
+        }
+      return;
+    }
+  Materialize ();
+  RemoveItemsAtStart (start);
+}
+void
+PacketMetadata::RemoveItemsAtStart (uint32_t start)
+{
+  NS_LOG_FUNCTION (this << start);
+  NS_ASSERT (IsStateOk ());
   NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
@@ -959,6 +1119,22 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
+  if (IsLogged ())
+    {
+      if (end > 0)
+        {
+          Log (LOG_REMOVE_AT_END, 0, end, 0, 0);
+        }
+      return;
+    }
+  Materialize ();
+  RemoveItemsAtEnd (end);
+}
+void
+PacketMetadata::RemoveItemsAtEnd (uint32_t end)
+{
+  NS_LOG_FUNCTION (this << end);
+  NS_ASSERT (IsStateOk ());
   NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
@@ -1014,6 +1190,142 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
   NS_ASSERT (leftToRemove == 0);
   NS_ASSERT (IsStateOk ());
 }
+void
+PacketMetadata::Log (enum LogOperation op, uint32_t typeUid, uint32_t size,
+                     uint16_t chunkUid, PacketMetadata *other)
+{
+  // No function logging: this is called for each packet.
+  struct LogEntry *entry;
+  if (m_logFreeList.empty ())
+    {
+      MemoryAccounting::Allocate (GetMetadataAccounting (), sizeof (struct LogEntry));
+      entry = new LogEntry;
+    }
+  else
+    {
+      entry = m_logFreeList.back ();
+      m_logFreeList.pop_back ();
+    }
+  entry->count = 1;
+  entry->depth = (m_log == 0) ? 1 : m_log->depth + 1;
+  // the entry takes over our reference to the previous one.
+  entry->prev = m_log;
+  entry->other = other;
+  entry->typeUid = typeUid;
+  entry->size = size;
+  entry->chunkUid = chunkUid;
+  entry->op = op;
+  m_log = entry;
+  if (entry->depth >= MAX_LOG_DEPTH)
+    {
+      Materialize ();
+    }
+}
+bool
+PacketMetadata::IsLogged (void) const
+{
+  // the operations on a list which is not shared are applied right
+  // away: they do not copy it.
+  return m_lazy && (m_log != 0 || m_data->m_count > 1);
+}
+void
+PacketMetadata::PopLog (void)
+{
+  NS_ASSERT (m_log != 0);
+  struct LogEntry *last = m_log;
+  m_log = last->prev;
+  if (m_log != 0)
+    {
+      m_log->count++;
+    }
+  ReleaseLog (last);
+}
+void
+PacketMetadata::ReleaseLog (struct LogEntry *entry)
+{
+  while (entry != 0)
+    {
+      NS_ASSERT (entry->count > 0);
+      entry->count--;
+      if (entry->count > 0)
+        {
+          return;
+        }
+      struct LogEntry *prev = entry->prev;
+      delete entry->other;
+      if (!m_enable || m_logFreeList.size () >= MAX_FREE_LOG_ENTRIES)
+        {
+          MemoryAccounting::Free (GetMetadataAccounting (), sizeof (struct LogEntry));
+          delete entry;
+        }
+      else
+        {
+          m_logFreeList.push_back (entry);
+        }
+      entry = prev;
+    }
+}
+void
+PacketMetadata::Materialize (void) const
+{
+  if (m_log == 0)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_log->depth);
+  PacketMetadata *self = const_cast<PacketMetadata *> (this);
+  std::vector<const struct LogEntry *> entries;
+  entries.reserve (m_log->depth);
+  for (const struct LogEntry *entry = m_log; entry != 0; entry = entry->prev)
+    {
+      entries.push_back (entry);
+    }
+  // the list now holds the items before the first entry: replay the
+  // entries from the oldest one, keeping them alive until done.
+  struct LogEntry *log = m_log;
+  self->m_log = 0;
+  for (std::vector<const struct LogEntry *>::reverse_iterator i = entries.rbegin ();
+       i != entries.rend (); ++i)
+    {
+      self->Replay (*i);
+    }
+  ReleaseLog (log);
+  NS_ASSERT (IsStateOk ());
+}
+void
+PacketMetadata::Replay (const struct LogEntry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  switch (entry->op)
+    {
+    case LOG_ADD_HEADER:
+      AddHeaderItem (entry->typeUid, entry->size, entry->chunkUid);
+      break;
+    case LOG_REMOVE_HEADER:
+      RemoveHeaderItem (entry->typeUid, entry->size);
+      break;
+    case LOG_ADD_TRAILER:
+      AddTrailerItem (entry->typeUid, entry->size, entry->chunkUid);
+      break;
+    case LOG_REMOVE_TRAILER:
+      RemoveTrailerItem (entry->typeUid, entry->size);
+      break;
+    case LOG_ADD_AT_END:
+      entry->other->Materialize ();
+      AddItemsAtEnd (*entry->other);
+      break;
+    case LOG_REMOVE_AT_START:
+      RemoveItemsAtStart (entry->size);
+      break;
+    case LOG_REMOVE_AT_END:
+      RemoveItemsAtEnd (entry->size);
+      break;
+    default:
+      NS_ASSERT_MSG (false, "Unknown log operation");
+      break;
+    }
+}
+
 uint32_t
 PacketMetadata::GetTotalSize (void) const
 {
@@ -1047,6 +1359,7 @@ PacketMetadata::ItemIterator
 PacketMetadata::BeginItem (Buffer buffer) const
 {
   NS_LOG_FUNCTION (this << &buffer);
+  Materialize ();
   return ItemIterator (this, buffer);
 }
 PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buffer buffer)
@@ -1150,6 +1463,7 @@ PacketMetadata::GetSerializedSize (void) const
     {
       return totalSize;
     }
+  Materialize ();
 
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
@@ -1183,6 +1497,7 @@ uint32_t
 PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  Materialize ();
   uint8_t* start = buffer;
 
   buffer = AddToRawU64 (m_packetUid, start, buffer, maxSize);
@@ -1284,6 +1599,7 @@ uint32_t
 PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  Materialize ();
   const uint8_t* start = buffer;
   uint32_t desSize = size - 4;
 
@@ -74,6 +74,16 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * When enabled with EnableLazy, the operations performed on a packet
+ * whose list is shared with other copies are not applied to this list
+ * right away, which would copy it: each one is appended, as a small
+ * LogEntry, to a log shared by all the copies of the packet, each
+ * copy pointing to its last entry.  The list is built from the
+ * log only when it is read, by BeginItem, GetSerializedSize or
+ * Serialize.  A header or a trailer removed right after it was added
+ * simply drops the last entry of the log, so that the packets which
+ * only go up and down a protocol stack never build their list.
  */
 class PacketMetadata 
 {
@@ -159,6 +169,15 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata, recorded in a log which is
+   * applied to the list of items only when they are read
+   *
+   * Ignored if the checking is enabled, which needs the list of
+   * items at each operation.  The later calls to Enable, such as
+   * those of the trace helpers, keep the metadata lazy.
+   */
+  static void EnableLazy (void);
 
   /**
    * \brief Constructor
@@ -500,7 +519,55 @@ public:
     ~DataFreeList ();
   };
 
+  /**
+   * \brief The operations recorded in the log.
+   */
+  enum LogOperation
+  {
+    LOG_ADD_HEADER,      //!< AddHeader
+    LOG_REMOVE_HEADER,   //!< RemoveHeader
+    LOG_ADD_TRAILER,     //!< AddTrailer
+    LOG_REMOVE_TRAILER,  //!< RemoveTrailer
+    LOG_ADD_AT_END,      //!< AddAtEnd
+    LOG_REMOVE_AT_START, //!< RemoveAtStart
+    LOG_REMOVE_AT_END    //!< RemoveAtEnd
+  };
+
+  /**
+   * \brief An operation recorded in the log, shared by the
+   * metadata of the packet copies made after it.
+   */
+  struct LogEntry
+  {
+    /** The number of metadata and entries which point to this entry. */
+    uint32_t count;
+    /** The number of entries in the log up to this one. */
+    uint32_t depth;
+    /** The previous operation, or 0 if this is the first one. */
+    struct LogEntry *prev;
+    /** The metadata appended, for LOG_ADD_AT_END. */
+    PacketMetadata *other;
+    /** The uid of the header or trailer. */
+    uint32_t typeUid;
+    /** The size of the header or trailer, or of the area removed. */
+    uint32_t size;
+    /** The chunk uid given to the header or trailer added. */
+    uint16_t chunkUid;
+    /** The operation, a LogOperation. */
+    uint8_t op;
+  };
+
+  /**
+   * \brief Class to hold the free log entries
+   */
+  class LogFreeList : public std::vector<struct LogEntry *>
+  {
+public:
+    ~LogFreeList ();
+  };
+
   friend DataFreeList::~DataFreeList ();
+  friend LogFreeList::~LogFreeList ();
   friend class ItemIterator;
 
   PacketMetadata ();
@@ -615,6 +682,86 @@ public:
    * \param size header serialized size
    */
   void DoAddHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Add an header item to the list
+   * \param uid header's uid to add
+   * \param size header serialized size
+   * \param chunkUid the chunk uid of the header
+   */
+  void AddHeaderItem (uint32_t uid, uint32_t size, uint16_t chunkUid);
+  /**
+   * \brief Remove the header item at the head of the list
+   * \param uid header's uid to remove
+   * \param size header serialized size
+   */
+  void RemoveHeaderItem (uint32_t uid, uint32_t size);
+  /**
+   * \brief Add a trailer item to the list
+   * \param uid trailer's uid to add
+   * \param size trailer serialized size
+   * \param chunkUid the chunk uid of the trailer
+   */
+  void AddTrailerItem (uint32_t uid, uint32_t size, uint16_t chunkUid);
+  /**
+   * \brief Remove the trailer item at the tail of the list
+   * \param uid trailer's uid to remove
+   * \param size trailer serialized size
+   */
+  void RemoveTrailerItem (uint32_t uid, uint32_t size);
+  /**
+   * \brief Append the items of another list to the list
+   * \param o the other metadata, without log
+   */
+  void AddItemsAtEnd (PacketMetadata const&o);
+  /**
+   * \brief Remove the items of the first bytes
+   * \param start the number of bytes to remove
+   */
+  void RemoveItemsAtStart (uint32_t start);
+  /**
+   * \brief Remove the items of the last bytes
+   * \param end the number of bytes to remove
+   */
+  void RemoveItemsAtEnd (uint32_t end);
+
+  /**
+   * \brief Append an operation to the log
+   * \param op the operation
+   * \param typeUid the uid of the header or trailer
+   * \param size the size of the header or trailer, or of the area removed
+   * \param chunkUid the chunk uid of the header or trailer added
+   * \param other the metadata appended, for LOG_ADD_AT_END
+   */
+  void Log (enum LogOperation op, uint32_t typeUid, uint32_t size,
+            uint16_t chunkUid, PacketMetadata *other);
+  /**
+   * \brief Check if the operations are recorded in the log
+   * \returns true if the metadata is lazy and the list of items is
+   * shared or already has a log
+   */
+  bool IsLogged (void) const;
+  /**
+   * \brief Drop the last entry of the log
+   */
+  void PopLog (void);
+  /**
+   * \brief Apply the log to the list of items, and drop it
+   *
+   * This is called by the const methods which read the list: the log
+   * and the list describe the same items, only the representation of
+   * this metadata changes.
+   */
+  void Materialize (void) const;
+  /**
+   * \brief Apply an entry of the log to the list of items
+   * \param entry the entry
+   */
+  void Replay (const struct LogEntry *entry);
+  /**
+   * \brief Release a reference to a log entry
+   * \param entry the entry, or 0
+   */
+  static void ReleaseLog (struct LogEntry *entry);
   /**
    * \brief Check if the metadata state is ok
    * \returns true if the internal state is ok
@@ -657,8 +804,10 @@ public:
   static void Deallocate (struct PacketMetadata::Data *data);
 
   static DataFreeList m_freeList; //!< the metadata data storage
+  static LogFreeList m_logFreeList; //!< the free log entries
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static bool m_lazy; //!< Record the operations in the log
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -680,6 +829,7 @@ public:
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
   uint64_t m_packetUid; //!< packet Uid
+  struct LogEntry *m_log; //!< last operation not applied to the list, or 0
 };
 
 } // namespace ns3
@@ -691,7 +841,8 @@ PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
-    m_packetUid (uid)
+    m_packetUid (uid),
+    m_log (0)
 {
   memset (m_data->m_data, 0xff, 4);
   if (size > 0)
@@ -704,11 +855,16 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
-    m_packetUid (o.m_packetUid)
+    m_packetUid (o.m_packetUid),
+    m_log (o.m_log)
 {
   NS_ASSERT (m_data != 0);
   NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
   m_data->m_count++;
+  if (m_log != 0)
+    {
+      m_log->count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -730,6 +886,15 @@ PacketMetadata::operator = (PacketMetadata const& o)
   m_tail = o.m_tail;
   m_used = o.m_used;
   m_packetUid = o.m_packetUid;
+  if (m_log != o.m_log)
+    {
+      if (o.m_log != 0)
+        {
+          o.m_log->count++;
+        }
+      PacketMetadata::ReleaseLog (m_log);
+      m_log = o.m_log;
+    }
   return *this;
 }
 PacketMetadata::~PacketMetadata ()
@@ -740,6 +905,10 @@ PacketMetadata::~PacketMetadata ()
     {
       PacketMetadata::Recycle (m_data);
     }
+  if (m_log != 0)
+    {
+      PacketMetadata::ReleaseLog (m_log);
+    }
 }
 
 } // namespace ns3
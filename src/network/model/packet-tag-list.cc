@@ -28,12 +28,77 @@
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/memory-accounting.h"
 #include <cstring>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
+/**
+ * \ingroup packet
+ * Get the MemoryAccounting counter of the packet tags.
+ * \returns The counter.
+ */
+static MemoryAccounting::Id
+GetPacketTagAccounting (void)
+{
+  static MemoryAccounting::Id id = MemoryAccounting::Register ("ns3::PacketTagList");
+  return id;
+}
+
+struct PacketTagList::TagData *
+PacketTagList::Allocate (void)
+{
+  MemoryAccounting::Allocate (GetPacketTagAccounting (), sizeof (struct TagData));
+  return new struct TagData ();
+}
+
+void
+PacketTagList::Deallocate (struct TagData *data)
+{
+  MemoryAccounting::Free (GetPacketTagAccounting (), sizeof (struct TagData));
+  delete data;
+}
+
+uint32_t
+PacketTagList::FindInline (TypeId tid, uint32_t &offset) const
+{
+  uint32_t i = 0;
+  offset = 0;
+  while (i < m_inlineCount && m_inlineTids[i] != tid)
+    {
+      offset += m_inlineSizes[i];
+      i++;
+    }
+  return i;
+}
+
+void
+PacketTagList::RemoveInline (uint32_t i, uint32_t offset)
+{
+  uint32_t size = m_inlineSizes[i];
+  std::memmove (m_inline + offset, m_inline + offset + size,
+                GetInlineBytes () - offset - size);
+  for ( ; i + 1 < m_inlineCount; i++)
+    {
+      m_inlineTids[i] = m_inlineTids[i + 1];
+      m_inlineSizes[i] = m_inlineSizes[i + 1];
+    }
+  m_inlineCount--;
+}
+
+uint32_t
+PacketTagList::GetInlineBytes (void) const
+{
+  uint32_t bytes = 0;
+  for (uint8_t i = 0; i < m_inlineCount; i++)
+    {
+      bytes += m_inlineSizes[i];
+    }
+  return bytes;
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -133,7 +198,7 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
       NS_ASSERT (cur != 0);
       NS_ASSERT (cur->count > 1);
       cur->count--;                       // unmerge cur
-      struct TagData * copy = new struct TagData ();
+      struct TagData * copy = Allocate ();
       copy->tid = cur->tid;
       copy->count = 1;
       memcpy (copy->data, cur->data, TagData::MAX_SIZE);
@@ -157,6 +222,16 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 bool
 PacketTagList::Remove (Tag & tag)
 {
+  uint32_t offset;
+  uint32_t i = FindInline (tag.GetInstanceTypeId (), offset);
+  if (i < m_inlineCount)
+    {
+      NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+      tag.Deserialize (TagBuffer (m_inline + offset,
+                                  m_inline + offset + m_inlineSizes[i]));
+      RemoveInline (i, offset);
+      return true;
+    }
   return COWTraverse (tag, &PacketTagList::RemoveWriter);
 }
 
@@ -177,7 +252,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      delete cur;
+      Deallocate (cur);
     }
   else
     {
@@ -196,6 +271,23 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
 bool
 PacketTagList::Replace (Tag & tag)
 {
+  uint32_t offset;
+  uint32_t i = FindInline (tag.GetInstanceTypeId (), offset);
+  if (i < m_inlineCount)
+    {
+      NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+      if (tag.GetSerializedSize () == m_inlineSizes[i])
+        {
+          tag.Serialize (TagBuffer (m_inline + offset,
+                                    m_inline + offset + m_inlineSizes[i]));
+        }
+      else
+        {
+          RemoveInline (i, offset);
+          Add (tag);
+        }
+      return true;
+    }
   bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
   if (!found)
     {
@@ -225,7 +317,7 @@ PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
       // cur is always a merge at this point
       // need to copy, replace, and link past cur
       cur->count--;                     // unmerge cur
-      struct TagData * copy = new struct TagData ();
+      struct TagData * copy = Allocate ();
       copy->tid = tag.GetInstanceTypeId ();
       copy->count = 1;
       tag.Serialize (TagBuffer (copy->data,
@@ -243,21 +335,35 @@ PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
 void 
 PacketTagList::Add (const Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
   // ensure this id was not yet added
+  uint32_t offset;
+  NS_ASSERT_MSG (FindInline (tid, offset) == m_inlineCount, "Error: cannot add the same kind of tag twice.");
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
-      NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (), "Error: cannot add the same kind of tag twice.");
+      NS_ASSERT_MSG (cur->tid != tid, "Error: cannot add the same kind of tag twice.");
     }
-  struct TagData * head = new struct TagData ();
+  uint32_t size = tag.GetSerializedSize ();
+  NS_ASSERT (size <= TagData::MAX_SIZE);
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  offset = GetInlineBytes ();
+  if (m_inlineCount < INLINE_TAGS && offset + size <= INLINE_BYTES)
+    {
+      tag.Serialize (TagBuffer (self->m_inline + offset, self->m_inline + offset + size));
+      self->m_inlineTids[m_inlineCount] = tid;
+      self->m_inlineSizes[m_inlineCount] = size;
+      self->m_inlineCount++;
+      return;
+    }
+  struct TagData * head = Allocate ();
   head->count = 1;
   head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
+  head->tid = tid;
   head->next = m_next;
-  NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
   tag.Serialize (TagBuffer (head->data, head->data + tag.GetSerializedSize ()));
 
-  const_cast<PacketTagList *> (this)->m_next = head;
+  self->m_next = head;
 }
 
 bool
@@ -265,6 +371,14 @@ PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
+  uint32_t offset;
+  uint32_t i = FindInline (tid, offset);
+  if (i < m_inlineCount)
+    {
+      uint8_t *data = const_cast<uint8_t *> (m_inline + offset);
+      tag.Deserialize (TagBuffer (data, data + m_inlineSizes[i]));
+      return true;
+    }
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       if (cur->tid == tid) 
@@ -284,5 +398,25 @@ PacketTagList::Head (void) const
   return m_next;
 }
 
+uint32_t
+PacketTagList::GetInlineN (void) const
+{
+  return m_inlineCount;
+}
+
+const uint8_t *
+PacketTagList::GetInline (uint32_t i, TypeId &tid, uint32_t &size) const
+{
+  NS_ASSERT (i < m_inlineCount);
+  uint32_t offset = 0;
+  for (uint32_t j = 0; j < i; j++)
+    {
+      offset += m_inlineSizes[j];
+    }
+  tid = m_inlineTids[i];
+  size = m_inlineSizes[i];
+  return m_inline + offset;
+}
+
 } /* namespace ns3 */
 
@@ -120,9 +120,25 @@ class Tag;
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
  *
+ * \par <b> Inline tags </b>
+ *
+ *   - Up to #INLINE_TAGS tags are not stored in the tree, but
+ *     serialized back to back in an arena of #INLINE_BYTES bytes
+ *     inside the PacketTagList itself, copied with it, so that most
+ *     packets never allocate a TagData.  Only the TypeId and the
+ *     serialized size of each inline tag are kept besides its bytes,
+ *     so that the PacketTagList stays within 40 bytes.
+ *
+ *   - Finding a tag first probes the few bytes of the inline TypeIds,
+ *     before walking the tree.
+ *
+ *   - The tags which do not fit in the arena go to the tree.
+ *
  * \par <b> Memory Management: </b>
  * \n
- * Packet tags must serialize to a finite maximum size, see TagData
+ * Packet tags must serialize to a finite maximum size, see TagData.
+ * The TagData of the tree are accounted in the MemoryAccounting
+ * counter "ns3::PacketTagList".
  *
  * This documentation entitles the original author to a free beer.
  */
@@ -167,6 +183,13 @@ public:
     uint32_t count;           /**< Number of incoming links */
   };  /* struct TagData */
 
+  /** The tags stored inside the PacketTagList. */
+  enum InlineTags_e
+  {
+    INLINE_TAGS = 4,          /**< Largest number of inline tags */
+    INLINE_BYTES = 19         /**< Size of the inline arena */
+  };
+
   /**
    * Create a new PacketTagList.
    */
@@ -177,7 +200,8 @@ public:
    * \param [in] o The PacketTagList to copy.
    *
    * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * pointing to the same \ref TagData as \pname{o}, and
+   * copying its inline tags.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -187,7 +211,8 @@ public:
    * \returns the copied object
    *
    * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * pointing to the same \ref TagData as \pname{o}, and
+   * copying its inline tags.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
@@ -234,9 +259,22 @@ public:
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to head of the tags stored in the tree
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns the number of inline tags
+   */
+  uint32_t GetInlineN (void) const;
+  /**
+   * Get an inline tag.
+   *
+   * \param [in] i The index of the tag, from 0 for the oldest.
+   * \param [out] tid The type of the tag.
+   * \param [out] size The serialized size of the tag.
+   * \returns The serialized tag.
+   */
+  const uint8_t *GetInline (uint32_t i, TypeId &tid, uint32_t &size) const;
 
 private:
   /**
@@ -287,10 +325,53 @@ private:
    */
   bool ReplaceWriter (Tag & tag, bool preMerge, struct TagData * cur, struct TagData ** prevNext);
 
+  /**
+   * Find an inline tag.
+   *
+   * \param [in] tid The TypeId of the tag.
+   * \param [out] offset The offset of the tag in #m_inline.
+   * \returns The index of the tag, or #m_inlineCount if not found.
+   */
+  uint32_t FindInline (TypeId tid, uint32_t &offset) const;
+  /**
+   * Remove an inline tag, keeping the most recent tags last.
+   *
+   * \param [in] i The index of the tag.
+   * \param [in] offset The offset of the tag in #m_inline.
+   */
+  void RemoveInline (uint32_t i, uint32_t offset);
+  /**
+   * \returns The number of bytes of #m_inline in use.
+   */
+  uint32_t GetInlineBytes (void) const;
+  /**
+   * Copy the inline tags of another list.
+   * \param [in] o The other list.
+   */
+  inline void CopyInline (PacketTagList const &o);
+  /**
+   * Allocate a TagData of the tree.
+   * \returns The TagData.
+   */
+  static struct TagData * Allocate (void);
+  /**
+   * Free a TagData of the tree.
+   * \param [in] data The TagData.
+   */
+  static void Deallocate (struct TagData *data);
+
   /**
    * Pointer to first \ref TagData on the list
    */
   struct TagData *m_next;
+  /** The TypeIds of the inline tags. */
+  TypeId m_inlineTids[INLINE_TAGS];
+  /** The serialized sizes of the inline tags. */
+  uint8_t m_inlineSizes[INLINE_TAGS];
+  /** The number of inline tags. */
+  uint8_t m_inlineCount;
+  /** The serialized inline tags, back to back, the most recent last. */
+  uint8_t m_inline[INLINE_BYTES];
 };
 
 } // namespace ns3
@@ -302,36 +383,60 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_next (),
+    m_inlineCount (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_next (o.m_next),
+    m_inlineCount (o.m_inlineCount)
 {
   if (m_next != 0)
     {
       m_next->count++;
     }
+  CopyInline (o);
 }
 
 PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o) 
     {
       return *this;
     }
-  RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  if (m_next != o.m_next)
     {
-      m_next->count++;
+      RemoveAll ();
+      m_next = o.m_next;
+      if (m_next != 0) 
+        {
+          m_next->count++;
+        }
     }
+  m_inlineCount = o.m_inlineCount;
+  CopyInline (o);
   return *this;
 }
 
+void
+PacketTagList::CopyInline (PacketTagList const &o)
+{
+  uint32_t bytes = 0;
+  for (uint8_t i = 0; i < m_inlineCount; i++)
+    {
+      m_inlineTids[i] = o.m_inlineTids[i];
+      m_inlineSizes[i] = o.m_inlineSizes[i];
+      bytes += o.m_inlineSizes[i];
+    }
+  for (uint32_t i = 0; i < bytes; i++)
+    {
+      m_inline[i] = o.m_inline[i];
+    }
+}
+
 PacketTagList::~PacketTagList ()
 {
   RemoveAll ();
@@ -340,6 +445,7 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
+  m_inlineCount = 0;
   struct TagData *prev = 0;
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
     {
@@ -350,13 +456,13 @@ PacketTagList::RemoveAll (void)
         }
       if (prev != 0) 
         {
-	  delete prev;
+          Deallocate (prev);
         }
       prev = cur;
     }
   if (prev != 0) 
     {
-      delete prev;
+      Deallocate (prev);
     }
   m_next = 0;
 }
@@ -20,7 +20,9 @@
 #include "packet.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/memory-accounting.h"
 #include "ns3/simulator.h"
+#include <algorithm>
 #include <string>
 #include <cstdarg>
 
@@ -28,7 +30,20 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
+/**
+ * \ingroup packet
+ * Get the MemoryAccounting counter of the packets.
+ * \returns The counter.
+ */
+static MemoryAccounting::Id
+GetPacketAccounting (void)
+{
+  static MemoryAccounting::Id id = MemoryAccounting::Register ("ns3::Packet");
+  return id;
+}
+
 uint32_t Packet::m_globalUid = 0;
+bool Packet::m_scatterGather = false;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -81,40 +96,52 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const PacketTagList *list)
+  : m_list (list),
+    m_current (list->Head ()),
+    m_inline (list->GetInlineN ())
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_current != 0 || m_inline != 0;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
-  const struct PacketTagList::TagData *prev = m_current;
-  m_current = m_current->next;
-  return PacketTagIterator::Item (prev);
+  if (m_current != 0)
+    {
+      const struct PacketTagList::TagData *prev = m_current;
+      m_current = m_current->next;
+      return PacketTagIterator::Item (prev->tid, prev->data, PacketTagList::TagData::MAX_SIZE);
+    }
+  // the inline tags, from the most recent one.
+  m_inline--;
+  TypeId tid;
+  uint32_t size;
+  const uint8_t *data = m_list->GetInline (m_inline, tid, size);
+  return PacketTagIterator::Item (tid, data, size);
 }
 
-PacketTagIterator::Item::Item (const struct PacketTagList::TagData *data)
-  : m_data (data)
+PacketTagIterator::Item::Item (TypeId tid, const uint8_t *data, uint32_t size)
+  : m_tid (tid),
+    m_data (data),
+    m_size (size)
 {
 }
 TypeId
 PacketTagIterator::Item::GetTypeId (void) const
 {
-  return m_data->tid;
+  return m_tid;
 }
 void
 PacketTagIterator::Item::GetTag (Tag &tag) const
 {
-  NS_ASSERT (tag.GetInstanceTypeId () == m_data->tid);
-  tag.Deserialize (TagBuffer ((uint8_t*)m_data->data,
-                              (uint8_t*)m_data->data
-                              + PacketTagList::TagData::MAX_SIZE));
+  NS_ASSERT (tag.GetInstanceTypeId () == m_tid);
+  tag.Deserialize (TagBuffer ((uint8_t*)m_data,
+                              (uint8_t*)m_data + m_size));
 }
 
 
@@ -129,6 +156,9 @@ Packet::Copy (void) const
 
 Packet::Packet ()
   : m_buffer (),
+    m_segmentsSize (0),
+    m_headerSize (0),
+    m_trailerSize (0),
     m_byteTagList (),
     m_packetTagList (),
     /* The upper 32 bits of the packet id in 
@@ -140,19 +170,30 @@ Packet::Packet ()
     m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
     m_nixVector (0)
 {
+  MemoryAccounting::Allocate (GetPacketAccounting (), sizeof (Packet));
   m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
+    m_segments (o.m_segments),
+    m_segmentsSize (o.m_segmentsSize),
+    m_headerSize (o.m_headerSize),
+    m_trailerSize (o.m_trailerSize),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
     m_metadata (o.m_metadata)
 {
+  MemoryAccounting::Allocate (GetPacketAccounting (), sizeof (Packet));
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
     : m_nixVector = 0;
 }
 
+Packet::~Packet ()
+{
+  MemoryAccounting::Free (GetPacketAccounting (), sizeof (Packet));
+}
+
 Packet &
 Packet::operator = (const Packet &o)
 {
@@ -161,6 +202,10 @@ Packet::operator = (const Packet &o)
       return *this;
     }
   m_buffer = o.m_buffer;
+  m_segments = o.m_segments;
+  m_segmentsSize = o.m_segmentsSize;
+  m_headerSize = o.m_headerSize;
+  m_trailerSize = o.m_trailerSize;
   m_byteTagList = o.m_byteTagList;
   m_packetTagList = o.m_packetTagList;
   m_metadata = o.m_metadata;
@@ -171,6 +216,9 @@ Packet::operator = (const Packet &o)
 
 Packet::Packet (uint32_t size)
   : m_buffer (size),
+    m_segmentsSize (0),
+    m_headerSize (0),
+    m_trailerSize (0),
     m_byteTagList (),
     m_packetTagList (),
     /* The upper 32 bits of the packet id in 
@@ -182,21 +230,29 @@ Packet::Packet (uint32_t size)
     m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
     m_nixVector (0)
 {
+  MemoryAccounting::Allocate (GetPacketAccounting (), sizeof (Packet));
   m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
+    m_segmentsSize (0),
+    m_headerSize (0),
+    m_trailerSize (0),
     m_byteTagList (),
     m_packetTagList (),
     m_metadata (0,0),
     m_nixVector (0)
 {
+  MemoryAccounting::Allocate (GetPacketAccounting (), sizeof (Packet));
   NS_ASSERT (magic);
   Deserialize (buffer, size);
 }
 
 Packet::Packet (uint8_t const*buffer, uint32_t size)
   : m_buffer (),
+    m_segmentsSize (0),
+    m_headerSize (0),
+    m_trailerSize (0),
     m_byteTagList (),
     m_packetTagList (),
     /* The upper 32 bits of the packet id in 
@@ -208,6 +264,7 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
     m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
     m_nixVector (0)
 {
+  MemoryAccounting::Allocate (GetPacketAccounting (), sizeof (Packet));
   m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
@@ -217,26 +274,74 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
 Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList, 
                 const PacketTagList &packetTagList, const PacketMetadata &metadata)
   : m_buffer (buffer),
+    m_segmentsSize (0),
+    m_headerSize (0),
+    m_trailerSize (0),
     m_byteTagList (byteTagList),
     m_packetTagList (packetTagList),
     m_metadata (metadata),
     m_nixVector (0)
 {
+  MemoryAccounting::Allocate (GetPacketAccounting (), sizeof (Packet));
 }
 
 Ptr<Packet>
 Packet::CreateFragment (uint32_t start, uint32_t length) const
 {
   NS_LOG_FUNCTION (this << start << length);
-  Buffer buffer = m_buffer.CreateFragment (start, length);
+  NS_ASSERT (GetSize () >= start + length);
+  Buffer buffer;
+  std::vector<Buffer> segments;
+  if (m_segments.empty () || start + length <= m_buffer.GetSize ())
+    {
+      buffer = m_buffer.CreateFragment (start, length);
+    }
+  else
+    {
+      // Share the segments which overlap the fragment.
+      uint32_t offset = 0;
+      bool first = true;
+      for (uint32_t i = 0; i <= m_segments.size () && offset < start + length; i++)
+        {
+          const Buffer &segment = i == 0 ? m_buffer : m_segments[i - 1];
+          uint32_t segmentEnd = offset + segment.GetSize ();
+          if (segmentEnd > start)
+            {
+              uint32_t from = std::max (start, offset);
+              uint32_t to = std::min (start + length, segmentEnd);
+              Buffer fragment = segment.CreateFragment (from - offset, to - from);
+              if (first)
+                {
+                  buffer = fragment;
+                  first = false;
+                }
+              else
+                {
+                  segments.push_back (fragment);
+                }
+            }
+          offset = segmentEnd;
+        }
+    }
   ByteTagList byteTagList = m_byteTagList;
   byteTagList.Adjust (-start);
-  NS_ASSERT (m_buffer.GetSize () >= start + length);
-  uint32_t end = m_buffer.GetSize () - (start + length);
+  uint32_t end = GetSize () - (start + length);
   PacketMetadata metadata = m_metadata.CreateFragment (start, end);
   // again, call the constructor directly rather than
   // through Create because it is private.
   Ptr<Packet> ret = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList, metadata), false);
+  ret->m_segments.swap (segments);
+  ret->m_segmentsSize = length - ret->m_buffer.GetSize ();
+  // The headers and trailers cut by the fragment are not kept whole.
+  if (start < m_headerSize && start + length >= m_headerSize)
+    {
+      ret->m_headerSize = m_headerSize - start;
+    }
+  uint32_t trailerStart = GetSize () - m_trailerSize;
+  if (start + length > trailerStart && start <= trailerStart)
+    {
+      ret->m_trailerSize = start + length - trailerStart;
+    }
   ret->SetNixVector (GetNixVector ());
   return ret;
 }
@@ -253,12 +358,65 @@ Packet::GetNixVector (void) const
   return m_nixVector;
 } 
 
+Buffer &
+Packet::GetTail (void)
+{
+  return m_segments.empty () ? m_buffer : m_segments.back ();
+}
+
+Buffer
+Packet::MergeSegments (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_segments.empty ())
+    {
+      return m_buffer;
+    }
+  Buffer buffer = m_buffer;
+  buffer.AddAtEnd (m_segmentsSize);
+  Buffer::Iterator i = buffer.End ();
+  i.Prev (m_segmentsSize);
+  for (std::vector<Buffer>::const_iterator j = m_segments.begin ();
+       j != m_segments.end (); ++j)
+    {
+      i.Write (j->Begin (), j->End ());
+    }
+  return buffer;
+}
+
+void
+Packet::Flatten (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_segments.empty ())
+    {
+      m_buffer = MergeSegments ();
+      m_segments.clear ();
+      m_segmentsSize = 0;
+    }
+}
+
+bool
+Packet::IsHeaderInBuffer (const Header &header) const
+{
+  return m_segments.empty ()
+         || (m_headerSize != 0 && header.GetSerializedSize () <= m_headerSize);
+}
+
+bool
+Packet::IsTrailerInTail (const Trailer &trailer) const
+{
+  return m_segments.empty ()
+         || (m_trailerSize != 0 && trailer.GetSerializedSize () <= m_trailerSize);
+}
+
 void
 Packet::AddHeader (const Header &header)
 {
   uint32_t size = header.GetSerializedSize ();
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
   m_buffer.AddAtStart (size);
+  m_headerSize += size;
   m_byteTagList.Adjust (size);
   m_byteTagList.AddAtStart (size);
   header.Serialize (m_buffer.Begin ());
@@ -267,9 +425,15 @@ Packet::AddHeader (const Header &header)
 uint32_t
 Packet::RemoveHeader (Header &header)
 {
+  if (!IsHeaderInBuffer (header))
+    {
+      // The header may span several segments.
+      Flatten ();
+    }
   uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
-  m_buffer.RemoveAtStart (deserialized);
+  NS_ASSERT_MSG (deserialized <= m_buffer.GetSize (), "The header overflows the first segment");
+  RemoveBufferAtStart (deserialized);
   m_byteTagList.Adjust (-deserialized);
   m_metadata.RemoveHeader (header, deserialized);
   return deserialized;
@@ -277,7 +441,15 @@ Packet::RemoveHeader (Header &header)
 uint32_t
 Packet::PeekHeader (Header &header) const
 {
-  uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
+  uint32_t deserialized;
+  if (!IsHeaderInBuffer (header))
+    {
+      deserialized = header.Deserialize (MergeSegments ().Begin ());
+    }
+  else
+    {
+      deserialized = header.Deserialize (m_buffer.Begin ());
+    }
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
 }
@@ -287,24 +459,46 @@ Packet::AddTrailer (const Trailer &trailer)
   uint32_t size = trailer.GetSerializedSize ();
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << size);
   m_byteTagList.AddAtEnd (GetSize ());
-  m_buffer.AddAtEnd (size);
-  Buffer::Iterator end = m_buffer.End ();
+  if (m_segments.empty ())
+    {
+      m_buffer.AddAtEnd (size);
+    }
+  else
+    {
+      // Do not unshare the last segment: append a new one.
+      m_segments.push_back (Buffer ());
+      m_segments.back ().AddAtEnd (size);
+      m_segmentsSize += size;
+      m_trailerSize = 0;
+    }
+  m_trailerSize += size;
+  Buffer::Iterator end = GetTail ().End ();
   trailer.Serialize (end);
   m_metadata.AddTrailer (trailer, size);
 }
 uint32_t
 Packet::RemoveTrailer (Trailer &trailer)
 {
-  uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
+  if (!IsTrailerInTail (trailer))
+    {
+      // The trailer may span several segments.
+      Flatten ();
+    }
+  uint32_t deserialized = trailer.Deserialize (GetTail ().End ());
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
-  m_buffer.RemoveAtEnd (deserialized);
+  NS_ASSERT_MSG (deserialized <= GetTail ().GetSize (), "The trailer overflows the last segment");
+  RemoveBufferAtEnd (deserialized);
   m_metadata.RemoveTrailer (trailer, deserialized);
   return deserialized;
 }
 uint32_t
 Packet::PeekTrailer (Trailer &trailer)
 {
-  uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
+  if (!IsTrailerInTail (trailer))
+    {
+      Flatten ();
+    }
+  uint32_t deserialized = trailer.Deserialize (GetTail ().End ());
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
 }
@@ -318,7 +512,31 @@ Packet::AddAtEnd (Ptr<const Packet> packet)
   copy.AddAtStart (0);
   copy.Adjust (GetSize ());
   m_byteTagList.Add (copy);
-  m_buffer.AddAtEnd (packet->m_buffer);
+  if (GetSize () == 0)
+    {
+      m_buffer = packet->m_buffer;
+      m_segments = packet->m_segments;
+      m_segmentsSize = packet->m_segmentsSize;
+      m_headerSize = packet->m_headerSize;
+    }
+  else if (packet->GetSize () == 0)
+    {
+      // Nothing to append.
+      m_metadata.AddAtEnd (packet->m_metadata);
+      return;
+    }
+  else if (m_scatterGather || !m_segments.empty () || !packet->m_segments.empty ())
+    {
+      m_segments.push_back (packet->m_buffer);
+      m_segments.insert (m_segments.end (), packet->m_segments.begin (),
+                         packet->m_segments.end ());
+      m_segmentsSize += packet->GetSize ();
+    }
+  else
+    {
+      m_buffer.AddAtEnd (packet->m_buffer);
+    }
+  m_trailerSize = packet->m_trailerSize;
   m_metadata.AddAtEnd (packet->m_metadata);
 }
 void
@@ -326,25 +544,95 @@ Packet::AddPaddingAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   m_byteTagList.AddAtEnd (GetSize ());
-  m_buffer.AddAtEnd (size);
+  if (m_segments.empty ())
+    {
+      m_buffer.AddAtEnd (size);
+    }
+  else
+    {
+      // A zero area: no memory is used.
+      m_segments.push_back (Buffer (size));
+      m_segmentsSize += size;
+    }
+  m_trailerSize = 0;
   m_metadata.AddPaddingAtEnd (size);
 }
 void 
 Packet::RemoveAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  m_buffer.RemoveAtEnd (size);
+  RemoveBufferAtEnd (size);
   m_metadata.RemoveAtEnd (size);
 }
 void 
 Packet::RemoveAtStart (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  m_buffer.RemoveAtStart (size);
+  RemoveBufferAtStart (size);
   m_byteTagList.Adjust (-size);
   m_metadata.RemoveAtStart (size);
 }
 
+void
+Packet::RemoveBufferAtEnd (uint32_t size)
+{
+  m_trailerSize -= std::min (m_trailerSize, size);
+  while (!m_segments.empty () && size >= m_segments.back ().GetSize ())
+    {
+      size -= m_segments.back ().GetSize ();
+      m_segmentsSize -= m_segments.back ().GetSize ();
+      m_segments.pop_back ();
+    }
+  if (m_segments.empty ())
+    {
+      m_buffer.RemoveAtEnd (size);
+      if (m_buffer.GetSize () < m_headerSize)
+        {
+          m_headerSize = 0;
+        }
+    }
+  else
+    {
+      m_segments.back ().RemoveAtEnd (size);
+      m_segmentsSize -= size;
+    }
+}
+
+void
+Packet::RemoveBufferAtStart (uint32_t size)
+{
+  m_headerSize -= std::min (m_headerSize, size);
+  if (!m_segments.empty () && size >= m_buffer.GetSize ())
+    {
+      // Drop the segments removed entirely.
+      std::vector<Buffer>::iterator i = m_segments.begin ();
+      size -= m_buffer.GetSize ();
+      while (i != m_segments.end () && size >= i->GetSize ())
+        {
+          size -= i->GetSize ();
+          m_segmentsSize -= i->GetSize ();
+          ++i;
+        }
+      if (i == m_segments.end ())
+        {
+          m_buffer = Buffer ();
+        }
+      else
+        {
+          m_buffer = *i;
+          m_segmentsSize -= i->GetSize ();
+          ++i;
+        }
+      m_segments.erase (m_segments.begin (), i);
+      m_headerSize = 0;
+    }
+  m_buffer.RemoveAtStart (size);
+  if (GetSize () < m_trailerSize)
+    {
+      m_trailerSize = 0;
+    }
+}
+
 void 
 Packet::RemoveAllByteTags (void)
 {
@@ -355,13 +643,29 @@ Packet::RemoveAllByteTags (void)
 uint32_t 
 Packet::CopyData (uint8_t *buffer, uint32_t size) const
 {
-  return m_buffer.CopyData (buffer, size);
+  uint32_t copied = m_buffer.CopyData (buffer, size);
+  for (std::vector<Buffer>::const_iterator i = m_segments.begin ();
+       i != m_segments.end () && copied < size; ++i)
+    {
+      copied += i->CopyData (buffer + copied, size - copied);
+    }
+  return copied;
 }
 
 void
 Packet::CopyData (std::ostream *os, uint32_t size) const
 {
-  return m_buffer.CopyData (os, size);
+  uint32_t left = size;
+  uint32_t n = std::min (left, m_buffer.GetSize ());
+  m_buffer.CopyData (os, n);
+  left -= n;
+  for (std::vector<Buffer>::const_iterator i = m_segments.begin ();
+       i != m_segments.end () && left > 0; ++i)
+    {
+      n = std::min (left, i->GetSize ());
+      i->CopyData (os, n);
+      left -= n;
+    }
 }
 
 uint64_t 
@@ -411,7 +715,7 @@ Packet::ToString() const
 void 
 Packet::Print (std::ostream &os) const
 {
-  PacketMetadata::ItemIterator i = m_metadata.BeginItem (m_buffer);
+  PacketMetadata::ItemIterator i = m_metadata.BeginItem (MergeSegments ());
   while (i.HasNext ())
     {
       PacketMetadata::Item item = i.Next ();
@@ -528,7 +832,7 @@ Packet::Print (std::ostream &os) const
 PacketMetadata::ItemIterator 
 Packet::BeginItem (void) const
 {
-  return m_metadata.BeginItem (m_buffer);
+  return m_metadata.BeginItem (MergeSegments ());
 }
 
 void
@@ -545,6 +849,20 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableLazyPrinting (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PacketMetadata::EnableLazy ();
+}
+
+void
+Packet::EnableScatterGather (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_scatterGather = true;
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
@@ -579,7 +897,7 @@ uint32_t Packet::GetSerializedSize (void) const
 
   // increment total size by size of buffer 
   // ensuring 4-byte boundary
-  size += ((m_buffer.GetSerializedSize () + 3) & (~3));
+  size += ((MergeSegments ().GetSerializedSize () + 3) & (~3));
 
   // add 4-bytes for entry of total length of buffer 
   size += 4;
@@ -673,7 +991,8 @@ Packet::Serialize (uint8_t* buffer, uint32_t maxSize) const
     }
 
   // Serialize the packet contents
-  uint32_t bufSize = m_buffer.GetSerializedSize ();
+  Buffer contents = MergeSegments ();
+  uint32_t bufSize = contents.GetSerializedSize ();
   if (size + bufSize <= maxSize)
     {
       // put the total length of the buffer in the
@@ -684,7 +1003,7 @@ Packet::Serialize (uint8_t* buffer, uint32_t maxSize) const
 
       // serialize the buffer
       uint32_t serialized = 
-        m_buffer.Serialize (reinterpret_cast<uint8_t *> (p), bufSize);
+        contents.Serialize (reinterpret_cast<uint8_t *> (p), bufSize);
       if (serialized)
         {
           // increment p by bufSize bytes
@@ -881,7 +1200,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (&m_packetTagList);
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <vector>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -152,10 +153,14 @@ private:
     friend class PacketTagIterator;
     /**
      * Constructor
-     * \param data the data to copy.
+     * \param tid the type of the tag.
+     * \param data the serialized tag.
+     * \param size the size of the serialized tag.
      */
-    Item (const struct PacketTagList::TagData *data);
-    const struct PacketTagList::TagData *m_data; //!< the tag data
+    Item (TypeId tid, const uint8_t *data, uint32_t size);
+    TypeId m_tid;             //!< the type of the tag
+    const uint8_t *m_data;    //!< the serialized tag
+    uint32_t m_size;          //!< the size of the serialized tag
   };
   /**
    * \returns true if calling Next is safe, false otherwise.
@@ -169,10 +174,12 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param list the list of the items
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
-  const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
+  PacketTagIterator (const PacketTagList *list);
+  const PacketTagList *m_list;  //!< the set of tags in a packet
+  const struct PacketTagList::TagData *m_current;  //!< actual position over the tree of tags in a packet
+  uint32_t m_inline;            //!< the number of inline tags not visited yet
 };
 
 /**
@@ -195,7 +202,9 @@ private:
  * output from Packet::Print. If you wish to only enable
  * checking of metadata, and do not need any printing capability, you can
  * call Packet::EnableChecking: its runtime cost is lower than
- * Packet::EnablePrinting.
+ * Packet::EnablePrinting. Packet::EnableLazyPrinting records the
+ * metadata at a much lower cost, and only builds it when a packet
+ * is printed.
  *
  * - The set of tags contain simulation-specific information which cannot
  * be stored in the packet byte buffer because the protocol headers or trailers
@@ -213,6 +222,11 @@ private:
  * qos class id set by an application and processed by a lower-level MAC 
  * layer.
  *
+ * - The byte buffer is normally contiguous. Once
+ * Packet::EnableScatterGather has been called, concatenating packets
+ * with AddAtEnd links their buffers instead of copying them, and the
+ * packet becomes a chain of shared segments: see \ref packetperf.
+ *
  * Implementing a new type of Header or Trailer for a new protocol is 
  * pretty easy and is a matter of creating a subclass of the ns3::Header 
  * or of the ns3::Trailer base class, and implementing the methods
@@ -238,6 +252,8 @@ public:
    * \param o object to copy
    */
   Packet (const Packet &o);
+  /** Destructor */
+  ~Packet ();
   /**
    * \brief Basic assignment
    * \param o object to copy
@@ -501,6 +517,34 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable printing packets metadata, recorded lazily.
+   *
+   * Same as EnablePrinting, except that the operations on the
+   * packets are only logged, in a log shared by the packet copies,
+   * and turned into metadata when the packet is printed, serialized
+   * or its items are iterated.  Most packets are never printed, so
+   * this is much cheaper than EnablePrinting, which can be called
+   * afterwards, as the trace helpers do, without effect.  Ignored
+   * if EnableChecking was called.
+   */
+  static void EnableLazyPrinting (void);
+  /**
+   * \brief Enable scatter-gather packet buffers.
+   *
+   * Once enabled, AddAtEnd links the buffer of the appended packet
+   * to the buffer of this packet instead of copying both into a new
+   * buffer, and CreateFragment, RemoveAtStart, RemoveAtEnd and
+   * CopyData work on the resulting chain of segments without copying
+   * it.  The segments are merged into a contiguous buffer only when
+   * a header or a trailer has to be read from bytes which were not
+   * added by AddHeader or AddTrailer, or when the packet is printed
+   * or serialized.
+   *
+   * Call this method during the simulation setup, before any packet
+   * is created.
+   */
+  static void EnableScatterGather (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -713,7 +757,58 @@ private:
 
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Get the last segment of the packet buffer.
+   * \returns the buffer holding the end of the packet
+   */
+  Buffer &GetTail (void);
+  /**
+   * \brief Get the packet buffer as a single contiguous buffer.
+   * \returns the packet buffer, with its segments merged
+   */
+  Buffer MergeSegments (void) const;
+  /**
+   * \brief Merge the segments of the packet buffer, if any.
+   */
+  void Flatten (void);
+  /**
+   * \brief Check that a header can be read in place, from m_buffer.
+   *
+   * The size of a header is only known once it is deserialized: it
+   * is read in place only from the bytes written by AddHeader, which
+   * must hold its current size.
+   *
+   * \param header the header to read
+   * \returns true if the header does not need the segments to be merged
+   */
+  bool IsHeaderInBuffer (const Header &header) const;
+  /**
+   * \brief Check that a trailer can be read in place, from the last
+   * segment.
+   * \param trailer the trailer to read
+   * \returns true if the trailer does not need the segments to be merged
+   */
+  bool IsTrailerInTail (const Trailer &trailer) const;
+  /**
+   * \brief Remove bytes from the start of the packet buffer only.
+   * \param size number of bytes to remove
+   */
+  void RemoveBufferAtStart (uint32_t size);
+  /**
+   * \brief Remove bytes from the end of the packet buffer only.
+   * \param size number of bytes to remove
+   */
+  void RemoveBufferAtEnd (uint32_t size);
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
+  /**
+   * The segments following m_buffer in a scatter-gather packet;
+   * m_buffer then holds the start of the packet and its headers.
+   */
+  std::vector<Buffer> m_segments;
+  uint32_t m_segmentsSize;        //!< the size of the segments
+  uint32_t m_headerSize;          //!< the bytes added by AddHeader at the start of m_buffer
+  uint32_t m_trailerSize;         //!< the bytes added by AddTrailer at the end of the last segment
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
   PacketMetadata m_metadata;      //!< the packet's metadata
@@ -722,6 +817,7 @@ private:
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
   static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static bool m_scatterGather; //!< Link the buffers of AddAtEnd
 };
 
 /**
@@ -767,6 +863,15 @@ std::ostream& operator<< (std::ostream& os, const Packet &packet);
  *   - ns3::Packet::RemoveAtEnd
  *   - ns3::Packet::CopyData
  *
+ * Once Packet::EnableScatterGather has been called, AddAtEnd
+ * never copies the packet data: the packet keeps a chain of
+ * shared immutable segments, and RemoveAtStart, RemoveAtEnd,
+ * CreateFragment and CopyData walk it. AddHeader and AddTrailer
+ * write to the first and the last segment, and RemoveHeader and
+ * RemoveTrailer read the bytes added by them in place; any other
+ * header or trailer, as well as Print and Serialize, merges the
+ * segments first.
+ *
  * Dirty operations will always be slower than non-dirty operations,
  * sometimes by several orders of magnitude. However, even the
  * dirty operations have been optimized for common use-cases which
@@ -785,7 +890,7 @@ namespace ns3 {
 uint32_t 
 Packet::GetSize (void) const
 {
-  return m_buffer.GetSize ();
+  return m_buffer.GetSize () + m_segmentsSize;
 }
 
 } // namespace ns3
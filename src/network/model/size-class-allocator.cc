@@ -0,0 +1,518 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "size-class-allocator.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::SizeClassAllocator and ns3::SizeClassPool implementations.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SizeClassAllocator");
+
+namespace {
+
+/** The number of bytes of each class kept by a thread cache. */
+const uint32_t CACHE_BYTES = 64 * 1024;
+
+/**
+ * Add statistics.
+ * \param [in,out] a The sum.
+ * \param [in] b The statistics to add.
+ */
+void
+AddStats (SizeClassAllocator::Stats &a, const SizeClassAllocator::Stats &b)
+{
+  a.hits += b.hits;
+  a.misses += b.misses;
+  a.releases += b.releases;
+  a.pooledBytes += b.pooledBytes;
+  a.pooledBlocks += b.pooledBlocks;
+}
+
+} // anonymous namespace
+
+SizeClassAllocator::SizeClassAllocator (std::string name, uint32_t minSize,
+                                        uint32_t maxSize, uint64_t limit)
+  : m_limit (limit),
+    m_depotBytes (0)
+{
+  NS_LOG_FUNCTION (this << name << minSize << maxSize << limit);
+  NS_ASSERT_MSG (minSize >= sizeof (struct FreeBlock) && (minSize & (minSize - 1)) == 0,
+                 "The smallest class size must be a power of two");
+  NS_ASSERT_MSG (maxSize >= minSize && (maxSize & (maxSize - 1)) == 0,
+                 "The largest class size must be a power of two");
+  m_accounting = MemoryAccounting::Register (name);
+  m_minShift = 0;
+  while ((1U << m_minShift) < minSize)
+    {
+      m_minShift++;
+    }
+  m_nClasses = 1;
+  while ((minSize << (m_nClasses - 1)) < maxSize)
+    {
+      m_nClasses++;
+    }
+  struct FreeList empty = { 0, 0 };
+  m_depot.resize (m_nClasses, empty);
+  std::memset (&m_sharedStats, 0, sizeof (m_sharedStats));
+#ifdef HAVE_PTHREAD_H
+  pthread_key_create (&m_key, &SizeClassAllocator::ThreadExit);
+  pthread_mutex_init (&m_mutex, 0);
+#else
+  m_cache = 0;
+#endif
+}
+
+SizeClassAllocator::~SizeClassAllocator ()
+{
+  NS_LOG_FUNCTION (this);
+  // The other threads are expected to be done with the allocator.
+  while (!m_caches.empty ())
+    {
+      ReleaseCache (m_caches.back ());
+    }
+  m_limit = 0;
+  Lock ();
+  TrimDepot ();
+  Unlock ();
+#ifdef HAVE_PTHREAD_H
+  pthread_key_delete (m_key);
+  pthread_mutex_destroy (&m_mutex);
+#endif
+}
+
+void
+SizeClassAllocator::Lock (void) const
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&m_mutex);
+#endif
+}
+
+void
+SizeClassAllocator::Unlock (void) const
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&m_mutex);
+#endif
+}
+
+uint32_t
+SizeClassAllocator::GetClass (uint32_t size) const
+{
+  uint32_t c = 0;
+  while (c < m_nClasses && GetClassSize (c) < size)
+    {
+      c++;
+    }
+  return c;
+}
+
+uint32_t
+SizeClassAllocator::GetClassSize (uint32_t c) const
+{
+  return 1U << (m_minShift + c);
+}
+
+void *
+SizeClassAllocator::SystemAllocate (uint32_t size)
+{
+  MemoryAccounting::Allocate (m_accounting, size);
+  return new uint8_t [size];
+}
+
+void
+SizeClassAllocator::SystemDeallocate (void *block, uint32_t size)
+{
+  MemoryAccounting::Free (m_accounting, size);
+  delete [] static_cast<uint8_t *> (block);
+}
+
+struct SizeClassAllocator::ThreadCache *
+SizeClassAllocator::GetCache (void)
+{
+#ifdef HAVE_PTHREAD_H
+  struct ThreadCache *cache = static_cast<struct ThreadCache *> (pthread_getspecific (m_key));
+#else
+  struct ThreadCache *cache = m_cache;
+#endif
+  if (cache == 0)
+    {
+      NS_LOG_LOGIC ("new thread cache");
+      cache = new ThreadCache ();
+      cache->allocator = this;
+      struct FreeList empty = { 0, 0 };
+      cache->classes.resize (m_nClasses, empty);
+      std::memset (&cache->stats, 0, sizeof (cache->stats));
+#ifdef HAVE_PTHREAD_H
+      pthread_setspecific (m_key, cache);
+#else
+      m_cache = cache;
+#endif
+      Lock ();
+      m_caches.push_back (cache);
+      Unlock ();
+    }
+  return cache;
+}
+
+void
+SizeClassAllocator::ThreadExit (void *cache)
+{
+  struct ThreadCache *threadCache = static_cast<struct ThreadCache *> (cache);
+  threadCache->allocator->ReleaseCache (threadCache);
+}
+
+void
+SizeClassAllocator::ReleaseCache (struct ThreadCache *cache)
+{
+  NS_LOG_FUNCTION (this << cache);
+  for (uint32_t c = 0; c < m_nClasses; c++)
+    {
+      Flush (cache, c, cache->classes[c].n);
+    }
+  Lock ();
+  m_caches.erase (std::find (m_caches.begin (), m_caches.end (), cache));
+  AddStats (m_sharedStats, cache->stats);
+  Unlock ();
+#ifdef HAVE_PTHREAD_H
+  if (pthread_getspecific (m_key) == cache)
+    {
+      pthread_setspecific (m_key, 0);
+    }
+#else
+  m_cache = 0;
+#endif
+  delete cache;
+}
+
+void
+SizeClassAllocator::Flush (struct ThreadCache *cache, uint32_t c, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << cache << c << n);
+  uint32_t size = GetClassSize (c);
+  struct FreeList &list = cache->classes[c];
+  Lock ();
+  for (uint32_t i = 0; i < n && list.head != 0; i++)
+    {
+      struct FreeBlock *block = list.head;
+      list.head = block->next;
+      list.n--;
+      cache->stats.pooledBlocks--;
+      cache->stats.pooledBytes -= size;
+      if (m_depotBytes + size <= m_limit)
+        {
+          block->next = m_depot[c].head;
+          m_depot[c].head = block;
+          m_depot[c].n++;
+          m_depotBytes += size;
+        }
+      else
+        {
+          cache->stats.releases++;
+          SystemDeallocate (block, size);
+        }
+    }
+  Unlock ();
+}
+
+void
+SizeClassAllocator::Fill (struct ThreadCache *cache, uint32_t c, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << cache << c << n);
+  uint32_t size = GetClassSize (c);
+  struct FreeList &list = cache->classes[c];
+  Lock ();
+  for (uint32_t i = 0; i < n && m_depot[c].head != 0; i++)
+    {
+      struct FreeBlock *block = m_depot[c].head;
+      m_depot[c].head = block->next;
+      m_depot[c].n--;
+      m_depotBytes -= size;
+      block->next = list.head;
+      list.head = block;
+      list.n++;
+      cache->stats.pooledBlocks++;
+      cache->stats.pooledBytes += size;
+    }
+  Unlock ();
+}
+
+void
+SizeClassAllocator::TrimDepot (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Largest classes first: they free the most memory per block.
+  for (uint32_t c = m_nClasses; c > 0 && m_depotBytes > m_limit; c--)
+    {
+      uint32_t size = GetClassSize (c - 1);
+      struct FreeList &list = m_depot[c - 1];
+      while (list.head != 0 && m_depotBytes > m_limit)
+        {
+          struct FreeBlock *block = list.head;
+          list.head = block->next;
+          list.n--;
+          m_depotBytes -= size;
+          m_sharedStats.releases++;
+          SystemDeallocate (block, size);
+        }
+    }
+}
+
+void *
+SizeClassAllocator::Allocate (uint32_t size, uint32_t &capacity)
+{
+  // No function logging: this is called for each packet.
+  struct ThreadCache *cache = GetCache ();
+  uint32_t c = GetClass (size);
+  if (c == m_nClasses)
+    {
+      cache->stats.misses++;
+      capacity = size;
+      return SystemAllocate (size);
+    }
+  capacity = GetClassSize (c);
+  struct FreeList &list = cache->classes[c];
+  if (list.head == 0)
+    {
+      Fill (cache, c, std::max (CACHE_BYTES / capacity / 2, 1U));
+      if (list.head == 0)
+        {
+          cache->stats.misses++;
+          return SystemAllocate (capacity);
+        }
+    }
+  struct FreeBlock *block = list.head;
+  list.head = block->next;
+  list.n--;
+  cache->stats.hits++;
+  cache->stats.pooledBlocks--;
+  cache->stats.pooledBytes -= capacity;
+  return block;
+}
+
+void
+SizeClassAllocator::Deallocate (void *block, uint32_t capacity)
+{
+  struct ThreadCache *cache = GetCache ();
+  uint32_t c = GetClass (capacity);
+  if (c == m_nClasses || m_limit == 0)
+    {
+      cache->stats.releases++;
+      SystemDeallocate (block, capacity);
+      return;
+    }
+  NS_ASSERT (GetClassSize (c) == capacity);
+  struct FreeList &list = cache->classes[c];
+  uint32_t maxBlocks = std::max (CACHE_BYTES / capacity, 2U);
+  if (list.n >= maxBlocks)
+    {
+      Flush (cache, c, maxBlocks / 2);
+    }
+  struct FreeBlock *freeBlock = static_cast<struct FreeBlock *> (block);
+  freeBlock->next = list.head;
+  list.head = freeBlock;
+  list.n++;
+  cache->stats.pooledBlocks++;
+  cache->stats.pooledBytes += capacity;
+}
+
+uint32_t
+SizeClassAllocator::GetCapacity (uint32_t size) const
+{
+  uint32_t c = GetClass (size);
+  return c == m_nClasses ? size : GetClassSize (c);
+}
+
+void
+SizeClassAllocator::SetLimit (uint64_t limit)
+{
+  NS_LOG_FUNCTION (this << limit);
+  Lock ();
+  m_limit = limit;
+  TrimDepot ();
+  Unlock ();
+  if (limit == 0)
+    {
+      Trim ();
+    }
+}
+
+uint64_t
+SizeClassAllocator::GetLimit (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_limit;
+}
+
+struct SizeClassAllocator::Stats
+SizeClassAllocator::GetStats (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Lock ();
+  struct Stats stats = m_sharedStats;
+  for (std::vector<struct ThreadCache *>::const_iterator i = m_caches.begin ();
+       i != m_caches.end (); ++i)
+    {
+      AddStats (stats, (*i)->stats);
+    }
+  for (uint32_t c = 0; c < m_nClasses; c++)
+    {
+      stats.pooledBlocks += m_depot[c].n;
+    }
+  stats.pooledBytes += m_depotBytes;
+  Unlock ();
+  return stats;
+}
+
+void
+SizeClassAllocator::Trim (void)
+{
+  NS_LOG_FUNCTION (this);
+  struct ThreadCache *cache = GetCache ();
+  for (uint32_t c = 0; c < m_nClasses; c++)
+    {
+      uint32_t size = GetClassSize (c);
+      struct FreeList &list = cache->classes[c];
+      while (list.head != 0)
+        {
+          struct FreeBlock *block = list.head;
+          list.head = block->next;
+          list.n--;
+          cache->stats.pooledBlocks--;
+          cache->stats.pooledBytes -= size;
+          cache->stats.releases++;
+          SystemDeallocate (block, size);
+        }
+    }
+  Lock ();
+  uint64_t limit = m_limit;
+  m_limit = 0;
+  TrimDepot ();
+  m_limit = limit;
+  Unlock ();
+}
+
+/* The following macros are pretty evil but they are needed to allow us to
+ * keep track of 3 possible states for the allocator of a pool:
+ *  - uninitialized means that no one has allocated a block yet
+ *    so no one has created the allocator (it is created
+ *    on-demand when the first block is allocated)
+ *  - initialized means that the allocator exists and is valid
+ *  - destroyed means that the LocalStaticDestructor of the pool has
+ *    run so, the allocator has returned its content to the system
+ * The key is that in destroyed state, we are careful not re-create it
+ * which is a typical weakness of lazy evaluation schemes which use
+ * '0' as a special value to indicate both un-initialized and destroyed.
+ * Note that it is important to use '0' as the marker for un-initialized state
+ * because the pool is an aggregate initialized before the constructors
+ * run, so this ensures perfect handling of crazy constructor orderings.
+ */
+#define MAGIC_DESTROYED (~(long) 0)
+#define IS_UNINITIALIZED(x) (x == (SizeClassAllocator*)0)
+#define IS_DESTROYED(x) (x == (SizeClassAllocator*)MAGIC_DESTROYED)
+#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
+#define DESTROYED ((SizeClassAllocator*)MAGIC_DESTROYED)
+
+SizeClassPool::LocalStaticDestructor::LocalStaticDestructor (SizeClassPool *pool)
+  : pool (pool)
+{
+}
+
+SizeClassPool::LocalStaticDestructor::~LocalStaticDestructor ()
+{
+  if (IS_INITIALIZED (pool->allocator))
+    {
+      delete pool->allocator;
+    }
+  pool->allocator = DESTROYED;
+}
+
+void *
+SizeClassPool::Allocate (uint32_t size, uint32_t &capacity)
+{
+  // No function logging: this is called for each packet.
+  if (IS_UNINITIALIZED (allocator))
+    {
+      allocator = new SizeClassAllocator (name, minSize, maxSize, limit);
+    }
+  else if (IS_DESTROYED (allocator))
+    {
+      capacity = size;
+      MemoryAccounting::Allocate (MemoryAccounting::Register (name), size);
+      return new uint8_t [size];
+    }
+  return allocator->Allocate (size, capacity);
+}
+
+void
+SizeClassPool::Deallocate (void *block, uint32_t capacity)
+{
+  NS_ASSERT (!IS_UNINITIALIZED (allocator));
+  if (IS_DESTROYED (allocator))
+    {
+      MemoryAccounting::Free (MemoryAccounting::Register (name), capacity);
+      delete [] static_cast<uint8_t *> (block);
+    }
+  else
+    {
+      allocator->Deallocate (block, capacity);
+    }
+}
+
+uint32_t
+SizeClassPool::GetCapacity (uint32_t size) const
+{
+  if (IS_INITIALIZED (allocator))
+    {
+      return allocator->GetCapacity (size);
+    }
+  return size;
+}
+
+void
+SizeClassPool::SetLimit (uint64_t newLimit)
+{
+  NS_LOG_FUNCTION (this << name << newLimit);
+  limit = newLimit;
+  if (IS_INITIALIZED (allocator))
+    {
+      allocator->SetLimit (newLimit);
+    }
+}
+
+SizeClassAllocator::Stats
+SizeClassPool::GetStats (void) const
+{
+  NS_LOG_FUNCTION (this << name);
+  if (IS_INITIALIZED (allocator))
+    {
+      return allocator->GetStats ();
+    }
+  SizeClassAllocator::Stats stats = { 0, 0, 0, 0, 0 };
+  return stats;
+}
+
+} // namespace ns3
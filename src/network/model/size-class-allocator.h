@@ -0,0 +1,346 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIZE_CLASS_ALLOCATOR_H
+#define SIZE_CLASS_ALLOCATOR_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ns3/core-config.h"
+#include "ns3/memory-accounting.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::SizeClassAllocator and ns3::SizeClassPool declarations.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ * \brief A pool of memory blocks sorted in power of two size classes.
+ *
+ * Each allocation is rounded up to the smallest size class which
+ * holds it, and the freed blocks are kept to serve the next
+ * allocations of the same class; allocations larger than the largest
+ * class go straight to the system.  This keeps the small and the
+ * large packets of a mixed traffic from churning the system
+ * allocator, as a single free list of the largest blocks would do.
+ *
+ * Each thread allocates from its own cache, without locking; a cache
+ * exchanges half its blocks with a depot shared by all the threads,
+ * under a lock, when it runs empty or full.  A thread which exits
+ * hands its blocks over to the depot.
+ *
+ * The depot keeps at most Limit bytes, the other blocks being
+ * returned to the system; each thread cache also holds up to 64 KiB
+ * of each class.  A limit of zero disables the pooling.
+ *
+ * The blocks allocated from the system are accounted in the
+ * MemoryAccounting counter named after the allocator.
+ */
+class SizeClassAllocator
+{
+public:
+  /** The statistics of an allocator. */
+  struct Stats
+  {
+    /** Number of allocations served from the pool. */
+    uint64_t hits;
+    /** Number of allocations served by the system. */
+    uint64_t misses;
+    /** Number of blocks returned to the system when freed. */
+    uint64_t releases;
+    /** Number of bytes kept in the pool. */
+    uint64_t pooledBytes;
+    /** Number of blocks kept in the pool. */
+    uint64_t pooledBlocks;
+  };
+
+  /**
+   * Constructor.
+   *
+   * \param [in] name The name of the MemoryAccounting counter.
+   * \param [in] minSize The size of the smallest class, a power of two.
+   * \param [in] maxSize The size of the largest class, a power of two.
+   * \param [in] limit The largest number of bytes kept in the depot.
+   */
+  SizeClassAllocator (std::string name, uint32_t minSize, uint32_t maxSize,
+                      uint64_t limit);
+  /** Destructor, returning all the pooled blocks to the system. */
+  ~SizeClassAllocator ();
+
+  /**
+   * Allocate a block.
+   *
+   * \param [in] size The number of bytes needed.
+   * \param [out] capacity The size of the block, at least \p size.
+   * \returns The block.
+   */
+  void * Allocate (uint32_t size, uint32_t &capacity);
+  /**
+   * Free a block.
+   *
+   * \param [in] block The block.
+   * \param [in] capacity The size of the block, as returned by Allocate().
+   */
+  void Deallocate (void *block, uint32_t capacity);
+  /**
+   * Get the size of the blocks Allocate() returns for a size, for the
+   * users which free a block knowing only the size they asked for.
+   *
+   * \param [in] size The number of bytes needed.
+   * \returns The size of the block.
+   */
+  uint32_t GetCapacity (uint32_t size) const;
+
+  /**
+   * Set the largest number of bytes kept in the depot.
+   *
+   * \param [in] limit The limit in bytes, 0 to disable the pooling.
+   */
+  void SetLimit (uint64_t limit);
+  /**
+   * Get the largest number of bytes kept in the depot.
+   * \returns The limit in bytes.
+   */
+  uint64_t GetLimit (void) const;
+  /**
+   * Get the statistics, summed over all the threads.
+   *
+   * The counters of the other threads may be slightly out of date.
+   *
+   * \returns The statistics.
+   */
+  struct Stats GetStats (void) const;
+  /**
+   * Return the blocks of the depot and of the cache of the calling
+   * thread to the system.
+   */
+  void Trim (void);
+
+private:
+  /** A free block, linked to the next one of its class. */
+  struct FreeBlock
+  {
+    struct FreeBlock *next;   //!< The next free block.
+  };
+  /** The free blocks of a class. */
+  struct FreeList
+  {
+    struct FreeBlock *head;   //!< The first free block.
+    uint32_t n;               //!< The number of free blocks.
+  };
+  /** The blocks and the statistics of a thread. */
+  struct ThreadCache
+  {
+    SizeClassAllocator *allocator;   //!< The allocator.
+    std::vector<struct FreeList> classes;   //!< The free blocks of each class.
+    struct Stats stats;              //!< The statistics of the thread.
+  };
+
+  /**
+   * Copy constructor, not implemented.
+   * \param [in] o The allocator to copy.
+   */
+  SizeClassAllocator (const SizeClassAllocator &o);
+  /**
+   * Assignment, not implemented.
+   * \param [in] o The allocator to copy.
+   * \returns This allocator.
+   */
+  SizeClassAllocator & operator = (const SizeClassAllocator &o);
+
+  /**
+   * Get the cache of the calling thread, creating it if needed.
+   * \returns The cache.
+   */
+  struct ThreadCache * GetCache (void);
+  /**
+   * Move the blocks of a cache to the depot, and forget the cache.
+   * \param [in] cache The cache.
+   */
+  void ReleaseCache (struct ThreadCache *cache);
+  /**
+   * Called when a thread exits.
+   * \param [in] cache The cache of the thread.
+   */
+  static void ThreadExit (void *cache);
+  /**
+   * Move some blocks of a class from a cache to the depot, returning
+   * to the system those which do not fit under the limit.
+   *
+   * \param [in,out] cache The cache.
+   * \param [in] c The class.
+   * \param [in] n The number of blocks to move.
+   */
+  void Flush (struct ThreadCache *cache, uint32_t c, uint32_t n);
+  /**
+   * Move some blocks of a class from the depot to a cache.
+   *
+   * \param [in,out] cache The cache.
+   * \param [in] c The class.
+   * \param [in] n The largest number of blocks to move.
+   */
+  void Fill (struct ThreadCache *cache, uint32_t c, uint32_t n);
+  /**
+   * Return the depot blocks above the limit to the system, with the
+   * depot locked.
+   */
+  void TrimDepot (void);
+  /**
+   * Get the size class of an allocation.
+   * \param [in] size The number of bytes needed.
+   * \returns The class, or the number of classes if too large.
+   */
+  uint32_t GetClass (uint32_t size) const;
+  /**
+   * Get the size of the blocks of a class.
+   * \param [in] c The class.
+   * \returns The size in bytes.
+   */
+  uint32_t GetClassSize (uint32_t c) const;
+  /**
+   * Allocate a block from the system.
+   * \param [in] size The size in bytes.
+   * \returns The block.
+   */
+  void * SystemAllocate (uint32_t size);
+  /**
+   * Free a block to the system.
+   * \param [in] block The block.
+   * \param [in] size The size in bytes.
+   */
+  void SystemDeallocate (void *block, uint32_t size);
+  /** Lock the depot and the list of caches. */
+  void Lock (void) const;
+  /** Unlock the depot and the list of caches. */
+  void Unlock (void) const;
+
+  /** The MemoryAccounting counter. */
+  MemoryAccounting::Id m_accounting;
+  /** The log2 of the smallest class size. */
+  uint32_t m_minShift;
+  /** The number of classes. */
+  uint32_t m_nClasses;
+  /** The largest number of bytes in the depot. */
+  uint64_t m_limit;
+
+  /** The free blocks of each class shared by all threads. */
+  std::vector<struct FreeList> m_depot;
+  /** The number of bytes in the depot. */
+  uint64_t m_depotBytes;
+  /** The caches of all the threads. */
+  std::vector<struct ThreadCache *> m_caches;
+  /** The statistics of the depot and of the threads which exited. */
+  struct Stats m_sharedStats;
+#ifdef HAVE_PTHREAD_H
+  /** The key of the cache of each thread. */
+  pthread_key_t m_key;
+  /** Protects the depot, the list of caches and the shared statistics. */
+  mutable pthread_mutex_t m_mutex;
+#else
+  /** The cache of the only thread. */
+  struct ThreadCache *m_cache;
+#endif
+};
+
+/**
+ * \ingroup packet
+ * \brief A SizeClassAllocator created on first use, for the pools held
+ * in static variables.
+ *
+ * A pool is an aggregate, initialized before any constructor runs:
+ * \code
+ *   SizeClassPool g_pool = { "ns3::Foo", 32, 512, 1024 * 1024, 0 };
+ * \endcode
+ * so that the objects created by the static constructors of the other
+ * compilation units find it.  Its allocator is created by the first
+ * allocation, and destroyed by a LocalStaticDestructor defined after
+ * the pool:
+ * \code
+ *   SizeClassPool::LocalStaticDestructor g_poolDestructor (&g_pool);
+ * \endcode
+ * The blocks freed by the static destructors which run after it are
+ * then freed to the system directly.  The pool itself has no
+ * destructor, so that it is still valid for them.
+ */
+struct SizeClassPool
+{
+  /** Destroy the allocator of a pool with the static variables. */
+  struct LocalStaticDestructor
+  {
+    /**
+     * Constructor.
+     * \param [in] pool The pool whose allocator is destroyed.
+     */
+    LocalStaticDestructor (SizeClassPool *pool);
+    /** Destructor, destroying the allocator and marking the pool as destroyed. */
+    ~LocalStaticDestructor ();
+
+    SizeClassPool *pool;  //!< The pool.
+  };
+
+  /**
+   * Allocate a block.
+   *
+   * \param [in] size The number of bytes needed.
+   * \param [out] capacity The size of the block, at least \p size.
+   * \returns The block.
+   */
+  void * Allocate (uint32_t size, uint32_t &capacity);
+  /**
+   * Free a block.
+   *
+   * \param [in] block The block.
+   * \param [in] capacity The size of the block, as returned by Allocate().
+   */
+  void Deallocate (void *block, uint32_t capacity);
+  /**
+   * Get the size of the blocks Allocate() returns for a size.
+   *
+   * \param [in] size The number of bytes needed.
+   * \returns The size of the block.
+   */
+  uint32_t GetCapacity (uint32_t size) const;
+  /**
+   * Set the largest number of bytes kept in the pool.
+   *
+   * \param [in] newLimit The limit in bytes, 0 to disable the pooling.
+   */
+  void SetLimit (uint64_t newLimit);
+  /**
+   * Get the statistics of the pool.
+   * \returns The statistics, all zero if the allocator was not created.
+   */
+  SizeClassAllocator::Stats GetStats (void) const;
+
+  const char *name;               //!< The name of the MemoryAccounting counter.
+  uint32_t minSize;               //!< The size of the smallest class.
+  uint32_t maxSize;               //!< The size of the largest class.
+  uint64_t limit;                 //!< The largest number of bytes pooled.
+  SizeClassAllocator *allocator;  //!< The allocator, or its state.
+};
+
+} // namespace ns3
+
+#endif /* SIZE_CLASS_ALLOCATOR_H */
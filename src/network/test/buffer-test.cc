@@ -359,6 +359,127 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // The spans use the formats of the iterator.
+  buffer = Buffer (0);
+  buffer.AddAtStart (38);
+  Buffer reference = Buffer (0);
+  reference.AddAtStart (38);
+  uint8_t bytes[] = { 1, 2, 3, 4, 5 };
+  {
+    i = buffer.Begin ();
+    Buffer::Span span (i, 38);
+    span.WriteU8 (0x12);
+    span.WriteU8 (0x34, 2);
+    span.WriteU16 (0x1234);
+    span.WriteU32 (0x12345678);
+    span.WriteHtolsbU16 (0x1234);
+    span.WriteHtolsbU64 (0x123456789abcdef0ULL);
+    span.WriteHtonU16 (0x1234);
+    span.WriteHtonU32 (0x12345678);
+    span.WriteHtonU64 (0x123456789abcdef0ULL);
+    span.Write (bytes, 5);
+    NS_TEST_ASSERT_MSG_EQ (span.GetRemainingSize (), 0, "Bad span size");
+    span.Commit ();
+    NS_TEST_ASSERT_MSG_EQ (i.IsEnd (), true, "Span not committed");
+  }
+  i = reference.Begin ();
+  i.WriteU8 (0x12);
+  i.WriteU8 (0x34, 2);
+  i.WriteU16 (0x1234);
+  i.WriteU32 (0x12345678);
+  i.WriteHtolsbU16 (0x1234);
+  i.WriteHtolsbU64 (0x123456789abcdef0ULL);
+  i.WriteHtonU16 (0x1234);
+  i.WriteHtonU32 (0x12345678);
+  i.WriteHtonU64 (0x123456789abcdef0ULL);
+  i.Write (bytes, 5);
+  NS_TEST_ASSERT_MSG_EQ (memcmp (buffer.PeekData (), reference.PeekData (), 38), 0,
+                         "Span and iterator formats differ");
+  {
+    i = buffer.Begin ();
+    Buffer::Span span (i, 38);
+    NS_TEST_ASSERT_MSG_EQ ((uint16_t)span.ReadU8 (), 0x12, "Bad span ReadU8");
+    NS_TEST_ASSERT_MSG_EQ ((uint16_t)span.ReadU8 (), 0x34, "Bad span ReadU8");
+    span.Next (1);
+    NS_TEST_ASSERT_MSG_EQ (span.ReadU16 (), 0x1234, "Bad span ReadU16");
+    NS_TEST_ASSERT_MSG_EQ (span.ReadU32 (), 0x12345678, "Bad span ReadU32");
+    NS_TEST_ASSERT_MSG_EQ (span.ReadLsbtohU16 (), 0x1234, "Bad span ReadLsbtohU16");
+    NS_TEST_ASSERT_MSG_EQ (span.ReadLsbtohU64 (), 0x123456789abcdef0ULL,
+                           "Bad span ReadLsbtohU64");
+    NS_TEST_ASSERT_MSG_EQ (span.ReadNtohU16 (), 0x1234, "Bad span ReadNtohU16");
+    NS_TEST_ASSERT_MSG_EQ (span.ReadNtohU32 (), 0x12345678, "Bad span ReadNtohU32");
+    span.Commit ();
+    NS_TEST_ASSERT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), 25,
+                           "Span committed past the bytes read");
+    NS_TEST_ASSERT_MSG_EQ (i.ReadNtohU64 (), 0x123456789abcdef0ULL,
+                           "Bad iterator after span");
+  }
+
+  // A span may read the zero area, out of a copy.
+  buffer = Buffer (10);
+  buffer.AddAtStart (2);
+  i = buffer.Begin ();
+  i.WriteU8 (0xaa);
+  i.WriteU8 (0xbb);
+  buffer.AddAtEnd (2);
+  i = buffer.End ();
+  i.Prev (2);
+  i.WriteU8 (0xcc);
+  i.WriteU8 (0xdd);
+  {
+    i = buffer.Begin ();
+    i.Next (1);
+    Buffer::Span span (i, 13);
+    uint8_t got[13];
+    span.Read (got, 13);
+    span.Commit ();
+    NS_TEST_ASSERT_MSG_EQ ((uint16_t)got[0], 0xbb, "Bad span over the zero area");
+    NS_TEST_ASSERT_MSG_EQ ((uint16_t)got[5], 0, "Bad span over the zero area");
+    NS_TEST_ASSERT_MSG_EQ ((uint16_t)got[12], 0xdd, "Bad span over the zero area");
+    NS_TEST_ASSERT_MSG_EQ (i.IsEnd (), true, "Span not committed");
+  }
+  i = buffer.End ();
+  i.Prev (2);
+  uint8_t tail[2];
+  i.Read (tail, 2);
+  NS_TEST_ASSERT_MSG_EQ ((uint16_t)tail[0], 0xcc, "Bad Read after the zero area");
+  NS_TEST_ASSERT_MSG_EQ ((uint16_t)tail[1], 0xdd, "Bad Read after the zero area");
+
+  // An iterator fragment shares the bytes before and after the zero
+  // area, and copies the bytes over it.
+  i = buffer.Begin ();
+  Buffer head = i.CreateFragment (2);
+  NS_TEST_ASSERT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), 0, "Iterator moved by CreateFragment");
+  i = buffer.End ();
+  i.Prev (2);
+  Buffer end = i.CreateFragment (2);
+  i = buffer.Begin ();
+  i.Next (1);
+  Buffer middle = i.CreateFragment (13);
+  NS_TEST_ASSERT_MSG_EQ (head.GetSize (), 2, "Bad fragment size");
+  NS_TEST_ASSERT_MSG_EQ ((uint16_t)head.Begin ().ReadU8 (), 0xaa, "Bad fragment before the zero area");
+  NS_TEST_ASSERT_MSG_EQ (end.Begin ().ReadNtohU16 (), 0xccdd, "Bad fragment after the zero area");
+  NS_TEST_ASSERT_MSG_EQ (middle.GetSize (), 13, "Bad fragment size");
+  i = middle.Begin ();
+  NS_TEST_ASSERT_MSG_EQ ((uint16_t)i.ReadU8 (), 0xbb, "Bad fragment over the zero area");
+  i.Next (10);
+  NS_TEST_ASSERT_MSG_EQ (i.ReadNtohU16 (), 0xccdd, "Bad fragment over the zero area");
+
+  buffer = Buffer ();
+  buffer.AddAtStart (8);
+  buffer.Begin ().WriteHtonU64 (0x0102030405060708ULL);
+  i = buffer.Begin ();
+  i.Next (3);
+  Buffer view = i.CreateFragment (4);
+  NS_TEST_ASSERT_MSG_EQ (view.PeekData (), buffer.PeekData () + 3, "Fragment copied");
+  Buffer grown = view;
+  grown.AddAtStart (1);
+  grown.Begin ().WriteU8 (0xff);
+  NS_TEST_ASSERT_MSG_EQ (buffer.Begin ().ReadNtohU64 (), 0x0102030405060708ULL,
+                         "Bytes shared with a fragment overwritten");
+  buffer = Buffer ();
+  NS_TEST_ASSERT_MSG_EQ (view.Begin ().ReadNtohU32 (), 0x04050607, "Fragment not kept alive");
 }
 //-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
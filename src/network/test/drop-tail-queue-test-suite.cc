@@ -19,6 +19,7 @@
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/uinteger.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -77,6 +78,82 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((item == 0), true, "There are really no packets in there");
 }
 
+/**
+ * Check the order of the items through many wrap-arounds of the ring
+ * buffer, also when the buffer grows in the bytes mode, and that the
+ * items of a steady queue come from the pool.
+ */
+class DropTailQueueRingTestCase : public TestCase
+{
+public:
+  DropTailQueueRingTestCase ();
+  virtual void DoRun (void);
+};
+
+DropTailQueueRingTestCase::DropTailQueueRingTestCase ()
+  : TestCase ("Check the ring buffer storage of the drop tail queue")
+{
+}
+void
+DropTailQueueRingTestCase::DoRun (void)
+{
+  Ptr<DropTailQueue> queue = CreateObject<DropTailQueue> ();
+  queue->SetMaxPackets (5);
+  std::vector<Ptr<Packet> > packets;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      packets.push_back (Create<Packet> (i + 1));
+      queue->Enqueue (Create<QueueItem> (packets.back ()));
+    }
+  SizeClassAllocator::Stats before = { 0, 0, 0, 0, 0 };
+  for (uint32_t i = 5; i < 1000; i++)
+    {
+      if (i == 10)
+        {
+          // Each item now reuses the memory of the one dequeued before.
+          before = QueueItem::GetPoolStats ();
+        }
+      Ptr<QueueItem> item = queue->Dequeue ();
+      NS_TEST_ASSERT_MSG_EQ (item->GetPacket (), packets[i - 5], "The items should leave in order");
+      packets.push_back (Create<Packet> (i + 1));
+      NS_TEST_ASSERT_MSG_EQ (queue->Enqueue (Create<QueueItem> (packets.back ())), true,
+                             "There should be room for the item");
+    }
+  SizeClassAllocator::Stats after = QueueItem::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (after.hits - before.hits, 990, "The items should come from the pool");
+  NS_TEST_EXPECT_MSG_EQ (after.misses, before.misses, "The pool should not call the system");
+  for (uint32_t i = 995; i < 1000; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (queue->Dequeue ()->GetPacket (), packets[i], "The items should leave in order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "The queue should be empty");
+
+  // The bytes mode does not reserve room: the ring grows while it wraps.
+  queue = CreateObject<DropTailQueue> ();
+  queue->SetMode (Queue::QUEUE_MODE_BYTES);
+  queue->SetMaxBytes (100000);
+  packets.clear ();
+  uint32_t head = 0;
+  for (uint32_t i = 0; i < 300; i++)
+    {
+      packets.push_back (Create<Packet> (10));
+      queue->Enqueue (Create<QueueItem> (packets.back ()));
+      if (i % 3 == 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (queue->Dequeue ()->GetPacket (), packets[head++],
+                                 "The items should leave in order");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 200, "There should be 200 packets in there");
+  while (!queue->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (queue->Dequeue ()->GetPacket (), packets[head++],
+                             "The items should leave in order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (head, 300, "All the packets should have left");
+  NS_TEST_EXPECT_MSG_EQ (packets[0]->GetReferenceCount (), 1, "The queue should release the packets");
+}
+
 static class DropTailQueueTestSuite : public TestSuite
 {
 public:
@@ -84,5 +161,6 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueRingTestCase (), TestCase::QUICK);
   }
 } g_dropTailQueueTestSuite;
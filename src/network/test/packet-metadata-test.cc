@@ -252,16 +252,25 @@ HistoryTrailer<N>::Deserialize (Buffer::Iterator start)
 
 class PacketMetadataTest : public TestCase {
 public:
-  PacketMetadataTest ();
+  /**
+   * Constructor.
+   * \param lazy Whether the metadata is recorded lazily.
+   */
+  PacketMetadataTest (bool lazy);
   virtual ~PacketMetadataTest ();
   void CheckHistory (Ptr<Packet> p, const char *file, int line, uint32_t n, ...);
   virtual void DoRun (void);
 private:
   Ptr<Packet> DoAddHeader (Ptr<Packet> p);
+  /** Check the log shared by the packet copies. */
+  void DoRunLazy (void);
+
+  bool m_lazy; //!< Whether the metadata is recorded lazily
 };
 
-PacketMetadataTest::PacketMetadataTest ()
-  : TestCase ("Packet metadata")
+PacketMetadataTest::PacketMetadataTest (bool lazy)
+  : TestCase (lazy ? "Packet metadata, recorded lazily" : "Packet metadata"),
+    m_lazy (lazy)
 {
 }
 
@@ -398,7 +407,14 @@ PacketMetadataTest::DoAddHeader (Ptr<Packet> p)
 void
 PacketMetadataTest::DoRun (void)
 {
-  PacketMetadata::Enable ();
+  if (m_lazy)
+    {
+      PacketMetadata::EnableLazy ();
+    }
+  else
+    {
+      PacketMetadata::Enable ();
+    }
 
   Ptr<Packet> p = Create<Packet> (0);
   Ptr<Packet> p1 = Create<Packet> (0);
@@ -821,6 +837,58 @@ PacketMetadataTest::DoRun (void)
                                  p3->GetSize ());
   delete [] buf;
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
+
+  if (m_lazy)
+    {
+      DoRunLazy ();
+    }
+}
+
+void
+PacketMetadataTest::DoRunLazy (void)
+{
+  // the copies share the operations made before they were copied.
+  Ptr<Packet> p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_TRAILER (p, 3);
+  Ptr<Packet> p1 = p->Copy ();
+  Ptr<Packet> p2 = p->Copy ();
+  REM_TRAILER (p1, 3);
+  REM_HEADER (p1, 2);
+  ADD_HEADER (p1, 4);
+  ADD_TRAILER (p2, 5);
+  CHECK_HISTORY (p1, 3, 4, 1, 10);
+  CHECK_HISTORY (p2, 5, 2, 1, 10, 3, 5);
+  CHECK_HISTORY (p, 4, 2, 1, 10, 3);
+
+  // a header added and removed leaves the packet as it was.
+  p1 = p->Copy ();
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      ADD_HEADER (p1, 6);
+      ADD_TRAILER (p1, 7);
+      REM_TRAILER (p1, 7);
+      REM_HEADER (p1, 6);
+    }
+  CHECK_HISTORY (p1, 4, 2, 1, 10, 3);
+
+  // long logs, concatenations and fragments.
+  Ptr<Packet> data = Create<Packet> (6000);
+  p1 = Create<Packet> ();
+  for (uint32_t i = 0; i < 600; i++)
+    {
+      Ptr<Packet> segment = data->CreateFragment (i * 10, 10);
+      ADD_HEADER (segment, 8);
+      REM_HEADER (segment, 8);
+      p1->AddAtEnd (segment);
+    }
+  CHECK_HISTORY (p1, 1, 6000);
+  ADD_HEADER (p1, 9);
+  p1->RemoveAtEnd (8);
+  CHECK_HISTORY (p1, 2, 9, 5992);
+  p2 = p1->CreateFragment (5, 10);
+  CHECK_HISTORY (p2, 2, 4, 6);
 }
 //-----------------------------------------------------------------------------
 class PacketMetadataTestSuite : public TestSuite
@@ -832,7 +900,8 @@ public:
 PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
-  AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataTest (false), TestCase::QUICK);
+  AddTestCase (new PacketMetadataTest (true), TestCase::QUICK);
 }
 
 PacketMetadataTestSuite g_packetMetadataTest;
@@ -20,9 +20,12 @@
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
 #include "ns3/test.h"
+#include "ns3/memory-accounting.h"
 #include "ns3/unused.h"
+#include <algorithm>
 #include <limits>     // std:numeric_limits
 #include <string>
+#include <vector>
 #include <cstdarg>
 #include <iostream>
 #include <iomanip>
@@ -584,6 +587,169 @@ PacketTest::DoRun (void)
   }
 }
 //--------------------------------------
+/**
+ * Check the memory accounting of the packets.
+ */
+class PacketMemoryAccountingTest : public TestCase
+{
+public:
+  PacketMemoryAccountingTest ();
+private:
+  void DoRun (void);
+};
+
+PacketMemoryAccountingTest::PacketMemoryAccountingTest ()
+  : TestCase ("Check the memory accounting of the packets")
+{
+}
+
+void
+PacketMemoryAccountingTest::DoRun (void)
+{
+  MemoryAccounting::Reset ();
+  MemoryAccounting::Enable (true);
+  {
+    // Larger than the buffers kept for reuse by the earlier tests.
+    std::vector<uint8_t> payload (100000, 1);
+    Ptr<Packet> p = Create<Packet> (&payload[0], payload.size ());
+    Ptr<Packet> copy = p->Copy ();
+    Ptr<Packet> fragment = p->CreateFragment (0, 100);
+
+    MemoryAccounting::Counter packets = MemoryAccounting::GetCounter ("ns3::Packet");
+    NS_TEST_EXPECT_MSG_EQ (packets.objects, 3, "Packets not accounted");
+    NS_TEST_EXPECT_MSG_EQ (packets.bytes, 3 * sizeof (Packet), "Wrong packet size");
+    MemoryAccounting::Counter buffers = MemoryAccounting::GetCounter ("ns3::Buffer");
+    NS_TEST_EXPECT_MSG_GT_OR_EQ (buffers.bytes, payload.size (), "Buffer not accounted");
+  }
+  MemoryAccounting::Counter packets = MemoryAccounting::GetCounter ("ns3::Packet");
+  NS_TEST_EXPECT_MSG_EQ (packets.objects, 0, "Packets left");
+  NS_TEST_EXPECT_MSG_EQ (packets.peakObjects, 3, "Wrong peak");
+  MemoryAccounting::Enable (false);
+  MemoryAccounting::Reset ();
+}
+//--------------------------------------
+/**
+ * Check the scatter-gather packet buffers.
+ */
+class PacketScatterGatherTest : public TestCase
+{
+public:
+  PacketScatterGatherTest ();
+private:
+  void DoRun (void);
+  /**
+   * Check the content of a packet.
+   * \param p The packet.
+   * \param start The first expected byte.
+   * \param size The expected size.
+   */
+  void CheckData (Ptr<const Packet> p, uint32_t start, uint32_t size);
+};
+
+PacketScatterGatherTest::PacketScatterGatherTest ()
+  : TestCase ("Check the scatter-gather packet buffers")
+{
+}
+
+void
+PacketScatterGatherTest::CheckData (Ptr<const Packet> p, uint32_t start, uint32_t size)
+{
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), size, "Wrong size");
+  std::vector<uint8_t> data (size + 1);
+  NS_TEST_ASSERT_MSG_EQ (p->CopyData (&data[0], size + 1), size, "Wrong copy size");
+  for (uint32_t i = 0; i < size; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t)data[i], (start + i) % 251, "Wrong byte " << i);
+    }
+}
+
+void
+PacketScatterGatherTest::DoRun (void)
+{
+  Packet::EnableScatterGather ();
+  std::vector<uint8_t> payload (300);
+  for (uint32_t i = 0; i < payload.size (); i++)
+    {
+      payload[i] = i % 251;
+    }
+  Ptr<Packet> p1 = Create<Packet> (&payload[0], 100);
+  Ptr<Packet> p2 = Create<Packet> (&payload[100], 100);
+  Ptr<Packet> p3 = Create<Packet> (&payload[200], 100);
+
+  Ptr<Packet> whole = p1->Copy ();
+  whole->AddAtEnd (p2);
+  whole->AddAtEnd (p3);
+  CheckData (whole, 0, 300);
+  CheckData (p1, 0, 100);
+
+  // Fragments and removals across the segments.
+  CheckData (whole->CreateFragment (50, 200), 50, 200);
+  CheckData (whole->CreateFragment (150, 20), 150, 20);
+  Ptr<Packet> tmp = whole->Copy ();
+  tmp->RemoveAtStart (120);
+  CheckData (tmp, 120, 180);
+  tmp->RemoveAtEnd (90);
+  CheckData (tmp, 120, 90);
+  tmp->RemoveAtStart (90);
+  CheckData (tmp, 210, 0);
+  CheckData (whole, 0, 300);
+
+  // Headers and trailers are written and read in place.
+  tmp = whole->Copy ();
+  tmp->AddHeader (ATestHeader<10> ());
+  tmp->AddTrailer (ATestTrailer<4> ());
+  NS_TEST_ASSERT_MSG_EQ (tmp->GetSize (), 314, "Wrong size");
+  ATestTrailer<4> trailer;
+  tmp->RemoveTrailer (trailer);
+  NS_TEST_EXPECT_MSG_EQ (trailer.m_error, false, "Wrong trailer");
+  ATestHeader<10> header;
+  tmp->RemoveHeader (header);
+  NS_TEST_EXPECT_MSG_EQ (header.m_error, false, "Wrong header");
+  CheckData (tmp, 0, 300);
+
+  // A header split across the segments is merged first.
+  Ptr<Packet> headerPacket = Create<Packet> (&payload[0], 20);
+  headerPacket->AddHeader (ATestHeader<8> ());
+  tmp = headerPacket->CreateFragment (0, 3);
+  tmp->AddAtEnd (headerPacket->CreateFragment (3, 25));
+  ATestHeader<8> split;
+  NS_TEST_EXPECT_MSG_EQ (tmp->PeekHeader (split), 8, "Wrong header size");
+  NS_TEST_EXPECT_MSG_EQ (split.m_error, false, "Wrong header");
+  tmp->RemoveHeader (split);
+  NS_TEST_EXPECT_MSG_EQ (split.m_error, false, "Wrong header");
+  CheckData (tmp, 0, 20);
+
+  // A header larger than the bytes written by AddHeader is merged first.
+  tmp = Create<Packet> ();
+  tmp->AddHeader (ATestHeader<2> ());
+  tmp->AddAtEnd (p1);
+  ATestHeader<8> larger;
+  NS_TEST_EXPECT_MSG_EQ (tmp->PeekHeader (larger), 8, "Wrong header size");
+  NS_TEST_EXPECT_MSG_EQ (tmp->RemoveHeader (larger), 8, "Wrong header size");
+  CheckData (tmp, 6, 94);
+
+  // Byte tags follow the bytes.
+  tmp = p1->Copy ();
+  p2->AddByteTag (ATestTag<2> ());
+  tmp->AddAtEnd (p2);
+  ByteTagIterator i = tmp->GetByteTagIterator ();
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "Tag lost");
+  ByteTagIterator::Item item = i.Next ();
+  NS_TEST_EXPECT_MSG_EQ (item.GetStart (), 100, "Wrong tag start");
+  NS_TEST_EXPECT_MSG_EQ (item.GetEnd (), 200, "Wrong tag end");
+  i = tmp->CreateFragment (150, 50)->GetByteTagIterator ();
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "Tag lost");
+  item = i.Next ();
+  NS_TEST_EXPECT_MSG_EQ (item.GetStart (), 0, "Wrong tag start");
+  NS_TEST_EXPECT_MSG_EQ (item.GetEnd (), 50, "Wrong tag end");
+
+  // Serialization merges the segments.
+  std::vector<uint8_t> serialized (whole->GetSerializedSize ());
+  NS_TEST_ASSERT_MSG_EQ (whole->Serialize (&serialized[0], serialized.size ()), 1,
+                         "Serialization failed");
+  CheckData (Create<Packet> (&serialized[0], serialized.size (), true), 0, 300);
+}
+//--------------------------------------
 class PacketTagListTest : public TestCase
 {
 public:
@@ -785,6 +951,54 @@ PacketTagListTest::DoRun (void)
 #   undef RemoveCheck
   }  // Removal
 
+  { // Inline tags
+    std::cout << GetName () << "check the inline tags" << std::endl;
+    NS_TEST_EXPECT_MSG_EQ ((sizeof (PacketTagList) <= 40), true, "inline tags too large");
+    MemoryAccounting::Reset ();
+    MemoryAccounting::Enable (true);
+    PacketTagList ptl;
+    ptl.Add (t1);
+    ptl.Add (t2);
+    ptl.Add (t3);
+    ptl.Add (t4);
+    PacketTagList cpy = ptl;
+    cpy.Remove (t2);
+    ATestTag<2> r2 (2);
+    cpy.Replace (r2);
+    CheckRef (cpy, r2, "inline replace");
+    CheckRef (ptl, t2, "inline orig");
+    NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetCounter ("ns3::PacketTagList").allocations,
+                           0, "inline tags allocated");
+    ptl.Add (t5);
+    NS_TEST_EXPECT_MSG_EQ (MemoryAccounting::GetCounter ("ns3::PacketTagList").allocations,
+                           1, "tag beyond the inline ones not allocated");
+    MemoryAccounting::Enable (false);
+    MemoryAccounting::Reset ();
+
+    // the iteration visits the inline and the tree tags.
+    Ptr<Packet> p = Create<Packet> ();
+    p->AddPacketTag (t1);
+    p->AddPacketTag (t2);
+    p->AddPacketTag (t3);
+    p->AddPacketTag (t4);
+    p->AddPacketTag (t5);
+    p->AddPacketTag (t6);
+    p->RemovePacketTag (t2);
+    std::vector<TypeId> tids;
+    PacketTagIterator i = p->GetPacketTagIterator ();
+    while (i.HasNext ())
+      {
+        tids.push_back (i.Next ().GetTypeId ());
+      }
+    NS_TEST_EXPECT_MSG_EQ (tids.size (), 5, "wrong number of tags iterated");
+    NS_TEST_EXPECT_MSG_EQ ((std::find (tids.begin (), tids.end (), t2.GetTypeId ()) == tids.end ()),
+                           true, "removed tag iterated");
+    NS_TEST_EXPECT_MSG_EQ ((std::find (tids.begin (), tids.end (), t1.GetTypeId ()) != tids.end ()),
+                           true, "inline tag not iterated");
+    NS_TEST_EXPECT_MSG_EQ ((std::find (tids.begin (), tids.end (), t6.GetTypeId ()) != tids.end ()),
+                           true, "tree tag not iterated");
+  }
+
   { // Replace
 
     std::cout << GetName () << "check replacing each tag" << std::endl;
@@ -859,6 +1073,9 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketMemoryAccountingTest, TestCase::QUICK);
+  // Last: the scatter-gather buffers cannot be disabled.
+  AddTestCase (new PacketScatterGatherTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite;
@@ -99,6 +99,166 @@ PbbTestCase::TestDeserialize (void)
                                       "deserialization failed, objects do not match");
 }
 
+/**
+ * Check that the address blocks survive a serialization and a
+ * deserialization, whatever the common head and tail of their
+ * addresses.
+ */
+class PbbAddressRoundTripTestCase : public TestCase
+{
+public:
+  PbbAddressRoundTripTestCase ();
+
+protected:
+  virtual void DoRun (void);
+};
+
+PbbAddressRoundTripTestCase::PbbAddressRoundTripTestCase ()
+  : TestCase ("address blocks round trip")
+{
+}
+
+void
+PbbAddressRoundTripTestCase::DoRun (void)
+{
+  Ptr<PbbPacket> packet = Create<PbbPacket> ();
+  Ptr<PbbMessageIpv4> m1 = Create<PbbMessageIpv4> ();
+  m1->SetType (1);
+
+  /* The first two addresses share a tail that the third one does not */
+  Ptr<PbbAddressBlockIpv4> m1a1 = Create<PbbAddressBlockIpv4> ();
+  m1a1->AddressPushBack (Ipv4Address ("10.0.0.1"));
+  m1a1->AddressPushBack (Ipv4Address ("10.0.0.2"));
+  m1a1->AddressPushBack (Ipv4Address ("10.1.0.2"));
+  m1->AddressBlockPushBack (m1a1);
+
+  /* Identical addresses, which keep one mid byte */
+  Ptr<PbbAddressBlockIpv4> m1a2 = Create<PbbAddressBlockIpv4> ();
+  m1a2->AddressPushBack (Ipv4Address ("10.0.0.1"));
+  m1a2->AddressPushBack (Ipv4Address ("10.0.0.1"));
+  m1->AddressBlockPushBack (m1a2);
+  packet->MessagePushBack (m1);
+
+  Ptr<PbbMessageIpv6> m2 = Create<PbbMessageIpv6> ();
+  m2->SetType (2);
+  Ptr<PbbAddressBlockIpv6> m2a1 = Create<PbbAddressBlockIpv6> ();
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      uint8_t bytes[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+      bytes[8] = i % 3;
+      bytes[15] = 1;
+      m2a1->AddressPushBack (Ipv6Address (bytes));
+      Ptr<PbbAddressTlv> tlv = Create<PbbAddressTlv> ();
+      tlv->SetType (i);
+      tlv->SetIndexStart (i);
+      m2a1->TlvPushBack (tlv);
+    }
+  m2->AddressBlockPushBack (m2a1);
+  packet->MessagePushBack (m2);
+
+  Buffer buffer;
+  buffer.AddAtStart (packet->GetSerializedSize ());
+  packet->Serialize (buffer.Begin ());
+  Ptr<PbbPacket> copy = Create<PbbPacket> ();
+  uint32_t size = copy->Deserialize (buffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (size, buffer.GetSize (), "deserialization did not use all bytes");
+  NS_TEST_ASSERT_MSG_EQ (*copy, *packet, "the deserialized packet differs");
+}
+
+/**
+ * Check that an address block whose head and tail are longer than its
+ * addresses ends the parsing instead of overflowing the address.
+ */
+class PbbMalformedAddressTestCase : public TestCase
+{
+public:
+  PbbMalformedAddressTestCase ();
+
+protected:
+  virtual void DoRun (void);
+};
+
+PbbMalformedAddressTestCase::PbbMalformedAddressTestCase ()
+  : TestCase ("malformed address blocks")
+{
+}
+
+void
+PbbMalformedAddressTestCase::DoRun (void)
+{
+  uint8_t bytes[] = {
+    0x00,                       /* packet flags */
+    0x01, 0x03, 0x00, 0x11,     /* IPv4 message of 17 bytes */
+    0x00, 0x00,                 /* no message TLV */
+    0x01, 0xc0,                 /* one address, with a head and a full tail */
+    0x03, 0x0a, 0x00, 0x00,     /* head of 3 bytes */
+    0xc8,                       /* tail of 200 bytes */
+    0x01, 0x02, 0x03, 0x04
+  };
+  Buffer buffer;
+  buffer.AddAtStart (sizeof (bytes));
+  buffer.Begin ().Write (bytes, sizeof (bytes));
+
+  Ptr<PbbPacket> packet = Create<PbbPacket> ();
+  uint32_t size = packet->Deserialize (buffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (size, sizeof (bytes), "the rest of the packet should be skipped");
+  NS_TEST_ASSERT_MSG_EQ (packet->MessageSize (), 1, "the message should be kept");
+  Ptr<PbbMessage> message = packet->MessageFront ();
+  NS_TEST_ASSERT_MSG_EQ (message->AddressBlockSize (), 1, "the address block should be kept");
+  NS_TEST_ASSERT_MSG_EQ (message->AddressBlockFront ()->AddressSize (), 0,
+                         "no address should be read");
+}
+
+/**
+ * Check that the values of the deserialized TLVs are views of the
+ * buffer they were read from.
+ */
+class PbbTlvViewTestCase : public TestCase
+{
+public:
+  PbbTlvViewTestCase ();
+
+protected:
+  virtual void DoRun (void);
+};
+
+PbbTlvViewTestCase::PbbTlvViewTestCase ()
+  : TestCase ("TLV values deserialized without copies")
+{
+}
+
+void
+PbbTlvViewTestCase::DoRun (void)
+{
+  uint8_t value[300];
+  for (uint32_t i = 0; i < sizeof (value); i++)
+    {
+      value[i] = i;
+    }
+  Ptr<PbbPacket> packet = Create<PbbPacket> ();
+  Ptr<PbbTlv> tlv = Create<PbbTlv> ();
+  tlv->SetType (1);
+  tlv->SetValue (value, sizeof (value));
+  packet->TlvPushBack (tlv);
+
+  Buffer buffer;
+  buffer.AddAtStart (packet->GetSerializedSize ());
+  packet->Serialize (buffer.Begin ());
+  Ptr<PbbPacket> copy = Create<PbbPacket> ();
+  copy->Deserialize (buffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (*copy, *packet, "the deserialized packet differs");
+
+  Buffer copied = copy->TlvFront ()->GetValue ();
+  const uint8_t *start = buffer.PeekData ();
+  const uint8_t *data = copied.PeekData ();
+  NS_TEST_ASSERT_MSG_EQ ((data >= start && data + sizeof (value) <= start + buffer.GetSize ()), true,
+                         "the value was copied out of the packet");
+
+  buffer = Buffer ();
+  NS_TEST_ASSERT_MSG_EQ (memcmp (copy->TlvFront ()->GetValue ().PeekData (), value, sizeof (value)), 0,
+                         "the value did not outlive the packet buffer");
+}
+
 class PbbTestSuite : public TestSuite
 {
 public:
@@ -3818,6 +3978,10 @@ PbbTestSuite::PbbTestSuite ()
     };
     AddTestCase (new PbbTestCase ("37", packet, buffer, sizeof(buffer)), TestCase::QUICK);
   }
+
+  AddTestCase (new PbbAddressRoundTripTestCase (), TestCase::QUICK);
+  AddTestCase (new PbbMalformedAddressTestCase (), TestCase::QUICK);
+  AddTestCase (new PbbTlvViewTestCase (), TestCase::QUICK);
 }
 
 static PbbTestSuite pbbTestSuite;
@@ -21,10 +21,21 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <fstream>
+#include <vector>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcap-batch-writer.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
 
 using namespace ns3;
 
@@ -77,6 +88,37 @@ CheckFileLength (std::string filename, uint64_t sizeExpected)
   return sizeActual == sizeExpected;
 }
 
+static std::string
+ReadFileBytes (std::string filename, bool compressed)
+{
+  std::string bytes;
+  if (!compressed)
+    {
+      std::ifstream file (filename.c_str (), std::ios::binary);
+      std::ostringstream oss;
+      oss << file.rdbuf ();
+      bytes = oss.str ();
+    }
+#ifdef HAVE_ZLIB_H
+  else
+    {
+      gzFile file = gzopen (filename.c_str (), "rb");
+      if (file == 0)
+        {
+          return bytes;
+        }
+      char buffer[4096];
+      int n;
+      while ((n = gzread (file, buffer, sizeof (buffer))) > 0)
+        {
+          bytes.append (buffer, n);
+        }
+      gzclose (file);
+    }
+#endif
+  return bytes;
+}
+
 // ===========================================================================
 // Test case to make sure that the Pcap File Object can do its most basic job 
 // and create an empty pcap file.
@@ -1121,6 +1163,165 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+// ===========================================================================
+// Test case to make sure that the batched writes of PcapFile result in the
+// same file as the direct ones.
+// ===========================================================================
+class BatchedWriteTestCase : public TestCase
+{
+public:
+  BatchedWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BatchedWriteTestCase::BatchedWriteTestCase ()
+  : TestCase ("Check that PcapFile::OpenBatched writes the same records")
+{
+}
+
+typedef struct RECORD_ENTRY {
+  uint32_t tsSec;
+  uint32_t tsUsec;
+  uint32_t origLen;
+  std::vector<uint8_t> data;
+} RecordEntry;
+
+void
+BatchedWriteTestCase::DoRun (void)
+{
+  PcapFile known;
+  known.Open (CreateDataDirFilename ("known.pcap"), std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (known.Fail (), false, "Open (known.pcap) returns error");
+
+  std::vector<RecordEntry> records;
+  RecordEntry record;
+  record.data.resize (known.GetSnapLen ());
+  uint32_t inclLen, readLen;
+  while (true)
+    {
+      known.Read (&record.data[0], record.data.size (), record.tsSec, record.tsUsec,
+                  inclLen, record.origLen, readLen);
+      if (known.Fail ())
+        {
+          break;
+        }
+      records.push_back (record);
+      records.back ().data.resize (readLen);
+    }
+  NS_TEST_ASSERT_MSG_EQ (records.size (), N_KNOWN_PACKETS, "Wrong number of known packets");
+
+  std::string reference = CreateTempDirFilename ("reference.pcap");
+  std::string batched = CreateTempDirFilename ("batched.pcap");
+
+  PcapFile f;
+  f.Open (reference, std::ios::out);
+  f.Init (known.GetDataLinkType (), known.GetSnapLen (), known.GetTimeZoneOffset ());
+  for (uint32_t i = 0; i < records.size (); ++i)
+    {
+      f.Write (records[i].tsSec, records[i].tsUsec, &records[i].data[0], records[i].origLen);
+    }
+  f.Close ();
+  std::string expected = ReadFileBytes (reference, false);
+
+  //
+  // The batches are smaller than the largest records.
+  //
+  for (uint32_t compressionLevel = 0; compressionLevel <= 1; ++compressionLevel)
+    {
+      if (compressionLevel > 0 && !PcapBatchWriter::IsCompressionSupported ())
+        {
+          continue;
+        }
+      for (uint32_t asynchronous = 0; asynchronous <= 1; ++asynchronous)
+        {
+          f.OpenBatched (batched, 1000, compressionLevel, asynchronous);
+          NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "OpenBatched (" << batched << ") returns error");
+          f.Init (known.GetDataLinkType (), known.GetSnapLen (), known.GetTimeZoneOffset ());
+          for (uint32_t i = 0; i < records.size (); ++i)
+            {
+              f.Write (records[i].tsSec, records[i].tsUsec, &records[i].data[0], records[i].origLen);
+            }
+          f.Close ();
+          NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Batched writes return error");
+
+          std::string bytes = ReadFileBytes (batched, compressionLevel > 0);
+          NS_TEST_EXPECT_MSG_EQ (bytes.size (), expected.size (),
+                                 "Wrong size with compression " << compressionLevel
+                                                                << " asynchronous " << asynchronous);
+          NS_TEST_EXPECT_MSG_EQ ((bytes == expected), true,
+                                 "Wrong bytes with compression " << compressionLevel
+                                                                 << " asynchronous " << asynchronous);
+        }
+    }
+
+  remove (reference.c_str ());
+  remove (batched.c_str ());
+}
+
+// ===========================================================================
+// Test case to make sure that the PcapFileWrapper filters select the records
+// by size and time.
+// ===========================================================================
+class WrapperFilterTestCase : public TestCase
+{
+public:
+  WrapperFilterTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WrapperFilterTestCase::WrapperFilterTestCase ()
+  : TestCase ("Check that the PcapFileWrapper filters select the records")
+{
+}
+
+void
+WrapperFilterTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("filtered.pcap");
+  Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+  file->SetAttribute ("Asynchronous", BooleanValue (true));
+  file->SetAttribute ("MinSize", UintegerValue (50));
+  file->SetAttribute ("MaxSize", UintegerValue (1500));
+  file->SetAttribute ("StartTime", TimeValue (Seconds (2)));
+  file->SetAttribute ("StopTime", TimeValue (Seconds (3)));
+  file->Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Open (" << filename << ") returns error");
+  file->Init (1);
+
+  uint8_t data[2000];
+  memset (data, 0, sizeof (data));
+  file->Write (Seconds (1), data, 100);           // before StartTime
+  file->Write (Seconds (2), data, 10);            // smaller than MinSize
+  file->Write (Seconds (2), data, 100);
+  file->Write (MilliSeconds (2500), data, 2000);  // larger than MaxSize
+  file->Write (MilliSeconds (2500), data, 1000);
+  file->Write (Seconds (3), data, 100);           // at StopTime
+  file->Close ();
+  NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Write returns error");
+
+  PcapFile f;
+  f.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::in\") returns error");
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "First record missing");
+  NS_TEST_EXPECT_MSG_EQ (tsSec, 2, "Wrong first record");
+  NS_TEST_EXPECT_MSG_EQ (origLen, 100, "Wrong first record");
+  f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Second record missing");
+  NS_TEST_EXPECT_MSG_EQ (tsUsec, 500000, "Wrong second record");
+  NS_TEST_EXPECT_MSG_EQ (origLen, 1000, "Wrong second record");
+  f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (f.Eof (), true, "Filtered record written");
+  f.Close ();
+
+  remove (filename.c_str ());
+}
+
 class PcapFileTestSuite : public TestSuite
 {
 public:
@@ -1138,6 +1339,8 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new BatchedWriteTestCase, TestCase::QUICK);
+  AddTestCase (new WrapperFilterTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite;
@@ -0,0 +1,321 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/size-class-allocator.h"
+#include "ns3/buffer.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/callback.h"
+#endif
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Check the rounding of the allocations to the size classes, and the
+ * reuse of the freed blocks.
+ */
+class SizeClassAllocatorClassesTestCase : public TestCase
+{
+public:
+  SizeClassAllocatorClassesTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+SizeClassAllocatorClassesTestCase::SizeClassAllocatorClassesTestCase ()
+  : TestCase ("Check the size classes and the reuse of the blocks")
+{
+}
+
+void
+SizeClassAllocatorClassesTestCase::DoRun (void)
+{
+  SizeClassAllocator allocator ("test-classes", 64, 4096, 1024 * 1024);
+  uint32_t capacity;
+
+  void *a = allocator.Allocate (1, capacity);
+  NS_TEST_ASSERT_MSG_EQ (capacity, 64, "Wrong smallest class");
+  allocator.Deallocate (a, capacity);
+  a = allocator.Allocate (65, capacity);
+  NS_TEST_ASSERT_MSG_EQ (capacity, 128, "Wrong class");
+  allocator.Deallocate (a, capacity);
+  a = allocator.Allocate (4096, capacity);
+  NS_TEST_ASSERT_MSG_EQ (capacity, 4096, "Wrong largest class");
+  allocator.Deallocate (a, capacity);
+
+  SizeClassAllocator::Stats stats = allocator.GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.misses, 3, "Empty pool expected to miss");
+  NS_TEST_ASSERT_MSG_EQ (stats.hits, 0, "Unexpected hit");
+  NS_TEST_ASSERT_MSG_EQ (stats.pooledBlocks, 3, "Freed blocks not pooled");
+  NS_TEST_ASSERT_MSG_EQ (stats.pooledBytes, 64 + 128 + 4096, "Wrong pooled bytes");
+
+  // The freed blocks serve the next allocations of their class only.
+  void *b = allocator.Allocate (100, capacity);
+  NS_TEST_ASSERT_MSG_EQ (capacity, 128, "Wrong class");
+  void *c = allocator.Allocate (100, capacity);
+  stats = allocator.GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.hits, 1, "Pooled block not reused");
+  NS_TEST_ASSERT_MSG_EQ (stats.misses, 4, "Empty class expected to miss");
+  NS_TEST_ASSERT_MSG_EQ (stats.pooledBlocks, 2, "Wrong pooled blocks");
+  allocator.Deallocate (b, capacity);
+  allocator.Deallocate (c, capacity);
+
+  // The blocks larger than the largest class are not pooled.
+  void *d = allocator.Allocate (5000, capacity);
+  NS_TEST_ASSERT_MSG_EQ (capacity, 5000, "Oversized block rounded");
+  allocator.Deallocate (d, capacity);
+  stats = allocator.GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.misses, 5, "Oversized allocation pooled");
+  NS_TEST_ASSERT_MSG_EQ (stats.releases, 1, "Oversized block pooled");
+  NS_TEST_ASSERT_MSG_EQ (stats.pooledBlocks, 4, "Wrong pooled blocks");
+}
+
+
+/**
+ * Check that the depot keeps at most its limit, and Trim().
+ */
+class SizeClassAllocatorLimitTestCase : public TestCase
+{
+public:
+  SizeClassAllocatorLimitTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+SizeClassAllocatorLimitTestCase::SizeClassAllocatorLimitTestCase ()
+  : TestCase ("Check the limit of the pool and its trimming")
+{
+}
+
+void
+SizeClassAllocatorLimitTestCase::DoRun (void)
+{
+  SizeClassAllocator allocator ("test-limit", 64, 1024, 4096);
+  std::vector<void *> blocks;
+  uint32_t capacity = 0;
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      blocks.push_back (allocator.Allocate (1024, capacity));
+    }
+  for (uint32_t i = 0; i < blocks.size (); i++)
+    {
+      allocator.Deallocate (blocks[i], capacity);
+    }
+  // The thread cache keeps 64 KiB of the class, the depot 4 KiB.
+  SizeClassAllocator::Stats stats = allocator.GetStats ();
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (stats.pooledBytes, 64 * 1024 + 4096, "Limit exceeded");
+  NS_TEST_ASSERT_MSG_EQ (stats.pooledBytes + stats.releases * 1024, 500 * 1024,
+                         "Blocks lost");
+  NS_TEST_ASSERT_MSG_GT (stats.releases, 0, "No block returned to the system");
+
+  allocator.Trim ();
+  stats = allocator.GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.pooledBytes, 0, "Pool not trimmed");
+  NS_TEST_ASSERT_MSG_EQ (stats.pooledBlocks, 0, "Pool not trimmed");
+  NS_TEST_ASSERT_MSG_EQ (stats.releases, 500, "Blocks lost");
+
+  // A zero limit disables the pooling.
+  allocator.SetLimit (0);
+  NS_TEST_ASSERT_MSG_EQ (allocator.GetLimit (), 0, "Limit not set");
+  void *block = allocator.Allocate (64, capacity);
+  allocator.Deallocate (block, capacity);
+  stats = allocator.GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.pooledBlocks, 0, "Block pooled without a limit");
+  NS_TEST_ASSERT_MSG_EQ (stats.releases, 501, "Block not returned to the system");
+}
+
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * Check that the blocks freed by a thread which exits serve the
+ * other threads.
+ */
+class SizeClassAllocatorThreadTestCase : public TestCase
+{
+public:
+  SizeClassAllocatorThreadTestCase ();
+private:
+  virtual void DoRun (void);
+  /** Allocate and free blocks, from another thread. */
+  void Work (void);
+
+  /** The allocator. */
+  SizeClassAllocator *m_allocator;
+};
+
+SizeClassAllocatorThreadTestCase::SizeClassAllocatorThreadTestCase ()
+  : TestCase ("Check the caches of the threads")
+{
+}
+
+void
+SizeClassAllocatorThreadTestCase::Work (void)
+{
+  std::vector<void *> blocks;
+  uint32_t capacity = 0;
+  for (uint32_t round = 0; round < 10; round++)
+    {
+      for (uint32_t i = 0; i < 16; i++)
+        {
+          blocks.push_back (m_allocator->Allocate (200, capacity));
+        }
+      for (uint32_t i = 0; i < blocks.size (); i++)
+        {
+          m_allocator->Deallocate (blocks[i], capacity);
+        }
+      blocks.clear ();
+    }
+}
+
+void
+SizeClassAllocatorThreadTestCase::DoRun (void)
+{
+  SizeClassAllocator allocator ("test-threads", 64, 4096, 1024 * 1024);
+  m_allocator = &allocator;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&SizeClassAllocatorThreadTestCase::Work, this)));
+      threads.back ()->Start ();
+    }
+  for (uint32_t i = 0; i < threads.size (); i++)
+    {
+      threads[i]->Join ();
+    }
+
+  // Each thread misses its first round only.
+  SizeClassAllocator::Stats stats = allocator.GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.hits + stats.misses, 4 * 10 * 16, "Allocations lost");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (stats.misses, 4 * 16, "Blocks not reused");
+  NS_TEST_ASSERT_MSG_EQ (stats.pooledBlocks, stats.misses, "Blocks lost");
+
+  // The exited threads left their blocks in the depot.
+  uint32_t capacity;
+  void *block = allocator.Allocate (200, capacity);
+  NS_TEST_ASSERT_MSG_EQ (allocator.GetStats ().hits, stats.hits + 1,
+                         "Depot not used");
+  allocator.Deallocate (block, capacity);
+}
+#endif /* HAVE_PTHREAD_H */
+
+
+/**
+ * Check that the buffers draw their data from the pool.
+ */
+class SizeClassAllocatorBufferTestCase : public TestCase
+{
+public:
+  SizeClassAllocatorBufferTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+SizeClassAllocatorBufferTestCase::SizeClassAllocatorBufferTestCase ()
+  : TestCase ("Check the pool of the buffer data")
+{
+}
+
+void
+SizeClassAllocatorBufferTestCase::DoRun (void)
+{
+  {
+    Buffer buffer (100);
+    buffer.AddAtStart (1500);
+  }
+  SizeClassAllocator::Stats before = Buffer::GetPoolStats ();
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Buffer buffer (100);
+      buffer.AddAtStart (1500);
+      buffer.Begin ().WriteU8 (1);
+    }
+  SizeClassAllocator::Stats after = Buffer::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_EQ (after.misses, before.misses, "Buffer data not reused");
+  NS_TEST_ASSERT_MSG_GT (after.hits, before.hits, "Buffer data not pooled");
+}
+
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the allocator created on first use by a SizeClassPool.
+ */
+class SizeClassPoolTestCase : public TestCase
+{
+public:
+  SizeClassPoolTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+SizeClassPoolTestCase::SizeClassPoolTestCase ()
+  : TestCase ("Check the pools held in static variables")
+{
+}
+
+void
+SizeClassPoolTestCase::DoRun (void)
+{
+  SizeClassPool pool = { "ns3::SizeClassPoolTest", 32, 512, 1024 * 1024, 0 };
+  uint32_t capacity;
+  void *late;
+  {
+    SizeClassPool::LocalStaticDestructor destructor (&pool);
+    NS_TEST_ASSERT_MSG_EQ (pool.GetStats ().misses, 0, "Allocator created before use");
+    NS_TEST_ASSERT_MSG_EQ (pool.GetCapacity (40), 40, "Capacity without an allocator");
+    void *block = pool.Allocate (40, capacity);
+    NS_TEST_ASSERT_MSG_EQ (capacity, 64, "Block not of the size class");
+    NS_TEST_ASSERT_MSG_EQ (pool.GetCapacity (40), 64, "Capacity not of the size class");
+    pool.Deallocate (block, capacity);
+    void *again = pool.Allocate (50, capacity);
+    NS_TEST_ASSERT_MSG_EQ (again, block, "Block not reused");
+    pool.Deallocate (again, capacity);
+    SizeClassAllocator::Stats stats = pool.GetStats ();
+    NS_TEST_ASSERT_MSG_EQ (stats.misses, 1, "Wrong number of misses");
+    NS_TEST_ASSERT_MSG_EQ (stats.hits, 1, "Wrong number of hits");
+    pool.SetLimit (0);
+    NS_TEST_ASSERT_MSG_EQ (pool.GetStats ().pooledBlocks, 0, "Blocks pooled without a limit");
+    late = pool.Allocate (40, capacity);
+  }
+  // The allocator is destroyed: the blocks go to and come from the system.
+  pool.Deallocate (late, capacity);
+  void *block = pool.Allocate (40, capacity);
+  NS_TEST_ASSERT_MSG_EQ (capacity, 40, "Block of a destroyed pool not from the system");
+  NS_TEST_ASSERT_MSG_EQ (pool.GetStats ().misses, 0, "Stats of a destroyed pool");
+  pool.Deallocate (block, capacity);
+}
+
+
+static class SizeClassAllocatorTestSuite : public TestSuite
+{
+public:
+  SizeClassAllocatorTestSuite ()
+    : TestSuite ("size-class-allocator", UNIT)
+  {
+    AddTestCase (new SizeClassAllocatorClassesTestCase (), TestCase::QUICK);
+    AddTestCase (new SizeClassAllocatorLimitTestCase (), TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+    AddTestCase (new SizeClassAllocatorThreadTestCase (), TestCase::QUICK);
+#endif
+    AddTestCase (new SizeClassAllocatorBufferTestCase (), TestCase::QUICK);
+    AddTestCase (new SizeClassPoolTestCase (), TestCase::QUICK);
+  }
+} g_sizeClassAllocatorTestSuite;
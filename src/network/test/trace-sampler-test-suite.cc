@@ -0,0 +1,319 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/nstime.h"
+#include "ns3/pcap-file.h"
+#include "ns3/pcap-file-wrapper.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/trace-sampler.h"
+#include "ns3/trace-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the packets and the nodes a TraceSampler selects.
+ */
+class TraceSamplerTestCase : public TestCase
+{
+public:
+  TraceSamplerTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TraceSamplerTestCase::TraceSamplerTestCase ()
+  : TestCase ("Check the packets and the nodes selected")
+{
+}
+
+void
+TraceSamplerTestCase::DoRun (void)
+{
+  Ptr<TraceSampler> sampler = CreateObject<TraceSampler> ();
+  sampler->SetAttribute ("Ratio", UintegerValue (10));
+  sampler->SetAttribute ("StartTime", TimeValue (Seconds (1)));
+  sampler->SetAttribute ("StopTime", TimeValue (Seconds (2)));
+  Ptr<TraceSampler> same = CreateObject<TraceSampler> ();
+  same->SetAttribute ("Ratio", UintegerValue (10));
+  Ptr<TraceSampler> salted = CreateObject<TraceSampler> ();
+  salted->SetAttribute ("Ratio", UintegerValue (10));
+  salted->SetAttribute ("Salt", UintegerValue (1));
+
+  uint32_t differ = 0;
+  for (uint32_t i = 0; i < 10000; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (100);
+      bool sampled = sampler->IsSampled (Seconds (1.5), p);
+      NS_TEST_ASSERT_MSG_EQ (sampler->IsSampled (Seconds (1.5), p->Copy ()), sampled,
+                             "A copy of a packet is sampled differently");
+      NS_TEST_ASSERT_MSG_EQ (same->IsSampled (Seconds (0), p), sampled,
+                             "Two samplers select different packets");
+      differ += (salted->IsSampled (Seconds (0), p) != sampled);
+    }
+  NS_TEST_ASSERT_MSG_EQ (sampler->GetNSampled () + sampler->GetNSkipped (), 20000,
+                         "Packets not counted");
+  NS_TEST_ASSERT_MSG_EQ_TOL (sampler->GetNSampled (), 2000, 200, "Not one packet in 10 sampled");
+  NS_TEST_ASSERT_MSG_GT (differ, 1000, "The salt does not change the packets sampled");
+
+  uint64_t sampled = sampler->GetNSampled ();
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (100);
+      sampler->IsSampled (Seconds (0.5), p);
+      sampler->IsSampled (Seconds (2), p);
+    }
+  NS_TEST_ASSERT_MSG_EQ (sampler->GetNSampled (), sampled, "Packet sampled out of the window");
+
+  // Packets of the same flow are all sampled or none is, whatever the
+  // link they cross.
+  Ptr<TraceSampler> flows = CreateObject<TraceSampler> ();
+  flows->SetAttribute ("Ratio", UintegerValue (4));
+  flows->SetAttribute ("Flows", BooleanValue (true));
+  uint32_t flowsSampled = 0;
+  for (uint8_t flow = 0; flow < 64; flow++)
+    {
+      // A UDP datagram from 10.0.0.1 port 12345 to 10.0.0.flow port 9
+      uint8_t ip[38] = { 0x45 };
+      ip[9] = 17;
+      ip[12] = 10;
+      ip[15] = 1;
+      ip[16] = 10;
+      ip[19] = flow;
+      ip[20] = 0x30;
+      ip[21] = 0x39;
+      ip[23] = 9;
+      uint8_t ppp[2 + sizeof (ip)] = { 0x00, 0x21 };
+      std::memcpy (ppp + 2, ip, sizeof (ip));
+      bool first = flows->IsSampled (Seconds (0), Create<Packet> (ppp, sizeof (ppp)));
+      for (uint8_t i = 0; i < 10; i++)
+        {
+          ip[4] = i;           // identification
+          ip[8] = 64 - i;      // time to live
+          ip[30] = i;          // payload
+          std::memcpy (ppp + 2, ip, sizeof (ip));
+          NS_TEST_ASSERT_MSG_EQ (flows->IsSampled (Seconds (0), Create<Packet> (ppp, sizeof (ppp)),
+                                                   PcapHelper::DLT_PPP),
+                                 first, "Packets of a flow sampled differently");
+          NS_TEST_ASSERT_MSG_EQ (flows->IsSampled (Seconds (0), ppp, sizeof (ppp), PcapHelper::DLT_PPP),
+                                 first, "Bytes of a flow sampled differently");
+
+          uint8_t ethernet[14 + sizeof (ip)] = { 0 };
+          ethernet[12] = 0x08;
+          std::memcpy (ethernet + 14, ip, sizeof (ip));
+          NS_TEST_ASSERT_MSG_EQ (flows->IsSampled (Seconds (0), Create<Packet> (ethernet, sizeof (ethernet)),
+                                                   PcapHelper::DLT_EN10MB),
+                                 first, "Packets of a flow sampled differently over Ethernet");
+          EthernetHeader header;
+          header.SetLengthType (0x0800);
+          NS_TEST_ASSERT_MSG_EQ (flows->IsSampled (Seconds (0), header, Create<Packet> (ip, sizeof (ip)),
+                                                   PcapHelper::DLT_EN10MB),
+                                 first, "Packets of a flow sampled differently after a header");
+          uint8_t snap[8 + sizeof (ip)] = { 0xaa, 0xaa, 0x03, 0x00, 0x00, 0x00, 0x08, 0x00 };
+          std::memcpy (snap + 8, ip, sizeof (ip));
+          NS_TEST_ASSERT_MSG_EQ (flows->IsSampled (Seconds (0), header, Create<Packet> (snap, sizeof (snap)),
+                                                   PcapHelper::DLT_EN10MB),
+                                 first, "Packets of a flow sampled differently after a header and LLC/SNAP");
+
+          // A QoS data frame, with an LLC/SNAP header
+          uint8_t wifi[26 + 8 + sizeof (ip)] = { 0x88, 0x01 };
+          uint8_t llc[8] = { 0xaa, 0xaa, 0x03, 0x00, 0x00, 0x00, 0x08, 0x00 };
+          std::memcpy (wifi + 26, llc, sizeof (llc));
+          std::memcpy (wifi + 34, ip, sizeof (ip));
+          NS_TEST_ASSERT_MSG_EQ (flows->IsSampled (Seconds (0), Create<Packet> (wifi, sizeof (wifi)),
+                                                   PcapHelper::DLT_IEEE802_11),
+                                 first, "Packets of a flow sampled differently over IEEE 802.11");
+        }
+      flowsSampled += first;
+    }
+  NS_TEST_ASSERT_MSG_GT (flowsSampled, 4, "Too few flows sampled");
+  NS_TEST_ASSERT_MSG_LT (flowsSampled, 32, "Too many flows sampled");
+
+  // The same for IPv6, after a hop-by-hop options header
+  uint32_t flows6Sampled = 0;
+  for (uint8_t flow = 0; flow < 64; flow++)
+    {
+      uint8_t ip6[40 + 8 + 8] = { 0x60 };
+      ip6[6] = 0;              // hop-by-hop options
+      ip6[7] = 64;
+      ip6[8] = 0x20;
+      ip6[39] = flow;
+      ip6[40] = 17;
+      ip6[49] = 9;
+      uint8_t ppp[2 + sizeof (ip6)] = { 0x00, 0x57 };
+      std::memcpy (ppp + 2, ip6, sizeof (ip6));
+      uint8_t ethernet[14 + sizeof (ip6)] = { 0 };
+      ethernet[12] = 0x86;
+      ethernet[13] = 0xdd;
+      ip6[1] = flow;           // flow label
+      ip6[7] = 32;             // hop limit
+      std::memcpy (ethernet + 14, ip6, sizeof (ip6));
+      bool first = flows->IsSampled (Seconds (0), ppp, sizeof (ppp), PcapHelper::DLT_PPP);
+      NS_TEST_ASSERT_MSG_EQ (flows->IsSampled (Seconds (0), ethernet, sizeof (ethernet),
+                                               PcapHelper::DLT_EN10MB),
+                             first, "IPv6 packets of a flow sampled differently");
+      flows6Sampled += first;
+    }
+  NS_TEST_ASSERT_MSG_GT (flows6Sampled, 4, "Too few IPv6 flows sampled");
+  NS_TEST_ASSERT_MSG_LT (flows6Sampled, 32, "Too many IPv6 flows sampled");
+
+  // The packets without a flow are sampled by uid
+  uint8_t arp[2 + 28] = { 0x80, 0x21 };
+  uint32_t arpSampled = 0;
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (arp, sizeof (arp));
+      bool sampled = flows->IsSampled (Seconds (0), p);
+      NS_TEST_ASSERT_MSG_EQ (flows->IsSampled (Seconds (0), p->Copy ()), sampled,
+                             "A copy of a packet without a flow is sampled differently");
+      arpSampled += sampled;
+    }
+  NS_TEST_ASSERT_MSG_GT (arpSampled, 0, "The packets without a flow are all sampled alike");
+  NS_TEST_ASSERT_MSG_LT (arpSampled, 100, "The packets without a flow are all sampled alike");
+
+  NS_TEST_ASSERT_MSG_EQ (sampler->IsNodeTraced (7), true, "Nodes not all traced");
+  sampler->AddNode (3);
+  sampler->AddNode (5);
+  NS_TEST_ASSERT_MSG_EQ (sampler->IsNodeTraced (3), true, "Node added not traced");
+  NS_TEST_ASSERT_MSG_EQ (sampler->IsNodeTraced (5), true, "Node added not traced");
+  NS_TEST_ASSERT_MSG_EQ (sampler->IsNodeTraced (7), false, "Node not added traced");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the pcap files, the default ascii sinks and the sinks which
+ * check AsciiTraceHelper::IsSampled only write the packets their sampler
+ * selects.
+ */
+class TraceSamplerSinkTestCase : public TestCase
+{
+public:
+  TraceSamplerSinkTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TraceSamplerSinkTestCase::TraceSamplerSinkTestCase ()
+  : TestCase ("Check that the trace files write the packets sampled")
+{
+}
+
+void
+TraceSamplerSinkTestCase::DoRun (void)
+{
+  Ptr<TraceSampler> sampler = CreateObject<TraceSampler> ();
+  sampler->SetAttribute ("Ratio", UintegerValue (5));
+
+  std::string filename = CreateTempDirFilename ("sampled.pcap");
+  Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+  file->Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (file->Fail (), false, "Open (" << filename << ") returns error");
+  file->Init (1);
+  file->SetSampler (sampler);
+
+  std::ostringstream oss;
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (&oss);
+  stream->SetSampler (sampler);
+  std::ostringstream deviceOss;
+  Ptr<OutputStreamWrapper> deviceStream = Create<OutputStreamWrapper> (&deviceOss);
+  deviceStream->SetSampler (sampler);
+  std::ostringstream allOss;
+  Ptr<OutputStreamWrapper> allStream = Create<OutputStreamWrapper> (&allOss);
+
+  uint32_t deviceWritten = 0;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (100);
+      file->Write (Seconds (0), p);
+      AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (stream, p);
+      // The sink of a device helper.
+      if (AsciiTraceHelper::IsSampled (deviceStream, p, PcapHelper::DLT_EN10MB))
+        {
+          deviceWritten++;
+        }
+      NS_TEST_ASSERT_MSG_EQ (AsciiTraceHelper::IsSampled (allStream, p), true,
+                             "Packet not written to a stream without sampler");
+    }
+  file->Close ();
+  uint64_t sampled = sampler->GetNSampled ();
+  NS_TEST_ASSERT_MSG_EQ (sampled % 3, 0, "A packet sampled in some traces only");
+  NS_TEST_ASSERT_MSG_GT (sampled, 0, "No packet sampled");
+
+  PcapFile f;
+  f.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::in\") returns error");
+  uint8_t data[100];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  uint32_t records = 0;
+  while (true)
+    {
+      f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      if (f.Fail ())
+        {
+          break;
+        }
+      records++;
+    }
+  f.Close ();
+  NS_TEST_ASSERT_MSG_EQ (records, sampled / 3, "Wrong number of pcap records");
+
+  std::istringstream lines (oss.str ());
+  std::string line;
+  uint32_t written = 0;
+  while (std::getline (lines, line))
+    {
+      written++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (written, sampled / 3, "Wrong number of ascii lines");
+  NS_TEST_ASSERT_MSG_EQ (deviceWritten, sampled / 3, "Wrong number of device sink lines");
+
+  remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * TraceSampler TestSuite
+ */
+class TraceSamplerTestSuite : public TestSuite
+{
+public:
+  TraceSamplerTestSuite ();
+};
+
+TraceSamplerTestSuite::TraceSamplerTestSuite ()
+  : TestSuite ("trace-sampler", UNIT)
+{
+  AddTestCase (new TraceSamplerTestCase, TestCase::QUICK);
+  AddTestCase (new TraceSamplerSinkTestCase, TestCase::QUICK);
+}
+
+static TraceSamplerTestSuite g_traceSamplerTestSuite; //!< Static variable for test initialization
@@ -109,6 +109,42 @@ void ReadFrom (Buffer::Iterator &i, Mac16Address &ad)
   ad.CopyFrom (mac);
 }
 
+void WriteTo (Buffer::Span &span, Ipv4Address ad)
+{
+  NS_LOG_FUNCTION (&span << &ad);
+  span.WriteHtonU32 (ad.Get ());
+}
+void WriteTo (Buffer::Span &span, Ipv6Address ad)
+{
+  NS_LOG_FUNCTION (&span << &ad);
+  uint8_t buf[16];
+  ad.GetBytes (buf);
+  span.Write (buf, 16);
+}
+void WriteTo (Buffer::Span &span, Mac48Address ad)
+{
+  NS_LOG_FUNCTION (&span << &ad);
+  uint8_t mac[6];
+  ad.CopyTo (mac);
+  span.Write (mac, 6);
+}
+
+void ReadFrom (Buffer::Span &span, Ipv4Address &ad)
+{
+  NS_LOG_FUNCTION (&span << &ad);
+  ad.Set (span.ReadNtohU32 ());
+}
+void ReadFrom (Buffer::Span &span, Ipv6Address &ad)
+{
+  NS_LOG_FUNCTION (&span << &ad);
+  ad.Set (span.Next (16));
+}
+void ReadFrom (Buffer::Span &span, Mac48Address &ad)
+{
+  NS_LOG_FUNCTION (&span << &ad);
+  ad.CopyFrom (span.Next (6));
+}
+
 namespace addressUtils {
 
 bool IsMulticast (const Address &ad)
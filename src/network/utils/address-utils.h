@@ -116,6 +116,48 @@ void ReadFrom (Buffer::Iterator &i, Mac48Address &ad);
  */
 void ReadFrom (Buffer::Iterator &i, Mac16Address &ad);
 
+/**
+ * \brief Write an Ipv4Address to a Buffer::Span
+ * \param span a reference to the span to write to
+ * \param ad the Ipv4Address
+ */
+void WriteTo (Buffer::Span &span, Ipv4Address ad);
+
+/**
+ * \brief Write an Ipv6Address to a Buffer::Span
+ * \param span a reference to the span to write to
+ * \param ad the Ipv6Address
+ */
+void WriteTo (Buffer::Span &span, Ipv6Address ad);
+
+/**
+ * \brief Write a Mac48Address to a Buffer::Span
+ * \param span a reference to the span to write to
+ * \param ad the Mac48Address
+ */
+void WriteTo (Buffer::Span &span, Mac48Address ad);
+
+/**
+ * \brief Read an Ipv4Address from a Buffer::Span
+ * \param span a reference to the span to read from
+ * \param ad a reference to the Ipv4Address to be read
+ */
+void ReadFrom (Buffer::Span &span, Ipv4Address &ad);
+
+/**
+ * \brief Read an Ipv6Address from a Buffer::Span
+ * \param span a reference to the span to read from
+ * \param ad a reference to the Ipv6Address to be read
+ */
+void ReadFrom (Buffer::Span &span, Ipv6Address &ad);
+
+/**
+ * \brief Read a Mac48Address from a Buffer::Span
+ * \param span a reference to the span to read from
+ * \param ad a reference to the Mac48Address to be read
+ */
+void ReadFrom (Buffer::Span &span, Mac48Address &ad);
+
 namespace addressUtils {
 
 /**
@@ -16,6 +16,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include "ns3/log.h"
 #include "drop-tail-queue.h"
 
@@ -25,6 +26,8 @@ NS_LOG_COMPONENT_DEFINE ("DropTailQueue");
 
 NS_OBJECT_ENSURE_REGISTERED (DropTailQueue);
 
+const uint32_t DropTailQueue::MAX_RESERVED;
+
 TypeId DropTailQueue::GetTypeId (void)
 {
   static TypeId tid = TypeId ("ns3::DropTailQueue")
@@ -51,9 +54,13 @@ bool
 DropTailQueue::DoEnqueue (Ptr<QueueItem> item)
 {
   NS_LOG_FUNCTION (this << item);
-  NS_ASSERT (m_packets.size () == GetNPackets ());
+  NS_ASSERT (m_packets.GetSize () == GetNPackets ());
 
-  m_packets.push (item);
+  if (m_packets.GetCapacity () == 0 && GetMode () == QUEUE_MODE_PACKETS)
+    {
+      m_packets.Reserve (std::min (GetMaxPackets (), MAX_RESERVED));
+    }
+  m_packets.PushBack (item);
 
   return true;
 }
@@ -62,10 +69,10 @@ Ptr<QueueItem>
 DropTailQueue::DoDequeue (void)
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT (m_packets.size () == GetNPackets ());
+  NS_ASSERT (m_packets.GetSize () == GetNPackets ());
 
-  Ptr<QueueItem> item = m_packets.front ();
-  m_packets.pop ();
+  Ptr<QueueItem> item = m_packets.Front ();
+  m_packets.PopFront ();
 
   NS_LOG_LOGIC ("Popped " << item);
 
@@ -76,9 +83,9 @@ Ptr<const QueueItem>
 DropTailQueue::DoPeek (void) const
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT (m_packets.size () == GetNPackets ());
+  NS_ASSERT (m_packets.GetSize () == GetNPackets ());
 
-  return m_packets.front ();
+  return m_packets.Front ();
 }
 
 } // namespace ns3
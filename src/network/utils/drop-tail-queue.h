@@ -19,8 +19,8 @@
 #ifndef DROPTAIL_H
 #define DROPTAIL_H
 
-#include <queue>
 #include "ns3/queue.h"
+#include "ring-buffer.h"
 
 namespace ns3 {
 
@@ -28,6 +28,11 @@ namespace ns3 {
  * \ingroup queue
  *
  * \brief A FIFO packet queue that drops tail-end packets on overflow
+ *
+ * The items are stored in a RingBuffer, which makes room for
+ * MaxPackets items (at most MAX_RESERVED) on the first enqueue in the
+ * packets mode, so that a saturated queue enqueues and dequeues
+ * without allocating memory.
  */
 class DropTailQueue : public Queue
 {
@@ -46,12 +51,15 @@ public:
 
   virtual ~DropTailQueue();
 
+  /** The largest number of items the queue makes room for up front. */
+  static const uint32_t MAX_RESERVED = 4096;
+
 private:
   virtual bool DoEnqueue (Ptr<QueueItem> item);
   virtual Ptr<QueueItem> DoDequeue (void);
   virtual Ptr<const QueueItem> DoPeek (void) const;
 
-  std::queue<Ptr<QueueItem> > m_packets; //!< the items in the queue
+  RingBuffer<Ptr<QueueItem> > m_packets; //!< the items in the queue
 };
 
 } // namespace ns3
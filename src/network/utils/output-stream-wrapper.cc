@@ -17,6 +17,7 @@
  */
 
 #include "output-stream-wrapper.h"
+#include "trace-sampler.h"
 #include "ns3/log.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/abort.h"
@@ -61,4 +62,18 @@ OutputStreamWrapper::GetStream (void)
   return m_ostream;
 }
 
+void
+OutputStreamWrapper::SetSampler (Ptr<TraceSampler> sampler)
+{
+  NS_LOG_FUNCTION (this << sampler);
+  m_sampler = sampler;
+}
+
+Ptr<TraceSampler>
+OutputStreamWrapper::GetSampler (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sampler;
+}
+
 } // namespace ns3
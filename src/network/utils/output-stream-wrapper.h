@@ -26,6 +26,8 @@
 
 namespace ns3 {
 
+class TraceSampler;
+
 /**
  * @brief A class encapsulating an output stream.
  *
@@ -92,9 +94,22 @@ public:
    */
   std::ostream *GetStream (void);
 
+  /**
+   * Set the sampler selecting the packets that the default ascii trace
+   * sinks of AsciiTraceHelper write to this stream.
+   *
+   * \param sampler The sampler, or 0 to write all the packets.
+   */
+  void SetSampler (Ptr<TraceSampler> sampler);
+  /**
+   * \returns The sampler, or 0 if none.
+   */
+  Ptr<TraceSampler> GetSampler (void) const;
+
 private:
   std::ostream *m_ostream; //!< The output stream
   bool m_destroyable; //!< Can be destroyed
+  Ptr<TraceSampler> m_sampler; //!< Selects the packets written, if any
 };
 
 } // namespace ns3
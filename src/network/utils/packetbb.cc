@@ -26,6 +26,7 @@
 #include "ns3/ipv6-address.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/size-class-allocator.h"
 #include "packetbb.h"
 
 static const uint8_t VERSION = 0;
@@ -54,10 +55,50 @@ static const uint8_t THAS_VALUE = 0x10;
 static const uint8_t THAS_EXT_LEN = 0x08;
 static const uint8_t TIS_MULTIVALUE = 0x04;
 
+/* The longest address, an IPv6 one */
+static const uint8_t MAX_ADDRESS_LENGTH = 16;
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketBB");
 
+namespace {
+
+/* The messages, address blocks and TLVs are allocated from a pool, so
+ * that parsing and building packets reuses the memory of the previous
+ * ones.  The size classes go from a TLV to an IPv6 message.
+ */
+SizeClassPool g_pool = { "ns3::PacketBB", 32, 512, 1024 * 1024, 0 }; //!< The pool of the objects
+SizeClassPool::LocalStaticDestructor g_poolDestructor (&g_pool); //!< Destroy the allocator of the pool
+
+/**
+ * Allocate a PacketBB object.
+ * \param size the size of the object
+ * \returns the memory of the object
+ */
+void *
+PoolAllocate (size_t size)
+{
+  uint32_t capacity;
+  return g_pool.Allocate (size, capacity);
+}
+
+/**
+ * Free a PacketBB object.
+ * \param p the memory of the object
+ * \param size the size of the object
+ */
+void
+PoolDeallocate (void *p, size_t size)
+{
+  if (p != 0)
+    {
+      g_pool.Deallocate (p, g_pool.GetCapacity (size));
+    }
+}
+
+} // anonymous namespace
+
 NS_OBJECT_ENSURE_REGISTERED (PbbPacket);
 
 PbbTlvBlock::PbbTlvBlock (void)
@@ -1039,6 +1080,18 @@ PbbMessage::~PbbMessage ()
   AddressBlockClear ();
 }
 
+void *
+PbbMessage::operator new (size_t size)
+{
+  return PoolAllocate (size);
+}
+
+void
+PbbMessage::operator delete (void *p, size_t size)
+{
+  PoolDeallocate (p, size);
+}
+
 void
 PbbMessage::SetType (uint8_t type)
 {
@@ -1845,6 +1898,18 @@ PbbAddressBlock::~PbbAddressBlock ()
   NS_LOG_FUNCTION (this);
 }
 
+void *
+PbbAddressBlock::operator new (size_t size)
+{
+  return PoolAllocate (size);
+}
+
+void
+PbbAddressBlock::operator delete (void *p, size_t size)
+{
+  PoolDeallocate (p, size);
+}
+
 /* Manipulating the address block */
 
 PbbAddressBlock::AddressIterator
@@ -2194,19 +2259,19 @@ PbbAddressBlock::GetSerializedSize (void) const
   NS_LOG_FUNCTION (this);
   /* num-addr + flags */
   uint32_t size = 2;
+  uint8_t len = GetAddressLength ();
 
   if (AddressSize () == 1)
     {
-      size += GetAddressLength () + PrefixSize ();
+      size += len + PrefixSize ();
     }
   else if (AddressSize () > 0)
     {
-      uint8_t* head = new uint8_t[GetAddressLength ()];
+      uint8_t first[MAX_ADDRESS_LENGTH];
       uint8_t headlen = 0;
-      uint8_t* tail = new uint8_t[GetAddressLength ()];
       uint8_t taillen = 0;
 
-      GetHeadTail (head, headlen, tail, taillen);
+      GetHeadTail (first, headlen, taillen);
 
       if (headlen > 0)
         {
@@ -2216,19 +2281,16 @@ PbbAddressBlock::GetSerializedSize (void) const
       if (taillen > 0)
         {
           size++;
-          if (!HasZeroTail (tail, taillen))
+          if (!HasZeroTail (first + len - taillen, taillen))
             {
               size += taillen;
             }
         }
 
       /* mid size */
-      size += (GetAddressLength () - headlen - taillen) * AddressSize ();
+      size += (len - headlen - taillen) * AddressSize ();
 
       size += PrefixSize ();
-
-      delete[] head;
-      delete[] tail;
     }
 
   size += m_addressTlvList.GetSerializedSize ();
@@ -2240,82 +2302,92 @@ void
 PbbAddressBlock::Serialize (Buffer::Iterator &start) const
 {
   NS_LOG_FUNCTION (this << &start);
-  start.WriteU8 (AddressSize ());
-  Buffer::Iterator bufref = start;
-  uint8_t flags = 0;
-  start.Next ();
+  uint8_t len = GetAddressLength ();
+  uint8_t first[MAX_ADDRESS_LENGTH];
+  uint8_t headlen = 0;
+  uint8_t taillen = 0;
+  bool zeroTail = false;
+
+  /* The addresses and their prefixes are written at once, so compute
+   * their size first. */
+  uint32_t size = 2;
+  if (AddressSize () == 1)
+    {
+      size += len + (PrefixSize () == 1 ? 1 : 0);
+    }
+  else if (AddressSize () > 0)
+    {
+      GetHeadTail (first, headlen, taillen);
+      zeroTail = taillen > 0 && HasZeroTail (first + len - taillen, taillen);
+      if (headlen > 0)
+        {
+          size += 1 + headlen;
+        }
+      if (taillen > 0)
+        {
+          size += zeroTail ? 1 : 1 + taillen;
+        }
+      size += (len - headlen - taillen) * AddressSize () + PrefixSize ();
+    }
+
+  Buffer::Span span (start, size);
+  span.WriteU8 (AddressSize ());
+  uint8_t *flags = span.Next (1);
+  *flags = 0;
 
   if (AddressSize () == 1)
     {
-      uint8_t* buf = new uint8_t[GetAddressLength ()];
-      SerializeAddress (buf, AddressBegin ());
-      start.Write (buf, GetAddressLength ());
+      SerializeAddress (span.Next (len), AddressBegin ());
 
       if (PrefixSize () == 1)
         {
-          start.WriteU8 (PrefixFront ());
-          flags |= AHAS_SINGLE_PRE_LEN;
+          span.WriteU8 (PrefixFront ());
+          *flags |= AHAS_SINGLE_PRE_LEN;
         }
-      bufref.WriteU8 (flags);
-      delete[] buf;
     }
   else if (AddressSize () > 0)
     {
-      uint8_t* head = new uint8_t[GetAddressLength ()];
-      uint8_t* tail = new uint8_t[GetAddressLength ()];
-      uint8_t headlen = 0;
-      uint8_t taillen = 0;
-
-      GetHeadTail (head, headlen, tail, taillen);
-
       if (headlen > 0)
         {
-          flags |= AHAS_HEAD;
-          start.WriteU8 (headlen);
-          start.Write (head, headlen);
+          *flags |= AHAS_HEAD;
+          span.WriteU8 (headlen);
+          span.Write (first, headlen);
         }
 
       if (taillen > 0)
         {
-          start.WriteU8 (taillen);
+          span.WriteU8 (taillen);
 
-          if (HasZeroTail (tail, taillen))
+          if (zeroTail)
             {
-              flags |= AHAS_ZERO_TAIL;
+              *flags |= AHAS_ZERO_TAIL;
             }
           else
             {
-              flags |= AHAS_FULL_TAIL;
-              start.Write (tail, taillen);
+              *flags |= AHAS_FULL_TAIL;
+              span.Write (first + len - taillen, taillen);
             }
         }
 
-      if (headlen + taillen < GetAddressLength ())
+      uint8_t mid[MAX_ADDRESS_LENGTH];
+      for (PbbAddressBlock::ConstAddressIterator iter = AddressBegin ();
+           iter != AddressEnd ();
+           iter++)
         {
-          uint8_t* mid = new uint8_t[GetAddressLength ()];
-          for (PbbAddressBlock::ConstAddressIterator iter = AddressBegin ();
-               iter != AddressEnd ();
-               iter++)
-            {
-              SerializeAddress (mid, iter);
-              start.Write (mid + headlen, GetAddressLength () - headlen - taillen);
-            }
-          delete[] mid;
+          SerializeAddress (mid, iter);
+          span.Write (mid + headlen, len - headlen - taillen);
         }
 
-      flags |= GetPrefixFlags ();
-      bufref.WriteU8 (flags);
+      *flags |= GetPrefixFlags ();
 
       for (ConstPrefixIterator iter = PrefixBegin ();
            iter != PrefixEnd ();
            iter++)
         {
-          start.WriteU8 (*iter);
+          span.WriteU8 (*iter);
         }
-
-      delete[] head;
-      delete[] tail;
     }
+  span.Commit ();
 
   m_addressTlvList.Serialize (start);
 }
@@ -2329,32 +2401,54 @@ PbbAddressBlock::Deserialize (Buffer::Iterator &start)
 
   if (numaddr > 0)
     {
+      uint8_t len = GetAddressLength ();
       uint8_t headlen = 0;
       uint8_t taillen = 0;
-      uint8_t* addrtmp = new uint8_t[GetAddressLength ()];
-      memset (addrtmp, 0, GetAddressLength ());
+      uint8_t addrtmp[MAX_ADDRESS_LENGTH];
+      memset (addrtmp, 0, len);
 
       if (flags & AHAS_HEAD)
         {
           headlen = start.ReadU8 ();
-          start.Read (addrtmp, headlen);
+          if (headlen <= len)
+            {
+              start.Read (addrtmp, headlen);
+            }
         }
 
       if ((flags & AHAS_FULL_TAIL) ^ (flags & AHAS_ZERO_TAIL))
         {
           taillen = start.ReadU8 ();
 
-          if (flags & AHAS_FULL_TAIL)
+          if ((flags & AHAS_FULL_TAIL) && headlen + taillen <= len)
+            {
+              start.Read (addrtmp + len - taillen, taillen);
+            }
+        }
+
+      if (headlen + taillen > len)
+        {
+          /* The head and the tail do not fit in an address: the rest of
+           * the packet cannot be parsed. */
+          NS_LOG_WARN ("Address block with a head of " << static_cast<uint32_t> (headlen)
+                       << " bytes and a tail of " << static_cast<uint32_t> (taillen)
+                       << " bytes for addresses of " << static_cast<uint32_t> (len) << " bytes");
+          while (!start.IsEnd ())
             {
-              start.Read (addrtmp + GetAddressLength () - taillen, taillen);
+              start.Next ();
             }
+          return;
         }
 
+      /* The mid parts of all the addresses are read in place */
+      uint8_t midlen = len - headlen - taillen;
+      Buffer::Span mids (start, numaddr * midlen);
       for (int i = 0; i < numaddr; i++)
         {
-          start.Read (addrtmp + headlen, GetAddressLength () - headlen - taillen);
+          mids.Read (addrtmp + headlen, midlen);
           AddressPushBack (DeserializeAddress (addrtmp));
         }
+      mids.Commit ();
 
       if (flags & AHAS_SINGLE_PRE_LEN)
         {
@@ -2367,8 +2461,6 @@ PbbAddressBlock::Deserialize (Buffer::Iterator &start)
               PrefixPushBack (start.ReadU8 ());
             }
         }
-
-      delete[] addrtmp;
     }
 
   m_addressTlvList.Deserialize (start);
@@ -2484,68 +2576,42 @@ PbbAddressBlock::GetPrefixFlags (void) const
 }
 
 void
-PbbAddressBlock::GetHeadTail (uint8_t *head, uint8_t &headlen,
-                              uint8_t *tail, uint8_t &taillen) const
+PbbAddressBlock::GetHeadTail (uint8_t *first, uint8_t &headlen, uint8_t &taillen) const
 {
-  NS_LOG_FUNCTION (this << &head << static_cast<uint32_t> (headlen)
-                   << &tail << static_cast<uint32_t> (taillen));
-  headlen = GetAddressLength ();
-  taillen = headlen;
-
-  /* Temporary automatic buffers to store serialized addresses */
-  uint8_t * buflast = new uint8_t[GetAddressLength ()];
-  uint8_t * bufcur = new uint8_t[GetAddressLength ()];
-  uint8_t * tmp;
-
-  SerializeAddress (buflast, AddressBegin ());
+  NS_LOG_FUNCTION (this << &first << static_cast<uint32_t> (headlen)
+                   << static_cast<uint32_t> (taillen));
+  uint8_t len = GetAddressLength ();
+  uint8_t cur[MAX_ADDRESS_LENGTH];
 
-  /* Skip the first item */
-  for (PbbAddressBlock::ConstAddressIterator iter = AddressBegin ()++;
-       iter != AddressEnd ();
-       iter++)
+  /* Compare each address with the first one, keeping at least one byte
+   * in the mid part. */
+  ConstAddressIterator iter = AddressBegin ();
+  SerializeAddress (first, iter);
+  headlen = len - 1;
+  taillen = len - 1;
+  for (iter++; iter != AddressEnd (); iter++)
     {
-      SerializeAddress (bufcur, iter);
+      SerializeAddress (cur, iter);
 
-      int i;
-      for (i = 0; i < headlen; i++)
+      uint8_t i = 0;
+      while (i < headlen && first[i] == cur[i])
         {
-          if (buflast[i] != bufcur[i])
-            {
-              headlen = i;
-              break;
-            }
+          i++;
         }
+      headlen = i;
 
-      /* If headlen == fulllen - 1, then tail is 0 */
-      if (GetAddressLength () - headlen > 0)
+      i = 0;
+      while (i < taillen && first[len - 1 - i] == cur[len - 1 - i])
         {
-          for (i = GetAddressLength () - 1;
-               GetAddressLength () - 1 - i <= taillen && i > headlen;
-               i--)
-            {
-              if (buflast[i] != bufcur[i])
-                {
-                  break;
-                }
-            }
-          taillen = GetAddressLength () - 1 - i;
-        }
-      else if (headlen == 0)
-        {
-          taillen = 0;
-          break;
+          i++;
         }
-
-      tmp = buflast;
-      buflast = bufcur;
-      bufcur = tmp;
+      taillen = i;
     }
 
-  memcpy (head, bufcur, headlen);
-  memcpy (tail, bufcur + (GetAddressLength () - taillen), taillen);
-
-  delete[] buflast;
-  delete[] bufcur;
+  if (headlen + taillen >= len)
+    {
+      taillen = len - 1 - headlen;
+    }
 }
 
 bool
@@ -2658,7 +2724,18 @@ PbbTlv::PbbTlv (void)
 PbbTlv::~PbbTlv (void)
 {
   NS_LOG_FUNCTION (this);
-  m_value.RemoveAtEnd (m_value.GetSize ());
+}
+
+void *
+PbbTlv::operator new (size_t size)
+{
+  return PoolAllocate (size);
+}
+
+void
+PbbTlv::operator delete (void *p, size_t size)
+{
+  PoolDeallocate (p, size);
 }
 
 void
@@ -2832,100 +2909,141 @@ void
 PbbTlv::Serialize (Buffer::Iterator &start) const
 {
   NS_LOG_FUNCTION (this << &start);
-  start.WriteU8 (GetType ());
+  /* type + flags, then the optional fields, written at once */
+  uint32_t size = 0;
+  uint32_t fieldsSize = 2;
+  if (HasTypeExt ())
+    {
+      fieldsSize++;
+    }
+  if (HasIndexStart ())
+    {
+      fieldsSize += HasIndexStop () ? 2 : 1;
+    }
+  if (HasValue ())
+    {
+      size = m_value.GetSize ();
+      fieldsSize += size > 255 ? 2 : 1;
+    }
 
-  Buffer::Iterator bufref = start;
-  uint8_t flags = 0;
-  start.Next ();
+  Buffer::Span span (start, fieldsSize);
+  span.WriteU8 (GetType ());
+
+  uint8_t *flags = span.Next (1);
+  *flags = 0;
 
   if (HasTypeExt ())
     {
-      flags |= THAS_TYPE_EXT;
-      start.WriteU8 (GetTypeExt ());
+      *flags |= THAS_TYPE_EXT;
+      span.WriteU8 (GetTypeExt ());
     }
 
   if (HasIndexStart ())
     {
-      start.WriteU8 (GetIndexStart ());
+      span.WriteU8 (GetIndexStart ());
 
       if (HasIndexStop ())
         {
-          flags |= THAS_MULTI_INDEX;
-          start.WriteU8 (GetIndexStop ());
+          *flags |= THAS_MULTI_INDEX;
+          span.WriteU8 (GetIndexStop ());
         } 
       else
         {
-          flags |= THAS_SINGLE_INDEX;
+          *flags |= THAS_SINGLE_INDEX;
         }
     }
 
   if (HasValue ()) 
     {
-      flags |= THAS_VALUE;
+      *flags |= THAS_VALUE;
 
-      uint32_t size = GetValue ().GetSize ();
       if (size > 255)
         {
-          flags |= THAS_EXT_LEN;
-          start.WriteHtonU16 (size);
+          *flags |= THAS_EXT_LEN;
+          span.WriteHtonU16 (size);
         }
       else
         {
-          start.WriteU8 (size);
+          span.WriteU8 (size);
         }
 
       if (IsMultivalue ())
         {
-          flags |= TIS_MULTIVALUE;
+          *flags |= TIS_MULTIVALUE;
         }
-
-      start.Write (GetValue ().Begin (), GetValue ().End ());
     }
+  span.Commit ();
 
-  bufref.WriteU8 (flags);
+  if (HasValue ())
+    {
+      start.Write (m_value.Begin (), m_value.End ());
+    }
 }
 
 void
 PbbTlv::Deserialize (Buffer::Iterator &start)
 {
   NS_LOG_FUNCTION (this << &start);
-  SetType (start.ReadU8 ());
+  Buffer::Span header (start, 2);
+  SetType (header.ReadU8 ());
 
-  uint8_t flags = start.ReadU8 ();
+  uint8_t flags = header.ReadU8 ();
+  header.Commit ();
 
+  /* the optional fields, read at once */
+  uint32_t fieldsSize = 0;
   if (flags & THAS_TYPE_EXT)
     {
-      SetTypeExt (start.ReadU8 ());
+      fieldsSize++;
+    }
+  if (flags & THAS_MULTI_INDEX)
+    {
+      fieldsSize += 2;
+    }
+  else if (flags & THAS_SINGLE_INDEX)
+    {
+      fieldsSize++;
+    }
+  if (flags & THAS_VALUE)
+    {
+      fieldsSize += (flags & THAS_EXT_LEN) ? 2 : 1;
+    }
+
+  Buffer::Span span (start, fieldsSize);
+  if (flags & THAS_TYPE_EXT)
+    {
+      SetTypeExt (span.ReadU8 ());
     }
 
   if (flags & THAS_MULTI_INDEX)
     {
-      SetIndexStart (start.ReadU8 ());
-      SetIndexStop (start.ReadU8 ());
+      SetIndexStart (span.ReadU8 ());
+      SetIndexStop (span.ReadU8 ());
     }
   else if (flags & THAS_SINGLE_INDEX)
     {
-      SetIndexStart (start.ReadU8 ());
+      SetIndexStart (span.ReadU8 ());
     }
 
+  uint16_t len = 0;
   if (flags & THAS_VALUE)
     {
-      uint16_t len = 0;
-
       if (flags & THAS_EXT_LEN)
         {
-          len = start.ReadNtohU16 ();
+          len = span.ReadNtohU16 ();
         }
       else
         {
-          len = start.ReadU8 ();
+          len = span.ReadU8 ();
         }
+    }
+  span.Commit ();
 
-      m_value.AddAtStart (len);
-
-      Buffer::Iterator valueStart = start;
+  if (flags & THAS_VALUE)
+    {
+      /* a view of the value in the packet, not a copy */
+      m_value = start.CreateFragment (len);
       start.Next (len);
-      m_value.Begin ().Write (valueStart, start);
       m_hasValue = true;
     }
 }
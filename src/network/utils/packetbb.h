@@ -707,6 +707,19 @@ public:
   PbbMessage ();
   virtual ~PbbMessage ();
 
+  /**
+   * \brief Allocate a message from the pool of PacketBB objects.
+   * \param size the size of the object
+   * \returns the memory of the object
+   */
+  static void * operator new (size_t size);
+  /**
+   * \brief Return a message to the pool of PacketBB objects.
+   * \param p the memory of the object
+   * \param size the size of the object
+   */
+  static void operator delete (void *p, size_t size);
+
   /**
    * \brief Sets the type for this message.
    * \param type the type to set.
@@ -1202,6 +1215,19 @@ public:
   PbbAddressBlock ();
   virtual ~PbbAddressBlock ();
 
+  /**
+   * \brief Allocate an address block from the pool of PacketBB objects.
+   * \param size the size of the object
+   * \returns the memory of the object
+   */
+  static void * operator new (size_t size);
+  /**
+   * \brief Return an address block to the pool of PacketBB objects.
+   * \param p the memory of the object
+   * \param size the size of the object
+   */
+  static void operator delete (void *p, size_t size);
+
   /* Manipulating the address block */
 
   /**
@@ -1587,14 +1613,16 @@ private:
    */
   uint8_t GetPrefixFlags (void) const;
   /**
-   * \brief Get head and tail
-   * \param head the head
+   * \brief Get the head and the tail shared by all the addresses
+   *
+   * The mid part of the addresses keeps at least one byte.
+   *
+   * \param first the first address, serialized, from which the head and
+   *        the tail are copied
    * \param headlen the head length
-   * \param tail the tail
    * \param taillen the tail length
    */
-  void GetHeadTail (uint8_t *head, uint8_t &headlen,
-                    uint8_t *tail, uint8_t &taillen) const;
+  void GetHeadTail (uint8_t *first, uint8_t &headlen, uint8_t &taillen) const;
 
   /**
    * \brief Check if the tail is empty
@@ -1662,6 +1690,19 @@ public:
   PbbTlv (void);
   virtual ~PbbTlv (void);
 
+  /**
+   * \brief Allocate a TLV from the pool of PacketBB objects.
+   * \param size the size of the object
+   * \returns the memory of the object
+   */
+  static void * operator new (size_t size);
+  /**
+   * \brief Return a TLV to the pool of PacketBB objects.
+   * \param p the memory of the object
+   * \param size the size of the object
+   */
+  static void operator delete (void *p, size_t size);
+
   /**
    * \brief Sets the type of this TLV.
    * \param type the type value to set.
@@ -1723,6 +1764,9 @@ public:
    *
    * Calling this while HasValue is False is undefined.  Make sure you check it
    * first.  This will be checked by an assert in debug builds.
+   *
+   * The value of a deserialized TLV shares the bytes of the buffer it was
+   * read from, which it keeps alive: do not change the contents of either.
    */
   Buffer GetValue (void) const;
 
@@ -1754,7 +1798,7 @@ public:
    * \param start a reference to the point in a buffer to begin deserializing.
    *
    * Users should not need to call this.  TLVs will be deserialized by their
-   * containing blocks.
+   * containing blocks.  The value is not copied, see GetValue.
    */
   void Deserialize (Buffer::Iterator &start);
 
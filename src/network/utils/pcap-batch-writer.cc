@@ -0,0 +1,352 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <sstream>
+
+#include "pcap-batch-writer.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+#endif
+
+/**
+ * \file
+ * \ingroup network
+ * ns3::PcapBatchWriter implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapBatchWriter");
+
+// Note:  The background thread does not log: the log prefixes read
+// the simulation time and context, which belong to the simulation
+// thread.
+
+#ifdef HAVE_PTHREAD_H
+namespace {
+
+/** Serializes the start and the stop of the background thread. */
+pthread_mutex_t g_threadMutex = PTHREAD_MUTEX_INITIALIZER;
+/**
+ * Protects the batches and the failure of the asynchronous writers,
+ * and the variables below.
+ */
+pthread_mutex_t g_mutex = PTHREAD_MUTEX_INITIALIZER;
+/** Wakes up the background thread. */
+pthread_cond_t g_dataCond = PTHREAD_COND_INITIALIZER;
+/** Signals a written batch. */
+pthread_cond_t g_doneCond = PTHREAD_COND_INITIALIZER;
+/** The writer of each batch waiting to be written, in order. */
+std::deque<PcapBatchWriter *> *g_queue = 0;
+/** The number of open asynchronous writers. */
+uint32_t g_writers = 0;
+/** Stop the background thread once the queue is empty. */
+bool g_stop = false;
+/** The background thread. */
+pthread_t g_thread;
+
+} // anonymous namespace
+#endif /* HAVE_PTHREAD_H */
+
+PcapBatchWriter::PcapBatchWriter (std::string filename, uint32_t batchSize,
+                                  uint32_t compressionLevel, bool asynchronous)
+  : m_filename (filename),
+    m_batchSize (std::max (batchSize, 1U)),
+    m_file (0),
+    m_gzFile (0),
+    m_asynchronous (asynchronous),
+    m_fail (false),
+    m_current (0)
+{
+  NS_LOG_FUNCTION (this << filename << batchSize << compressionLevel << asynchronous);
+  if (compressionLevel > 0)
+    {
+#ifdef HAVE_ZLIB_H
+      std::ostringstream mode;
+      mode << "wb" << std::min (compressionLevel, 9U);
+      m_gzFile = gzopen (filename.c_str (), mode.str ().c_str ());
+      m_fail = (m_gzFile == 0);
+#else
+      NS_FATAL_ERROR ("Can not compress " << filename << ": ns-3 was built without zlib");
+#endif
+    }
+  else
+    {
+      m_file = std::fopen (filename.c_str (), "wb");
+      m_fail = (m_file == 0);
+    }
+  m_current = GetBatch (m_batchSize);
+
+#ifdef HAVE_PTHREAD_H
+  if (m_asynchronous)
+    {
+      pthread_mutex_lock (&g_threadMutex);
+      if (g_writers++ == 0)
+        {
+          g_queue = new std::deque<PcapBatchWriter *> ();
+          g_stop = false;
+          if (pthread_create (&g_thread, 0, &PcapBatchWriter::Run, 0) != 0)
+            {
+              NS_FATAL_ERROR ("Could not start the pcap writer thread");
+            }
+        }
+      pthread_mutex_unlock (&g_threadMutex);
+    }
+#else
+  m_asynchronous = false;
+#endif
+}
+
+PcapBatchWriter::~PcapBatchWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+PcapBatchWriter::IsCompressionSupported (void)
+{
+#ifdef HAVE_ZLIB_H
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool
+PcapBatchWriter::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_asynchronous)
+    {
+      pthread_mutex_lock (&g_mutex);
+      bool fail = m_fail;
+      pthread_mutex_unlock (&g_mutex);
+      return fail;
+    }
+#endif
+  return m_fail;
+}
+
+struct PcapBatchWriter::Batch *
+PcapBatchWriter::GetBatch (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  struct Batch *batch;
+  if (m_free.empty ())
+    {
+      batch = new Batch ();
+      batch->data.resize (std::max (size, m_batchSize));
+    }
+  else
+    {
+      batch = m_free.back ();
+      m_free.pop_back ();
+      if (batch->data.size () < size)
+        {
+          batch->data.resize (size);
+        }
+    }
+  batch->size = 0;
+  return batch;
+}
+
+void
+PcapBatchWriter::Submit (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  if (!m_asynchronous)
+    {
+      if (!Output (m_current))
+        {
+          m_fail = true;
+        }
+      m_current->size = 0;
+      if (m_current->data.size () < size)
+        {
+          m_current->data.resize (size);
+        }
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&g_mutex);
+  if (m_current->size == 0)
+    {
+      m_current->data.resize (std::max<std::size_t> (size, m_current->data.size ()));
+      pthread_mutex_unlock (&g_mutex);
+      return;
+    }
+  while (m_pending.size () >= MAX_PENDING)
+    {
+      pthread_cond_wait (&g_doneCond, &g_mutex);
+    }
+  m_pending.push_back (m_current);
+  g_queue->push_back (this);
+  pthread_cond_signal (&g_dataCond);
+  m_current = GetBatch (size);
+  pthread_mutex_unlock (&g_mutex);
+#endif
+}
+
+void
+PcapBatchWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_current == 0)
+    {
+      return;
+    }
+  if (m_current->size > 0)
+    {
+      Submit (0);
+    }
+#ifdef HAVE_PTHREAD_H
+  if (m_asynchronous)
+    {
+      pthread_mutex_lock (&g_mutex);
+      while (!m_pending.empty ())
+        {
+          pthread_cond_wait (&g_doneCond, &g_mutex);
+        }
+      pthread_mutex_unlock (&g_mutex);
+    }
+#endif
+  if (m_file != 0)
+    {
+      std::fflush (m_file);
+    }
+}
+
+void
+PcapBatchWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_current == 0)
+    {
+      return;
+    }
+  Flush ();
+
+#ifdef HAVE_PTHREAD_H
+  if (m_asynchronous)
+    {
+      pthread_mutex_lock (&g_threadMutex);
+      if (--g_writers == 0)
+        {
+          pthread_mutex_lock (&g_mutex);
+          g_stop = true;
+          pthread_cond_signal (&g_dataCond);
+          pthread_mutex_unlock (&g_mutex);
+          pthread_join (g_thread, 0);
+          delete g_queue;
+          g_queue = 0;
+        }
+      pthread_mutex_unlock (&g_threadMutex);
+    }
+#endif
+
+  if (m_file != 0)
+    {
+      if (std::fclose (m_file) != 0)
+        {
+          m_fail = true;
+        }
+      m_file = 0;
+    }
+#ifdef HAVE_ZLIB_H
+  if (m_gzFile != 0)
+    {
+      if (gzclose (static_cast<gzFile> (m_gzFile)) != Z_OK)
+        {
+          m_fail = true;
+        }
+      m_gzFile = 0;
+    }
+#endif
+  delete m_current;
+  m_current = 0;
+  for (std::vector<struct Batch *>::iterator i = m_free.begin (); i != m_free.end (); ++i)
+    {
+      delete *i;
+    }
+  m_free.clear ();
+}
+
+bool
+PcapBatchWriter::Output (const struct Batch *batch)
+{
+  if (batch->size == 0)
+    {
+      return true;
+    }
+#ifdef HAVE_ZLIB_H
+  if (m_gzFile != 0)
+    {
+      return gzwrite (static_cast<gzFile> (m_gzFile), &batch->data[0], batch->size)
+             == static_cast<int> (batch->size);
+    }
+#endif
+  if (m_file != 0)
+    {
+      return std::fwrite (&batch->data[0], 1, batch->size, m_file) == batch->size;
+    }
+  return false;
+}
+
+void *
+PcapBatchWriter::Run (void *arg)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&g_mutex);
+  while (true)
+    {
+      while (g_queue->empty () && !g_stop)
+        {
+          pthread_cond_wait (&g_dataCond, &g_mutex);
+        }
+      if (g_queue->empty ())
+        {
+          break;
+        }
+      PcapBatchWriter *writer = g_queue->front ();
+      g_queue->pop_front ();
+      struct Batch *batch = writer->m_pending.front ();
+      pthread_mutex_unlock (&g_mutex);
+
+      bool written = writer->Output (batch);
+
+      pthread_mutex_lock (&g_mutex);
+      writer->m_fail = writer->m_fail || !written;
+      writer->m_pending.pop_front ();
+      batch->size = 0;
+      writer->m_free.push_back (batch);
+      pthread_cond_broadcast (&g_doneCond);
+    }
+  pthread_mutex_unlock (&g_mutex);
+#endif
+  return 0;
+}
+
+} // namespace ns3
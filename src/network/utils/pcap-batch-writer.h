@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_BATCH_WRITER_H
+#define PCAP_BATCH_WRITER_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup network
+ * ns3::PcapBatchWriter declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ * \brief Write a file in large batches, optionally gzip compressed
+ * and from a background thread.
+ *
+ * The bytes are appended to a batch in memory, which is written to
+ * the file with a single call once full.  The batches of an
+ * asynchronous writer are written by a background thread shared by
+ * all the asynchronous writers, so that the calling thread only
+ * copies the bytes; it waits for the background thread only when
+ * MAX_PENDING batches are already waiting to be written.
+ *
+ * With a non zero compression level the file is written in the gzip
+ * format, which Wireshark and tcpdump read as is.  The compression
+ * needs zlib, see IsCompressionSupported().
+ */
+class PcapBatchWriter
+{
+public:
+  /** The largest number of batches of a writer waiting to be written. */
+  static const uint32_t MAX_PENDING = 2;
+
+  /**
+   * Create the file, truncating any existing one.
+   *
+   * \param [in] filename The name of the file.
+   * \param [in] batchSize The size of the batches, in bytes.
+   * \param [in] compressionLevel The gzip compression level from 1 to 9,
+   *             or 0 to write the bytes uncompressed.
+   * \param [in] asynchronous Whether to write the batches from the
+   *             background thread.
+   */
+  PcapBatchWriter (std::string filename, uint32_t batchSize,
+                   uint32_t compressionLevel, bool asynchronous);
+  /** Destructor, closing the file. */
+  ~PcapBatchWriter ();
+
+  /**
+   * Check if the file could not be created, or if a write failed.
+   * \returns \c true on failure.
+   */
+  bool Fail (void) const;
+  /**
+   * Reserve the next bytes of the file.
+   *
+   * \param [in] size The number of bytes.
+   * \returns The bytes to fill, valid until the next call.
+   */
+  uint8_t * Reserve (uint32_t size);
+  /**
+   * Append bytes to the file.
+   *
+   * \param [in] data The bytes.
+   * \param [in] size The number of bytes.
+   */
+  void Write (uint8_t const *data, uint32_t size);
+  /** Write all the bytes appended so far, and wait for the file. */
+  void Flush (void);
+  /** Write all the bytes appended so far and close the file. */
+  void Close (void);
+
+  /**
+   * Check if ns-3 was built with zlib, which the compression needs.
+   * \returns \c true if the compression is supported.
+   */
+  static bool IsCompressionSupported (void);
+
+private:
+  /** A batch of bytes. */
+  struct Batch
+  {
+    std::vector<uint8_t> data;   //!< The bytes, with room for more.
+    uint32_t size;               //!< The number of bytes used.
+  };
+
+  /**
+   * Copy constructor, not implemented.
+   * \param [in] o The writer to copy.
+   */
+  PcapBatchWriter (const PcapBatchWriter &o);
+  /**
+   * Assignment, not implemented.
+   * \param [in] o The writer to copy.
+   * \returns This writer.
+   */
+  PcapBatchWriter & operator = (const PcapBatchWriter &o);
+
+  /**
+   * Hand the current batch over to be written, and start a new one.
+   * \param [in] size The number of bytes the new batch must hold.
+   */
+  void Submit (uint32_t size);
+  /**
+   * Get an empty batch.
+   * \param [in] size The number of bytes the batch must hold.
+   * \returns The batch.
+   */
+  struct Batch * GetBatch (uint32_t size);
+  /**
+   * Write a batch to the file.
+   * \param [in] batch The batch.
+   * \returns \c false if the write failed.
+   */
+  bool Output (const struct Batch *batch);
+  /**
+   * Background thread entry point.
+   * \param [in] arg Unused.
+   * \returns 0.
+   */
+  static void * Run (void *arg);
+
+  /** The name of the file. */
+  std::string m_filename;
+  /** The size of the batches. */
+  uint32_t m_batchSize;
+  /** The uncompressed file, if not compressed. */
+  std::FILE *m_file;
+  /** The gzip file, if compressed. */
+  void *m_gzFile;
+  /** Whether the background thread writes the batches. */
+  bool m_asynchronous;
+  /** Whether the file could not be created or written. */
+  bool m_fail;
+  /** The batch being filled. */
+  struct Batch *m_current;
+  /** The batches waiting to be written, the first one being written. */
+  std::deque<struct Batch *> m_pending;
+  /** The empty batches. */
+  std::vector<struct Batch *> m_free;
+};
+
+} // namespace ns3
+
+
+/****************************************************
+ *  Inline implementations
+ ***************************************************/
+
+namespace ns3 {
+
+inline uint8_t *
+PcapBatchWriter::Reserve (uint32_t size)
+{
+  if (m_current->size + size > m_current->data.size ())
+    {
+      Submit (size);
+    }
+  uint8_t *bytes = &m_current->data[0] + m_current->size;
+  m_current->size += size;
+  return bytes;
+}
+
+inline void
+PcapBatchWriter::Write (uint8_t const *data, uint32_t size)
+{
+  std::memcpy (Reserve (size), data, size);
+}
+
+} // namespace ns3
+
+#endif /* PCAP_BATCH_WRITER_H */
@@ -19,6 +19,7 @@
 #include "ns3/log.h"
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
+#include "ns3/nstime.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
 #include "pcap-file-wrapper.h"
@@ -46,6 +47,44 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("Asynchronous",
+                   "Whether the records are written in batches by a background thread.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_asynchronous),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BatchSize",
+                   "The size in bytes of the batches of records written at once, "
+                   "when Asynchronous or compressed.",
+                   UintegerValue (64 * 1024),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_batchSize),
+                   MakeUintegerChecker<uint32_t> (4096))
+    .AddAttribute ("CompressionLevel",
+                   "The gzip compression level of the file from 1 (fastest) to 9 (smallest), "
+                   "or 0 to write an uncompressed pcap file.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_compressionLevel),
+                   MakeUintegerChecker<uint32_t> (0, 9))
+    .AddAttribute ("MinSize",
+                   "The size of the smallest packets written.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_minSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxSize",
+                   "The size of the largest packets written.",
+                   UintegerValue (std::numeric_limits<uint32_t>::max ()),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_maxSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("StartTime",
+                   "The packets timestamped before this time are not written.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&PcapFileWrapper::m_startTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("StopTime",
+                   "The packets timestamped at or after this time are not written; "
+                   "zero to write them all.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&PcapFileWrapper::m_stopTime),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
@@ -93,7 +132,14 @@ void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
-  m_file.Open (filename, mode);
+  if ((mode & std::ios::in) == 0 && (m_asynchronous || m_compressionLevel > 0))
+    {
+      m_file.OpenBatched (filename, m_batchSize, m_compressionLevel, m_asynchronous);
+    }
+  else
+    {
+      m_file.Open (filename, mode);
+    }
 }
 
 void
@@ -115,10 +161,45 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
     } 
 }
 
+bool
+PcapFileWrapper::IsCompressed (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_compressionLevel > 0;
+}
+
+bool
+PcapFileWrapper::Accept (Time t, uint32_t size) const
+{
+  NS_LOG_FUNCTION (this << t << size);
+  return size >= m_minSize && size <= m_maxSize
+         && t >= m_startTime
+         && (t < m_stopTime || m_stopTime.IsZero ());
+}
+
+void
+PcapFileWrapper::SetSampler (Ptr<TraceSampler> sampler)
+{
+  NS_LOG_FUNCTION (this << sampler);
+  m_sampler = sampler;
+}
+
+Ptr<TraceSampler>
+PcapFileWrapper::GetSampler (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sampler;
+}
+
 void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << p);
+  if (!Accept (t, p->GetSize ())
+      || (m_sampler != 0 && !m_sampler->IsSampled (t, p, m_file.GetDataLinkType ())))
+    {
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -139,6 +220,12 @@ void
 PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << &header << p);
+  if (!Accept (t, header.GetSerializedSize () + p->GetSize ())
+      || (m_sampler != 0
+          && !m_sampler->IsSampled (t, header, p, m_file.GetDataLinkType ())))
+    {
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -159,6 +246,12 @@ void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
+  if (!Accept (t, length)
+      || (m_sampler != 0
+          && !m_sampler->IsSampled (t, buffer, length, m_file.GetDataLinkType ())))
+    {
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
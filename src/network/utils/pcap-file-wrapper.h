@@ -27,6 +27,7 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "pcap-file.h"
+#include "trace-sampler.h"
 
 namespace ns3 {
 
@@ -35,6 +36,25 @@ namespace ns3 {
  * ns-3 interface to the low-level public methods of PcapFile.  Users are
  * encouraged to use this object instead of class ns3::PcapFile in ns-3
  * public APIs.
+ *
+ * With the Asynchronous attribute, or a non zero CompressionLevel, the
+ * files opened for writing only are written in batches of BatchSize bytes
+ * (see PcapFile::OpenBatched): the records are copied into the current
+ * batch, and the batches are written by a background thread, gzip
+ * compressed if requested.  Such a file can not be read back until closed.
+ *
+ * The MinSize, MaxSize, StartTime and StopTime attributes select the
+ * records written by their size and their timestamp, before any copy.
+ * As the attributes of the files created by the trace helpers, they are
+ * usually set for a whole run with Config::SetDefault:
+ * \code
+ *   Config::SetDefault ("ns3::PcapFileWrapper::Asynchronous", BooleanValue (true));
+ *   Config::SetDefault ("ns3::PcapFileWrapper::CompressionLevel", UintegerValue (1));
+ *   Config::SetDefault ("ns3::PcapFileWrapper::StartTime", TimeValue (Seconds (10)));
+ * \endcode
+ *
+ * A TraceSampler set with SetSampler() selects the packets of the
+ * records that pass these filters, also before any copy.
  */
 class PcapFileWrapper : public Object
 {
@@ -220,10 +240,48 @@ public:
    */ 
   uint32_t GetDataLinkType (void);
 
+  /**
+   * \brief Check if the file is gzip compressed.
+   *
+   * \returns true if the CompressionLevel attribute is not zero
+   */
+  bool IsCompressed (void) const;
+
+  /**
+   * \brief Select the packets written with a sampler.
+   *
+   * The records written with a header are sampled by their packet
+   * only, without the header.
+   *
+   * \param sampler The sampler, or 0 to write all the packets.
+   */
+  void SetSampler (Ptr<TraceSampler> sampler);
+  /**
+   * \returns The sampler, or 0 if none.
+   */
+  Ptr<TraceSampler> GetSampler (void) const;
+
 private:
+  /**
+   * \brief Check if a record passes the filters.
+   *
+   * \param t Packet timestamp as ns3::Time.
+   * \param size The size of the packet.
+   * \returns true if the record is to be written.
+   */
+  bool Accept (Time t, uint32_t size) const;
+
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  bool     m_asynchronous; //!< Write the batches from a background thread
+  uint32_t m_batchSize; //!< Size of the batches
+  uint32_t m_compressionLevel; //!< gzip compression level, 0 for none
+  uint32_t m_minSize; //!< Smallest packet written
+  uint32_t m_maxSize; //!< Largest packet written
+  Time     m_startTime; //!< Time of the first packet written
+  Time     m_stopTime; //!< Time after the last packet written, 0 for none
+  Ptr<TraceSampler> m_sampler; //!< Selects the packets written, if any
 };
 
 } // namespace ns3
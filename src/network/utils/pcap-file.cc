@@ -20,6 +20,7 @@
 
 #include <iostream>
 #include <cstring>
+#include <algorithm>
 #include "ns3/assert.h"
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
@@ -27,6 +28,7 @@
 #include "ns3/header.h"
 #include "ns3/buffer.h"
 #include "pcap-file.h"
+#include "pcap-batch-writer.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
 //
@@ -50,7 +52,8 @@ const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pc
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_writer (0)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -68,12 +71,20 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return m_writer->Fail ();
+    }
   return m_file.fail ();
 }
 bool 
 PcapFile::Eof (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      return false;
+    }
   return m_file.eof ();
 }
 void 
@@ -88,6 +99,17 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      m_writer->Close ();
+      if (m_writer->Fail ())
+        {
+          m_file.setstate (std::ios::failbit);
+        }
+      delete m_writer;
+      m_writer = 0;
+      return;
+    }
   m_file.close ();
 }
 
@@ -202,12 +224,6 @@ void
 PcapFile::WriteFileHeader (void)
 {
   NS_LOG_FUNCTION (this);
-  //
-  // If we're initializing the file, we need to write the pcap file header
-  // at the start of the file.
-  //
-  m_file.seekp (0, std::ios::beg);
- 
   //
   // We have the ability to write out the pcap file header in a foreign endian
   // format, so we need a temp place to swap on the way out.
@@ -231,16 +247,30 @@ PcapFile::WriteFileHeader (void)
     }
 
   //
-  // Watch out for memory alignment differences between machines, so write
+  // Watch out for memory alignment differences between machines, so copy
   // them all individually.
   //
-  m_file.write ((const char *)&headerOut->m_magicNumber, sizeof(headerOut->m_magicNumber));
-  m_file.write ((const char *)&headerOut->m_versionMajor, sizeof(headerOut->m_versionMajor));
-  m_file.write ((const char *)&headerOut->m_versionMinor, sizeof(headerOut->m_versionMinor));
-  m_file.write ((const char *)&headerOut->m_zone, sizeof(headerOut->m_zone));
-  m_file.write ((const char *)&headerOut->m_sigFigs, sizeof(headerOut->m_sigFigs));
-  m_file.write ((const char *)&headerOut->m_snapLen, sizeof(headerOut->m_snapLen));
-  m_file.write ((const char *)&headerOut->m_type, sizeof(headerOut->m_type));
+  uint8_t buffer[24];
+  std::memcpy (buffer, &headerOut->m_magicNumber, 4);
+  std::memcpy (buffer + 4, &headerOut->m_versionMajor, 2);
+  std::memcpy (buffer + 6, &headerOut->m_versionMinor, 2);
+  std::memcpy (buffer + 8, &headerOut->m_zone, 4);
+  std::memcpy (buffer + 12, &headerOut->m_sigFigs, 4);
+  std::memcpy (buffer + 16, &headerOut->m_snapLen, 4);
+  std::memcpy (buffer + 20, &headerOut->m_type, 4);
+
+  if (m_writer != 0)
+    {
+      m_writer->Write (buffer, sizeof (buffer));
+      return;
+    }
+
+  //
+  // If we're initializing the file, we need to write the pcap file header
+  // at the start of the file.
+  //
+  m_file.seekp (0, std::ios::beg);
+  m_file.write ((const char *)buffer, sizeof (buffer));
 }
 
 void
@@ -327,6 +357,7 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
   NS_LOG_FUNCTION (this << filename << mode);
   NS_ASSERT ((mode & std::ios::app) == 0);
   NS_ASSERT (!m_file.fail ());
+  NS_ASSERT (m_writer == 0);
   //
   // All pcap files are binary files, so we just do this automatically.
   //
@@ -341,6 +372,16 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
     }
 }
 
+void
+PcapFile::OpenBatched (std::string const &filename, uint32_t batchSize,
+                       uint32_t compressionLevel, bool asynchronous)
+{
+  NS_LOG_FUNCTION (this << filename << batchSize << compressionLevel << asynchronous);
+  NS_ASSERT (m_writer == 0 && !m_file.is_open ());
+  m_filename = filename;
+  m_writer = new PcapBatchWriter (filename, batchSize, compressionLevel, asynchronous);
+}
+
 void
 PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection, bool swapMode, bool nanosecMode)
 {
@@ -400,11 +441,9 @@ PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrect
 }
 
 uint32_t
-PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
+PcapFile::SerializePacketHeader (uint8_t *buffer, uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 {
-  NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
-
+  NS_LOG_FUNCTION (this << &buffer << tsSec << tsUsec << totalLen);
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
   PcapRecordHeader header;
@@ -419,21 +458,50 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
     }
 
   //
-  // Watch out for memory alignment differences between machines, so write
+  // Watch out for memory alignment differences between machines, so copy
   // them all individually.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
+  std::memcpy (buffer, &header.m_tsSec, 4);
+  std::memcpy (buffer + 4, &header.m_tsUsec, 4);
+  std::memcpy (buffer + 8, &header.m_inclLen, 4);
+  std::memcpy (buffer + 12, &header.m_origLen, 4);
+  return inclLen;
+}
+
+uint32_t
+PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
+  NS_ASSERT (m_file.good ());
+
+  uint8_t buffer[16];
+  uint32_t inclLen = SerializePacketHeader (buffer, tsSec, tsUsec, totalLen);
+  m_file.write ((const char *)buffer, sizeof (buffer));
   NS_BUILD_DEBUG(m_file.flush());
   return inclLen;
 }
 
+uint8_t *
+PcapFile::ReserveRecord (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t &inclLen)
+{
+  NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
+  uint32_t size = std::min (totalLen, m_fileHeader.m_snapLen);
+  uint8_t *record = m_writer->Reserve (16 + size);
+  inclLen = SerializePacketHeader (record, tsSec, tsUsec, totalLen);
+  return record + 16;
+}
+
 void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
+  if (m_writer != 0)
+    {
+      uint32_t inclLen;
+      uint8_t *buffer = ReserveRecord (tsSec, tsUsec, totalLen, inclLen);
+      std::memcpy (buffer, data, inclLen);
+      return;
+    }
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
   m_file.write ((const char *)data, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
@@ -443,6 +511,13 @@ void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
+  if (m_writer != 0)
+    {
+      uint32_t inclLen;
+      uint8_t *buffer = ReserveRecord (tsSec, tsUsec, p->GetSize (), inclLen);
+      p->CopyData (buffer, inclLen);
+      return;
+    }
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
   p->CopyData (&m_file, inclLen);
   NS_BUILD_DEBUG(m_file.flush());
@@ -454,11 +529,22 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &header << p);
   uint32_t headerSize = header.GetSerializedSize ();
   uint32_t totalSize = headerSize + p->GetSize ();
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalSize);
 
   Buffer headerBuffer;
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
+
+  if (m_writer != 0)
+    {
+      uint32_t inclLen;
+      uint8_t *buffer = ReserveRecord (tsSec, tsUsec, totalSize, inclLen);
+      uint32_t toCopy = std::min (headerSize, inclLen);
+      headerBuffer.CopyData (buffer, toCopy);
+      p->CopyData (buffer + toCopy, inclLen - toCopy);
+      return;
+    }
+
+  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalSize);
   uint32_t toCopy = std::min (headerSize, inclLen);
   headerBuffer.CopyData (&m_file, toCopy);
   inclLen -= toCopy;
@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class PcapBatchWriter;
 
 
 /**
@@ -80,6 +81,25 @@ public:
    */
   void Open (std::string const &filename, std::ios::openmode mode);
 
+  /**
+   * Create a new pcap file, written in large batches rather than record
+   * by record, optionally gzip compressed and from a background thread.
+   * See PcapBatchWriter.
+   *
+   * The file can only be written: Init() it, then Write() the records.
+   * Fail() reports the errors of the background thread with a delay,
+   * and Close() waits for all the records to be written.
+   *
+   * \param filename String containing the name of the file.
+   * \param batchSize The size of the batches, in bytes.
+   * \param compressionLevel The gzip compression level from 1 to 9, or
+   * 0 to write a plain pcap file.
+   * \param asynchronous Whether to write the batches from the background
+   * thread.
+   */
+  void OpenBatched (std::string const &filename, uint32_t batchSize,
+                    uint32_t compressionLevel, bool asynchronous);
+
   /**
    * Close the underlying file.
    */
@@ -357,6 +377,29 @@ private:
    */
   uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
 
+  /**
+   * \brief Serialize a Pcap packet header
+   *
+   * \param buffer The 16 bytes to write the header to
+   * \param tsSec Time stamp (seconds part)
+   * \param tsUsec Time stamp (microseconds part)
+   * \param totalLen total packet length
+   * \returns the length of the packet to write in the Pcap file
+   */
+  uint32_t SerializePacketHeader (uint8_t *buffer, uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
+
+  /**
+   * \brief Append a Pcap packet header to the batches, and reserve room
+   * for the packet data
+   *
+   * \param tsSec Time stamp (seconds part)
+   * \param tsUsec Time stamp (microseconds part)
+   * \param totalLen total packet length
+   * \param inclLen [out] the length of the packet to write in the Pcap file
+   * \returns the bytes to copy the packet data to
+   */
+  uint8_t * ReserveRecord (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t &inclLen);
+
   /**
    * \brief Read and verify a Pcap file header
    */
@@ -367,6 +410,7 @@ private:
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  PcapBatchWriter *m_writer;    //!< batch writer, if opened with OpenBatched ()
 };
 
 } // namespace ns3
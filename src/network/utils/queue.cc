@@ -120,7 +120,7 @@ Queue::Enqueue (Ptr<QueueItem> item)
   if (retval)
     {
       NS_LOG_LOGIC ("m_traceEnqueue (p)");
-      m_traceEnqueue (item->GetPacket ());
+      NS_TRACE (m_traceEnqueue, (item->GetPacket ()));
 
       uint32_t size = item->GetPacketSize ();
       m_nBytes += size;
@@ -154,7 +154,7 @@ Queue::Dequeue (void)
       m_nPackets--;
 
       NS_LOG_LOGIC ("m_traceDequeue (packet)");
-      m_traceDequeue (item->GetPacket ());
+      NS_TRACE (m_traceDequeue, (item->GetPacket ()));
     }
   return item;
 }
@@ -327,7 +327,7 @@ Queue::Drop (Ptr<Packet> p)
   m_nTotalDroppedBytes += p->GetSize ();
 
   NS_LOG_LOGIC ("m_traceDrop (p)");
-  m_traceDrop (p);
+  NS_TRACE (m_traceDrop, (p));
 }
 
 } // namespace ns3
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/assert.h"
+
+/**
+ * \file
+ * \ingroup queue
+ * ns3::RingBuffer declaration and implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ * \brief A FIFO of values stored in a circular array.
+ *
+ * Once the array holds as many values as the FIFO ever held, pushing
+ * and popping values does not allocate memory, unlike std::deque
+ * which allocates and frees a chunk every few hundred values going
+ * through it.  The array doubles in size when full.
+ *
+ * A popped value is overwritten with a default constructed value, so
+ * that a Ptr releases its object as soon as it leaves the FIFO.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  /** Create an empty FIFO, which allocates on the first push. */
+  RingBuffer ();
+
+  /**
+   * Make room for a number of values, so that pushing as many values
+   * does not allocate memory.
+   *
+   * \param [in] capacity The number of values.
+   */
+  void Reserve (uint32_t capacity);
+  /**
+   * Append a value.
+   * \param [in] value The value.
+   */
+  void PushBack (const T &value);
+  /**
+   * Get the first value, which must exist.
+   * \returns The first value.
+   */
+  const T & Front (void) const;
+  /** Remove the first value, which must exist. */
+  void PopFront (void);
+  /** Remove all the values, keeping the room for them. */
+  void Clear (void);
+
+  /**
+   * \returns The number of values.
+   */
+  uint32_t GetSize (void) const;
+  /**
+   * \returns The number of values held without allocating memory.
+   */
+  uint32_t GetCapacity (void) const;
+  /**
+   * \returns \c true if there is no value.
+   */
+  bool IsEmpty (void) const;
+
+private:
+  /**
+   * Copy the values to a new array.
+   * \param [in] capacity The size of the new array.
+   */
+  void Resize (uint32_t capacity);
+
+  std::vector<T> m_values;   //!< The circular array.
+  uint32_t m_head;           //!< The index of the first value.
+  uint32_t m_size;           //!< The number of values.
+};
+
+} // namespace ns3
+
+
+/****************************************************
+ *  Implementation of the templates declared above.
+ ***************************************************/
+
+namespace ns3 {
+
+template <typename T>
+RingBuffer<T>::RingBuffer ()
+  : m_head (0),
+    m_size (0)
+{
+}
+
+template <typename T>
+void
+RingBuffer<T>::Resize (uint32_t capacity)
+{
+  std::vector<T> values (capacity);
+  for (uint32_t i = 0; i < m_size; i++)
+    {
+      values[i] = m_values[(m_head + i) % m_values.size ()];
+    }
+  m_values.swap (values);
+  m_head = 0;
+}
+
+template <typename T>
+void
+RingBuffer<T>::Reserve (uint32_t capacity)
+{
+  if (capacity > m_values.size ())
+    {
+      Resize (capacity);
+    }
+}
+
+template <typename T>
+void
+RingBuffer<T>::PushBack (const T &value)
+{
+  if (m_size == m_values.size ())
+    {
+      Resize (m_size == 0 ? 16 : 2 * m_size);
+    }
+  uint32_t tail = m_head + m_size;
+  if (tail >= m_values.size ())
+    {
+      tail -= m_values.size ();
+    }
+  m_values[tail] = value;
+  m_size++;
+}
+
+template <typename T>
+const T &
+RingBuffer<T>::Front (void) const
+{
+  NS_ASSERT (m_size > 0);
+  return m_values[m_head];
+}
+
+template <typename T>
+void
+RingBuffer<T>::PopFront (void)
+{
+  NS_ASSERT (m_size > 0);
+  m_values[m_head] = T ();
+  m_head++;
+  if (m_head == m_values.size ())
+    {
+      m_head = 0;
+    }
+  m_size--;
+}
+
+template <typename T>
+void
+RingBuffer<T>::Clear (void)
+{
+  while (m_size > 0)
+    {
+      PopFront ();
+    }
+  m_head = 0;
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::GetSize (void) const
+{
+  return m_size;
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::GetCapacity (void) const
+{
+  return m_values.size ();
+}
+
+template <typename T>
+bool
+RingBuffer<T>::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
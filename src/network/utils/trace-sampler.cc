@@ -0,0 +1,471 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "trace-sampler.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/packet.h"
+
+/**
+ * \file
+ * \ingroup network
+ * ns3::TraceSampler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TraceSampler");
+
+NS_OBJECT_ENSURE_REGISTERED (TraceSampler);
+
+const uint32_t TraceSampler::MAX_HEADER_BYTES;
+const uint32_t TraceSampler::MAX_FLOW_KEY;
+
+namespace {
+
+/* The pcap data link types parsed, see PcapHelper */
+const uint32_t DLT_EN10MB = 1;
+const uint32_t DLT_PPP = 9;
+const uint32_t DLT_RAW = 101;
+const uint32_t DLT_IEEE802_11 = 105;
+const uint32_t DLT_LINUX_SLL = 113;
+const uint32_t DLT_PRISM_HEADER = 119;
+const uint32_t DLT_IEEE802_11_RADIO = 127;
+/* Not a pcap data link type: the packets without their link header */
+const uint32_t LINK_PAYLOAD = 0xffffffff;
+
+/* The protocol numbers of the IP packets and their payloads */
+const uint16_t ETHERTYPE_IPV4 = 0x0800;
+const uint16_t ETHERTYPE_IPV6 = 0x86dd;
+const uint16_t ETHERTYPE_VLAN = 0x8100;
+const uint16_t PPP_IPV4 = 0x0021;
+const uint16_t PPP_IPV6 = 0x0057;
+const uint8_t IPPROTO_HOPOPTS = 0;
+const uint8_t IPPROTO_TCP = 6;
+const uint8_t IPPROTO_UDP = 17;
+const uint8_t IPPROTO_ROUTING = 43;
+const uint8_t IPPROTO_DSTOPTS = 60;
+
+/* The size of the prism header before the IEEE 802.11 frames */
+const uint32_t PRISM_HEADER_SIZE = 144;
+
+/**
+ * \param [in] buffer The bytes.
+ * \returns The 16 bits at buffer, in network order.
+ */
+uint16_t
+ReadNtohU16 (uint8_t const *buffer)
+{
+  return (buffer[0] << 8) | buffer[1];
+}
+
+/**
+ * Find the ethertype after an LLC/SNAP header.
+ *
+ * \param [in] buffer The bytes of the LLC/SNAP header.
+ * \param [in] length The number of bytes.
+ * \param [out] ethertype The ethertype of the payload.
+ * \returns The size of the header, 0 if there is none.
+ */
+uint32_t
+ReadLlcSnap (uint8_t const *buffer, uint32_t length, uint16_t &ethertype)
+{
+  if (length < 8 || buffer[0] != 0xaa || buffer[1] != 0xaa || buffer[2] != 0x03)
+    {
+      return 0;
+    }
+  ethertype = ReadNtohU16 (buffer + 6);
+  return 8;
+}
+
+/**
+ * Find the network header of a packet.
+ *
+ * \param [in] buffer The first bytes of the packet.
+ * \param [in] length The number of bytes.
+ * \param [in] dataLinkType The pcap data link type of the packet.
+ * \param [out] ethertype The ethertype of the network header, 0 if
+ *               there is none known.
+ * \returns The offset of the network header.
+ */
+uint32_t
+FindNetworkHeader (uint8_t const *buffer, uint32_t length,
+                   uint32_t dataLinkType, uint16_t &ethertype)
+{
+  ethertype = 0;
+  switch (dataLinkType)
+    {
+    case DLT_RAW:
+      if (length > 0)
+        {
+          ethertype = (buffer[0] >> 4) == 6 ? ETHERTYPE_IPV6 : ETHERTYPE_IPV4;
+        }
+      return 0;
+    case LINK_PAYLOAD:
+      {
+        uint32_t offset = ReadLlcSnap (buffer, length, ethertype);
+        if (offset == 0 && length > 0)
+          {
+            uint8_t version = buffer[0] >> 4;
+            ethertype = version == 4 ? ETHERTYPE_IPV4
+              : version == 6 ? ETHERTYPE_IPV6 : 0;
+          }
+        return offset;
+      }
+    case DLT_PPP:
+      if (length >= 2)
+        {
+          uint16_t protocol = ReadNtohU16 (buffer);
+          ethertype = protocol == PPP_IPV4 ? ETHERTYPE_IPV4
+            : protocol == PPP_IPV6 ? ETHERTYPE_IPV6 : 0;
+        }
+      return 2;
+    case DLT_EN10MB:
+      {
+        uint32_t offset = 12;
+        if (length >= offset + 2 && ReadNtohU16 (buffer + offset) == ETHERTYPE_VLAN)
+          {
+            offset += 4;
+          }
+        if (length < offset + 2)
+          {
+            return 0;
+          }
+        ethertype = ReadNtohU16 (buffer + offset);
+        offset += 2;
+        if (ethertype <= 1500)
+          {
+            // A length: the payload starts with an LLC/SNAP header
+            ethertype = 0;
+            offset += ReadLlcSnap (buffer + offset, length - offset, ethertype);
+          }
+        return offset;
+      }
+    case DLT_LINUX_SLL:
+      if (length >= 16)
+        {
+          ethertype = ReadNtohU16 (buffer + 14);
+        }
+      return 16;
+    case DLT_PRISM_HEADER:
+    case DLT_IEEE802_11_RADIO:
+      {
+        uint32_t offset = PRISM_HEADER_SIZE;
+        if (dataLinkType == DLT_IEEE802_11_RADIO)
+          {
+            // The length of the radiotap header is little endian
+            offset = length >= 4 ? buffer[2] | (buffer[3] << 8) : length;
+          }
+        if (offset >= length)
+          {
+            return 0;
+          }
+        return offset + FindNetworkHeader (buffer + offset, length - offset,
+                                           DLT_IEEE802_11, ethertype);
+      }
+    case DLT_IEEE802_11:
+      {
+        // Only the data frames, which are not A-MSDUs, carry a network header
+        if (length < 2 || ((buffer[0] >> 2) & 0x3) != 2)
+          {
+            return 0;
+          }
+        uint32_t offset = 24;
+        if ((buffer[1] & 0x3) == 0x3)
+          {
+            offset += 6;
+          }
+        if (buffer[0] & 0x80)
+          {
+            // The QoS control field, and the HT control field if any
+            if (length < offset + 2 || (buffer[offset] & 0x80) != 0)
+              {
+                return 0;
+              }
+            offset += 2;
+            if (buffer[1] & 0x80)
+              {
+                offset += 4;
+              }
+          }
+        if (length < offset)
+          {
+            return 0;
+          }
+        return offset + ReadLlcSnap (buffer + offset, length - offset, ethertype);
+      }
+    default:
+      return 0;
+    }
+}
+
+} // anonymous namespace
+
+TypeId
+TraceSampler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TraceSampler")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<TraceSampler> ()
+    .AddAttribute ("Ratio",
+                   "One packet in Ratio is traced, chosen by its hash.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TraceSampler::m_ratio),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Salt",
+                   "Mixed into the hashes, to trace another subset of the packets.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&TraceSampler::m_salt),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Flows",
+                   "Hash the protocol, the addresses and the ports of the "
+                   "IP packets instead of their uids, to trace all the "
+                   "packets of a flow or none.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TraceSampler::m_flows),
+                   MakeBooleanChecker ())
+    .AddAttribute ("DataLinkType",
+                   "The pcap data link type of the link headers of the "
+                   "packets of the ascii traces, to find their flows.",
+                   UintegerValue (DLT_PPP),
+                   MakeUintegerAccessor (&TraceSampler::m_dataLinkType),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("StartTime",
+                   "The packets before this time are not traced.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TraceSampler::m_startTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("StopTime",
+                   "The packets at or after this time are not traced; "
+                   "zero to trace them all.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&TraceSampler::m_stopTime),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+TraceSampler::TraceSampler ()
+  : m_nSampled (0),
+    m_nSkipped (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TraceSampler::~TraceSampler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TraceSampler::AddNode (uint32_t nodeId)
+{
+  NS_LOG_FUNCTION (this << nodeId);
+  m_nodes.insert (nodeId);
+}
+
+bool
+TraceSampler::IsNodeTraced (uint32_t nodeId) const
+{
+  NS_LOG_FUNCTION (this << nodeId);
+  return m_nodes.empty () || m_nodes.find (nodeId) != m_nodes.end ();
+}
+
+bool
+TraceSampler::IsInWindow (Time t) const
+{
+  return t >= m_startTime && (t < m_stopTime || m_stopTime.IsZero ());
+}
+
+bool
+TraceSampler::Select (uint64_t key)
+{
+  // The finalizer of MurmurHash3, so that consecutive uids do not
+  // select every Ratio-th packet.
+  key ^= m_salt;
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  if (key % m_ratio == 0)
+    {
+      m_nSampled++;
+      return true;
+    }
+  m_nSkipped++;
+  return false;
+}
+
+uint32_t
+TraceSampler::GetFlowKey (uint8_t const *buffer, uint32_t length,
+                          uint32_t dataLinkType, uint8_t *key)
+{
+  uint16_t ethertype;
+  uint32_t offset = FindNetworkHeader (buffer, length, dataLinkType, ethertype);
+  uint8_t const *ip = buffer + offset;
+  uint32_t ipLength = offset < length ? length - offset : 0;
+  uint8_t protocol;
+  uint32_t addresses;
+  uint32_t addressesSize;
+  uint32_t ports;
+  if (ethertype == ETHERTYPE_IPV4 && ipLength >= 20
+      && (ip[0] >> 4) == 4 && (ip[0] & 0xf) >= 5)
+    {
+      protocol = ip[9];
+      addresses = 12;
+      addressesSize = 8;
+      ports = (ip[0] & 0xf) * 4;
+      if ((ReadNtohU16 (ip + 6) & 0x3fff) != 0)
+        {
+          // The fragments of a datagram go with its flow, without the ports
+          ports = 0;
+        }
+    }
+  else if (ethertype == ETHERTYPE_IPV6 && ipLength >= 40 && (ip[0] >> 4) == 6)
+    {
+      protocol = ip[6];
+      addresses = 8;
+      addressesSize = 32;
+      ports = 40;
+      while ((protocol == IPPROTO_HOPOPTS || protocol == IPPROTO_ROUTING
+              || protocol == IPPROTO_DSTOPTS) && ports + 2 <= ipLength)
+        {
+          protocol = ip[ports];
+          ports += (ip[ports + 1] + 1) * 8;
+        }
+    }
+  else
+    {
+      return 0;
+    }
+  key[0] = protocol;
+  std::copy (ip + addresses, ip + addresses + addressesSize, key + 1);
+  uint32_t size = 1 + addressesSize;
+  if ((protocol == IPPROTO_TCP || protocol == IPPROTO_UDP)
+      && ports != 0 && ports + 4 <= ipLength)
+    {
+      std::copy (ip + ports, ip + ports + 4, key + size);
+      size += 4;
+    }
+  return size;
+}
+
+bool
+TraceSampler::HashFlow (uint8_t const *buffer, uint32_t length,
+                        uint32_t dataLinkType, uint64_t &hash)
+{
+  uint8_t key[MAX_FLOW_KEY];
+  uint32_t size = GetFlowKey (buffer, length, dataLinkType, key);
+  if (size == 0)
+    {
+      return false;
+    }
+  hash = m_hasher.clear ().GetHash64 (reinterpret_cast<char *> (key), size);
+  return true;
+}
+
+bool
+TraceSampler::IsSampled (Time t, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << t << p);
+  return IsSampled (t, p, m_dataLinkType);
+}
+
+bool
+TraceSampler::IsSampled (Time t, Ptr<const Packet> p, uint32_t dataLinkType)
+{
+  NS_LOG_FUNCTION (this << t << p << dataLinkType);
+  if (!IsInWindow (t))
+    {
+      m_nSkipped++;
+      return false;
+    }
+  if (m_ratio == 1)
+    {
+      m_nSampled++;
+      return true;
+    }
+  uint64_t hash;
+  if (m_flows)
+    {
+      uint8_t bytes[MAX_HEADER_BYTES];
+      uint32_t size = p->CopyData (bytes, MAX_HEADER_BYTES);
+      if (HashFlow (bytes, size, dataLinkType, hash))
+        {
+          return Select (hash);
+        }
+    }
+  return Select (p->GetUid ());
+}
+
+bool
+TraceSampler::IsSampled (Time t, const Header &header, Ptr<const Packet> p,
+                         uint32_t dataLinkType)
+{
+  NS_LOG_FUNCTION (this << t << &header << p << dataLinkType);
+  if (dataLinkType == DLT_PRISM_HEADER || dataLinkType == DLT_IEEE802_11_RADIO)
+    {
+      // The packet holds the whole IEEE 802.11 frame
+      return IsSampled (t, p, DLT_IEEE802_11);
+    }
+  // Otherwise the header is the link header.  It is not serialized:
+  // the packet starts with the network header, or with an LLC/SNAP
+  // header, which tell the network protocol.
+  return IsSampled (t, p, LINK_PAYLOAD);
+}
+
+bool
+TraceSampler::IsSampled (Time t, uint8_t const *buffer, uint32_t length, uint32_t dataLinkType)
+{
+  NS_LOG_FUNCTION (this << t << &buffer << length << dataLinkType);
+  if (!IsInWindow (t))
+    {
+      m_nSkipped++;
+      return false;
+    }
+  if (m_ratio == 1)
+    {
+      m_nSampled++;
+      return true;
+    }
+  uint64_t hash;
+  if (!m_flows || !HashFlow (buffer, length, dataLinkType, hash))
+    {
+      hash = m_hasher.clear ().GetHash64 (reinterpret_cast<char const *> (buffer), length);
+    }
+  return Select (hash);
+}
+
+uint64_t
+TraceSampler::GetNSampled (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_nSampled;
+}
+
+uint64_t
+TraceSampler::GetNSkipped (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_nSkipped;
+}
+
+} // namespace ns3
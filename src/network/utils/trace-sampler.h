@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TRACE_SAMPLER_H
+#define TRACE_SAMPLER_H
+
+#include <stdint.h>
+#include <set>
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/hash.h"
+
+/**
+ * \file
+ * \ingroup network
+ * ns3::TraceSampler declaration.
+ */
+
+namespace ns3 {
+
+class Packet;
+class Header;
+
+/**
+ * \ingroup network
+ * \brief Select the packets written to the pcap and ascii traces.
+ *
+ * A sampler keeps the packets of a time window and, within it, one
+ * packet in Ratio, chosen by a hash of the packet.  The hash is
+ * deterministic: a packet keeps its uid from hop to hop, so the same
+ * packets are traced on every device of their path, and two runs with
+ * the same Salt trace the same packets.  With Flows, the protocol, the
+ * addresses and the UDP or TCP ports of the IPv4 and IPv6 packets are
+ * hashed instead of the uid, so that all the packets of a flow are
+ * traced or none is, whatever the link they cross.  The IP header is
+ * found after the link header of the pcap data link type of the file,
+ * or of the DataLinkType attribute for the ascii traces: PPP, Ethernet
+ * (with or without LLC/SNAP), IEEE 802.11 (with or without a radiotap
+ * or prism header), Linux cooked and raw IP are parsed.  The packets
+ * of the other links, and those which are not IP, are hashed as if
+ * Flows was not set.
+ *
+ * The sampler also holds the nodes whose devices are traced, all of
+ * them if none was added.
+ *
+ * The trace helpers attach a sampler to the trace files they create,
+ * see PcapHelperForDevice::SetPcapSampler() and
+ * AsciiTraceHelperForDevice::SetAsciiSampler(), and the packets are
+ * selected before the records are formatted:
+ * \code
+ *   Ptr<TraceSampler> sampler = CreateObject<TraceSampler> ();
+ *   sampler->SetAttribute ("Ratio", UintegerValue (100));
+ *   sampler->SetAttribute ("StartTime", TimeValue (Seconds (10)));
+ *   sampler->AddNode (0);
+ *   pointToPoint.SetPcapSampler (sampler);
+ *   pointToPoint.EnablePcapAll ("trace");
+ * \endcode
+ */
+class TraceSampler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TraceSampler ();
+  virtual ~TraceSampler ();
+
+  /**
+   * Trace the devices of a node.  Once a node is added, the devices
+   * of the nodes not added are not traced.
+   *
+   * \param [in] nodeId The id of the node.
+   */
+  void AddNode (uint32_t nodeId);
+  /**
+   * \param [in] nodeId The id of a node.
+   * \returns true if the devices of the node are traced.
+   */
+  bool IsNodeTraced (uint32_t nodeId) const;
+
+  /**
+   * Check if a packet is traced, and count it.
+   *
+   * \param [in] t The time of the record.
+   * \param [in] p The packet, starting with a link header of the
+   *              DataLinkType attribute.
+   * \returns true if the packet is to be written.
+   */
+  bool IsSampled (Time t, Ptr<const Packet> p);
+  /**
+   * Check if a packet is traced, and count it.
+   *
+   * \param [in] t The time of the record.
+   * \param [in] p The packet, starting with its link header.
+   * \param [in] dataLinkType The pcap data link type of the link
+   *              header.  The radiotap or prism header of the IEEE
+   *              802.11 types is not part of the packet.
+   * \returns true if the packet is to be written.
+   */
+  bool IsSampled (Time t, Ptr<const Packet> p, uint32_t dataLinkType);
+  /**
+   * Check if a packet written after a header is traced, and count it.
+   *
+   * \param [in] t The time of the record.
+   * \param [in] header The radiotap or prism header of the IEEE 802.11
+   *              data link types, or else the link header.  The header
+   *              is not serialized: with the other data link types, the
+   *              flow is found from the network header, or the LLC/SNAP
+   *              header, at the start of the packet.
+   * \param [in] p The packet.
+   * \param [in] dataLinkType The pcap data link type of the record.
+   * \returns true if the packet is to be written.
+   */
+  bool IsSampled (Time t, const Header &header, Ptr<const Packet> p,
+                  uint32_t dataLinkType);
+  /**
+   * Check if the bytes of a packet are traced, and count them.
+   *
+   * Without Flows, or for a packet without a flow, the bytes are hashed.
+   *
+   * \param [in] t The time of the record.
+   * \param [in] buffer The bytes of the packet, starting with its link
+   *              header.
+   * \param [in] length The number of bytes.
+   * \param [in] dataLinkType The pcap data link type of the link header.
+   * \returns true if the packet is to be written.
+   */
+  bool IsSampled (Time t, uint8_t const *buffer, uint32_t length, uint32_t dataLinkType);
+
+  /**
+   * \returns The number of packets traced so far.
+   */
+  uint64_t GetNSampled (void) const;
+  /**
+   * \returns The number of packets not traced so far.
+   */
+  uint64_t GetNSkipped (void) const;
+
+private:
+  /**
+   * The number of bytes of a packet parsed for its flow: an IEEE
+   * 802.11 header with LLC/SNAP, an IPv4 header with options and the
+   * ports.
+   */
+  static const uint32_t MAX_HEADER_BYTES = 128;
+  /**
+   * The longest flow key: the protocol, two IPv6 addresses and two
+   * ports.
+   */
+  static const uint32_t MAX_FLOW_KEY = 37;
+
+  /**
+   * \param [in] t The time of a record.
+   * \returns true if the time is in the window.
+   */
+  bool IsInWindow (Time t) const;
+  /**
+   * Keep one key in Ratio, and count the packet.
+   *
+   * \param [in] key The uid or the hash of the packet.
+   * \returns true if the packet is to be written.
+   */
+  bool Select (uint64_t key);
+  /**
+   * Extract the flow of a packet.
+   *
+   * \param [in] buffer The first bytes of the packet.
+   * \param [in] length The number of bytes.
+   * \param [in] dataLinkType The pcap data link type of the packet.
+   * \param [out] key The protocol, the addresses and the ports of the
+   *               packet, MAX_FLOW_KEY bytes at most.
+   * \returns The number of bytes of the key, 0 if the packet has no
+   *          flow known.
+   */
+  static uint32_t GetFlowKey (uint8_t const *buffer, uint32_t length,
+                              uint32_t dataLinkType, uint8_t *key);
+  /**
+   * Hash the flow of a packet.
+   *
+   * \param [in] buffer The first bytes of the packet.
+   * \param [in] length The number of bytes.
+   * \param [in] dataLinkType The pcap data link type of the packet.
+   * \param [out] hash The hash of the flow.
+   * \returns true if the packet has a flow.
+   */
+  bool HashFlow (uint8_t const *buffer, uint32_t length,
+                 uint32_t dataLinkType, uint64_t &hash);
+
+  uint32_t m_ratio;              //!< One packet in m_ratio is traced
+  uint32_t m_salt;               //!< Mixed into the hashes
+  bool m_flows;                  //!< Hash the flows instead of the uids
+  uint32_t m_dataLinkType;       //!< The link type of the ascii traces
+  Time m_startTime;              //!< The start of the window
+  Time m_stopTime;               //!< The end of the window, 0 for none
+  std::set<uint32_t> m_nodes;    //!< The nodes traced, empty for all
+  Hasher m_hasher;               //!< Hashes the flow bytes
+  uint64_t m_nSampled;           //!< The number of packets traced
+  uint64_t m_nSkipped;           //!< The number of packets not traced
+};
+
+} // namespace ns3
+
+#endif /* TRACE_SAMPLER_H */
@@ -20,6 +20,7 @@
 #include "point-to-point-net-device.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 
@@ -106,6 +107,38 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointChannel::TransmitBurstStart (
+  Ptr<PacketBurst> burst,
+  Ptr<PointToPointNetDevice> src,
+  DataRate bps,
+  Time interframeGap)
+{
+  NS_LOG_FUNCTION (this << burst << src);
+
+  NS_ASSERT (m_link[0].m_state != INITIALIZING);
+  NS_ASSERT (m_link[1].m_state != INITIALIZING);
+
+  uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+  uint32_t context = m_link[wire].m_dst->GetNode ()->GetId ();
+
+  Time start = Seconds (0);
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      Ptr<Packet> p = *i;
+      NS_LOG_LOGIC ("UID is " << p->GetUid () << ")");
+      Time txEnd = start + bps.CalculateBytesTxTime (p->GetSize ());
+      Simulator::ScheduleWithContext (context, txEnd + m_delay,
+                                      &PointToPointNetDevice::Receive,
+                                      m_link[wire].m_dst, p);
+
+      // Call the tx anim callback on the net device
+      m_txrxPointToPoint (p, src, m_link[wire].m_dst, txEnd, txEnd + m_delay);
+      start = txEnd + interframeGap;
+    }
+  return true;
+}
+
 uint32_t 
 PointToPointChannel::GetNDevices (void) const
 {
@@ -30,6 +30,7 @@ namespace ns3 {
 
 class PointToPointNetDevice;
 class Packet;
+class PacketBurst;
 
 /**
  * \ingroup point-to-point
@@ -80,6 +81,23 @@ public:
    */
   virtual bool TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
 
+  /**
+   * \brief Transmit back-to-back packets over this channel
+   *
+   * Each packet is received at the time it would be if transmitted on
+   * its own, right after the previous one and its interframe gap.  The
+   * TxRxPointToPoint trace fires for all the packets at the start of
+   * the burst, with the times relative to the start of the burst.
+   *
+   * \param burst Packets to transmit, in order
+   * \param src Source PointToPointNetDevice
+   * \param bps Data rate of the source
+   * \param interframeGap Time between the end of a packet and the start of the next
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitBurstStart (Ptr<PacketBurst> burst, Ptr<PointToPointNetDevice> src,
+                                   DataRate bps, Time interframeGap);
+
   /**
    * \brief Get number of devices on this channel
    * \returns number of devices on this channel
@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/packet-burst.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -67,6 +68,13 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("MaxBurstPackets",
+                   "The largest number of packets waiting in the queue "
+                   "sent back-to-back with a single event, 1 to send "
+                   "each packet on its own",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_maxBurstPackets),
+                   MakeUintegerChecker<uint32_t> (1))
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -175,6 +183,8 @@ PointToPointNetDevice::GetTypeId (void)
 PointToPointNetDevice::PointToPointNetDevice () 
   :
     m_txMachineState (READY),
+    m_maxBurstPackets (1),
+    m_burstBacklogBytes (0),
     m_channel (0),
     m_linkUp (false),
     m_currentPkt (0)
@@ -224,6 +234,8 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
+  m_burstBacklog.clear ();
+  m_burstBacklogBytes = 0;
   m_queue = 0;
   m_queueInterface = 0;
   NetDevice::DoDispose ();
@@ -257,7 +269,7 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
   m_txMachineState = BUSY;
   m_currentPkt = p;
-  m_phyTxBeginTrace (m_currentPkt);
+  NS_TRACE_OPTIONAL (m_phyTxBeginTrace, (m_currentPkt));
 
   Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
   Time txCompleteTime = txTime + m_tInterframeGap;
@@ -268,7 +280,7 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   bool result = m_channel->TransmitStart (p, this, txTime);
   if (result == false)
     {
-      m_phyTxDropTrace (p);
+      NS_TRACE_OPTIONAL (m_phyTxDropTrace, (p));
     }
   return result;
 }
@@ -289,8 +301,10 @@ PointToPointNetDevice::TransmitComplete (void)
 
   NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
 
-  m_phyTxEndTrace (m_currentPkt);
+  NS_TRACE_OPTIONAL (m_phyTxEndTrace, (m_currentPkt));
   m_currentPkt = 0;
+  m_burstBacklog.clear ();
+  m_burstBacklogBytes = 0;
 
   Ptr<NetDeviceQueue> txq;
   if (m_queueInterface)
@@ -319,10 +333,95 @@ PointToPointNetDevice::TransmitComplete (void)
     {
       txq->Start ();
     }
-  Ptr<Packet> p = item->GetPacket ();
-  m_snifferTrace (p);
-  m_promiscSnifferTrace (p);
-  TransmitStart (p);
+  TransmitDequeued (item->GetPacket ());
+}
+
+bool
+PointToPointNetDevice::TransmitBurstStart (Ptr<PacketBurst> burst)
+{
+  NS_LOG_FUNCTION (this << burst);
+  NS_LOG_LOGIC (burst->GetNPackets () << " packets");
+
+  NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+  m_txMachineState = BUSY;
+
+  //
+  // The transmitter is busy until the end of the interframe gap of the
+  // last packet, as it would be sending the packets one by one.  The
+  // packets after the first one would wait in the queue until they start.
+  //
+  Time txCompleteTime = Seconds (0);
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      if (i != burst->Begin ())
+        {
+          m_burstBacklog.push_back (std::make_pair (Simulator::Now () + txCompleteTime,
+                                                    (*i)->GetSize ()));
+          m_burstBacklogBytes += (*i)->GetSize ();
+        }
+      txCompleteTime += m_bps.CalculateBytesTxTime ((*i)->GetSize ()) + m_tInterframeGap;
+      m_currentPkt = *i;
+    }
+
+  NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
+  Simulator::Schedule (txCompleteTime, &PointToPointNetDevice::TransmitComplete, this);
+
+  bool result = m_channel->TransmitBurstStart (burst, this, m_bps, m_tInterframeGap);
+  if (result == false)
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+        {
+          NS_TRACE_OPTIONAL (m_phyTxDropTrace, (*i));
+        }
+    }
+  return result;
+}
+
+bool
+PointToPointNetDevice::CanTransmitBurst (void) const
+{
+  return m_maxBurstPackets > 1
+         && m_phyTxBeginTrace.IsEmpty () && m_phyTxEndTrace.IsEmpty ()
+         && m_snifferTrace.IsEmpty () && m_promiscSnifferTrace.IsEmpty ();
+}
+
+bool
+PointToPointNetDevice::IsBurstBacklogFull (Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  while (!m_burstBacklog.empty () && m_burstBacklog.front ().first <= Simulator::Now ())
+    {
+      m_burstBacklogBytes -= m_burstBacklog.front ().second;
+      m_burstBacklog.pop_front ();
+    }
+  if (m_burstBacklog.empty ())
+    {
+      return false;
+    }
+  if (m_queue->GetMode () == Queue::QUEUE_MODE_PACKETS)
+    {
+      return m_queue->GetNPackets () + m_burstBacklog.size () >= m_queue->GetMaxPackets ();
+    }
+  return m_queue->GetNBytes () + m_burstBacklogBytes + p->GetSize () > m_queue->GetMaxBytes ();
+}
+
+bool
+PointToPointNetDevice::TransmitDequeued (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  if (CanTransmitBurst () && !m_queue->IsEmpty ())
+    {
+      Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+      burst->AddPacket (p);
+      while (burst->GetNPackets () < m_maxBurstPackets && !m_queue->IsEmpty ())
+        {
+          burst->AddPacket (m_queue->Dequeue ()->GetPacket ());
+        }
+      return TransmitBurstStart (burst);
+    }
+  NS_TRACE (m_snifferTrace, (p));
+  NS_TRACE (m_promiscSnifferTrace, (p));
+  return TransmitStart (p);
 }
 
 bool
@@ -369,7 +468,7 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
       // If we have an error model and it indicates that it is time to lose a
       // corrupted packet, don't forward this packet up, let it go.
       //
-      m_phyRxDropTrace (packet);
+      NS_TRACE (m_phyRxDropTrace, (packet));
     }
   else 
     {
@@ -378,9 +477,9 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
       // device because it is so simple, but this is not usually the case in
       // more complicated devices.
       //
-      m_snifferTrace (packet);
-      m_promiscSnifferTrace (packet);
-      m_phyRxEndTrace (packet);
+      NS_TRACE (m_snifferTrace, (packet));
+      NS_TRACE (m_promiscSnifferTrace, (packet));
+      NS_TRACE_OPTIONAL (m_phyRxEndTrace, (packet));
 
       //
       // Trace sinks will expect complete packets, not packets without some of the
@@ -398,11 +497,11 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
 
       if (!m_promiscCallback.IsNull ())
         {
-          m_macPromiscRxTrace (originalPacket);
+          NS_TRACE_OPTIONAL (m_macPromiscRxTrace, (originalPacket));
           m_promiscCallback (this, packet, protocol, GetRemote (), GetAddress (), NetDevice::PACKET_HOST);
         }
 
-      m_macRxTrace (originalPacket);
+      NS_TRACE (m_macRxTrace, (originalPacket));
       m_rxCallback (this, packet, protocol, GetRemote ());
     }
 }
@@ -550,13 +649,55 @@ PointToPointNetDevice::Send (
   NS_LOG_LOGIC ("p=" << packet << ", dest=" << &dest);
   NS_LOG_LOGIC ("UID is " << packet->GetUid ());
 
+  return SendPacket (packet, protocolNumber, txq);
+}
+
+bool
+PointToPointNetDevice::SendBurst (
+  Ptr<PacketBurst> burst,
+  const Address &dest,
+  uint16_t protocolNumber)
+{
+  Ptr<NetDeviceQueue> txq;
+  if (m_queueInterface)
+  {
+    txq = m_queueInterface->GetTxQueue (0);
+  }
+
+  NS_ASSERT_MSG (!txq || !txq->IsStopped (), "Send should not be called when the device is stopped");
+
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+
+  //
+  // The packets go through the queue one by one, as if sent one by one,
+  // so that the queue fills and overflows as it would; those which wait
+  // in the queue then leave as a burst once the transmitter is free.
+  //
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      if (!SendPacket (*i, protocolNumber, txq))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+PointToPointNetDevice::SendPacket (
+  Ptr<Packet> packet,
+  uint16_t protocolNumber,
+  Ptr<NetDeviceQueue> txq)
+{
+  NS_LOG_FUNCTION (this << packet << protocolNumber << txq);
+
   //
   // If IsLinkUp() is false it means there is no channel to send any packet 
   // over so we just hit the drop trace on the packet and return an error.
   //
   if (IsLinkUp () == false)
     {
-      m_macTxDropTrace (packet);
+      NS_TRACE_OPTIONAL (m_macTxDropTrace, (packet));
       return false;
     }
 
@@ -566,12 +707,14 @@ PointToPointNetDevice::Send (
   //
   AddHeader (packet, protocolNumber);
 
-  m_macTxTrace (packet);
+  NS_TRACE (m_macTxTrace, (packet));
 
   //
   // We should enqueue and dequeue the packet to hit the tracing hooks.
+  // The packets of a burst which have not started yet still take room
+  // in the queue.
   //
-  if (m_queue->Enqueue (Create<QueueItem> (packet)))
+  if (!IsBurstBacklogFull (packet) && m_queue->Enqueue (Create<QueueItem> (packet)))
     {
       //
       // If the channel is ready for transition we send the packet right now
@@ -579,16 +722,14 @@ PointToPointNetDevice::Send (
       if (m_txMachineState == READY)
         {
           packet = m_queue->Dequeue ()->GetPacket ();
-          m_snifferTrace (packet);
-          m_promiscSnifferTrace (packet);
-          return TransmitStart (packet);
+          return TransmitDequeued (packet);
         }
       return true;
     }
 
   // Enqueue may fail (overflow). Stop the tx queue, so that the upper layers
   // do not send packets until there is room in the queue again.
-  m_macTxDropTrace (packet);
+  NS_TRACE_OPTIONAL (m_macTxDropTrace, (packet));
   if (txq)
   {
     txq->Stop ();
@@ -20,6 +20,8 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <deque>
+#include <utility>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -58,6 +60,19 @@ class ErrorModel;
  * Key parameters or objects that can be specified for this device 
  * include a queue, data rate, and interframe transmission gap (the 
  * propagation delay is set in the PointToPointChannel).
+ *
+ * With a MaxBurstPackets attribute larger than one, the packets waiting
+ * in the queue when the transmitter gets free are sent back-to-back as
+ * a PacketBurst, with a single transmit complete event at the end of
+ * the burst instead of one per packet.  Each packet still starts, ends
+ * and is received at the same time as when sent on its own; but the
+ * packets of a burst leave the queue, and hit its Dequeue trace, when
+ * the burst starts.  Those which have not started yet still count
+ * against the limit of the queue: a packet sent while they would have
+ * filled it is dropped, and hits the MacTxDrop trace but not the Drop
+ * trace of the queue.  The bursts are not used while the PhyTxBegin,
+ * PhyTxEnd, Sniffer or PromiscSniffer traces, which report the
+ * transmission of each packet as it happens, are connected.
  */
 class PointToPointNetDevice : public NetDevice
 {
@@ -177,6 +192,7 @@ public:
 
   virtual bool Send (Ptr<Packet> packet, const Address &dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual bool SendBurst (Ptr<PacketBurst> burst, const Address &dest, uint16_t protocolNumber);
 
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
@@ -269,6 +285,55 @@ private:
    */
   bool TransmitStart (Ptr<Packet> p);
 
+  /**
+   * Start Sending Back-to-Back Packets Down the Wire.
+   *
+   * Like TransmitStart, for all the packets of a burst: a single event
+   * is scheduled for the time at which the bits of the last packet
+   * have been completely transmitted.
+   *
+   * \see PointToPointChannel::TransmitBurstStart ()
+   * \param burst the packets to send, in order
+   * \returns true if success, false on failure
+   */
+  bool TransmitBurstStart (Ptr<PacketBurst> burst);
+
+  /**
+   * Start sending a packet just dequeued from the transmit queue,
+   * together with the packets waiting behind it if a burst is allowed.
+   *
+   * \param p the packet
+   * \returns true if success, false on failure
+   */
+  bool TransmitDequeued (Ptr<Packet> p);
+
+  /**
+   * \returns true if the packets waiting in the queue may be sent as
+   * a burst.
+   */
+  bool CanTransmitBurst (void) const;
+
+  /**
+   * Forget the packets of the burst which have started, and tell
+   * whether the queue would overflow if those which have not were
+   * still in it.
+   *
+   * \param p the packet to enqueue
+   * \returns true if the packet has to be dropped
+   */
+  bool IsBurstBacklogFull (Ptr<const Packet> p);
+
+  /**
+   * Send a packet from above: add the header, enqueue it, and start
+   * transmitting if the transmitter is ready.
+   *
+   * \param packet the packet
+   * \param protocolNumber the protocol number of the payload
+   * \param txq the queue of the device in the traffic control layer, if any
+   * \returns true if the packet was accepted
+   */
+  bool SendPacket (Ptr<Packet> packet, uint16_t protocolNumber, Ptr<NetDeviceQueue> txq);
+
   /**
    * Stop Sending a Packet Down the Wire and Begin the Interframe Gap.
    *
@@ -309,6 +374,23 @@ private:
    */
   Time           m_tInterframeGap;
 
+  /**
+   * The largest number of packets sent back-to-back with a single
+   * event, 1 to send each packet on its own.
+   */
+  uint32_t       m_maxBurstPackets;
+
+  /**
+   * The start times and the sizes of the packets of the current burst
+   * which would still be in the queue if sent one by one.
+   */
+  std::deque<std::pair<Time, uint32_t> > m_burstBacklog;
+
+  /**
+   * The total size of the packets of m_burstBacklog.
+   */
+  uint32_t       m_burstBacklogBytes;
+
   /**
    * The PointToPointChannel to which this PointToPointNetDevice has been
    * attached.
@@ -23,6 +23,7 @@
 #include "point-to-point-remote-channel.h"
 #include "point-to-point-net-device.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/mpi-interface.h"
@@ -77,4 +78,33 @@ PointToPointRemoteChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointRemoteChannel::TransmitBurstStart (
+  Ptr<PacketBurst> burst,
+  Ptr<PointToPointNetDevice> src,
+  DataRate bps,
+  Time interframeGap)
+{
+  NS_LOG_FUNCTION (this << burst << src);
+
+  IsInitialized ();
+
+  uint32_t wire = src == GetSource (0) ? 0 : 1;
+  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+
+#ifdef NS3_MPI
+  // Calculate the rxTime (absolute) of each packet
+  Time start = Simulator::Now ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); ++i)
+    {
+      Time txEnd = start + bps.CalculateBytesTxTime ((*i)->GetSize ());
+      MpiInterface::SendPacket (*i, txEnd + GetDelay (), dst->GetNode ()->GetId (), dst->GetIfIndex ());
+      start = txEnd + interframeGap;
+    }
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+  return true;
+}
+
 } // namespace ns3
@@ -68,6 +68,18 @@ public:
    */
   virtual bool TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+  /**
+   * \brief Transmit back-to-back packets
+   *
+   * \param burst Packets to transmit, in order
+   * \param src Source PointToPointNetDevice
+   * \param bps Data rate of the source
+   * \param interframeGap Time between the end of a packet and the start of the next
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitBurstStart (Ptr<PacketBurst> burst, Ptr<PointToPointNetDevice> src,
+                                   DataRate bps, Time interframeGap);
 };
 
 } // namespace ns3
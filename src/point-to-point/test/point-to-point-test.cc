@@ -23,6 +23,9 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/packet-burst.h"
+#include "ns3/uinteger.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -98,6 +101,162 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test of the bursts of PointToPointNetDevice
+ *
+ * It sends the same packets with and without bursts, and checks that
+ * they are received at the same times, with fewer events, and that the
+ * same packets are dropped when the queue overflows.
+ */
+class PointToPointBurstTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBurstTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send packets of various sizes over a link
+   *
+   * \param maxBurstPackets the MaxBurstPackets attribute of the sender
+   * \param overflow whether to send more packets than the queue holds
+   * \param rxTimes the receive times of the packets
+   * \returns the number of events executed
+   */
+  uint64_t SendPackets (uint32_t maxBurstPackets, bool overflow, std::vector<Time> &rxTimes);
+
+  /**
+   * \brief Send a burst of packets to the device specified
+   *
+   * \param device NetDevice to send to
+   * \param n the number of packets
+   */
+  void SendBurst (Ptr<PointToPointNetDevice> device, uint32_t n);
+
+  /**
+   * \brief Record the time a packet is received
+   *
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                uint16_t protocol, const Address &from);
+
+  std::vector<Time> m_rxTimes; //!< The receive times of the current run
+};
+
+PointToPointBurstTest::PointToPointBurstTest ()
+  : TestCase ("PointToPoint bursts")
+{
+}
+
+void
+PointToPointBurstTest::SendBurst (Ptr<PointToPointNetDevice> device, uint32_t n)
+{
+  Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      burst->AddPacket (Create<Packet> (100 + 50 * i));
+    }
+  device->SendBurst (burst, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointBurstTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                uint16_t protocol, const Address &from)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+  return true;
+}
+
+uint64_t
+PointToPointBurstTest::SendPackets (uint32_t maxBurstPackets, bool overflow, std::vector<Time> &rxTimes)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  Ptr<DropTailQueue> queue = CreateObject<DropTailQueue> ();
+  queue->SetAttribute ("MaxPackets", UintegerValue (overflow ? 8 : 100));
+  devA->SetQueue (queue);
+  devA->SetDataRate (DataRate ("10Mbps"));
+  devA->SetInterframeGap (MicroSeconds (1));
+  devA->SetAttribute ("MaxBurstPackets", UintegerValue (maxBurstPackets));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue> ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointBurstTest::Receive, this));
+
+  m_rxTimes.clear ();
+  if (overflow)
+    {
+      // A full queue, and more packets sent once five packets have
+      // left it: five of them fit, whether the packets left behind are
+      // sent one by one or in a burst.
+      Simulator::Schedule (Seconds (1.0), &PointToPointBurstTest::SendBurst, this, devA, 9);
+      Simulator::Schedule (Seconds (1.001), &PointToPointBurstTest::SendBurst, this, devA, 8);
+    }
+  else
+    {
+      // A burst, more packets sent while it is on the wire, and a last
+      // burst once the link is idle again.
+      Simulator::Schedule (Seconds (1.0), &PointToPointBurstTest::SendBurst, this, devA, 20);
+      Simulator::Schedule (Seconds (1.001), &PointToPointBurstTest::SendBurst, this, devA, 1);
+      Simulator::Schedule (Seconds (1.002), &PointToPointBurstTest::SendBurst, this, devA, 5);
+      Simulator::Schedule (Seconds (2.0), &PointToPointBurstTest::SendBurst, this, devA, 3);
+    }
+
+  Simulator::Run ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  rxTimes = m_rxTimes;
+  return events;
+}
+
+void
+PointToPointBurstTest::DoRun (void)
+{
+  std::vector<Time> single;
+  std::vector<Time> burst;
+  uint64_t singleEvents = SendPackets (1, false, single);
+  uint64_t burstEvents = SendPackets (8, false, burst);
+
+  NS_TEST_ASSERT_MSG_EQ (single.size (), 29, "All the packets should be received");
+  NS_TEST_ASSERT_MSG_EQ (burst.size (), single.size (), "All the packets should be received in bursts");
+  for (uint32_t i = 0; i < single.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (burst[i], single[i], "Packet " << i << " should be received at the same time");
+    }
+  NS_TEST_EXPECT_MSG_LT (burstEvents, singleEvents - 20, "The bursts should save events");
+
+  SendPackets (1, true, single);
+  SendPackets (8, true, burst);
+  NS_TEST_ASSERT_MSG_EQ (single.size (), 14, "Three packets should overflow the queue");
+  NS_TEST_ASSERT_MSG_EQ (burst.size (), single.size (), "The same packets should overflow the queue in bursts");
+  for (uint32_t i = 0; i < single.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (burst[i], single[i], "Packet " << i << " should be received at the same time");
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -114,6 +273,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBurstTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/packetbb.h"
+#include "ns3/icmpv6-header.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/sdn-db-header.h"
+
+/**
+ * \file
+ * \ingroup packet
+ * Benchmark of the serialization of the largest headers.
+ *
+ * Each header is serialized into, and deserialized from, a buffer
+ * of its size, as Packet::AddHeader and Packet::RemoveHeader do once
+ * the buffer is reserved.  The program reports the time of each
+ * operation:
+ *
+ * \verbatim
+   ./waf --run="bench-header-serialization --iterations=1000000"
+   \endverbatim
+ */
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * Time the serialization and the deserialization of a header.
+ *
+ * \param [in] name The name of the header.
+ * \param [in] header The header.
+ * \param [in] iterations The number of operations timed.
+ */
+template <typename T>
+void
+Bench (std::string name, const T &header, uint32_t iterations)
+{
+  uint32_t size = header.GetSerializedSize ();
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      header.Serialize (buffer.Begin ());
+    }
+  int64_t serializeMs = clock.End ();
+
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      T copy;
+      copy.Deserialize (buffer.Begin ());
+    }
+  int64_t deserializeMs = clock.End ();
+
+  std::cout << std::left << std::setw (28) << name
+            << std::right << std::setw (5) << size << " bytes: "
+            << std::fixed << std::setprecision (1)
+            << (serializeMs * 1e6) / iterations << " ns serialize, "
+            << (deserializeMs * 1e6) / iterations << " ns deserialize"
+            << std::endl;
+}
+
+} // anonymous namespace
+
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t iterations = 1000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("iterations", "Operations timed per header", iterations);
+  cmd.Parse (argc, argv);
+
+  WifiMacHeader wifi;
+  wifi.SetType (WIFI_MAC_QOSDATA);
+  wifi.SetDsFrom ();
+  wifi.SetDsTo ();
+  wifi.SetAddr1 (Mac48Address ("00:00:00:00:00:01"));
+  wifi.SetAddr2 (Mac48Address ("00:00:00:00:00:02"));
+  wifi.SetAddr3 (Mac48Address ("00:00:00:00:00:03"));
+  wifi.SetAddr4 (Mac48Address ("00:00:00:00:00:04"));
+  wifi.SetDuration (MicroSeconds (44));
+  wifi.SetSequenceNumber (100);
+  wifi.SetFragmentNumber (0);
+  wifi.SetNoMoreFragments ();
+  wifi.SetNoRetry ();
+  wifi.SetQosTid (5);
+  wifi.SetQosNoEosp ();
+  wifi.SetQosNormalAck ();
+  wifi.SetQosNoAmsdu ();
+  wifi.SetQosTxopLimit (0);
+  Bench ("WifiMacHeader", wifi, iterations);
+
+  Icmpv6NA na;
+  na.SetIpv6Target (Ipv6Address ("2001:db8::1"));
+  na.SetFlagS (true);
+  Bench ("Icmpv6NA", na, iterations);
+
+  Icmpv6RA ra;
+  ra.SetCurHopLimit (64);
+  ra.SetLifeTime (1800);
+  ra.SetReachableTime (30000);
+  Bench ("Icmpv6RA", ra, iterations);
+
+  sdndb::MessageHeader hello;
+  hello.SetMessageType (sdndb::MessageHeader::HELLO_MESSAGE);
+  hello.GetHello ().ID = Ipv4Address ("10.0.0.1");
+  hello.GetHello ().SetPosition (100, 200, 0);
+  hello.GetHello ().SetVelocity (10, 0, 0);
+  Bench ("sdndb::MessageHeader Hello", hello, iterations);
+
+  sdndb::MessageHeader rm;
+  rm.SetMessageType (sdndb::MessageHeader::ROUTING_MESSAGE);
+  rm.GetRm ().ID = Ipv4Address ("10.0.0.1");
+  for (uint32_t i = 0; i < 32; i++)
+    {
+      sdndb::MessageHeader::Rm::Routing_Tuple route;
+      route.destAddress = Ipv4Address (0x0a000100 + i);
+      route.mask = Ipv4Address (0xffffff00);
+      route.nextHop = Ipv4Address (0x0a000002 + i);
+      rm.GetRm ().routingTables.push_back (route);
+    }
+  rm.GetRm ().SetRoutingMessageSize (rm.GetRm ().routingTables.size ());
+  Bench ("sdndb::MessageHeader Rm", rm, iterations);
+
+  PbbPacket pbb;
+  pbb.SetSequenceNumber (1);
+  Ptr<PbbMessageIpv4> message = Create<PbbMessageIpv4> ();
+  message->SetType (1);
+  message->SetOriginatorAddress (Ipv4Address ("10.0.0.1"));
+  message->SetHopLimit (255);
+  message->SetSequenceNumber (1);
+  uint8_t value[4] = { 1, 2, 3, 4 };
+  for (uint8_t type = 0; type < 8; type++)
+    {
+      Ptr<PbbTlv> tlv = Create<PbbTlv> ();
+      tlv->SetType (type);
+      tlv->SetValue (value, sizeof (value));
+      message->TlvPushBack (tlv);
+    }
+  Ptr<PbbAddressBlockIpv4> block = Create<PbbAddressBlockIpv4> ();
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      block->AddressPushBack (Ipv4Address (0x0a000001 + i));
+    }
+  for (uint8_t index = 0; index < 8; index++)
+    {
+      Ptr<PbbAddressTlv> tlv = Create<PbbAddressTlv> ();
+      tlv->SetType (1);
+      tlv->SetIndexStart (index);
+      tlv->SetValue (value, 1);
+      block->TlvPushBack (tlv);
+    }
+  message->AddressBlockPushBack (block);
+  pbb.MessagePushBack (message);
+  Bench ("PbbPacket", pbb, iterations);
+
+  return 0;
+}
@@ -208,12 +208,14 @@ void
 MessageHeader::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
-  i.WriteHtonU32 (GetOriginatorAddress().Get());
-  i.WriteU8 (m_messageType);
-  i.WriteU8 (m_vTime);
-  i.WriteHtonU16 (GetSerializedSize ());
-  i.WriteHtonU16 (m_timeToLive);
-  i.WriteHtonU16 (m_messageSequenceNumber);
+  Buffer::Span span (i, SDN_MSG_HEADER_SIZE);
+  span.WriteHtonU32 (GetOriginatorAddress().Get());
+  span.WriteU8 (m_messageType);
+  span.WriteU8 (m_vTime);
+  span.WriteHtonU16 (GetSerializedSize ());
+  span.WriteHtonU16 (m_timeToLive);
+  span.WriteHtonU16 (m_messageSequenceNumber);
+  span.Commit ();
 
   switch (m_messageType)
     {
@@ -250,14 +252,16 @@ MessageHeader::Deserialize (Buffer::Iterator start)
 {
   uint32_t size;
   Buffer::Iterator i = start;
-  uint32_t add_temp = i.ReadNtohU32();
+  Buffer::Span span (i, SDN_MSG_HEADER_SIZE);
+  uint32_t add_temp = span.ReadNtohU32();
   SetOriginatorAddress(Ipv4Address(add_temp));
-  m_messageType  = (MessageType) i.ReadU8 ();
+  m_messageType  = (MessageType) span.ReadU8 ();
   NS_ASSERT (m_messageType >= HELLO_MESSAGE && m_messageType <= LCROUTING_MESSAGE);//todo
-  m_vTime  = i.ReadU8 ();
-  m_messageSize  = i.ReadNtohU16 ();
-  m_timeToLive  = i.ReadNtohU16 ();
-  m_messageSequenceNumber = i.ReadNtohU16 ();
+  m_vTime  = span.ReadU8 ();
+  m_messageSize  = span.ReadNtohU16 ();
+  m_timeToLive  = span.ReadNtohU16 ();
+  m_messageSequenceNumber = span.ReadNtohU16 ();
+  span.Commit ();
   size = SDN_MSG_HEADER_SIZE;
   switch (m_messageType)
     {
@@ -315,15 +319,16 @@ void
 MessageHeader::Hello::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
+  Buffer::Span span (i, SDN_HELLO_HEADER_SIZE);
 
-  i.WriteHtonU32 (this->ID.Get());
-  i.WriteHtonU32 (this->position.X);
-  i.WriteHtonU32 (this->position.Y);
-  i.WriteHtonU32 (this->position.Z);
-  i.WriteHtonU32 (this->velocity.X);
-  i.WriteHtonU32 (this->velocity.Y);
-  i.WriteHtonU32 (this->velocity.Z);
-
+  span.WriteHtonU32 (this->ID.Get());
+  span.WriteHtonU32 (this->position.X);
+  span.WriteHtonU32 (this->position.Y);
+  span.WriteHtonU32 (this->position.Z);
+  span.WriteHtonU32 (this->velocity.X);
+  span.WriteHtonU32 (this->velocity.Y);
+  span.WriteHtonU32 (this->velocity.Z);
+  span.Commit ();
 }
 
 uint32_t
@@ -334,14 +339,16 @@ MessageHeader::Hello::Deserialize (Buffer::Iterator start,
 
   NS_ASSERT (messageSize == SDN_HELLO_HEADER_SIZE);
 
-  uint32_t add_temp = i.ReadNtohU32();
+  Buffer::Span span (i, SDN_HELLO_HEADER_SIZE);
+  uint32_t add_temp = span.ReadNtohU32();
   this->ID.Set(add_temp);
-  this->position.X = i.ReadNtohU32();
-  this->position.Y = i.ReadNtohU32();
-  this->position.Z = i.ReadNtohU32();
-  this->velocity.X = i.ReadNtohU32();
-  this->velocity.Y = i.ReadNtohU32();
-  this->velocity.Z = i.ReadNtohU32();
+  this->position.X = span.ReadNtohU32();
+  this->position.Y = span.ReadNtohU32();
+  this->position.Z = span.ReadNtohU32();
+  this->velocity.X = span.ReadNtohU32();
+  this->velocity.Y = span.ReadNtohU32();
+  this->velocity.Z = span.ReadNtohU32();
+  span.Commit ();
 
   return (messageSize);
 }
@@ -367,19 +374,21 @@ void
 MessageHeader::Rm::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
+  Buffer::Span span (i, GetSerializedSize ());
 
-  i.WriteHtonU32 (this->routingMessageSize);
-  i.WriteHtonU32 (this->ID.Get());
+  span.WriteHtonU32 (this->routingMessageSize);
+  span.WriteHtonU32 (this->ID.Get());
 
   for (std::vector<Routing_Tuple>::const_iterator iter = 
     this->routingTables.begin (); 
     iter != this->routingTables.end (); 
     iter++)
     {
-      i.WriteHtonU32 (iter->destAddress.Get());
-      i.WriteHtonU32 (iter->mask.Get());
-      i.WriteHtonU32 (iter->nextHop.Get());
+      span.WriteHtonU32 (iter->destAddress.Get());
+      span.WriteHtonU32 (iter->mask.Get());
+      span.WriteHtonU32 (iter->nextHop.Get());
     }
+  span.Commit ();
 }
 
 uint32_t
@@ -391,8 +400,9 @@ MessageHeader::Rm::Deserialize (Buffer::Iterator start,
   this->routingTables.clear ();
   NS_ASSERT (messageSize >= SDN_RM_HEADER_SIZE);
 
-  this->routingMessageSize = i.ReadNtohU32 ();
-  uint32_t add_temp = i.ReadNtohU32();
+  Buffer::Span span (i, messageSize);
+  this->routingMessageSize = span.ReadNtohU32 ();
+  uint32_t add_temp = span.ReadNtohU32();
   this->ID.Set(add_temp);
 
   NS_ASSERT ((messageSize - SDN_RM_HEADER_SIZE) % 
@@ -400,17 +410,19 @@ MessageHeader::Rm::Deserialize (Buffer::Iterator start,
     
   int numTuples = (messageSize - SDN_RM_HEADER_SIZE) 
     / (IPV4_ADDRESS_SIZE * SDN_RM_TUPLE_SIZE);
+  this->routingTables.reserve (numTuples);
   for (int n = 0; n < numTuples; ++n)
   {
     Routing_Tuple temp_tuple;
-    uint32_t temp_dest = i.ReadNtohU32();
-    uint32_t temp_mask = i.ReadNtohU32();
-    uint32_t temp_next = i.ReadNtohU32();
+    uint32_t temp_dest = span.ReadNtohU32();
+    uint32_t temp_mask = span.ReadNtohU32();
+    uint32_t temp_next = span.ReadNtohU32();
     temp_tuple.destAddress.Set(temp_dest);
     temp_tuple.mask.Set(temp_mask);
     temp_tuple.nextHop.Set(temp_next);
     this->routingTables.push_back (temp_tuple);
    }
+  span.Commit ();
     
   return (messageSize);
 }
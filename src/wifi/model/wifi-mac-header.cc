@@ -20,6 +20,8 @@
  * Author: Mirko Banchi <mk.banchi@gmail.com>
  */
 
+#include <algorithm>
+
 #include "ns3/assert.h"
 #include "ns3/address-utils.h"
 #include "wifi-mac-header.h"
@@ -1165,8 +1167,9 @@ WifiMacHeader::GetSerializedSize (void) const
 }
 
 void
-WifiMacHeader::Serialize (Buffer::Iterator i) const
+WifiMacHeader::Serialize (Buffer::Iterator start) const
 {
+  Buffer::Span i (start, GetSerializedSize ());
   i.WriteHtolsbU16 (GetFrameControl ());
   i.WriteHtolsbU16 (m_duration);
   WriteTo (i, m_addr1);
@@ -1215,14 +1218,17 @@ WifiMacHeader::Serialize (Buffer::Iterator i) const
       NS_ASSERT (false);
       break;
     }
+  i.Commit ();
 }
 
 uint32_t
 WifiMacHeader::Deserialize (Buffer::Iterator start)
 {
-  Buffer::Iterator i = start;
-  uint16_t frame_control = i.ReadLsbtohU16 ();
+  Buffer::Iterator j = start;
+  uint16_t frame_control = j.ReadLsbtohU16 ();
   SetFrameControl (frame_control);
+  // The duration and the first address follow in all the frames.
+  Buffer::Span i (j, std::max (GetSerializedSize (), 10U) - 2);
   m_duration = i.ReadLsbtohU16 ();
   ReadFrom (i, m_addr1);
   switch (m_ctrlType)
@@ -1261,7 +1267,8 @@ WifiMacHeader::Deserialize (Buffer::Iterator start)
         }
       break;
     }
-  return i.GetDistanceFrom (start);
+  i.Commit ();
+  return j.GetDistanceFrom (start);
 }
 
 } //namespace ns3
@@ -83,6 +83,8 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
+  EventBatch batch;
+  batch.Reserve (m_phyList.size ());
   uint32_t j = 0;
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
     {
@@ -118,11 +120,11 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
           parameters.txVector = txVector;
           parameters.preamble = preamble;
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, parameters);
+          batch.Add (dstNode, delay, &YansWifiChannel::Receive, this,
+                     j, copy, parameters);
         }
     }
+  Simulator::ScheduleWithContext (batch);
 }
 
 void
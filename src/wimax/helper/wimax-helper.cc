@@ -409,12 +409,20 @@ void WimaxHelper::AsciiRxEvent (Ptr<OutputStreamWrapper> stream,
                                 Ptr<const Packet> packet,
                                 const Mac48Address &source)
 {
+  if (!AsciiTraceHelper::IsSampled (stream, packet))
+    {
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " from: " << source << " ";
   *stream->GetStream () << path << std::endl;
 }
 
 void WimaxHelper::AsciiTxEvent (Ptr<OutputStreamWrapper> stream, std::string path, Ptr<const Packet> packet, const Mac48Address &dest)
 {
+  if (!AsciiTraceHelper::IsSampled (stream, packet))
+    {
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " to: " << dest << " ";
   *stream->GetStream () << path << std::endl;
 }